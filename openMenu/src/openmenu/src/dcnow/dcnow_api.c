@@ -1,35 +1,110 @@
 #include "dcnow_api.h"
 #include "dcnow_json.h"
+#include "dcnow_http.h"
+#include "dcnow_delta.h"
 #include "dcnow_vmu.h"
 #include "dcnow_net_init.h"
+#include "dcnow_port.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <errno.h>
+#include <stdatomic.h>
 
 #ifdef _arch_dreamcast
-#include <kos.h>
-#include <kos/net.h>
-#include <kos/thread.h>
-#include <arch/timer.h>
 #include <dc/modem/modem.h>
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
-#include <netdb.h>
-#include <unistd.h>
 #endif
 
-/* Cached data from last successful fetch */
-static dcnow_data_t cached_data = {0};
+#define DCNOW_HOST "dreamcast.online"
+#define DCNOW_PORT 80
+#define DCNOW_PATH "/now/api/users.json"
+
+/*
+ * Results are triple buffered. A fetch fills snapshots[snapshot_write] in place
+ * and publishes it by swapping its index with snapshot_middle, the reader takes
+ * the newest one by swapping its own index back. Neither side ever sees a buffer
+ * the other is using and nothing is copied. One writer at a time (the worker, or
+ * the main loop without DCNOW_ASYNC) and one reader (the main loop).
+ */
+#define SNAPSHOT_INDEX 3
+#define SNAPSHOT_FRESH 4  /* middle holds a buffer the reader hasn't taken yet */
+
+static dcnow_data_t snapshots[3];
+static int snapshot_write = 1;           /* writer's */
+static int snapshot_read = 0;            /* reader's */
+static atomic_int snapshot_middle = 2;
+/* Last buffer published, writer's to read: nobody writes it until it comes back */
+static int snapshot_published = 0;
+static uint32_t snapshot_seq = 0;
+
+/* The published data is the one cached_validators describe */
 static bool cache_valid = false;
+#ifdef _arch_dreamcast
 static bool network_initialized = false;
-static int last_socket_errno = 0;  /* Store errno from socket failures */
+#endif
+/* Sent along with the next request so an unchanged list costs a 304 and no parse */
+static http_validators_t cached_validators = {0};
+static char last_error[128] = "";
+
+/* Where fetches go, dreamcast.online unless dcnow_set_server() said otherwise */
+static char server_host[64] = DCNOW_HOST;
+static uint16_t server_port = DCNOW_PORT;
+
+static dcnow_fetch_stats_t fetch_stats;
+#ifdef DCNOW_NET
+static uint64_t fetch_start;
+static bool first_game_seen;
+#endif
+
+/* fetch_into() result when the server's list hasn't changed */
+#define FETCH_NOT_MODIFIED 1
+
+#ifdef DCNOW_NET
+/* Mostly its 32KB history window, too big for the stack of whichever thread fetches */
+static inflate_stream_t inflater;
+#endif
+
+static void snapshot_publish(void) {
+    dcnow_data_t* data = &snapshots[snapshot_write];
+
+    data->seq = ++snapshot_seq;
+    dcnow_delta_compute(&snapshots[snapshot_published], data);
+
+    snapshot_published = snapshot_write;
+    snapshot_write = atomic_exchange(&snapshot_middle, snapshot_write | SNAPSHOT_FRESH) & SNAPSHOT_INDEX;
+}
+
+const dcnow_data_t* dcnow_get_snapshot(void) {
+    if (atomic_load(&snapshot_middle) & SNAPSHOT_FRESH) {
+        snapshot_read = atomic_exchange(&snapshot_middle, snapshot_read) & SNAPSHOT_INDEX;
+    }
+    return &snapshots[snapshot_read];
+}
+
+const char* dcnow_get_last_error(void) {
+    return last_error;
+}
+
+void dcnow_set_server(const char* host, uint16_t port) {
+    strncpy(server_host, host ? host : DCNOW_HOST, sizeof(server_host) - 1);
+    server_host[sizeof(server_host) - 1] = '\0';
+    server_port = host ? port : DCNOW_PORT;
+    /* Validators from one server mean nothing to another */
+    memset(&cached_validators, 0, sizeof(cached_validators));
+    cache_valid = false;
+}
+
+void dcnow_set_cancel_flag(const volatile bool* flag) {
+    dcnow_http_set_cancel_flag(flag);
+}
+
+const dcnow_fetch_stats_t* dcnow_get_fetch_stats(void) {
+    return &fetch_stats;
+}
 
 int dcnow_init(void) {
 #ifdef _arch_dreamcast
-    /* Initialize the cache */
-    memset(&cached_data, 0, sizeof(cached_data));
+    /* A new connection starts with an unconditional fetch */
     cache_valid = false;
 
     /* Verify network device exists */
@@ -96,7 +171,6 @@ int dcnow_init(void) {
     return 0;
 #else
     /* Non-Dreamcast platforms - just initialize cache */
-    memset(&cached_data, 0, sizeof(cached_data));
     cache_valid = false;
     return 0;
 #endif
@@ -104,187 +178,34 @@ int dcnow_init(void) {
 
 void dcnow_shutdown(void) {
     cache_valid = false;
+#ifdef DCNOW_NET
+    dcnow_http_disconnect();
+#endif
     /* Note: We don't call net_shutdown() as other parts of the system may be using the network */
 }
 
-#ifdef _arch_dreamcast
-static int http_get_request(const char* hostname, const char* path, char* response_buf, int buf_size, uint32_t timeout_ms) {
-    int sock = -1;
-    struct hostent *host;
-    struct sockaddr_in server_addr;
-    char request_buf[512];
-    int total_received = 0;
-    uint64_t start_time;
-    uint64_t timeout_ticks;
-    FILE* logfile;
-
-    /* Verify network is still available */
-    if (!net_default_dev) {
-        DCNOW_DPRINTF("DC Now: ERROR - Network device disappeared\n");
-        return -2;
-    }
-
-    DCNOW_DPRINTF("DC Now: net_default_dev = %p\n", (void*)net_default_dev);
-    DCNOW_DPRINTF("DC Now: Device name: %s\n", net_default_dev->name);
-    DCNOW_DPRINTF("DC Now: IP: %d.%d.%d.%d\n",
-           net_default_dev->ip_addr[0], net_default_dev->ip_addr[1],
-           net_default_dev->ip_addr[2], net_default_dev->ip_addr[3]);
-    DCNOW_DPRINTF("DC Now: DNS: %d.%d.%d.%d\n",
-           net_default_dev->dns[0], net_default_dev->dns[1],
-           net_default_dev->dns[2], net_default_dev->dns[3]);
-
-    /* Create socket - Try protocol 0 first, then IPPROTO_TCP */
-    DCNOW_DPRINTF("DC Now: Attempting socket(AF_INET, SOCK_STREAM, 0)...\n");
-    sock = socket(AF_INET, SOCK_STREAM, 0);
-
-    if (sock < 0) {
-        DCNOW_DPRINTF("DC Now: Protocol 0 failed (errno=%d), trying IPPROTO_TCP...\n", errno);
-        sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-    }
-
-    if (sock < 0) {
-        last_socket_errno = errno;
-        DCNOW_DPRINTF("DC Now: ERROR - socket() failed, errno=%d\n", errno);
-        switch (errno) {
-            case EIO: DCNOW_DPRINTF("DC Now: I/O error\n"); break;
-            case EPROTONOSUPPORT: DCNOW_DPRINTF("DC Now: Protocol not supported\n"); break;
-            case EMFILE: DCNOW_DPRINTF("DC Now: Too many open files\n"); break;
-            case ENFILE: DCNOW_DPRINTF("DC Now: System file table full\n"); break;
-            case EACCES: DCNOW_DPRINTF("DC Now: Permission denied\n"); break;
-            case ENOBUFS: DCNOW_DPRINTF("DC Now: No buffer space available\n"); break;
-            case ENOMEM: DCNOW_DPRINTF("DC Now: Out of memory\n"); break;
-            default: DCNOW_DPRINTF("DC Now: Unknown socket error\n"); break;
-        }
-        return -2;
-    }
-
-    last_socket_errno = 0;  /* Clear errno on success */
-
-    DCNOW_DPRINTF("DC Now: Socket created successfully (fd=%d)\n", sock);
-
-    /* Log success to SD card */
-    logfile = fopen("/ram/DCNOW_LOG.TXT", "a");
-    if (logfile) {
-        fprintf(logfile, "Socket created: fd=%d\n", sock);
-        fclose(logfile);
-    }
-
-    /* Resolve hostname */
-    DCNOW_DPRINTF("DC Now: Resolving %s...\n", hostname);
-    dcnow_vmu_show_refreshing();  /* Update spinner before DNS lookup */
-    host = gethostbyname(hostname);
-    if (!host) {
-        DCNOW_DPRINTF("DC Now: DNS lookup failed for %s\n", hostname);
-        close(sock);
-        return -3;  /* DNS resolution failed */
-    }
-
-    DCNOW_DPRINTF("DC Now: Resolved to %s\n", inet_ntoa(*(struct in_addr*)host->h_addr));
-    dcnow_vmu_show_refreshing();  /* Update spinner after DNS */
-
-    /* Setup server address */
-    memset(&server_addr, 0, sizeof(server_addr));
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(80);
-    memcpy(&server_addr.sin_addr, host->h_addr, host->h_length);
-
-    /* Connect to server */
-    DCNOW_DPRINTF("DC Now: Connecting...\n");
-    dcnow_vmu_show_refreshing();  /* Update spinner before connect */
-    start_time = timer_ms_gettime64();
-    timeout_ticks = timeout_ms;
-
-    int connect_result = connect(sock, (struct sockaddr*)&server_addr, sizeof(server_addr));
-
-    if (connect_result < 0) {
-        /* For blocking sockets, connect should succeed or fail immediately on Dreamcast */
-        DCNOW_DPRINTF("DC Now: Connection failed (errno: %d)\n", errno);
-        close(sock);
-        return -4;
-    }
-
-    DCNOW_DPRINTF("DC Now: Connected\n");
-    dcnow_vmu_show_refreshing();  /* Update spinner after connect */
-
-    /* Build HTTP GET request */
-    snprintf(request_buf, sizeof(request_buf),
-             "GET %s HTTP/1.1\r\n"
-             "Host: %s\r\n"
-             "User-Agent: openMenu-Dreamcast/1.1-ateam\r\n"
-             "Accept: application/json\r\n"
-             "Connection: close\r\n"
-             "\r\n",
-             path, hostname);
-
-    /* Send request */
-    DCNOW_DPRINTF("DC Now: Sending request...\n");
-    int sent = send(sock, request_buf, strlen(request_buf), 0);
-    if (sent <= 0) {
-        DCNOW_DPRINTF("DC Now: Send failed (errno: %d)\n", errno);
-        close(sock);
-        return -5;  /* Send failed */
-    }
-
-    DCNOW_DPRINTF("DC Now: Request sent, waiting for response...\n");
-
-    /* Receive response */
-    start_time = timer_ms_gettime64();
-    total_received = 0;
-    uint64 last_spinner_update = 0;
-
-    while (total_received < buf_size - 1) {
-        if (timer_ms_gettime64() - start_time > timeout_ticks) {
-            DCNOW_DPRINTF("DC Now: Receive timeout\n");
-            break;  /* Timeout - but we may have received some data */
-        }
-
-        /* Update spinner animation every 100ms for smooth animation */
-        uint64 now = timer_ms_gettime64();
-        if (now - last_spinner_update >= 100) {
-            dcnow_vmu_show_refreshing();
-            last_spinner_update = now;
-        }
-
-        int received = recv(sock, response_buf + total_received,
-                           buf_size - total_received - 1, 0);
-
-        if (received > 0) {
-            total_received += received;
-            start_time = timer_ms_gettime64();  /* Reset timeout on successful receive */
-        } else if (received == 0) {
-            /* Connection closed by server - this is normal */
-            DCNOW_DPRINTF("DC Now: Server closed connection\n");
-            break;
-        } else {
-            /* Error receiving */
-            if (total_received == 0) {
-                DCNOW_DPRINTF("DC Now: Receive failed (errno: %d)\n", errno);
-                close(sock);
-                return -6;  /* Receive failed */
-            }
-            break;  /* We got some data, so continue */
-        }
+#ifdef DCNOW_NET
+/* Body bytes go straight into the JSON parser */
+static void http_body_to_json(void* user, const char* data, int len) {
+    json_parser_t* parser = (json_parser_t*)user;
 
-        thd_pass();  /* Yield to other threads */
+    dcnow_json_feed(parser, data, len);
+    if (!first_game_seen && parser->game_count > 0) {
+        first_game_seen = true;
+        fetch_stats.first_game_ms = (uint32_t)(dcnow_port_ms() - fetch_start);
     }
-
-    response_buf[total_received] = '\0';
-    close(sock);
-
-    DCNOW_DPRINTF("DC Now: Received %d bytes\n", total_received);
-
-    return (total_received > 0) ? total_received : -6;
 }
 #endif
 
-int dcnow_fetch_data(dcnow_data_t *data, uint32_t timeout_ms) {
-    if (!data) {
-        return -1;
-    }
-
-    /* Clear the data structure */
+/* Fills data, which nobody else is looking at, returns FETCH_NOT_MODIFIED if it was left alone */
+static int fetch_into(dcnow_data_t *data, uint32_t timeout_ms) {
+    /* Clear the data structure, the arena keeps its blocks for the parse */
+    const dcnow_arena_t arena = data->arena;
     memset(data, 0, sizeof(dcnow_data_t));
+    data->arena = arena;
+    memset(&fetch_stats, 0, sizeof(fetch_stats));
 
+#ifdef DCNOW_NET
 #ifdef _arch_dreamcast
     /* Detailed network checks */
     if (!net_default_dev) {
@@ -301,19 +222,35 @@ int dcnow_fetch_data(dcnow_data_t *data, uint32_t timeout_ms) {
         return -12;
     }
 
-    char response[8192];
-    int result;
-
-    DCNOW_DPRINTF("DC Now: Fetching data from dreamcast.online/now/api/users.json...\n");
     DCNOW_DPRINTF("DC Now: Using device %s, IP %d.%d.%d.%d\n",
            net_default_dev->name,
            net_default_dev->ip_addr[0],
            net_default_dev->ip_addr[1],
            net_default_dev->ip_addr[2],
            net_default_dev->ip_addr[3]);
+#endif
+
+    http_response_t response;
+    json_parser_t parser;
+    json_dcnow_t json_result;
+    int result;
+
+    fetch_start = dcnow_port_ms();
+    first_game_seen = false;
+    DCNOW_DPRINTF("DC Now: Fetching data from %s:%u%s...\n", server_host, (unsigned)server_port, DCNOW_PATH);
 
     /* Perform HTTP GET request - use correct API endpoint */
-    result = http_get_request("dreamcast.online", "/now/api/users.json", response, sizeof(response), timeout_ms);
+    dcnow_json_begin(&parser, &json_result, &data->arena);
+    dcnow_http_response_init(&response, http_body_to_json, &parser);
+    response.inflater = &inflater;
+    result = dcnow_http_get(server_host, server_port, DCNOW_PATH,
+                            cache_valid ? &cached_validators : NULL, &response, timeout_ms);
+
+    fetch_stats.total_ms = (uint32_t)(dcnow_port_ms() - fetch_start);
+    fetch_stats.status = response.status;
+    fetch_stats.gzip = response.gzip;
+    fetch_stats.body_bytes = response.body_bytes;
+    fetch_stats.inflated_bytes = response.gzip ? inflater.out_bytes : response.body_bytes;
 
     if (result < 0) {
         /* Network error - create meaningful error message */
@@ -325,8 +262,8 @@ int dcnow_fetch_data(dcnow_data_t *data, uint32_t timeout_ms) {
             case -2:
                 error_msg = "Socket creation failed";
                 /* Include errno if available */
-                if (last_socket_errno != 0) {
-                    switch(last_socket_errno) {
+                if (dcnow_http_socket_errno() != 0) {
+                    switch(dcnow_http_socket_errno()) {
                         case EIO: errno_str = "I/O error"; break;
                         case EPROTONOSUPPORT: errno_str = "Proto not supported"; break;
                         case EMFILE: errno_str = "Too many files"; break;
@@ -335,7 +272,7 @@ int dcnow_fetch_data(dcnow_data_t *data, uint32_t timeout_ms) {
                         case ENOBUFS: errno_str = "No buffers"; break;
                         case ENOMEM: errno_str = "Out of memory"; break;
                         default:
-                            snprintf(errno_buf, sizeof(errno_buf), "errno=%d", last_socket_errno);
+                            snprintf(errno_buf, sizeof(errno_buf), "errno=%d", dcnow_http_socket_errno());
                             errno_str = errno_buf;
                             break;
                     }
@@ -345,6 +282,7 @@ int dcnow_fetch_data(dcnow_data_t *data, uint32_t timeout_ms) {
             case -4: error_msg = "Connection failed"; break;
             case -5: error_msg = "Send failed"; break;
             case -6: error_msg = "Receive failed"; break;
+            case -7: error_msg = "Cancelled"; break;
         }
 
         if (errno_str[0] != '\0') {
@@ -358,46 +296,34 @@ int dcnow_fetch_data(dcnow_data_t *data, uint32_t timeout_ms) {
         data->data_valid = false;
         return result;
     }
+    fetch_stats.wire_bytes = result;
 
-    /* Find the JSON body (skip HTTP headers) */
-    char *json_start = strstr(response, "\r\n\r\n");
-    if (!json_start) {
-        strcpy(data->error_message, "Invalid HTTP response");
-        data->data_valid = false;
-        DCNOW_DPRINTF("DC Now: Invalid HTTP response\n");
-        return -7;
+    /* Nothing changed since the published snapshot, skip parsing altogether */
+    if (response.status == 304 && cache_valid) {
+        DCNOW_DPRINTF("DC Now: Not modified (%d bytes on the wire, %u ms)\n",
+               result, (unsigned)fetch_stats.total_ms);
+        return FETCH_NOT_MODIFIED;
     }
-    json_start += 4;  /* Skip the \r\n\r\n */
-
-    /* DEBUG: Print the actual JSON we received */
-    DCNOW_DPRINTF("DC Now: ========== RAW JSON START ==========\n");
-    DCNOW_DPRINTF("%s\n", json_start);
-    DCNOW_DPRINTF("DC Now: ========== RAW JSON END ==========\n");
 
     /* Check for HTTP error status */
-    if (strncmp(response, "HTTP/1.", 7) == 0) {
-        /* Extract status code */
-        char *status_line = response;
-        char *status_code_start = strchr(status_line, ' ');
-        if (status_code_start) {
-            status_code_start++;
-            int status_code = atoi(status_code_start);
-            if (status_code != 200) {
-                snprintf(data->error_message, sizeof(data->error_message),
-                        "HTTP error %d", status_code);
-                data->data_valid = false;
-                DCNOW_DPRINTF("DC Now: HTTP error %d\n", status_code);
-                return -8;
-            }
-        }
+    if (response.status != 0 && response.status != 200) {
+        snprintf(data->error_message, sizeof(data->error_message),
+                "HTTP error %d", response.status);
+        data->data_valid = false;
+        DCNOW_DPRINTF("DC Now: HTTP error %d\n", response.status);
+        return -8;
     }
 
-    DCNOW_DPRINTF("DC Now: Parsing JSON...\n");
+    /* The body was parsed as it arrived, it only has to have arrived whole */
+    if (!dcnow_http_response_done(&response)) {
+        strcpy(data->error_message, "Invalid HTTP response");
+        data->data_valid = false;
+        DCNOW_DPRINTF("DC Now: Invalid HTTP response\n");
+        return -7;
+    }
 
-    /* Parse JSON */
-    json_dcnow_t json_result;
-    if (!dcnow_json_parse(json_start, &json_result)) {
-        strcpy(data->error_message, "JSON parse error");
+    if (!dcnow_json_end(&parser)) {
+        strcpy(data->error_message, parser.out_of_memory ? "Out of memory" : "JSON parse error");
         data->data_valid = false;
         DCNOW_DPRINTF("DC Now: JSON parse failed\n");
         return -9;
@@ -412,36 +338,29 @@ int dcnow_fetch_data(dcnow_data_t *data, uint32_t timeout_ms) {
 
     DCNOW_DPRINTF("DC Now: Successfully parsed %d games, %d total players\n",
            json_result.game_count, json_result.total_players);
+    DCNOW_DPRINTF("DC Now: %d bytes on the wire, %u byte body%s, data after %u ms\n",
+           result, (unsigned)response.body_bytes,
+           response.gzip ? " gzipped" : "", (unsigned)fetch_stats.total_ms);
+    if (response.gzip) {
+        DCNOW_DPRINTF("DC Now: Inflated to %u bytes\n", (unsigned)inflater.out_bytes);
+    }
 
-    /* Copy parsed data to result structure */
+    /* The games are already in the snapshot's arena */
     data->total_players = json_result.total_players;
     data->game_count = json_result.game_count;
+    data->games = json_result.games;
 
-    for (int i = 0; i < json_result.game_count && i < MAX_DCNOW_GAMES; i++) {
-        strncpy(data->games[i].game_name, json_result.games[i].name, MAX_GAME_NAME_LEN - 1);
-        data->games[i].game_name[MAX_GAME_NAME_LEN - 1] = '\0';
-        strncpy(data->games[i].game_code, json_result.games[i].code, MAX_GAME_CODE_LEN - 1);
-        data->games[i].game_code[MAX_GAME_CODE_LEN - 1] = '\0';
-        data->games[i].player_count = json_result.games[i].players;
-        data->games[i].is_active = (json_result.games[i].players > 0);
-
-        /* Copy player names and details */
-        for (int j = 0; j < json_result.games[i].players && j < MAX_PLAYERS_PER_GAME; j++) {
-            strncpy(data->games[i].player_names[j], json_result.games[i].player_names[j], MAX_USERNAME_LEN - 1);
-            data->games[i].player_names[j][MAX_USERNAME_LEN - 1] = '\0';
-            memcpy(&data->games[i].player_details[j], &json_result.games[i].player_details[j], sizeof(json_player_details_t));
-        }
-
+    for (int i = 0; i < data->game_count; i++) {
         DCNOW_DPRINTF("DC Now:   %s (%s) - %d players\n",
                data->games[i].game_name, data->games[i].game_code, data->games[i].player_count);
     }
 
     data->data_valid = true;
-    data->last_update_time = (uint32_t)timer_ms_gettime64();
+    data->last_update_time = (uint32_t)dcnow_port_ms();
+    fetch_stats.arena_used = data->arena.bytes_used;
+    fetch_stats.arena_reserved = data->arena.bytes_reserved;
 
-    /* Cache the data */
-    memcpy(&cached_data, data, sizeof(dcnow_data_t));
-    cache_valid = true;
+    cached_validators = response.validators;
 
     DCNOW_DPRINTF("DC Now: Data fetch complete\n");
     return 0;
@@ -450,35 +369,45 @@ int dcnow_fetch_data(dcnow_data_t *data, uint32_t timeout_ms) {
     /* Non-Dreamcast platforms - return stub data or error */
     #ifdef DCNOW_USE_STUB_DATA
     /* Populate with stub data for testing on non-DC platforms */
-    strcpy(data->games[0].game_name, "Phantasy Star Online");
-    data->games[0].player_count = 12;
-    data->games[0].is_active = true;
-
-    strcpy(data->games[1].game_name, "Quake III Arena");
-    data->games[1].player_count = 4;
-    data->games[1].is_active = true;
-
-    strcpy(data->games[2].game_name, "Toy Racer");
-    data->games[2].player_count = 2;
-    data->games[2].is_active = true;
-
-    strcpy(data->games[3].game_name, "4x4 Evolution");
-    data->games[3].player_count = 0;
-    data->games[3].is_active = false;
-
-    strcpy(data->games[4].game_name, "Starlancer");
-    data->games[4].player_count = 1;
-    data->games[4].is_active = true;
+    static const struct { const char* name; int players; } stub_games[] = {
+        {"Phantasy Star Online", 12},
+        {"Quake III Arena", 4},
+        {"Toy Racer", 2},
+        {"4x4 Evolution", 0},
+        {"Starlancer", 1},
+    };
+
+    dcnow_arena_reset(&data->arena);
+    data->games = dcnow_arena_alloc(&data->arena, 5 * sizeof(dcnow_game_info_t));
+    if (!data->games) {
+        strcpy(data->error_message, "Out of memory");
+        return -13;
+    }
+    for (int i = 0; i < 5; i++) {
+        dcnow_game_info_t* game = &data->games[i];
+        game->game_name = stub_games[i].name;
+        game->game_code = "";
+        game->player_count = stub_games[i].players;
+        game->is_active = stub_games[i].players > 0;
+        game->players = dcnow_arena_alloc(&data->arena, game->player_count * sizeof(dcnow_player_t));
+        if (!game->players) {
+            strcpy(data->error_message, "Out of memory");
+            return -13;
+        }
+        for (int j = 0; j < game->player_count; j++) {
+            char name[16];
+            const int len = snprintf(name, sizeof(name), "player%d", j + 1);
+            game->players[j].name = dcnow_arena_strndup(&data->arena, name, len);
+            game->players[j].level = "";
+            strcpy(game->players[j].country, "US");
+        }
+    }
 
     data->game_count = 5;
     data->total_players = 19;
     data->data_valid = true;
     data->last_update_time = 0;
 
-    /* Cache the stub data */
-    memcpy(&cached_data, data, sizeof(dcnow_data_t));
-    cache_valid = true;
-
     return 0;
     #else
     strcpy(data->error_message, "Network not available");
@@ -488,16 +417,45 @@ int dcnow_fetch_data(dcnow_data_t *data, uint32_t timeout_ms) {
 #endif
 }
 
-bool dcnow_get_cached_data(dcnow_data_t *data) {
-    if (!data || !cache_valid) {
-        return false;
+int dcnow_prefetch_dns(void) {
+#ifdef DCNOW_NET
+#ifdef _arch_dreamcast
+    if (!net_default_dev) {
+        return -11;
+    }
+#endif
+    return dcnow_http_prefetch_dns(server_host);
+#else
+    return -100;
+#endif
+}
+
+int dcnow_fetch_data(uint32_t timeout_ms) {
+    dcnow_data_t* data = &snapshots[snapshot_write];
+    const int result = fetch_into(data, timeout_ms);
+
+    if (result < 0) {
+        /* The published snapshot stays, only the reason travels */
+        strncpy(last_error, data->error_message, sizeof(last_error) - 1);
+        last_error[sizeof(last_error) - 1] = '\0';
+        return result;
     }
 
-    memcpy(data, &cached_data, sizeof(dcnow_data_t));
-    return true;
+    last_error[0] = '\0';
+    if (result != FETCH_NOT_MODIFIED) {
+        snapshot_publish();
+        cache_valid = true;
+    }
+    return 0;
 }
 
 void dcnow_clear_cache(void) {
-    memset(&cached_data, 0, sizeof(cached_data));
+    dcnow_data_t* data = &snapshots[snapshot_write];
+
+    /* Hand the memory back, this buffer is the writer's */
+    dcnow_arena_release(&data->arena);
+    memset(data, 0, sizeof(dcnow_data_t));
+    snapshot_publish();
+    memset(&cached_validators, 0, sizeof(cached_validators));
     cache_valid = false;
 }
@@ -5,45 +5,88 @@
 #include <stdbool.h>
 #include "dcnow_json.h"
 
-/* Maximum number of games that can be displayed */
-#define MAX_DCNOW_GAMES 32
-
-/* Maximum length for game names */
-#define MAX_GAME_NAME_LEN 64
-
 /* Maximum length for game codes (e.g., "PSO", "BROWSERS") */
-#define MAX_GAME_CODE_LEN 16
-
-/* Maximum number of players per game to track */
-#define MAX_PLAYERS_PER_GAME 16
+#define MAX_GAME_CODE_LEN JSON_MAX_CODE_LEN
 
 /* Maximum length for player usernames */
-#define MAX_USERNAME_LEN 32
+#define MAX_USERNAME_LEN JSON_MAX_USERNAME_LEN
 
 /**
  * Structure representing a single game's active player data
+ * game_code is interned: equal codes are equal pointers, in any snapshot.
+ */
+typedef json_game_t dcnow_game_info_t;
+
+/* Name, level and country of one player */
+typedef json_player_t dcnow_player_t;
+
+/* Maximum number of changes kept per snapshot */
+#define MAX_DCNOW_EVENTS 48
+
+typedef enum {
+    DCNOW_EVENT_GAME_ADDED,
+    DCNOW_EVENT_GAME_REMOVED,
+    DCNOW_EVENT_COUNT_CHANGED,
+    DCNOW_EVENT_PLAYER_JOINED,
+    DCNOW_EVENT_PLAYER_LEFT,
+} dcnow_event_type_t;
+
+/**
+ * One change between a snapshot and the one published before it
  */
 typedef struct {
-    char game_name[MAX_GAME_NAME_LEN];   /* Display name (e.g., "Phantasy Star Online") */
-    char game_code[MAX_GAME_CODE_LEN];   /* Short code for texture lookup (e.g., "PSO") */
-    int player_count;
-    bool is_active;
-    char player_names[MAX_PLAYERS_PER_GAME][MAX_USERNAME_LEN];  /* List of usernames */
-    json_player_details_t player_details[MAX_PLAYERS_PER_GAME];  /* Level and country per player */
-} dcnow_game_info_t;
+    dcnow_event_type_t type;
+    int row;                             /* Game's row in this snapshot, -1 once removed */
+    int count_before;                    /* COUNT_CHANGED only */
+    int count_after;
+    char game_code[MAX_GAME_CODE_LEN];   /* Game code, or the start of its name */
+    char username[MAX_USERNAME_LEN];     /* PLAYER_JOINED and PLAYER_LEFT only */
+} dcnow_event_t;
+
+/**
+ * Everything that changed since the snapshot numbered base_seq
+ * The arrays live in the snapshot's arena.
+ */
+typedef struct {
+    uint32_t base_seq;
+    uint32_t* changed_rows;              /* Bit per row whose game or count differs */
+    int row_count;                       /* rows changed_rows covers */
+    int16_t* prev_row;                   /* Row each game had before, -1 when new */
+    int event_count;
+    bool events_complete;                /* false when there were more than MAX_DCNOW_EVENTS */
+    dcnow_event_t events[MAX_DCNOW_EVENTS];
+} dcnow_delta_t;
 
 /**
  * Structure representing the complete DC Now data from dreamcast.online/now
  */
 typedef struct {
-    dcnow_game_info_t games[MAX_DCNOW_GAMES];
+    dcnow_game_info_t* games;            /* game_count entries, in arena */
     int game_count;
     int total_players;
     bool data_valid;
     char error_message[128];
     uint32_t last_update_time;
+    uint32_t seq;                        /* Publish number, 0 before the first */
+    dcnow_delta_t delta;                 /* Changes since the previous publish */
+    dcnow_arena_t arena;                 /* Everything the pointers above point to */
 } dcnow_data_t;
 
+/**
+ * How the last dcnow_fetch_data() went, for logs and tools/dcnowbench
+ */
+typedef struct {
+    int status;                          /* HTTP status, 0 when no response came */
+    bool gzip;
+    uint32_t wire_bytes;                 /* everything received, headers included */
+    uint32_t body_bytes;                 /* body as sent, after dechunking */
+    uint32_t inflated_bytes;             /* body as parsed */
+    uint32_t total_ms;                   /* request sent to last byte parsed */
+    uint32_t first_game_ms;              /* until the parser had a game, 0 if it never did */
+    uint32_t arena_used;                 /* snapshot arena after a successful parse */
+    uint32_t arena_reserved;
+} dcnow_fetch_stats_t;
+
 /**
  * Initialize the DC Now network subsystem
  * This should be called once at startup
@@ -70,9 +113,11 @@ void dcnow_shutdown(void);
  * Fetch the current active player data from dreamcast.online/now
  *
  * This function connects via DreamPi (dial-up modem emulation) to fetch
- * JSON data from dreamcast.online/now and parse it into the dcnow_data_t structure.
+ * JSON data from dreamcast.online/now and parses it straight into a spare
+ * snapshot, which is published on success. On failure the last published
+ * snapshot stays and dcnow_get_last_error() says why.
+ * Called from one thread at a time.
  *
- * @param data Pointer to dcnow_data_t structure to fill with results
  * @param timeout_ms Timeout in milliseconds for the network operation
  * @return 0 on success, negative error code on failure
  *
@@ -92,19 +137,49 @@ void dcnow_shutdown(void);
  *   "total_players": 7
  * }
  */
-int dcnow_fetch_data(dcnow_data_t *data, uint32_t timeout_ms);
+int dcnow_fetch_data(uint32_t timeout_ms);
 
 /**
- * Get a cached copy of the most recent DC Now data
- * This can be used to avoid repeated network calls
+ * Resolve the DC Now host ahead of the next fetch
  *
- * @param data Pointer to dcnow_data_t structure to fill with cached results
- * @return true if cached data is available and valid, false otherwise
+ * @return 0 on success, negative error code on failure
+ */
+int dcnow_prefetch_dns(void);
+
+/**
+ * Most recently published DC Now data, for the main loop only
+ * The snapshot is never written while it is handed out, it stays valid and
+ * unchanged until the next call. data_valid is false before the first fetch.
+ *
+ * @return Pointer to the snapshot, never NULL
+ */
+const dcnow_data_t* dcnow_get_snapshot(void);
+
+/**
+ * Reason the last dcnow_fetch_data() failed, empty after a success
+ */
+const char* dcnow_get_last_error(void);
+
+/**
+ * Point fetches at another server, such as a local replay of recorded lists
+ * Forgets the validators. Not for use while a fetch runs.
+ *
+ * @param host Name or dotted address, NULL to go back to dreamcast.online
+ */
+void dcnow_set_server(const char* host, uint16_t port);
+
+/* Numbers from the last dcnow_fetch_data(), overwritten by the next one */
+const dcnow_fetch_stats_t* dcnow_get_fetch_stats(void);
+
+/**
+ * Make dcnow_fetch_data() stop with -7 once *flag turns true, NULL for never
+ * Same thread rules as dcnow_fetch_data()
  */
-bool dcnow_get_cached_data(dcnow_data_t *data);
+void dcnow_set_cancel_flag(const volatile bool* flag);
 
 /**
- * Clear the cached data
+ * Publish an empty snapshot and forget the validators
+ * Same thread rules as dcnow_fetch_data()
  */
 void dcnow_clear_cache(void);
 
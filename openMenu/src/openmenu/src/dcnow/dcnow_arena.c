@@ -0,0 +1,131 @@
+#include "dcnow_arena.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_ALIGN 8
+#define ARENA_HEADER ((uint32_t)((sizeof(dcnow_arena_block_t) + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1)))
+
+static char* block_data(dcnow_arena_block_t* block) {
+    return (char*)block + ARENA_HEADER;
+}
+
+void dcnow_arena_reset(dcnow_arena_t* arena) {
+    for (dcnow_arena_block_t* block = arena->first; block; block = block->next) {
+        block->used = 0;
+    }
+    arena->current = arena->first;
+    arena->bytes_used = 0;
+}
+
+void dcnow_arena_release(dcnow_arena_t* arena) {
+    dcnow_arena_block_t* block = arena->first;
+    while (block) {
+        dcnow_arena_block_t* next = block->next;
+        free(block);
+        block = next;
+    }
+    memset(arena, 0, sizeof(*arena));
+}
+
+void* dcnow_arena_alloc(dcnow_arena_t* arena, uint32_t size) {
+    size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+
+    dcnow_arena_block_t* block = arena->current;
+    while (block && block->size - block->used < size) {
+        /* Rewound blocks further down the chain may still have room */
+        block = block->next;
+    }
+
+    if (!block) {
+        const uint32_t block_size = size > DCNOW_ARENA_BLOCK ? size : DCNOW_ARENA_BLOCK;
+        block = malloc(ARENA_HEADER + block_size);
+        if (!block) {
+            return NULL;
+        }
+        block->size = block_size;
+        block->used = 0;
+
+        /* After the current block, the ones before it are used up */
+        if (arena->current) {
+            block->next = arena->current->next;
+            arena->current->next = block;
+        } else {
+            block->next = arena->first;
+            arena->first = block;
+        }
+        arena->bytes_reserved += ARENA_HEADER + block_size;
+    }
+
+    arena->current = block;
+
+    void* ptr = block_data(block) + block->used;
+    block->used += size;
+    arena->bytes_used += size;
+    return ptr;
+}
+
+char* dcnow_arena_strndup(dcnow_arena_t* arena, const char* str, int len) {
+    char* copy = dcnow_arena_alloc(arena, (uint32_t)len + 1);
+    if (copy) {
+        memcpy(copy, str, len);
+        copy[len] = '\0';
+    }
+    return copy;
+}
+
+/* Interned codes, open addressing over pointers into intern_arena */
+static dcnow_arena_t intern_arena;
+static const char** intern_slots = NULL;
+static uint32_t intern_slot_count = 0;
+static uint32_t intern_count = 0;
+
+static uint32_t intern_hash(const char* str) {
+    uint32_t hash = 2166136261u;
+    while (*str) {
+        hash = (hash ^ (unsigned char)*str++) * 16777619u;
+    }
+    return hash;
+}
+
+static bool intern_grow(void) {
+    const uint32_t slot_count = intern_slot_count ? intern_slot_count * 2 : 64;
+    const char** slots = calloc(slot_count, sizeof(*slots));
+    if (!slots) {
+        return false;
+    }
+    for (uint32_t i = 0; i < intern_slot_count; i++) {
+        if (intern_slots[i]) {
+            uint32_t slot = intern_hash(intern_slots[i]) & (slot_count - 1);
+            while (slots[slot]) {
+                slot = (slot + 1) & (slot_count - 1);
+            }
+            slots[slot] = intern_slots[i];
+        }
+    }
+    free(intern_slots);
+    intern_slots = slots;
+    intern_slot_count = slot_count;
+    return true;
+}
+
+const char* dcnow_intern(const char* str) {
+    /* Keep the table at most half full */
+    if ((intern_count + 1) * 2 > intern_slot_count && !intern_grow()) {
+        return NULL;
+    }
+
+    uint32_t slot = intern_hash(str) & (intern_slot_count - 1);
+    while (intern_slots[slot]) {
+        if (strcmp(intern_slots[slot], str) == 0) {
+            return intern_slots[slot];
+        }
+        slot = (slot + 1) & (intern_slot_count - 1);
+    }
+
+    const char* copy = dcnow_arena_strndup(&intern_arena, str, strlen(str));
+    if (copy) {
+        intern_slots[slot] = copy;
+        intern_count++;
+    }
+    return copy;
+}
@@ -0,0 +1,55 @@
+#ifndef DCNOW_ARENA_H
+#define DCNOW_ARENA_H
+
+/*
+ * Bump allocator for one DC Now snapshot. Blocks are malloc'd the first time
+ * a fetch needs them and rewound rather than freed for the next fetch into the
+ * same snapshot, so memory follows the busiest list seen instead of a fixed
+ * worst case, and a steady list allocates nothing at all.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define DCNOW_ARENA_BLOCK 8192  /* bigger allocations get a block of their own */
+
+typedef struct dcnow_arena_block {
+    struct dcnow_arena_block* next;
+    uint32_t size;
+    uint32_t used;
+} dcnow_arena_block_t;
+
+typedef struct {
+    dcnow_arena_block_t* first;
+    dcnow_arena_block_t* current;
+    uint32_t bytes_used;       /* handed out since the last reset */
+    uint32_t bytes_reserved;   /* malloc'd, including block headers */
+} dcnow_arena_t;
+
+/* Rewind, keeping the blocks for the next fill */
+void dcnow_arena_reset(dcnow_arena_t* arena);
+
+/* Free every block */
+void dcnow_arena_release(dcnow_arena_t* arena);
+
+/**
+ * Pointer aligned for any of the DC Now structures
+ *
+ * @return NULL when malloc fails
+ */
+void* dcnow_arena_alloc(dcnow_arena_t* arena, uint32_t size);
+
+/* Copy of the first len bytes of str, terminated, NULL when malloc fails */
+char* dcnow_arena_strndup(dcnow_arena_t* arena, const char* str, int len);
+
+/**
+ * Shared copy of a game code
+ * The same code always returns the same pointer, for as long as the program
+ * runs, so codes from different snapshots compare by address. Only the thread
+ * that fetches may intern.
+ *
+ * @return NULL when malloc fails
+ */
+const char* dcnow_intern(const char* str);
+
+#endif /* DCNOW_ARENA_H */
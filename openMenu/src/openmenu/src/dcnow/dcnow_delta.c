@@ -0,0 +1,184 @@
+#include "dcnow_delta.h"
+#include "dcnow_net_init.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Same rule the parser groups users by: codes when there are any, names only between games
+ * without one. game_hash must key on the same thing */
+static bool game_matches(const dcnow_game_info_t* a, const dcnow_game_info_t* b) {
+    if (a->game_code[0] != '\0' || b->game_code[0] != '\0') {
+        /* Interned */
+        return a->game_code == b->game_code;
+    }
+    return strcmp(a->game_name, b->game_name) == 0;
+}
+
+/* Codes are interned, so their address identifies them, names have to be hashed */
+static uint32_t game_hash(const dcnow_game_info_t* game) {
+    if (game->game_code[0] != '\0') {
+        return (uint32_t)(uintptr_t)game->game_code * 2654435761u;
+    }
+    uint32_t hash = 2166136261u;
+    for (const char* c = game->game_name; *c; c++) {
+        hash = (hash ^ (unsigned char)*c) * 16777619u;
+    }
+    return hash;
+}
+
+static bool has_player(const dcnow_game_info_t* game, const char* username) {
+    for (int i = 0; i < game->player_count; i++) {
+        if (strcmp(game->players[i].name, username) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static dcnow_event_t* add_event(dcnow_delta_t* delta, dcnow_event_type_t type, int row,
+                                const dcnow_game_info_t* game) {
+    if (delta->event_count >= MAX_DCNOW_EVENTS) {
+        delta->events_complete = false;
+        return NULL;
+    }
+
+    dcnow_event_t* event = &delta->events[delta->event_count++];
+    memset(event, 0, sizeof(*event));
+    event->type = type;
+    event->row = row;
+    strncpy(event->game_code, game->game_code[0] != '\0' ? game->game_code : game->game_name,
+            MAX_GAME_CODE_LEN - 1);
+    return event;
+}
+
+/* Players in from but not in to (NULL when the game isn't in the other snapshot) */
+static void diff_players(dcnow_delta_t* delta, dcnow_event_type_t type, int row,
+                         const dcnow_game_info_t* from, const dcnow_game_info_t* to) {
+    for (int i = 0; i < from->player_count; i++) {
+        const char* name = from->players[i].name;
+        if (name[0] == '\0' || (to && has_player(to, name))) {
+            continue;
+        }
+        dcnow_event_t* event = add_event(delta, type, row, from);
+        if (!event) {
+            return;
+        }
+        strncpy(event->username, name, MAX_USERNAME_LEN - 1);
+    }
+}
+
+static void mark_row(dcnow_delta_t* delta, int row) {
+    delta->changed_rows[row / 32] |= 1u << (row % 32);
+}
+
+void dcnow_delta_compute(const dcnow_data_t* prev, dcnow_data_t* next) {
+    dcnow_delta_t* delta = &next->delta;
+    dcnow_arena_t* arena = &next->arena;
+    const int row_count = next->game_count > prev->game_count ? next->game_count : prev->game_count;
+    const int words = (row_count + 31) / 32;
+
+    delta->base_seq = prev->seq;
+    delta->event_count = 0;
+    delta->events_complete = true;
+    delta->row_count = 0;
+
+    /* Previous rows by game, open addressing, at most half full */
+    uint32_t slot_count = 16;
+    while (slot_count < (uint32_t)prev->game_count * 2) {
+        slot_count *= 2;
+    }
+    int16_t* slots = dcnow_arena_alloc(arena, slot_count * sizeof(int16_t));
+    bool* matched = dcnow_arena_alloc(arena, prev->game_count + 1);
+    delta->changed_rows = dcnow_arena_alloc(arena, (words + 1) * sizeof(uint32_t));
+    delta->prev_row = dcnow_arena_alloc(arena, (next->game_count + 1) * sizeof(int16_t));
+    if (!slots || !matched || !delta->changed_rows || !delta->prev_row) {
+        /* Nobody can tell what changed, so readers treat everything as changed */
+        delta->base_seq = next->seq;
+        delta->events_complete = false;
+        DCNOW_DPRINTF("DC Now: Out of memory for the snapshot delta\n");
+        return;
+    }
+    memset(slots, 0xff, slot_count * sizeof(int16_t));
+    memset(matched, 0, prev->game_count + 1);
+    memset(delta->changed_rows, 0, (words + 1) * sizeof(uint32_t));
+    delta->row_count = row_count;
+
+    for (int i = 0; i < prev->game_count; i++) {
+        uint32_t slot = game_hash(&prev->games[i]) & (slot_count - 1);
+        while (slots[slot] >= 0) {
+            slot = (slot + 1) & (slot_count - 1);
+        }
+        slots[slot] = (int16_t)i;
+    }
+
+    for (int row = 0; row < next->game_count; row++) {
+        const dcnow_game_info_t* game = &next->games[row];
+        int from = -1;
+
+        uint32_t slot = game_hash(game) & (slot_count - 1);
+        while (slots[slot] >= 0) {
+            const int i = slots[slot];
+            if (!matched[i] && game_matches(&prev->games[i], game)) {
+                from = i;
+                break;
+            }
+            slot = (slot + 1) & (slot_count - 1);
+        }
+        delta->prev_row[row] = (int16_t)from;
+
+        if (from < 0) {
+            mark_row(delta, row);
+            add_event(delta, DCNOW_EVENT_GAME_ADDED, row, game);
+            diff_players(delta, DCNOW_EVENT_PLAYER_JOINED, row, game, NULL);
+            continue;
+        }
+        matched[from] = true;
+
+        const dcnow_game_info_t* before = &prev->games[from];
+        if (from != row || before->player_count != game->player_count ||
+            strcmp(before->game_name, game->game_name) != 0) {
+            mark_row(delta, row);
+        }
+        if (before->player_count != game->player_count) {
+            dcnow_event_t* event = add_event(delta, DCNOW_EVENT_COUNT_CHANGED, row, game);
+            if (event) {
+                event->count_before = before->player_count;
+                event->count_after = game->player_count;
+            }
+        }
+        diff_players(delta, DCNOW_EVENT_PLAYER_JOINED, row, game, before);
+        diff_players(delta, DCNOW_EVENT_PLAYER_LEFT, row, before, game);
+    }
+
+    for (int i = 0; i < prev->game_count; i++) {
+        if (matched[i]) {
+            continue;
+        }
+        /* Its row is either someone else's now or gone, both count as changed */
+        mark_row(delta, i);
+        add_event(delta, DCNOW_EVENT_GAME_REMOVED, -1, &prev->games[i]);
+        diff_players(delta, DCNOW_EVENT_PLAYER_LEFT, -1, &prev->games[i], NULL);
+    }
+
+    DCNOW_DPRINTF("DC Now: %d changes since snapshot %u%s\n",
+           delta->event_count, (unsigned)delta->base_seq,
+           delta->events_complete ? "" : ", list truncated");
+}
+
+bool dcnow_delta_row_changed(const dcnow_delta_t* delta, int row) {
+    return row >= 0 && row < delta->row_count && (delta->changed_rows[row / 32] & (1u << (row % 32)));
+}
+
+int dcnow_delta_find_row(const dcnow_data_t* data, uint32_t shown_seq, int prev_row) {
+    if (data->seq == shown_seq) {
+        return prev_row < data->game_count ? prev_row : -1;
+    }
+    if (data->delta.base_seq != shown_seq || !data->delta.prev_row || prev_row < 0) {
+        return -1;
+    }
+    for (int row = 0; row < data->game_count; row++) {
+        if (data->delta.prev_row[row] == prev_row) {
+            return row;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,33 @@
+#ifndef DCNOW_DELTA_H
+#define DCNOW_DELTA_H
+
+#include <stdint.h>
+#include "dcnow_api.h"
+
+/*
+ * Differences between consecutive snapshots. The writer works them out once
+ * per publish, while it still has the previous snapshot to compare with, and
+ * the reader finds them in the snapshot it takes. Games are matched by code
+ * (by name only when neither has one) and players by username, so a game that
+ * only moved rows is neither added nor removed. The row arrays go into the
+ * new snapshot's arena.
+ */
+
+/**
+ * Fill next->delta with what changed since prev
+ * prev is only read, next->seq must already be set
+ */
+void dcnow_delta_compute(const dcnow_data_t* prev, dcnow_data_t* next);
+
+/* Whether the game or count in a row differs from the previous snapshot */
+bool dcnow_delta_row_changed(const dcnow_delta_t* delta, int row);
+
+/**
+ * Row a game had in the snapshot numbered shown_seq
+ *
+ * @return Row of the same game in data, -1 when it is gone or data doesn't
+ *         follow on from shown_seq
+ */
+int dcnow_delta_find_row(const dcnow_data_t* data, uint32_t shown_seq, int prev_row);
+
+#endif /* DCNOW_DELTA_H */
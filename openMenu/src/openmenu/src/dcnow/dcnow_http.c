@@ -0,0 +1,581 @@
+#include "dcnow_http.h"
+#include "dcnow_net_init.h"
+#include "dcnow_port.h"
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <errno.h>
+
+void dcnow_http_response_init(http_response_t* res, http_body_cb on_body, void* user) {
+    memset(res, 0, sizeof(*res));
+    res->state = HTTP_STATUS_LINE;
+    res->content_length = -1;
+    res->keep_alive = true;
+    res->on_body = on_body;
+    res->user = user;
+}
+
+/* Case insensitive "Name:" match, returns the value with leading spaces skipped */
+static const char* header_value(const char* line, const char* name) {
+    while (*name) {
+        if (tolower((unsigned char)*line) != *name) {
+            return NULL;
+        }
+        line++;
+        name++;
+    }
+    if (*line != ':') {
+        return NULL;
+    }
+    line++;
+    while (*line == ' ' || *line == '\t') {
+        line++;
+    }
+    return line;
+}
+
+static bool has_token(const char* value, const char* token) {
+    const int len = strlen(token);
+    for (; *value; value++) {
+        int i = 0;
+        while (i < len && tolower((unsigned char)value[i]) == token[i]) {
+            i++;
+        }
+        if (i == len) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void copy_value(char* out, const char* value) {
+    strncpy(out, value, HTTP_MAX_VALIDATOR_LEN - 1);
+    out[HTTP_MAX_VALIDATOR_LEN - 1] = '\0';
+}
+
+/* Headers are over, pick how the body is framed */
+static bool body_begin(http_response_t* res) {
+    /* Informational responses are followed by the real one */
+    if (res->status >= 100 && res->status < 200) {
+        res->state = HTTP_STATUS_LINE;
+        res->chunked = false;
+        res->gzip = false;
+        res->content_length = -1;
+        return true;
+    }
+
+    if (res->status == 204 || res->status == 304) {
+        res->state = HTTP_DONE;
+    } else if (res->chunked) {
+        res->state = HTTP_CHUNK_SIZE;
+    } else if (res->content_length >= 0) {
+        res->remaining = res->content_length;
+        res->state = res->remaining ? HTTP_BODY : HTTP_DONE;
+    } else {
+        res->remaining = -1;
+        res->state = HTTP_BODY;
+    }
+
+    if (res->state == HTTP_DONE) {
+        res->gzip = false;
+    } else if (res->gzip) {
+        if (!res->inflater) {
+            DCNOW_DPRINTF("DC Now: gzip body that wasn't asked for\n");
+            return false;
+        }
+        dcnow_inflate_init(res->inflater, res->on_body, res->user);
+    }
+    return true;
+}
+
+static bool process_line(http_response_t* res) {
+    const char* line = res->line;
+    const char* value;
+
+    switch (res->state) {
+        case HTTP_STATUS_LINE:
+            if (strncmp(line, "HTTP/1.", 7) != 0) {
+                DCNOW_DPRINTF("DC Now: Not an HTTP response\n");
+                return false;
+            }
+            value = strchr(line, ' ');
+            res->status = value ? atoi(value + 1) : 0;
+            /* Persistent by default from 1.1 on */
+            res->keep_alive = (line[7] != '0');
+            res->state = HTTP_HEADERS;
+            return res->status > 0;
+
+        case HTTP_HEADERS:
+            if (res->line_len == 0) {
+                return body_begin(res);
+            } else if ((value = header_value(line, "transfer-encoding"))) {
+                res->chunked = has_token(value, "chunked");
+            } else if ((value = header_value(line, "content-length"))) {
+                res->content_length = atoi(value);
+            } else if ((value = header_value(line, "content-encoding"))) {
+                res->gzip = has_token(value, "gzip");
+            } else if ((value = header_value(line, "connection"))) {
+                if (has_token(value, "close")) {
+                    res->keep_alive = false;
+                } else if (has_token(value, "keep-alive")) {
+                    res->keep_alive = true;
+                }
+            } else if ((value = header_value(line, "etag"))) {
+                copy_value(res->validators.etag, value);
+            } else if ((value = header_value(line, "last-modified"))) {
+                copy_value(res->validators.last_modified, value);
+            }
+            return true;
+
+        case HTTP_CHUNK_SIZE: {
+            char* end;
+            const long size = strtol(line, &end, 16);
+            /* Extensions after ';' are ignored */
+            if (end == line || size < 0 || (*end && *end != ';' && *end != ' ')) {
+                DCNOW_DPRINTF("DC Now: Bad chunk size line\n");
+                return false;
+            }
+            res->remaining = size;
+            res->state = size ? HTTP_CHUNK_DATA : HTTP_TRAILERS;
+            return true;
+        }
+
+        case HTTP_TRAILERS:
+            if (res->line_len == 0) {
+                res->state = HTTP_DONE;
+            }
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+/* Collects one CRLF terminated line, returns the bytes used and sets *complete at its end */
+static int take_line(http_response_t* res, const char* data, int len, bool* complete) {
+    int i = 0;
+
+    *complete = false;
+    while (i < len) {
+        const char c = data[i++];
+        if (c == '\n') {
+            /* Drop the CR before it */
+            if (res->line_len > 0 && res->line[res->line_len - 1] == '\r') {
+                res->line_len--;
+            }
+            res->line[res->line_len < HTTP_MAX_LINE_LEN ? res->line_len : HTTP_MAX_LINE_LEN - 1] = '\0';
+            *complete = true;
+            return i;
+        }
+        if (res->line_len < HTTP_MAX_LINE_LEN - 1) {
+            res->line[res->line_len++] = c;
+        }
+    }
+    return i;
+}
+
+static bool pass_body(http_response_t* res, const char* data, int len) {
+    res->body_bytes += len;
+    if (res->gzip) {
+        return dcnow_inflate_feed(res->inflater, data, len);
+    }
+    if (res->on_body) {
+        res->on_body(res->user, data, len);
+    }
+    return true;
+}
+
+/* A gzip body also has to have reached the end of its stream */
+static void check_done(http_response_t* res) {
+    if (res->state == HTTP_DONE && res->gzip && !dcnow_inflate_done(res->inflater)) {
+        DCNOW_DPRINTF("DC Now: gzip stream cut short\n");
+        res->state = HTTP_ERROR;
+    }
+}
+
+bool dcnow_http_response_feed(http_response_t* res, const char* data, int len) {
+    int i = 0;
+
+    while (i < len && res->state != HTTP_ERROR && res->state != HTTP_DONE) {
+        switch (res->state) {
+            case HTTP_STATUS_LINE:
+            case HTTP_HEADERS:
+            case HTTP_CHUNK_SIZE:
+            case HTTP_TRAILERS: {
+                bool complete;
+                i += take_line(res, data + i, len - i, &complete);
+                if (complete) {
+                    if (!process_line(res)) {
+                        res->state = HTTP_ERROR;
+                    }
+                    res->line_len = 0;
+                }
+                break;
+            }
+
+            case HTTP_BODY:
+            case HTTP_CHUNK_DATA: {
+                int take = len - i;
+                if (res->remaining >= 0 && take > res->remaining) {
+                    take = res->remaining;
+                }
+                if (!pass_body(res, data + i, take)) {
+                    res->state = HTTP_ERROR;
+                    break;
+                }
+                i += take;
+                if (res->remaining >= 0) {
+                    res->remaining -= take;
+                    if (res->remaining == 0) {
+                        res->state = (res->state == HTTP_BODY) ? HTTP_DONE : HTTP_CHUNK_END;
+                    }
+                }
+                break;
+            }
+
+            case HTTP_CHUNK_END:
+                /* Wait for the LF, the CR before it is optional in practice */
+                if (data[i] == '\n') {
+                    res->state = HTTP_CHUNK_SIZE;
+                } else if (data[i] != '\r') {
+                    res->state = HTTP_ERROR;
+                }
+                i++;
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    check_done(res);
+    return res->state != HTTP_ERROR;
+}
+
+bool dcnow_http_response_close(http_response_t* res) {
+    if (res->state == HTTP_BODY && res->remaining < 0) {
+        res->state = HTTP_DONE;
+        check_done(res);
+    }
+    return res->state == HTTP_DONE;
+}
+
+bool dcnow_http_response_done(const http_response_t* res) {
+    return res->state == HTTP_DONE;
+}
+
+#ifdef DCNOW_NET
+/* Size of the receive window, the response is parsed as it arrives and never held whole */
+#define HTTP_RECV_WINDOW 1024
+#define HTTP_MAX_HOST_LEN 64
+
+/* Connection kept open between requests, -1 when there is none */
+static int http_sock = -1;
+static char http_host[HTTP_MAX_HOST_LEN];
+static uint16_t http_port;
+
+/* Last resolved address */
+static char dns_host[HTTP_MAX_HOST_LEN];
+static struct in_addr dns_addr;
+static uint64_t dns_expires = 0;
+
+static int socket_errno = 0;
+
+void dcnow_http_disconnect(void) {
+    if (http_sock >= 0) {
+        DCNOW_DPRINTF("DC Now: Closing connection (fd=%d)\n", http_sock);
+        close(http_sock);
+        http_sock = -1;
+    }
+}
+
+int dcnow_http_socket_errno(void) {
+    return socket_errno;
+}
+
+static bool http_resolve(const char* hostname, struct in_addr* addr) {
+    struct hostent* host;
+
+    if (dns_expires && dcnow_port_ms() < dns_expires && strcmp(dns_host, hostname) == 0) {
+        *addr = dns_addr;
+        DCNOW_DPRINTF("DC Now: %s cached as %s\n", hostname, inet_ntoa(*addr));
+        return true;
+    }
+
+    DCNOW_DPRINTF("DC Now: Resolving %s...\n", hostname);
+    dcnow_port_progress();  /* Update spinner before DNS lookup */
+    host = gethostbyname(hostname);
+    if (!host) {
+        DCNOW_DPRINTF("DC Now: DNS lookup failed for %s\n", hostname);
+        return false;
+    }
+
+    memcpy(addr, host->h_addr, sizeof(*addr));
+    dns_addr = *addr;
+    strncpy(dns_host, hostname, sizeof(dns_host) - 1);
+    dns_host[sizeof(dns_host) - 1] = '\0';
+    dns_expires = dcnow_port_ms() + HTTP_DNS_TTL_MS;
+
+    DCNOW_DPRINTF("DC Now: Resolved to %s\n", inet_ntoa(*addr));
+    dcnow_port_progress();  /* Update spinner after DNS */
+    return true;
+}
+
+int dcnow_http_prefetch_dns(const char* hostname) {
+    struct in_addr addr;
+    return http_resolve(hostname, &addr) ? 0 : -3;
+}
+
+static int http_connect(const char* hostname, uint16_t port) {
+    struct sockaddr_in server_addr;
+    int sock;
+
+#ifdef _arch_dreamcast
+    FILE* logfile;
+
+    /* Verify network is still available */
+    if (!net_default_dev) {
+        DCNOW_DPRINTF("DC Now: ERROR - Network device disappeared\n");
+        return -2;
+    }
+
+    DCNOW_DPRINTF("DC Now: net_default_dev = %p\n", (void*)net_default_dev);
+    DCNOW_DPRINTF("DC Now: Device name: %s\n", net_default_dev->name);
+    DCNOW_DPRINTF("DC Now: IP: %d.%d.%d.%d\n",
+           net_default_dev->ip_addr[0], net_default_dev->ip_addr[1],
+           net_default_dev->ip_addr[2], net_default_dev->ip_addr[3]);
+    DCNOW_DPRINTF("DC Now: DNS: %d.%d.%d.%d\n",
+           net_default_dev->dns[0], net_default_dev->dns[1],
+           net_default_dev->dns[2], net_default_dev->dns[3]);
+#endif
+
+    /* Create socket - Try protocol 0 first, then IPPROTO_TCP */
+    DCNOW_DPRINTF("DC Now: Attempting socket(AF_INET, SOCK_STREAM, 0)...\n");
+    sock = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (sock < 0) {
+        DCNOW_DPRINTF("DC Now: Protocol 0 failed (errno=%d), trying IPPROTO_TCP...\n", errno);
+        sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    }
+
+    if (sock < 0) {
+        socket_errno = errno;
+        DCNOW_DPRINTF("DC Now: ERROR - socket() failed, errno=%d\n", errno);
+        switch (errno) {
+            case EIO: DCNOW_DPRINTF("DC Now: I/O error\n"); break;
+            case EPROTONOSUPPORT: DCNOW_DPRINTF("DC Now: Protocol not supported\n"); break;
+            case EMFILE: DCNOW_DPRINTF("DC Now: Too many open files\n"); break;
+            case ENFILE: DCNOW_DPRINTF("DC Now: System file table full\n"); break;
+            case EACCES: DCNOW_DPRINTF("DC Now: Permission denied\n"); break;
+            case ENOBUFS: DCNOW_DPRINTF("DC Now: No buffer space available\n"); break;
+            case ENOMEM: DCNOW_DPRINTF("DC Now: Out of memory\n"); break;
+            default: DCNOW_DPRINTF("DC Now: Unknown socket error\n"); break;
+        }
+        return -2;
+    }
+
+    socket_errno = 0;  /* Clear errno on success */
+
+    DCNOW_DPRINTF("DC Now: Socket created successfully (fd=%d)\n", sock);
+
+#ifdef _arch_dreamcast
+    /* Log success to SD card */
+    logfile = fopen("/ram/DCNOW_LOG.TXT", "a");
+    if (logfile) {
+        fprintf(logfile, "Socket created: fd=%d\n", sock);
+        fclose(logfile);
+    }
+#endif
+
+    /* Setup server address */
+    memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(port);
+    if (!http_resolve(hostname, &server_addr.sin_addr)) {
+        close(sock);
+        return -3;  /* DNS resolution failed */
+    }
+
+    /* Connect to server */
+    DCNOW_DPRINTF("DC Now: Connecting...\n");
+    dcnow_port_progress();  /* Update spinner before connect */
+
+    if (connect(sock, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+        /* For blocking sockets, connect should succeed or fail immediately on Dreamcast */
+        DCNOW_DPRINTF("DC Now: Connection failed (errno: %d)\n", errno);
+        close(sock);
+        dns_expires = 0;  /* The host may have moved, look it up again next time */
+        return -4;
+    }
+
+    DCNOW_DPRINTF("DC Now: Connected\n");
+    dcnow_port_progress();  /* Update spinner after connect */
+    dcnow_port_socket_setup(sock);
+
+    http_sock = sock;
+    strncpy(http_host, hostname, sizeof(http_host) - 1);
+    http_host[sizeof(http_host) - 1] = '\0';
+    http_port = port;
+    return 0;
+}
+
+static const volatile bool* cancel_flag;
+
+void dcnow_http_set_cancel_flag(const volatile bool* flag) {
+    cancel_flag = flag;
+}
+
+static bool http_cancelled(void) {
+    return cancel_flag && *cancel_flag;
+}
+
+/* Sends the request on the open connection and parses the response as it comes */
+static int http_exchange(const char* request, http_response_t* response, uint32_t timeout_ms) {
+    char window[HTTP_RECV_WINDOW];
+    int total_received = 0;
+    uint64_t start_time;
+    uint64_t last_spinner_update = 0;
+
+    /* Send request */
+    DCNOW_DPRINTF("DC Now: Sending request...\n");
+    int sent = send(http_sock, request, strlen(request), 0);
+    if (sent <= 0) {
+        DCNOW_DPRINTF("DC Now: Send failed (errno: %d)\n", errno);
+        return -5;  /* Send failed */
+    }
+
+    DCNOW_DPRINTF("DC Now: Request sent, waiting for response...\n");
+
+    /* Receive response */
+    start_time = dcnow_port_ms();
+
+    while (!dcnow_http_response_done(response)) {
+        if (http_cancelled()) {
+            DCNOW_DPRINTF("DC Now: Request cancelled\n");
+            return -7;
+        }
+        if (dcnow_port_ms() - start_time > timeout_ms) {
+            DCNOW_DPRINTF("DC Now: Receive timeout\n");
+            break;  /* Timeout - but we may have received some data */
+        }
+
+        /* Update spinner animation every 100ms for smooth animation */
+        uint64_t now = dcnow_port_ms();
+        if (now - last_spinner_update >= 100) {
+            dcnow_port_progress();
+            last_spinner_update = now;
+        }
+
+        int received = recv(http_sock, window, sizeof(window), 0);
+
+        if (received > 0) {
+            total_received += received;
+            start_time = dcnow_port_ms();  /* Reset timeout on successful receive */
+            if (!dcnow_http_response_feed(response, window, received)) {
+                DCNOW_DPRINTF("DC Now: Malformed HTTP response\n");
+                break;
+            }
+        } else if (received == 0) {
+            /* Connection closed by server - this is normal */
+            DCNOW_DPRINTF("DC Now: Server closed connection\n");
+            dcnow_http_response_close(response);
+            response->keep_alive = false;
+            break;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            /* Nothing yet, the loop's own timeout decides */
+            dcnow_port_recv_wait();
+        } else {
+            /* Error receiving */
+            if (total_received == 0) {
+                DCNOW_DPRINTF("DC Now: Receive failed (errno: %d)\n", errno);
+                return -6;  /* Receive failed */
+            }
+            break;  /* We got some data, so continue */
+        }
+
+        dcnow_port_yield();  /* Yield to other threads */
+    }
+
+    DCNOW_DPRINTF("DC Now: Received %d bytes, %u of body\n", total_received, (unsigned)response->body_bytes);
+
+    return (total_received > 0) ? total_received : -6;
+}
+
+int dcnow_http_get(const char* hostname, uint16_t port, const char* path, const http_validators_t* validators,
+                   http_response_t* response, uint32_t timeout_ms) {
+    char request_buf[512];
+    char host_port[8] = "";
+    int len;
+    int result = -6;
+    uint32_t budget = timeout_ms;
+
+    if (port != 80) {
+        snprintf(host_port, sizeof(host_port), ":%u", (unsigned)port);
+    }
+
+    /* Build HTTP GET request */
+    len = snprintf(request_buf, sizeof(request_buf),
+                   "GET %s HTTP/1.1\r\n"
+                   "Host: %s%s\r\n"
+                   "User-Agent: openMenu-Dreamcast/1.1-ateam\r\n"
+                   "Accept: application/json\r\n"
+                   "%s"
+                   "Connection: keep-alive\r\n",
+                   path, hostname, host_port, response->inflater ? "Accept-Encoding: gzip\r\n" : "");
+    if (validators && validators->etag[0]) {
+        len += snprintf(request_buf + len, sizeof(request_buf) - len, "If-None-Match: %s\r\n", validators->etag);
+    }
+    if (validators && validators->last_modified[0]) {
+        len += snprintf(request_buf + len, sizeof(request_buf) - len, "If-Modified-Since: %s\r\n",
+                        validators->last_modified);
+    }
+    snprintf(request_buf + len, sizeof(request_buf) - len, "\r\n");
+
+    if (http_sock >= 0 && (strcmp(http_host, hostname) != 0 || http_port != port)) {
+        dcnow_http_disconnect();
+    }
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        const bool reused = (http_sock >= 0);
+        const uint64_t attempt_start = dcnow_port_ms();
+
+        if (http_cancelled()) {
+            result = -7;
+            break;
+        }
+        if (!reused) {
+            result = http_connect(hostname, port);
+            if (result < 0) {
+                return result;
+            }
+        } else {
+            DCNOW_DPRINTF("DC Now: Reusing connection (fd=%d)\n", http_sock);
+        }
+
+        result = http_exchange(request_buf, response, budget);
+
+        /* The server may have dropped an idle connection since the last request, nothing of
+         * this response has arrived yet so it can go again on a fresh one. The retry only gets
+         * what is left of the timeout, a silent dead connection must not cost it twice. */
+        const uint64_t spent = dcnow_port_ms() - attempt_start;
+        if (reused && (result == -5 || result == -6) && spent < budget) {
+            budget -= (uint32_t)spent;
+            DCNOW_DPRINTF("DC Now: Kept connection went stale, reconnecting\n");
+            inflate_stream_t* inflater = response->inflater;
+            dcnow_http_disconnect();
+            dcnow_http_response_init(response, response->on_body, response->user);
+            response->inflater = inflater;
+            continue;
+        }
+        break;
+    }
+
+    /* Anything short of a whole response leaves the stream in an unknown place */
+    if (result < 0 || !dcnow_http_response_done(response) || !response->keep_alive) {
+        dcnow_http_disconnect();
+    }
+
+    return result;
+}
+#endif
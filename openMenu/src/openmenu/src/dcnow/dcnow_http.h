@@ -0,0 +1,115 @@
+#ifndef DCNOW_HTTP_H
+#define DCNOW_HTTP_H
+
+/*
+ * Incremental HTTP/1.1 response parser for DC Now
+ * Fed whatever recv() returned, it splits the status line and headers from the
+ * body and undoes chunked transfer encoding on the fly. Body bytes are handed to
+ * a callback as they arrive, so nothing has to hold the whole response. A gzip
+ * body is inflated on the way when the caller gave the response an inflater.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "dcnow_inflate.h"
+
+#define HTTP_MAX_LINE_LEN 256  /* longer header lines are cut, only their start matters */
+#define HTTP_MAX_VALIDATOR_LEN 64
+
+/* Cache validators of a response, empty strings when the server sent none */
+typedef struct {
+    char etag[HTTP_MAX_VALIDATOR_LEN];
+    char last_modified[HTTP_MAX_VALIDATOR_LEN];
+} http_validators_t;
+
+typedef enum {
+    HTTP_STATUS_LINE = 0,
+    HTTP_HEADERS,
+    HTTP_BODY,          /* Content-Length bytes, or until close without one */
+    HTTP_CHUNK_SIZE,
+    HTTP_CHUNK_DATA,
+    HTTP_CHUNK_END,     /* CRLF after each chunk's data */
+    HTTP_TRAILERS,
+    HTTP_DONE,
+    HTTP_ERROR,
+} http_state_t;
+
+typedef void (*http_body_cb)(void* user, const char* data, int len);
+
+typedef struct {
+    http_state_t state;
+    int status;               /* status code from the status line */
+    bool chunked;
+    bool gzip;                /* Content-Encoding: gzip on a response with a body */
+    bool keep_alive;          /* server will take another request on this connection */
+    http_validators_t validators;
+    int32_t content_length;   /* -1 when the server didn't send one */
+    int32_t remaining;        /* bytes left in the body or the current chunk */
+    uint32_t body_bytes;      /* body bytes after dechunking, before inflating */
+    char line[HTTP_MAX_LINE_LEN];
+    int line_len;
+    http_body_cb on_body;
+    void* user;
+    inflate_stream_t* inflater; /* set after init to accept gzip, NULL for plain bodies only */
+} http_response_t;
+
+void dcnow_http_response_init(http_response_t* res, http_body_cb on_body, void* user);
+
+/**
+ * Feed the next bytes received
+ *
+ * @return false once the response is malformed
+ */
+bool dcnow_http_response_feed(http_response_t* res, const char* data, int len);
+
+/**
+ * The server closed the connection
+ *
+ * @return true if the response was complete, a body without a length ends here
+ */
+bool dcnow_http_response_close(http_response_t* res);
+
+/* True as soon as the last byte of the body has been passed on */
+bool dcnow_http_response_done(const http_response_t* res);
+
+/*
+ * Client, wherever dcnow_port.h finds a network: KOS on the Dreamcast, POSIX
+ * sockets in a DCNOW_HOST_BUILD. One connection is kept open between requests
+ * while the server allows it, and the host's address is cached for
+ * HTTP_DNS_TTL_MS. A request on a connection the server already dropped is
+ * retried once on a new one.
+ */
+#define HTTP_DNS_TTL_MS (10 * 60 * 1000)
+
+/**
+ * GET path from hostname
+ *
+ * @param port 80 for dreamcast.online, anything else for a local server
+ * @param validators From an earlier response, sent as If-None-Match and
+ *                   If-Modified-Since so an unchanged resource comes back as 304.
+ *                   NULL for an unconditional request
+ * @param response Initialized with dcnow_http_response_init, parsed as it arrives.
+ *                 With an inflater set, gzip is offered in Accept-Encoding
+ * @return bytes received, or -2 socket, -3 DNS, -4 connect, -5 send, -6 receive failure,
+ *         -7 cancelled
+ */
+int dcnow_http_get(const char* hostname, uint16_t port, const char* path, const http_validators_t* validators,
+                   http_response_t* response, uint32_t timeout_ms);
+
+/* Looks hostname up ahead of a request so the request finds it cached, 0 or -3 */
+int dcnow_http_prefetch_dns(const char* hostname);
+
+/**
+ * Requests give up with -7 as soon as *flag turns true, instead of running
+ * into their timeout. The flag is read between receives, so a request stops
+ * within one wait slice. NULL for none, only the thread that requests sets it.
+ */
+void dcnow_http_set_cancel_flag(const volatile bool* flag);
+
+/* Closes the kept connection, call when the network goes away */
+void dcnow_http_disconnect(void);
+
+/* errno of the last socket() failure, 0 after a success */
+int dcnow_http_socket_errno(void);
+
+#endif /* DCNOW_HTTP_H */
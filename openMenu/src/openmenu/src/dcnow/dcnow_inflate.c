@@ -0,0 +1,537 @@
+#include "dcnow_inflate.h"
+#include "dcnow_net_init.h"
+#include <string.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/*
+ * Inflate after RFC 1951, with the decoding done the way zlib's puff does it:
+ * canonical codes walked one bit at a time, no lookup tables to build or store.
+ * Where puff can read on until the stream ends, here every step first makes
+ * sure the bits it needs are in, and otherwise returns to wait for the next
+ * feed with nothing consumed. A Huffman code is only taken off the bit buffer
+ * together with the extra bits that follow it.
+ */
+
+#define NEED_MORE (-1)
+#define BAD_CODE (-2)
+
+static const int16_t length_base[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27,
+                                        31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const int16_t length_extra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                         2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const int16_t dist_base[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+                                      193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097,
+                                      6145, 8193, 12289, 16385, 24577};
+static const int16_t dist_extra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+                                       6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+/* Order the code length code's lengths are sent in */
+static const uint8_t code_order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+/* CRC-32 four bits at a time, 64 bytes of table instead of 1KB */
+static const uint32_t crc_nibble[16] = {
+    0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+    0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
+};
+
+static uint32_t crc_update(uint32_t crc, const uint8_t* data, uint32_t len) {
+    crc = ~crc;
+    while (len--) {
+        crc ^= *data++;
+        crc = (crc >> 4) ^ crc_nibble[crc & 15];
+        crc = (crc >> 4) ^ crc_nibble[crc & 15];
+    }
+    return ~crc;
+}
+
+void dcnow_inflate_init(inflate_stream_t* s, inflate_out_cb on_out, void* user) {
+    /* The window is left as is, nothing reads it before writing */
+    memset(s, 0, offsetof(inflate_stream_t, window));
+    s->window_pos = 0;
+    s->flushed = 0;
+    s->crc = 0;
+    s->in_bytes = 0;
+    s->out_bytes = 0;
+    s->state = INFLATE_GZIP_HEADER;
+    s->on_out = on_out;
+    s->user = user;
+}
+
+/* Pulls input into the bit buffer until it holds n bits, false if the feed ran out first */
+static bool need(inflate_stream_t* s, int n) {
+    while (s->bit_count < n) {
+        if (s->in_left == 0) {
+            return false;
+        }
+        s->bits |= (uint32_t)*s->in++ << s->bit_count;
+        s->bit_count += 8;
+        s->in_left--;
+    }
+    return true;
+}
+
+static uint32_t take(inflate_stream_t* s, int n) {
+    const uint32_t value = s->bits & ((1u << n) - 1);
+    s->bits >>= n;
+    s->bit_count -= n;
+    return value;
+}
+
+static bool get_byte(inflate_stream_t* s, uint32_t* out) {
+    if (!need(s, 8)) {
+        return false;
+    }
+    *out = take(s, 8);
+    return true;
+}
+
+/* Next symbol of code h without taking it, its length goes to *len */
+static int peek_symbol(inflate_stream_t* s, const inflate_huffman_t* h, int* len) {
+    int code = 0;
+    int first = 0;
+    int index = 0;
+
+    for (int l = 1; l < 16; l++) {
+        if (!need(s, l)) {
+            return NEED_MORE;
+        }
+        code |= (s->bits >> (l - 1)) & 1;
+        const int count = h->count[l];
+        if (code - count < first) {
+            *len = l;
+            return h->symbol[index + (code - first)];
+        }
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+    return BAD_CODE;
+}
+
+/* Returns 0 for a complete code, > 0 if incomplete and < 0 if oversubscribed */
+static int build(inflate_huffman_t* h, const int16_t* length, int n) {
+    int16_t offs[16];
+    int left = 1;
+
+    memset(h->count, 0, sizeof(h->count));
+    for (int i = 0; i < n; i++) {
+        h->count[length[i]]++;
+    }
+    if (h->count[0] == n) {
+        return 0;
+    }
+
+    for (int l = 1; l < 16; l++) {
+        left <<= 1;
+        left -= h->count[l];
+        if (left < 0) {
+            return left;
+        }
+    }
+
+    offs[1] = 0;
+    for (int l = 1; l < 15; l++) {
+        offs[l + 1] = offs[l] + h->count[l];
+    }
+    for (int i = 0; i < n; i++) {
+        if (length[i]) {
+            h->symbol[offs[length[i]]++] = i;
+        }
+    }
+    return left;
+}
+
+static void build_fixed(inflate_stream_t* s) {
+    int i = 0;
+
+    for (; i < 144; i++) s->lens[i] = 8;
+    for (; i < 256; i++) s->lens[i] = 9;
+    for (; i < 280; i++) s->lens[i] = 7;
+    for (; i < 288; i++) s->lens[i] = 8;
+    build(&s->lencode, s->lens, 288);
+
+    for (i = 0; i < 30; i++) s->lens[i] = 5;
+    build(&s->distcode, s->lens, 30);
+}
+
+static void flush(inflate_stream_t* s) {
+    const uint32_t len = s->window_pos - s->flushed;
+
+    if (len) {
+        s->crc = crc_update(s->crc, s->window + s->flushed, len);
+        if (s->on_out) {
+            s->on_out(s->user, (const char*)s->window + s->flushed, len);
+        }
+        s->flushed = s->window_pos;
+    }
+}
+
+static void put(inflate_stream_t* s, uint8_t c) {
+    s->window[s->window_pos++] = c;
+    s->out_bytes++;
+    if (s->window_pos == INFLATE_WINDOW) {
+        flush(s);
+        s->window_pos = 0;
+        s->flushed = 0;
+    }
+}
+
+/* The optional gzip header fields, in the order they come */
+static inflate_state_t next_header_field(inflate_stream_t* s) {
+    s->header_pos = 0;
+    s->field = 0;
+    if (s->flags & 0x04) return INFLATE_GZIP_EXTRA_LEN;
+    if (s->flags & 0x08) return INFLATE_GZIP_NAME;
+    if (s->flags & 0x10) return INFLATE_GZIP_COMMENT;
+    if (s->flags & 0x02) return INFLATE_GZIP_HCRC;
+    return INFLATE_BLOCK_HEADER;
+}
+
+static inflate_state_t end_block(inflate_stream_t* s) {
+    if (!s->last_block) {
+        return INFLATE_BLOCK_HEADER;
+    }
+    /* The trailer starts on the next byte */
+    take(s, s->bit_count & 7);
+    s->header_pos = 0;
+    s->field = 0;
+    flush(s);
+    return INFLATE_TRAILER;
+}
+
+static bool tables_done(inflate_stream_t* s) {
+    int err;
+
+    /* Without an end of block code the block could never end */
+    if (s->lens[256] == 0) {
+        return false;
+    }
+
+    /* An incomplete code is only allowed when it holds a single symbol */
+    err = build(&s->lencode, s->lens, s->nlen);
+    if (err < 0 || (err > 0 && s->nlen != s->lencode.count[0] + s->lencode.count[1])) {
+        return false;
+    }
+    err = build(&s->distcode, s->lens + s->nlen, s->ndist);
+    if (err < 0 || (err > 0 && s->ndist != s->distcode.count[0] + s->distcode.count[1])) {
+        return false;
+    }
+    return true;
+}
+
+/* Advances by one state, false when it has to wait for more input */
+static bool step(inflate_stream_t* s) {
+    uint32_t byte;
+    int sym, len;
+
+    switch (s->state) {
+        case INFLATE_GZIP_HEADER:
+            /* Magic, deflate method, flags, then mtime, xfl and os which don't matter */
+            if (!get_byte(s, &byte)) {
+                return false;
+            }
+            if ((s->header_pos == 0 && byte != 0x1f) || (s->header_pos == 1 && byte != 0x8b) ||
+                (s->header_pos == 2 && byte != 8) || (s->header_pos == 3 && (byte & 0xe0))) {
+                DCNOW_DPRINTF("DC Now: Not a gzip stream\n");
+                s->state = INFLATE_ERROR;
+                return true;
+            }
+            if (s->header_pos == 3) {
+                s->flags = byte;
+            }
+            if (++s->header_pos == 10) {
+                s->state = next_header_field(s);
+            }
+            return true;
+
+        case INFLATE_GZIP_EXTRA_LEN:
+            if (!get_byte(s, &byte)) {
+                return false;
+            }
+            s->field |= byte << (8 * s->header_pos);
+            if (++s->header_pos == 2) {
+                if (s->field) {
+                    s->state = INFLATE_GZIP_EXTRA;
+                } else {
+                    s->flags &= ~0x04;
+                    s->state = next_header_field(s);
+                }
+            }
+            return true;
+
+        case INFLATE_GZIP_EXTRA:
+            if (!get_byte(s, &byte)) {
+                return false;
+            }
+            if (--s->field == 0) {
+                s->flags &= ~0x04;
+                s->state = next_header_field(s);
+            }
+            return true;
+
+        case INFLATE_GZIP_NAME:
+        case INFLATE_GZIP_COMMENT:
+            if (!get_byte(s, &byte)) {
+                return false;
+            }
+            if (byte == 0) {
+                s->flags &= (s->state == INFLATE_GZIP_NAME) ? ~0x08 : ~0x10;
+                s->state = next_header_field(s);
+            }
+            return true;
+
+        case INFLATE_GZIP_HCRC:
+            if (!get_byte(s, &byte)) {
+                return false;
+            }
+            if (++s->header_pos == 2) {
+                s->flags &= ~0x02;
+                s->state = next_header_field(s);
+            }
+            return true;
+
+        case INFLATE_BLOCK_HEADER:
+            if (!need(s, 3)) {
+                return false;
+            }
+            s->last_block = take(s, 1);
+            switch (take(s, 2)) {
+                case 0:
+                    take(s, s->bit_count & 7);
+                    s->state = INFLATE_STORED_LEN;
+                    break;
+                case 1:
+                    build_fixed(s);
+                    s->state = INFLATE_SYMBOL;
+                    break;
+                case 2:
+                    s->state = INFLATE_TABLE_SIZES;
+                    break;
+                default:
+                    s->state = INFLATE_ERROR;
+                    break;
+            }
+            return true;
+
+        case INFLATE_STORED_LEN: {
+            if (!need(s, 32)) {
+                return false;
+            }
+            const uint32_t stored = take(s, 16);
+            if (stored != (~take(s, 16) & 0xffff)) {
+                s->state = INFLATE_ERROR;
+                return true;
+            }
+            s->stored_left = stored;
+            s->state = stored ? INFLATE_STORED : end_block(s);
+            return true;
+        }
+
+        case INFLATE_STORED:
+            /* Whole bytes may still sit in the bit buffer from the length */
+            while (s->stored_left) {
+                if (s->bit_count >= 8) {
+                    put(s, take(s, 8));
+                } else if (s->in_left) {
+                    put(s, *s->in++);
+                    s->in_left--;
+                } else {
+                    return false;
+                }
+                s->stored_left--;
+            }
+            s->state = end_block(s);
+            return true;
+
+        case INFLATE_TABLE_SIZES:
+            if (!need(s, 14)) {
+                return false;
+            }
+            s->nlen = take(s, 5) + 257;
+            s->ndist = take(s, 5) + 1;
+            s->ncode = take(s, 4) + 4;
+            if (s->nlen > 286 || s->ndist > 30) {
+                s->state = INFLATE_ERROR;
+                return true;
+            }
+            s->lens_index = 0;
+            s->state = INFLATE_CODE_LENS;
+            return true;
+
+        case INFLATE_CODE_LENS:
+            while (s->lens_index < s->ncode) {
+                if (!need(s, 3)) {
+                    return false;
+                }
+                s->lens[code_order[s->lens_index++]] = take(s, 3);
+            }
+            for (int i = s->ncode; i < 19; i++) {
+                s->lens[code_order[i]] = 0;
+            }
+            /* The code length code lives in lencode until the real one is built */
+            if (build(&s->lencode, s->lens, 19) != 0) {
+                s->state = INFLATE_ERROR;
+                return true;
+            }
+            s->lens_index = 0;
+            s->state = INFLATE_LENS;
+            return true;
+
+        case INFLATE_LENS:
+            while (s->lens_index < s->nlen + s->ndist) {
+                sym = peek_symbol(s, &s->lencode, &len);
+                if (sym == NEED_MORE) {
+                    return false;
+                }
+                if (sym < 0) {
+                    s->state = INFLATE_ERROR;
+                    return true;
+                }
+                if (sym < 16) {
+                    take(s, len);
+                    s->lens[s->lens_index++] = sym;
+                    continue;
+                }
+
+                /* Repeats, their count follows in extra bits */
+                const int extra = (sym == 16) ? 2 : (sym == 17) ? 3 : 7;
+                if (!need(s, len + extra)) {
+                    return false;
+                }
+                take(s, len);
+                int16_t value = 0;
+                int repeat = take(s, extra) + ((sym == 18) ? 11 : 3);
+                if (sym == 16) {
+                    if (s->lens_index == 0) {
+                        s->state = INFLATE_ERROR;
+                        return true;
+                    }
+                    value = s->lens[s->lens_index - 1];
+                }
+                if (s->lens_index + repeat > s->nlen + s->ndist) {
+                    s->state = INFLATE_ERROR;
+                    return true;
+                }
+                while (repeat--) {
+                    s->lens[s->lens_index++] = value;
+                }
+            }
+            s->state = tables_done(s) ? INFLATE_SYMBOL : INFLATE_ERROR;
+            return true;
+
+        case INFLATE_SYMBOL:
+            sym = peek_symbol(s, &s->lencode, &len);
+            if (sym == NEED_MORE) {
+                return false;
+            }
+            if (sym < 0 || sym > 285) {
+                s->state = INFLATE_ERROR;
+                return true;
+            }
+            take(s, len);
+            if (sym < 256) {
+                put(s, sym);
+            } else if (sym == 256) {
+                s->state = end_block(s);
+            } else {
+                s->symbol = sym - 257;
+                s->state = INFLATE_LENGTH_EXTRA;
+            }
+            return true;
+
+        case INFLATE_LENGTH_EXTRA:
+            if (!need(s, length_extra[s->symbol])) {
+                return false;
+            }
+            s->length = length_base[s->symbol] + take(s, length_extra[s->symbol]);
+            s->state = INFLATE_DISTANCE;
+            return true;
+
+        case INFLATE_DISTANCE:
+            sym = peek_symbol(s, &s->distcode, &len);
+            if (sym == NEED_MORE) {
+                return false;
+            }
+            if (sym < 0 || sym > 29) {
+                s->state = INFLATE_ERROR;
+                return true;
+            }
+            take(s, len);
+            s->symbol = sym;
+            s->state = INFLATE_DISTANCE_EXTRA;
+            return true;
+
+        case INFLATE_DISTANCE_EXTRA:
+            if (!need(s, dist_extra[s->symbol])) {
+                return false;
+            }
+            s->distance = dist_base[s->symbol] + take(s, dist_extra[s->symbol]);
+            if ((uint32_t)s->distance > s->out_bytes) {
+                DCNOW_DPRINTF("DC Now: gzip distance too far back\n");
+                s->state = INFLATE_ERROR;
+                return true;
+            }
+            s->state = INFLATE_COPY;
+            return true;
+
+        case INFLATE_COPY:
+            /* Byte by byte, the match may overlap what it writes */
+            while (s->length) {
+                put(s, s->window[(s->window_pos - s->distance) & (INFLATE_WINDOW - 1)]);
+                s->length--;
+            }
+            s->state = INFLATE_SYMBOL;
+            return true;
+
+        case INFLATE_TRAILER:
+            /* CRC-32 then length mod 2^32, both little endian */
+            if (!get_byte(s, &byte)) {
+                return false;
+            }
+            s->field |= byte << (8 * (s->header_pos & 3));
+            s->header_pos++;
+            if (s->header_pos == 4) {
+                if (s->field != s->crc) {
+                    DCNOW_DPRINTF("DC Now: gzip CRC mismatch\n");
+                    s->state = INFLATE_ERROR;
+                    return true;
+                }
+                s->field = 0;
+            } else if (s->header_pos == 8) {
+                if (s->field != s->out_bytes) {
+                    DCNOW_DPRINTF("DC Now: gzip length mismatch\n");
+                    s->state = INFLATE_ERROR;
+                    return true;
+                }
+                s->state = INFLATE_DONE;
+            }
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+bool dcnow_inflate_feed(inflate_stream_t* s, const char* data, int len) {
+    s->in = (const uint8_t*)data;
+    s->in_left = len;
+    s->in_bytes += len;
+
+    while (s->state != INFLATE_DONE && s->state != INFLATE_ERROR) {
+        if (!step(s)) {
+            break;
+        }
+    }
+
+    if (s->state != INFLATE_ERROR) {
+        flush(s);
+    }
+    s->in = NULL;
+    s->in_left = 0;
+    return s->state != INFLATE_ERROR;
+}
+
+bool dcnow_inflate_done(const inflate_stream_t* s) {
+    return s->state == INFLATE_DONE;
+}
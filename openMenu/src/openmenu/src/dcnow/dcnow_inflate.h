@@ -0,0 +1,97 @@
+#ifndef DCNOW_INFLATE_H
+#define DCNOW_INFLATE_H
+
+/*
+ * Streaming gzip decoder for DC Now
+ * Takes the compressed body in whatever pieces recv() returned and hands the
+ * inflated bytes on as they come out. Every state can stop at any byte, so
+ * nothing but the 32KB history window that deflate needs is ever held. The
+ * CRC and length in the gzip trailer are checked at the end.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define INFLATE_WINDOW 32768  /* deflate distances reach back this far */
+
+typedef enum {
+    INFLATE_GZIP_HEADER = 0,
+    INFLATE_GZIP_EXTRA_LEN,
+    INFLATE_GZIP_EXTRA,
+    INFLATE_GZIP_NAME,
+    INFLATE_GZIP_COMMENT,
+    INFLATE_GZIP_HCRC,
+    INFLATE_BLOCK_HEADER,
+    INFLATE_STORED_LEN,
+    INFLATE_STORED,
+    INFLATE_TABLE_SIZES,
+    INFLATE_CODE_LENS,  /* lengths of the code length code */
+    INFLATE_LENS,       /* literal/length and distance code lengths */
+    INFLATE_SYMBOL,
+    INFLATE_LENGTH_EXTRA,
+    INFLATE_DISTANCE,
+    INFLATE_DISTANCE_EXTRA,
+    INFLATE_COPY,
+    INFLATE_TRAILER,
+    INFLATE_DONE,
+    INFLATE_ERROR,
+} inflate_state_t;
+
+/* Canonical Huffman code, codes per length and symbols in code order */
+typedef struct {
+    int16_t count[16];
+    int16_t symbol[288];
+} inflate_huffman_t;
+
+typedef void (*inflate_out_cb)(void* user, const char* data, int len);
+
+typedef struct {
+    inflate_state_t state;
+
+    /* Input of the current feed and the bits taken from it but not used yet */
+    const uint8_t* in;
+    int in_left;
+    uint32_t bits;
+    int bit_count;
+
+    uint8_t flags;        /* gzip header flags still to be skipped */
+    int header_pos;
+    uint32_t field;
+    bool last_block;
+
+    uint32_t stored_left;
+    int nlen, ndist, ncode;
+    int lens_index;
+    int16_t lens[320];
+    inflate_huffman_t lencode;
+    inflate_huffman_t distcode;
+
+    int symbol;
+    int length;
+    int distance;
+
+    uint8_t window[INFLATE_WINDOW];
+    uint32_t window_pos;
+    uint32_t flushed;     /* window bytes already handed on */
+
+    uint32_t crc;
+    uint32_t in_bytes;    /* compressed bytes fed */
+    uint32_t out_bytes;   /* inflated bytes produced */
+
+    inflate_out_cb on_out;
+    void* user;
+} inflate_stream_t;
+
+void dcnow_inflate_init(inflate_stream_t* s, inflate_out_cb on_out, void* user);
+
+/**
+ * Feed the next compressed bytes, inflated output goes to on_out before this returns
+ *
+ * @return false once the stream is corrupt
+ */
+bool dcnow_inflate_feed(inflate_stream_t* s, const char* data, int len);
+
+/* True once the trailer has been read and checked */
+bool dcnow_inflate_done(const inflate_stream_t* s);
+
+#endif /* DCNOW_INFLATE_H */
@@ -1,285 +1,578 @@
 #include "dcnow_json.h"
 #include "dcnow_net_init.h"
+#include <limits.h>
 #include <string.h>
 #include <stdlib.h>
-#include <ctype.h>
 #include <stdio.h>
 #include <stdbool.h>
 
-/* Helper functions */
-
-static const char* skip_whitespace(const char* p) {
-    while (*p && isspace((unsigned char)*p)) {
-        p++;
+/*
+ * Single pass parser: every byte goes through a small lexer state machine once.
+ * Containers are tracked on a bit stack, keys are hashed while they are read and
+ * only looked up in the table below when they sit directly in the root object or
+ * directly in a user object, so a key nested deeper (or a longer key sharing a
+ * prefix) can never be mistaken for a field. Values of known fields are copied
+ * straight into the user being built, which is folded into the game list when
+ * its object closes. Commas and colons are checked against what the open
+ * container allows next, so a document that isn't JSON fails the parse. Games
+ * are found by hashing their code, players are chained onto them in the arena
+ * and only laid out as arrays at the end, when every count is known.
+ */
+
+typedef struct {
+    const char* name;
+    bool in_user;  /* false for keys of the root object */
+    json_field_t field;
+} json_key_t;
+
+static const json_key_t known_keys[] = {
+    {"users", false, FIELD_USERS},
+    {"online_count", false, FIELD_ONLINE_COUNT},
+    {"username", true, FIELD_USERNAME},
+    {"level", true, FIELD_LEVEL},
+    {"country", true, FIELD_COUNTRY},
+    {"current_game_display", true, FIELD_GAME_DISPLAY},
+    {"current_game", true, FIELD_GAME_CODE},
+};
+
+#define KNOWN_KEY_COUNT ((int)(sizeof(known_keys) / sizeof(known_keys[0])))
+
+static uint32_t known_key_hashes[KNOWN_KEY_COUNT];
+static bool known_keys_hashed = false;
+
+/* FNV-1a, fed one byte at a time as the key arrives */
+#define KEY_HASH_BASIS 2166136261u
+#define KEY_HASH_STEP(hash, c) (((hash) ^ (unsigned char)(c)) * 16777619u)
+
+static void hash_known_keys(void) {
+    for (int i = 0; i < KNOWN_KEY_COUNT; i++) {
+        uint32_t hash = KEY_HASH_BASIS;
+        for (const char* c = known_keys[i].name; *c; c++) {
+            hash = KEY_HASH_STEP(hash, *c);
+        }
+        known_key_hashes[i] = hash;
     }
-    return p;
+    known_keys_hashed = true;
 }
 
-static const char* parse_string(const char* p, char* out, int max_len) {
-    if (*p != '"') return NULL;
-    p++;  /* Skip opening quote */
-
-    int i = 0;
-    while (*p && *p != '"' && i < max_len - 1) {
-        if (*p == '\\') {
-            p++;  /* Skip escape char */
-            if (!*p) return NULL;
-            /* Simple escape handling */
-            switch (*p) {
-                case 'n': out[i++] = '\n'; break;
-                case 't': out[i++] = '\t'; break;
-                case 'r': out[i++] = '\r'; break;
-                case '"': out[i++] = '"'; break;
-                case '\\': out[i++] = '\\'; break;
-                default: out[i++] = *p; break;
-            }
-        } else {
-            out[i++] = *p;
-        }
-        p++;
-    }
+static bool top_is_object(const json_parser_t* p) {
+    return p->depth > 0 && (p->containers & (1u << (p->depth - 1)));
+}
 
-    out[i] = '\0';
+static json_field_t lookup_key(const json_parser_t* p) {
+    bool in_user;
 
-    if (*p != '"') return NULL;
-    p++;  /* Skip closing quote */
+    if (p->depth == 1) {
+        in_user = false;
+    } else if (p->users_depth && p->depth == p->users_depth + 1) {
+        in_user = true;
+    } else {
+        return FIELD_NONE;
+    }
+    if (p->key_len >= JSON_MAX_KEY_LEN) {
+        return FIELD_NONE;
+    }
 
-    return p;
+    for (int i = 0; i < KNOWN_KEY_COUNT; i++) {
+        if (known_key_hashes[i] == p->key_hash && known_keys[i].in_user == in_user &&
+            strcmp(known_keys[i].name, p->key) == 0) {
+            return known_keys[i].field;
+        }
+    }
+    return FIELD_NONE;
 }
 
-static const char* parse_number(const char* p, int* out) {
-    int sign = 1;
-    int value = 0;
+/* Where the string value of the current field goes, NULL to drop it */
+static char* value_target(json_parser_t* p, int* max_len) {
+    if (p->field_depth != p->depth) {
+        return NULL;
+    }
+    switch (p->field) {
+        case FIELD_USERNAME: *max_len = JSON_MAX_USERNAME_LEN; return p->user.username;
+        case FIELD_LEVEL: *max_len = JSON_MAX_LEVEL_LEN; return p->user.level;
+        case FIELD_COUNTRY: *max_len = sizeof(p->user.country); return p->user.country;
+        case FIELD_GAME_DISPLAY: *max_len = JSON_MAX_NAME_LEN; return p->user.game_name;
+        case FIELD_GAME_CODE: *max_len = JSON_MAX_CODE_LEN; return p->user.game_code;
+        default: return NULL;
+    }
+}
 
-    if (*p == '-') {
-        sign = -1;
-        p++;
+static uint32_t string_hash(const char* str) {
+    uint32_t hash = KEY_HASH_BASIS;
+    while (*str) {
+        hash = KEY_HASH_STEP(hash, *str++);
     }
+    return hash;
+}
 
-    if (!isdigit((unsigned char)*p)) return NULL;
+/* Games are the same when their codes are, or their names when either has no code */
+static bool game_is(const json_game_node_t* node, const json_user_t* user) {
+    if (user->game_code[0] != '\0') {
+        return strcmp(node->game.game_code, user->game_code) == 0;
+    }
+    return node->game.game_code[0] == '\0' && strcmp(node->game.game_name, user->game_name) == 0;
+}
 
-    while (isdigit((unsigned char)*p)) {
-        value = value * 10 + (*p - '0');
-        p++;
+static bool grow_game_slots(json_parser_t* p) {
+    const uint32_t slot_count = p->game_slot_count ? p->game_slot_count * 2 : 32;
+    json_game_node_t** slots = dcnow_arena_alloc(p->arena, slot_count * sizeof(*slots));
+    if (!slots) {
+        return false;
     }
+    memset(slots, 0, slot_count * sizeof(*slots));
 
-    *out = value * sign;
-    return p;
+    /* The old table stays behind in the arena, it's at most half the new one */
+    for (json_game_node_t* node = p->first_game; node; node = node->next) {
+        uint32_t slot = node->key_hash & (slot_count - 1);
+        while (slots[slot]) {
+            slot = (slot + 1) & (slot_count - 1);
+        }
+        slots[slot] = node;
+    }
+    p->game_slots = slots;
+    p->game_slot_count = slot_count;
+    return true;
 }
 
-static const char* find_key(const char* p, const char* key) {
-    const char* search = p;
-    int key_len = strlen(key);
-
-    while (*search) {
-        search = skip_whitespace(search);
-
-        if (*search == '"') {
-            const char* key_start = search + 1;
-            const char* key_end = strchr(key_start, '"');
-
-            if (key_end) {
-                int found_len = key_end - key_start;
-                if (found_len == key_len && strncmp(key_start, key, key_len) == 0) {
-                    /* Found the key, skip to the colon */
-                    search = key_end + 1;
-                    search = skip_whitespace(search);
-                    if (*search == ':') {
-                        return skip_whitespace(search + 1);
-                    }
-                }
-            }
+static json_game_node_t* find_game(json_parser_t* p) {
+    const json_user_t* user = &p->user;
+    const uint32_t hash = string_hash(user->game_code[0] != '\0' ? user->game_code : user->game_name);
+
+    uint32_t slot = hash & (p->game_slot_count - 1);
+    while (p->game_slots[slot]) {
+        json_game_node_t* node = p->game_slots[slot];
+        if (node->key_hash == hash && game_is(node, user)) {
+            return node;
         }
+        slot = (slot + 1) & (p->game_slot_count - 1);
+    }
 
-        search++;
+    /* New game, the slot found is free */
+    json_game_node_t* node = dcnow_arena_alloc(p->arena, sizeof(*node));
+    const char* name = node ? dcnow_arena_strndup(p->arena, user->game_name, strlen(user->game_name)) : NULL;
+    const char* code = name ? dcnow_intern(user->game_code) : NULL;
+    if (!code) {
+        return NULL;
+    }
+    memset(node, 0, sizeof(*node));
+    node->game.game_name = name;
+    node->game.game_code = code;
+    node->key_hash = hash;
+    p->game_slots[slot] = node;
+
+    if (p->last_game) {
+        p->last_game->next = node;
+    } else {
+        p->first_game = node;
     }
+    p->last_game = node;
+    p->game_count++;
 
-    return NULL;
+    if ((uint32_t)p->game_count * 2 > p->game_slot_count && !grow_game_slots(p)) {
+        return NULL;
+    }
+    return node;
 }
 
-bool dcnow_json_parse(const char* json_str, json_dcnow_t* result) {
-    if (!json_str || !result) {
+static bool add_player(json_parser_t* p, json_game_node_t* game) {
+    const json_user_t* user = &p->user;
+    json_player_node_t* node = dcnow_arena_alloc(p->arena, sizeof(*node));
+    if (!node) {
         return false;
     }
 
-    memset(result, 0, sizeof(json_dcnow_t));
+    /* Levels repeat across every user, codes are interned anyway */
+    node->player.name = dcnow_arena_strndup(p->arena, user->username, strlen(user->username));
+    node->player.level = dcnow_intern(user->level);
+    memcpy(node->player.country, user->country, sizeof(node->player.country));
+    node->next = NULL;
+    if (!node->player.name || !node->player.level) {
+        return false;
+    }
 
-    const char* p = skip_whitespace(json_str);
+    if (game->last) {
+        game->last->next = node;
+    } else {
+        game->first = node;
+    }
+    game->last = node;
+    game->game.player_count++;
+    return true;
+}
+
+/* Fold a finished user object into the per game lists */
+static void commit_user(json_parser_t* p) {
+    const json_user_t* user = &p->user;
+    json_game_node_t* game;
+
+    p->user_count++;
+
+    if (user->game_name[0] == '\0') {
+        /* User is idle/not in a game */
+        p->users_without_games++;
+        game = &p->idle;
+        DCNOW_DPRINTF("DC Now: User %d (%s) is idle/not in game\n", p->user_count, user->username);
+    } else {
+        p->users_with_games++;
+        game = find_game(p);
+    }
+
+    if (!game || !add_player(p, game)) {
+        p->out_of_memory = true;
+        p->state = LEX_ERROR;
+    }
+}
 
-    /* Expect opening brace */
-    if (*p != '{') {
+/* Lay a game's chained players out as an array of exactly the right size */
+static bool finish_game(json_parser_t* p, json_game_node_t* node, json_game_t* game) {
+    *game = node->game;
+    game->is_active = game->player_count > 0;
+    game->players = dcnow_arena_alloc(p->arena, game->player_count * sizeof(json_player_t));
+    if (!game->players && game->player_count > 0) {
         return false;
     }
-    p++;
 
-    /* Parse online_count (total players) */
-    const char* online_val = find_key(p, "online_count");
-    if (online_val) {
-        const char* next = parse_number(online_val, &result->total_players);
-        if (!next) {
-            result->total_players = 0;
+    int i = 0;
+    for (json_player_node_t* player = node->first; player; player = player->next) {
+        game->players[i++] = player->player;
+    }
+    return true;
+}
+
+static void string_put(json_parser_t* p, char c) {
+    if (p->in_key) {
+        p->key_hash = KEY_HASH_STEP(p->key_hash, c);
+        if (p->key_len < JSON_MAX_KEY_LEN - 1) {
+            p->key[p->key_len] = c;
         }
+        p->key_len++;
+    } else if (p->out && p->out_len < p->out_max - 1) {
+        p->out[p->out_len++] = c;
     }
+}
 
-    /* Find users array */
-    const char* users_val = find_key(p, "users");
-    if (!users_val || *users_val != '[') {
-        /* No users array - return empty but valid */
-        result->valid = true;
-        return true;
+static bool expecting_value(const json_parser_t* p) {
+    return p->expect == EXPECT_VALUE || p->expect == EXPECT_FIRST_VALUE;
+}
+
+/* A value is complete, its container wants a comma or its end now */
+static void value_end(json_parser_t* p) {
+    p->expect = EXPECT_COMMA;
+    p->field = FIELD_NONE;
+    p->state = LEX_VALUE;
+}
+
+static void string_begin(json_parser_t* p) {
+    p->in_key = p->expect == EXPECT_KEY || p->expect == EXPECT_FIRST_KEY;
+    if (p->in_key) {
+        p->key_len = 0;
+        p->key_hash = KEY_HASH_BASIS;
+        p->out = NULL;
+    } else {
+        p->out = value_target(p, &p->out_max);
+        p->out_len = 0;
     }
+    p->state = LEX_STRING;
+}
 
-    users_val++;  /* Skip opening bracket */
-    users_val = skip_whitespace(users_val);
+static void string_end(json_parser_t* p) {
+    if (p->in_key) {
+        p->key[p->key_len < JSON_MAX_KEY_LEN ? p->key_len : JSON_MAX_KEY_LEN - 1] = '\0';
+        p->field = lookup_key(p);
+        p->field_depth = p->depth;
+        p->expect = EXPECT_COLON;
+        p->state = LEX_VALUE;
+    } else {
+        if (p->out) {
+            p->out[p->out_len] = '\0';
+        }
+        value_end(p);
+    }
+}
 
-    /* Parse each user and aggregate games */
-    int user_count = 0;
-    int users_with_games = 0;
-    int users_without_games = 0;
+static void number_end(json_parser_t* p) {
+    if (p->number_wanted) {
+        p->result->total_players = p->number * p->number_sign;
+    }
+    value_end(p);
+}
 
-    /* Array to store idle player usernames and details */
-    char idle_player_names[JSON_MAX_PLAYERS_PER_GAME][JSON_MAX_USERNAME_LEN];
-    json_player_details_t idle_player_details[JSON_MAX_PLAYERS_PER_GAME];
-    int idle_player_count = 0;
+static bool container_open(json_parser_t* p, bool object) {
+    if (p->depth >= JSON_MAX_DEPTH || !expecting_value(p)) {
+        return false;
+    }
 
-    while (*users_val && *users_val != ']') {
-        users_val = skip_whitespace(users_val);
+    if (object && p->users_depth && p->depth == p->users_depth) {
+        memset(&p->user, 0, sizeof(p->user));
+    }
+    if (!object && p->field == FIELD_USERS && p->field_depth == p->depth) {
+        p->users_depth = p->depth + 1;
+    }
 
-        if (*users_val != '{') {
-            break;  /* Not an object */
-        }
-        users_val++;  /* Skip opening brace */
-        user_count++;
-
-        /* Find username field */
-        const char* username_val = find_key(users_val, "username");
-        char username[JSON_MAX_USERNAME_LEN] = "";
-        if (username_val && *username_val == '"') {
-            parse_string(username_val, username, JSON_MAX_USERNAME_LEN);
-        }
+    if (object) {
+        p->containers |= (1u << p->depth);
+    } else {
+        p->containers &= ~(1u << p->depth);
+    }
+    p->depth++;
+    p->expect = object ? EXPECT_FIRST_KEY : EXPECT_FIRST_VALUE;
+    p->field = FIELD_NONE;
+    return true;
+}
 
-        /* Parse minimal player details (level and country only) */
-        json_player_details_t player_details;
-        memset(&player_details, 0, sizeof(player_details));
+static bool container_close(json_parser_t* p, bool object) {
+    if (p->depth == 0 || top_is_object(p) != object) {
+        return false;
+    }
+    if (p->expect != EXPECT_COMMA && p->expect != (object ? EXPECT_FIRST_KEY : EXPECT_FIRST_VALUE)) {
+        return false;  /* a trailing comma, or a key without its value */
+    }
 
-        /* Level */
-        const char* level_val = find_key(users_val, "level");
-        if (level_val && *level_val == '"') {
-            parse_string(level_val, player_details.level, JSON_MAX_LEVEL_LEN);
+    if (object && p->users_depth && p->depth == p->users_depth + 1) {
+        commit_user(p);
+        if (p->state == LEX_ERROR) {
+            return false;
         }
+    }
+    if (!object && p->depth == p->users_depth) {
+        p->users_depth = 0;
+    }
 
-        /* Country */
-        const char* country_val = find_key(users_val, "country");
-        if (country_val && *country_val == '"') {
-            parse_string(country_val, player_details.country, sizeof(player_details.country));
-        }
+    p->depth--;
+    value_end(p);
+    if (p->depth == 0) {
+        p->state = LEX_DONE;
+    }
+    return true;
+}
 
-        /* Find current_game_display field (full name) */
-        const char* game_display_val = find_key(users_val, "current_game_display");
-        /* Find current_game field (short code) */
-        const char* game_code_val = find_key(users_val, "current_game");
-        bool has_game = false;
-
-        if (game_display_val && *game_display_val == '"') {
-            char game_name[JSON_MAX_NAME_LEN];
-            char game_code[JSON_MAX_CODE_LEN];
-            const char* next = parse_string(game_display_val, game_name, JSON_MAX_NAME_LEN);
-
-            /* Also extract the game code if present */
-            game_code[0] = '\0';
-            if (game_code_val && *game_code_val == '"') {
-                parse_string(game_code_val, game_code, JSON_MAX_CODE_LEN);
+/* Between tokens, returns false on a byte that can't start or separate one */
+static bool lex_value(json_parser_t* p, char c) {
+    switch (c) {
+        case ' ': case '\t': case '\r': case '\n':
+            return true;
+        case '{':
+            return container_open(p, true);
+        case '[':
+            return p->depth > 0 && container_open(p, false);
+        case '}':
+            return container_close(p, true);
+        case ']':
+            return container_close(p, false);
+        case ':':
+            if (p->expect != EXPECT_COLON) {
+                return false;
+            }
+            p->expect = EXPECT_VALUE;
+            return true;
+        case ',':
+            if (p->expect != EXPECT_COMMA || p->depth == 0) {
+                return false;
             }
+            p->expect = top_is_object(p) ? EXPECT_KEY : EXPECT_VALUE;
+            p->field = FIELD_NONE;
+            return true;
+        case '"':
+            if (p->depth == 0 || p->expect == EXPECT_COLON || p->expect == EXPECT_COMMA) {
+                return false;
+            }
+            string_begin(p);
+            return true;
+        default:
+            break;
+    }
+
+    if (p->depth == 0 || !expecting_value(p)) {
+        return false;
+    }
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        p->number_wanted = (p->field == FIELD_ONLINE_COUNT && p->field_depth == p->depth);
+        p->number_sign = (c == '-') ? -1 : 1;
+        p->number = (c == '-' || !p->number_wanted) ? 0 : c - '0';
+        p->number_fraction = false;
+        p->state = LEX_NUMBER;
+        return true;
+    }
+    switch (c) {
+        case 't': p->literal = "true"; break;
+        case 'f': p->literal = "false"; break;
+        case 'n': p->literal = "null"; break;
+        default: return false;
+    }
+    p->literal_len = 1;
+    p->state = LEX_LITERAL;
+    return true;
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
 
-            if (next && game_name[0] != '\0') {
-                /* User has a game */
-                users_with_games++;
-                has_game = true;
+bool dcnow_json_feed(json_parser_t* p, const char* data, int len) {
+    for (int i = 0; i < len && p->state != LEX_ERROR; i++) {
+        const char c = data[i];
 
-                /* Find existing game or add new one */
-                int found_idx = -1;
-                for (int i = 0; i < result->game_count; i++) {
-                    if (strcmp(result->games[i].name, game_name) == 0) {
-                        found_idx = i;
+        switch (p->state) {
+            case LEX_VALUE:
+                if (!lex_value(p, c)) {
+                    p->state = LEX_ERROR;
+                }
+                break;
+
+            case LEX_STRING:
+                if (c == '\\') {
+                    p->state = LEX_ESCAPE;
+                } else if (c == '"') {
+                    string_end(p);
+                } else {
+                    string_put(p, c);
+                }
+                break;
+
+            case LEX_ESCAPE:
+                p->state = LEX_STRING;
+                switch (c) {
+                    case 'n': string_put(p, '\n'); break;
+                    case 't': string_put(p, '\t'); break;
+                    case 'r': string_put(p, '\r'); break;
+                    case 'b': string_put(p, '\b'); break;
+                    case 'f': string_put(p, '\f'); break;
+                    case 'u':
+                        p->unicode = 0;
+                        p->unicode_digits = 0;
+                        p->state = LEX_UNICODE;
                         break;
-                    }
+                    default: string_put(p, c); break;
                 }
+                break;
 
-                if (found_idx >= 0) {
-                    /* Increment existing game count and add username + details */
-                    int player_idx = result->games[found_idx].players;
-                    if (player_idx < JSON_MAX_PLAYERS_PER_GAME && username[0] != '\0') {
-                        strncpy(result->games[found_idx].player_names[player_idx], username, JSON_MAX_USERNAME_LEN - 1);
-                        result->games[found_idx].player_names[player_idx][JSON_MAX_USERNAME_LEN - 1] = '\0';
-                        memcpy(&result->games[found_idx].player_details[player_idx], &player_details, sizeof(player_details));
-                    }
-                    result->games[found_idx].players++;
-                } else if (result->game_count < JSON_MAX_GAMES) {
-                    /* Add new game */
-                    strncpy(result->games[result->game_count].name, game_name, JSON_MAX_NAME_LEN - 1);
-                    result->games[result->game_count].name[JSON_MAX_NAME_LEN - 1] = '\0';
-                    strncpy(result->games[result->game_count].code, game_code, JSON_MAX_CODE_LEN - 1);
-                    result->games[result->game_count].code[JSON_MAX_CODE_LEN - 1] = '\0';
-                    result->games[result->game_count].players = 1;
-                    /* Add first username and details */
-                    if (username[0] != '\0') {
-                        strncpy(result->games[result->game_count].player_names[0], username, JSON_MAX_USERNAME_LEN - 1);
-                        result->games[result->game_count].player_names[0][JSON_MAX_USERNAME_LEN - 1] = '\0';
-                        memcpy(&result->games[result->game_count].player_details[0], &player_details, sizeof(player_details));
-                    }
-                    result->game_count++;
+            case LEX_UNICODE: {
+                const int digit = hex_value(c);
+                if (digit < 0) {
+                    p->state = LEX_ERROR;
+                    break;
+                }
+                p->unicode = (p->unicode << 4) | digit;
+                if (++p->unicode_digits == 4) {
+                    /* The fonts only cover ASCII */
+                    string_put(p, p->unicode < 0x80 ? (char)p->unicode : '?');
+                    p->state = LEX_STRING;
                 }
+                break;
             }
-        }
 
-        if (!has_game) {
-            /* User is idle/not in a game - store their username and details */
-            users_without_games++;
-            if (idle_player_count < JSON_MAX_PLAYERS_PER_GAME && username[0] != '\0') {
-                strncpy(idle_player_names[idle_player_count], username, JSON_MAX_USERNAME_LEN - 1);
-                idle_player_names[idle_player_count][JSON_MAX_USERNAME_LEN - 1] = '\0';
-                memcpy(&idle_player_details[idle_player_count], &player_details, sizeof(player_details));
-                idle_player_count++;
-            }
-            DCNOW_DPRINTF("DC Now: User %d (%s) is idle/not in game\n", user_count, username);
-        }
+            case LEX_NUMBER:
+                if (c >= '0' && c <= '9') {
+                    /* Only online_count is kept, and a count that long just pins at INT_MAX */
+                    if (p->number_wanted && !p->number_fraction) {
+                        p->number = p->number > (INT_MAX - (c - '0')) / 10 ? INT_MAX : p->number * 10 + (c - '0');
+                    }
+                } else if (c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-') {
+                    p->number_fraction = true;
+                } else {
+                    number_end(p);
+                    i--;  /* the byte after the number is a token of its own */
+                }
+                break;
+
+            case LEX_LITERAL:
+                if (p->literal[p->literal_len] == '\0') {
+                    value_end(p);
+                    i--;  /* the byte after the literal is a token of its own */
+                } else if (c == p->literal[p->literal_len]) {
+                    p->literal_len++;
+                } else {
+                    p->state = LEX_ERROR;
+                }
+                break;
 
-        /* Skip to end of user object */
-        int brace_count = 1;
-        while (*users_val && brace_count > 0) {
-            if (*users_val == '{') brace_count++;
-            else if (*users_val == '}') brace_count--;
-            users_val++;
-        }
+            case LEX_DONE:
+                /* Anything after the root object is ignored */
+                return true;
 
-        /* Skip comma if present */
-        users_val = skip_whitespace(users_val);
-        if (*users_val == ',') {
-            users_val++;
+            case LEX_ERROR:
+                break;
         }
     }
+    return p->state != LEX_ERROR;
+}
+
+bool dcnow_json_end(json_parser_t* p) {
+    json_dcnow_t* result = p->result;
+
+    if (p->state != LEX_DONE) {
+        DCNOW_DPRINTF("DC Now: JSON %s at depth %d\n",
+                      p->out_of_memory ? "out of memory" : p->state == LEX_ERROR ? "syntax error" : "ended early",
+                      p->depth);
+        return false;
+    }
 
     DCNOW_DPRINTF("DC Now: Parsed %d users total - %d with games, %d without games\n",
-           user_count, users_with_games, users_without_games);
+           p->user_count, p->users_with_games, p->users_without_games);
     DCNOW_DPRINTF("DC Now: Total players from API: %d\n", result->total_players);
 
-    /* Add idle users as a separate entry if any */
-    if (users_without_games > 0 && result->game_count < JSON_MAX_GAMES) {
-        strncpy(result->games[result->game_count].name, "Idle/Not in game", JSON_MAX_NAME_LEN - 1);
-        result->games[result->game_count].name[JSON_MAX_NAME_LEN - 1] = '\0';
-        result->games[result->game_count].code[0] = '\0';  /* No box art for idle users */
-        result->games[result->game_count].players = users_without_games;
-
-        /* Copy idle player usernames and details */
-        for (int i = 0; i < idle_player_count && i < JSON_MAX_PLAYERS_PER_GAME; i++) {
-            strncpy(result->games[result->game_count].player_names[i], idle_player_names[i], JSON_MAX_USERNAME_LEN - 1);
-            result->games[result->game_count].player_names[i][JSON_MAX_USERNAME_LEN - 1] = '\0';
-            memcpy(&result->games[result->game_count].player_details[i], &idle_player_details[i], sizeof(json_player_details_t));
+    const int game_count = p->game_count + (p->idle.game.player_count > 0 ? 1 : 0);
+    result->games = dcnow_arena_alloc(p->arena, game_count * sizeof(json_game_t));
+    if (!result->games && game_count > 0) {
+        p->out_of_memory = true;
+        return false;
+    }
+
+    for (json_game_node_t* node = p->first_game; node; node = node->next) {
+        if (!finish_game(p, node, &result->games[result->game_count++])) {
+            p->out_of_memory = true;
+            return false;
         }
+    }
 
-        result->game_count++;
+    /* Add idle users as a separate entry if any */
+    if (p->idle.game.player_count > 0) {
+        p->idle.game.game_name = "Idle/Not in game";
+        p->idle.game.game_code = "";  /* No box art for idle users */
+        if (!finish_game(p, &p->idle, &result->games[result->game_count++])) {
+            p->out_of_memory = true;
+            return false;
+        }
     }
 
+    DCNOW_DPRINTF("DC Now: %u bytes of snapshot arena in use\n", (unsigned)p->arena->bytes_used);
+
     result->valid = true;
     return true;
 }
+
+void dcnow_json_begin(json_parser_t* parser, json_dcnow_t* result, dcnow_arena_t* arena) {
+    if (!known_keys_hashed) {
+        hash_known_keys();
+    }
+
+    memset(result, 0, sizeof(json_dcnow_t));
+    memset(parser, 0, sizeof(*parser));
+    parser->result = result;
+    parser->arena = arena;
+
+    dcnow_arena_reset(arena);
+    if (!grow_game_slots(parser)) {
+        parser->out_of_memory = true;
+        parser->state = LEX_ERROR;
+    }
+}
+
+bool dcnow_json_done(const json_parser_t* parser) {
+    return parser->state == LEX_DONE;
+}
+
+bool dcnow_json_parse(const char* json_str, json_dcnow_t* result, dcnow_arena_t* arena) {
+    json_parser_t parser;
+
+    if (!json_str || !result || !arena) {
+        return false;
+    }
+
+    dcnow_json_begin(&parser, result, arena);
+    dcnow_json_feed(&parser, json_str, strlen(json_str));
+    return dcnow_json_end(&parser);
+}
@@ -8,38 +8,169 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "dcnow_arena.h"
 
-/* Maximum values for parsing */
-#define JSON_MAX_GAMES 32
+/* Longest strings kept, longer ones are cut short */
 #define JSON_MAX_NAME_LEN 64
 #define JSON_MAX_CODE_LEN 16
-#define JSON_MAX_PLAYERS_PER_GAME 16
 #define JSON_MAX_USERNAME_LEN 32
 #define JSON_MAX_LEVEL_LEN 32
 
-/* Player details structure - minimal info only */
+/* One user in a game's list */
 typedef struct {
-    char level[JSON_MAX_LEVEL_LEN];  /* e.g., "Newbie", "Occasional Gamer", "Enthusiastic Gamer" */
-    char country[4];                 /* 2-letter country code like "US", "UK", "JP" */
-} json_player_details_t;
+    const char* name;
+    const char* level;     /* e.g., "Newbie", "Occasional Gamer", "" when not given */
+    char country[4];       /* 2-letter country code like "US", "UK", "JP" */
+} json_player_t;
 
 /* Parsed game structure */
 typedef struct {
-    char name[JSON_MAX_NAME_LEN];      /* Display name (e.g., "Phantasy Star Online") */
-    char code[JSON_MAX_CODE_LEN];      /* Short code (e.g., "PSO") */
-    int players;
-    char player_names[JSON_MAX_PLAYERS_PER_GAME][JSON_MAX_USERNAME_LEN];  /* List of usernames */
-    json_player_details_t player_details[JSON_MAX_PLAYERS_PER_GAME];  /* Level and country per player */
+    const char* game_name;     /* Display name (e.g., "Phantasy Star Online") */
+    const char* game_code;     /* Short code (e.g., "PSO"), interned, "" when none */
+    int player_count;
+    bool is_active;
+    json_player_t* players;    /* player_count entries, in the order they were listed */
 } json_game_t;
 
-/* Parsed JSON data */
+/* Parsed JSON data, games and players live in the arena given to dcnow_json_begin */
 typedef struct {
-    json_game_t games[JSON_MAX_GAMES];
+    json_game_t* games;        /* game_count entries */
     int game_count;
     int total_players;
     bool valid;
 } json_dcnow_t;
 
+/* Push parser state, callers only allocate it. See dcnow_json_begin */
+#define JSON_MAX_DEPTH 32  /* one bit per level in containers */
+#define JSON_MAX_KEY_LEN 32
+
+typedef enum {
+    FIELD_NONE = 0,
+    /* Root object */
+    FIELD_USERS,
+    FIELD_ONLINE_COUNT,
+    /* User objects */
+    FIELD_USERNAME,
+    FIELD_LEVEL,
+    FIELD_COUNTRY,
+    FIELD_GAME_DISPLAY,
+    FIELD_GAME_CODE,
+} json_field_t;
+
+typedef enum {
+    LEX_VALUE = 0,  /* between tokens */
+    LEX_STRING,
+    LEX_ESCAPE,
+    LEX_UNICODE,
+    LEX_NUMBER,
+    LEX_LITERAL,    /* true, false, null */
+    LEX_DONE,       /* root object closed */
+    LEX_ERROR,
+} json_lex_t;
+
+/* What the grammar allows next */
+typedef enum {
+    EXPECT_VALUE = 0,   /* after a colon or a comma in an array, the root object at the start */
+    EXPECT_FIRST_VALUE, /* a value or the end of an array just opened */
+    EXPECT_KEY,         /* after a comma in an object */
+    EXPECT_FIRST_KEY,   /* a key or the end of an object just opened */
+    EXPECT_COLON,       /* after a key */
+    EXPECT_COMMA,       /* after a value, a comma or the end of its container */
+} json_expect_t;
+
+/* One user while its object is open */
+typedef struct {
+    char username[JSON_MAX_USERNAME_LEN];
+    char level[JSON_MAX_LEVEL_LEN];
+    char country[4];
+    char game_name[JSON_MAX_NAME_LEN];
+    char game_code[JSON_MAX_CODE_LEN];
+} json_user_t;
+
+/* A player while the document is read, chained onto its game */
+typedef struct json_player_node {
+    json_player_t player;
+    struct json_player_node* next;
+} json_player_node_t;
+
+/* A game while the document is read, games are chained in order of appearance */
+typedef struct json_game_node {
+    json_game_t game;
+    uint32_t key_hash;         /* of the code, or of the name when there is no code */
+    json_player_node_t* first;
+    json_player_node_t* last;
+    struct json_game_node* next;
+} json_game_node_t;
+
+typedef struct {
+    json_dcnow_t* result;
+    json_lex_t state;
+
+    uint32_t containers;  /* bit set for objects, clear for arrays */
+    int depth;
+    int users_depth;      /* depth inside the users array, 0 when not in it */
+    json_expect_t expect;
+
+    /* String being read, either a key or a value bound for out */
+    bool in_key;
+    char key[JSON_MAX_KEY_LEN];
+    int key_len;
+    uint32_t key_hash;
+    char* out;
+    int out_len;
+    int out_max;
+    uint32_t unicode;
+    int unicode_digits;
+    const char* literal;  /* true, false or null, and how much of it is matched */
+    int literal_len;
+
+    /* Last key and the depth it was read at, its value comes next */
+    json_field_t field;
+    int field_depth;
+
+    /* Number being read */
+    int number;
+    int number_sign;
+    bool number_wanted;
+    bool number_fraction;
+
+    json_user_t user;
+    int user_count;
+    int users_with_games;
+    int users_without_games;
+
+    /* Games by key_hash, open addressing, at most half full */
+    dcnow_arena_t* arena;
+    json_game_node_t** game_slots;
+    uint32_t game_slot_count;
+    int game_count;
+    json_game_node_t* first_game;
+    json_game_node_t* last_game;
+    json_game_node_t idle;     /* users not in a game, listed last */
+    bool out_of_memory;
+} json_parser_t;
+
+/**
+ * Push parser, fed the document in pieces as they arrive
+ *
+ *   json_parser_t parser;
+ *   dcnow_json_begin(&parser, &result, &arena);
+ *   while (...more data...) dcnow_json_feed(&parser, chunk, len);
+ *   ok = dcnow_json_end(&parser);
+ *
+ * Pieces may split the document anywhere, even inside a key or an escape.
+ * dcnow_json_feed returns false once the data can't be JSON, dcnow_json_done
+ * becomes true the moment the root object closes. There is no limit on the
+ * number of games or players, everything goes into the arena, which
+ * dcnow_json_begin rewinds. Users are grouped by game code (display name when
+ * there is none) through a hash table.
+ */
+void dcnow_json_begin(json_parser_t* parser, json_dcnow_t* result, dcnow_arena_t* arena);
+bool dcnow_json_feed(json_parser_t* parser, const char* data, int len);
+bool dcnow_json_done(const json_parser_t* parser);
+/* Completes result, false on a syntax error or a document that ended early */
+bool dcnow_json_end(json_parser_t* parser);
+
 /**
  * Parse DC Now JSON response
  *
@@ -57,8 +188,9 @@ typedef struct {
  *
  * @param json_str Null-terminated JSON string
  * @param result Pointer to result structure to fill
+ * @param arena Where the games and players go
  * @return true on success, false on parse error
  */
-bool dcnow_json_parse(const char* json_str, json_dcnow_t* result);
+bool dcnow_json_parse(const char* json_str, json_dcnow_t* result, dcnow_arena_t* arena);
 
 #endif /* DCNOW_JSON_H */
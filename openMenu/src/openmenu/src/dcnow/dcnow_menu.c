@@ -20,6 +20,8 @@
 #include "ui/ui_menu_credits.h"
 
 #include "dcnow_api.h"
+#include "dcnow_delta.h"
+#include "dcnow_sched.h"
 #include "dcnow_net_init.h"
 #include "dcnow_vmu.h"
 #include <arch/timer.h>
@@ -117,7 +119,10 @@ typedef enum {
     DCNOW_VIEW_PLAYERS             /* Showing list of players for selected game */
 } dcnow_view_t;
 
-static dcnow_data_t dcnow_data;
+/* Snapshot on screen, dcnow_get_snapshot() hands out a newer one once a fetch finished */
+static const dcnow_data_t* dcnow_data = NULL;
+static bool dcnow_data_valid = false;  /* dcnow_data is shown, otherwise dcnow_error_message */
+static char dcnow_error_message[128] = "";
 static dcnow_view_t dcnow_view = DCNOW_VIEW_GAMES;
 static int dcnow_choice = 0;
 static int dcnow_conn_choice = 0;  /* Connection method: 0=Serial, 1=Modem */
@@ -133,8 +138,7 @@ static int* dcnow_navigate_timeout = NULL;  /* Pointer to navigate timeout for i
 
 /* Timestamp (ms) of the last successful fetch — 0 until first fetch completes */
 static uint64_t dcnow_last_fetch_ms = 0;
-/* Scratch buffer for auto-refresh so old data survives a failed fetch */
-static dcnow_data_t dcnow_temp_data;
+static dcnow_sched_t dcnow_sched;  /* when the next auto-refresh is due */
 
 static bool dcnow_is_connecting = false;
 static bool dcnow_connect_cooldown_pending = false;
@@ -145,14 +149,144 @@ static int dcnow_connect_anim_frame = 0;
 static dcnow_worker_context_t dcnow_worker_ctx;
 static bool dcnow_worker_initialized = false;
 static bool dcnow_bg_fetch_active = false;  /* Background auto-refresh in progress */
+static bool dcnow_dns_prefetched = false;   /* DNS prefetch queued for the coming refresh */
 #endif
 
-extern void (*current_ui_draw_OP)(void);
-extern void (*current_ui_draw_TR)(void);
+extern void draw_scene(void);
 
 #define DCNOW_INPUT_TIMEOUT_INITIAL (10)
 #define DCNOW_INPUT_TIMEOUT_REPEAT (4)
-#define DCNOW_AUTO_REFRESH_MS       60000  /* 60 seconds between auto-refreshes */
+#define DCNOW_DNS_PREFETCH_LEAD_MS  5000   /* DNS prefetch this long before an auto-refresh */
+
+/* Widest list lines in characters, measured once per snapshot and selected game */
+static uint32_t dcnow_measured_seq = 0;
+static int dcnow_measured_game = -2;
+static int dcnow_widest_game_name = 0;
+static int dcnow_widest_player_line = 0;
+
+static void dcnow_measure_lists(void) {
+    if (dcnow_data->seq == dcnow_measured_seq && dcnow_selected_game == dcnow_measured_game) {
+        return;
+    }
+    dcnow_measured_seq = dcnow_data->seq;
+    dcnow_measured_game = dcnow_selected_game;
+
+    dcnow_widest_game_name = 0;
+    for (int i = 0; i < dcnow_data->game_count; i++) {
+        int len = strlen(dcnow_data->games[i].game_name);
+        if (len > dcnow_widest_game_name) {
+            dcnow_widest_game_name = len;
+        }
+    }
+
+    dcnow_widest_player_line = 0;
+    if (dcnow_selected_game >= 0 && dcnow_selected_game < dcnow_data->game_count) {
+        const dcnow_game_info_t* game = &dcnow_data->games[dcnow_selected_game];
+        for (int i = 0; i < game->player_count; i++) {
+            int len = strlen(game->players[i].name);
+            const dcnow_player_t *details = &game->players[i];
+            /* Add space for " [Level | Country]" if present */
+            if (details->level[0] != '\0' || details->country[0] != '\0') {
+                len += strlen(details->level) + strlen(details->country) + 8;  /* " [ | ]" + margin */
+            }
+            if (len > dcnow_widest_player_line) {
+                dcnow_widest_player_line = len;
+            }
+        }
+    }
+}
+
+/* Scroll so the selection is on screen */
+static void dcnow_keep_choice_visible(void) {
+    int max_visible = (sf_ui[0] == UI_SCROLL || sf_ui[0] == UI_FOLDERS) ? 10 : 8;
+    if (dcnow_choice < dcnow_scroll_offset) {
+        dcnow_scroll_offset = dcnow_choice;
+    } else if (dcnow_choice >= dcnow_scroll_offset + max_visible) {
+        dcnow_scroll_offset = dcnow_choice - max_visible + 1;
+    }
+}
+
+/* Keep the selection on the same game when a refresh reorders the list */
+static void dcnow_follow_selection(uint32_t shown_seq) {
+    if (dcnow_view == DCNOW_VIEW_PLAYERS) {
+        int row = dcnow_delta_find_row(dcnow_data, shown_seq, dcnow_selected_game);
+        if (row < 0) {
+            /* The game emptied out, nothing left to list */
+            dcnow_view = DCNOW_VIEW_GAMES;
+            dcnow_selected_game = -1;
+            dcnow_choice = 0;
+            dcnow_scroll_offset = 0;
+            return;
+        }
+        dcnow_selected_game = row;
+        int player_count = dcnow_data->games[row].player_count;
+        if (dcnow_choice >= player_count) {
+            dcnow_choice = player_count > 0 ? player_count - 1 : 0;
+        }
+    } else if (dcnow_view == DCNOW_VIEW_GAMES) {
+        int row = dcnow_delta_find_row(dcnow_data, shown_seq, dcnow_choice);
+        if (row < 0) {
+            row = dcnow_choice < dcnow_data->game_count ? dcnow_choice : dcnow_data->game_count - 1;
+        }
+        dcnow_choice = row > 0 ? row : 0;
+    } else {
+        return;
+    }
+    dcnow_keep_choice_visible();
+}
+
+/* Switch to the snapshot the last successful fetch published */
+static void dcnow_take_snapshot(void) {
+    const uint32_t shown_seq = dcnow_data ? dcnow_data->seq : 0;
+    const bool was_shown = dcnow_data_valid;
+
+    dcnow_data = dcnow_get_snapshot();
+    dcnow_data_valid = dcnow_data->data_valid;
+
+    /* Without a delta from what was shown, assume the worst */
+    bool changed = dcnow_data->seq != shown_seq;
+    bool counts_changed = changed;
+    if (changed && dcnow_data->delta.base_seq == shown_seq) {
+        /* Every 200 publishes a new snapshot, only the delta says whether anything in it differs */
+        changed = dcnow_data->delta.event_count > 0 || !dcnow_data->delta.events_complete;
+        for (int row = 0; !changed && row < dcnow_data->delta.row_count; row++) {
+            changed = dcnow_delta_row_changed(&dcnow_data->delta, row);
+        }
+        counts_changed = !dcnow_data->delta.events_complete;
+        for (int i = 0; i < dcnow_data->delta.event_count; i++) {
+            const dcnow_event_t* event = &dcnow_data->delta.events[i];
+            if (event->type == DCNOW_EVENT_PLAYER_JOINED) {
+                DCNOW_DPRINTF("DC Now: %s joined %s\n", event->username, event->game_code);
+            } else if (event->type == DCNOW_EVENT_PLAYER_LEFT) {
+                DCNOW_DPRINTF("DC Now: %s left %s\n", event->username, event->game_code);
+            } else {
+                counts_changed = true;
+            }
+        }
+    }
+    if (was_shown && dcnow_data_valid) {
+        dcnow_follow_selection(shown_seq);
+    }
+
+    dcnow_sched_on_success(&dcnow_sched, timer_ms_gettime64(), changed, counts_changed);
+    dcnow_vmu_set_refresh_due(dcnow_sched_next_ms(&dcnow_sched));
+    dcnow_vmu_update_display(dcnow_data);
+}
+
+/* An auto-refresh failed, the old data stays up */
+static void dcnow_auto_refresh_failed(void) {
+    dcnow_sched_on_error(&dcnow_sched, timer_ms_gettime64(), dcnow_net_get_ppp_cooldown_remaining_ms());
+    dcnow_vmu_set_refresh_due(dcnow_sched_next_ms(&dcnow_sched));
+    /* Restore old VMU display */
+    dcnow_vmu_update_display(dcnow_data);
+}
+
+/* Show why the last fetch failed in place of the list */
+static void dcnow_show_fetch_error(void) {
+    strncpy(dcnow_error_message, dcnow_get_last_error(), sizeof(dcnow_error_message) - 1);
+    dcnow_error_message[sizeof(dcnow_error_message) - 1] = '\0';
+    dcnow_data_valid = false;
+}
 
 static void dcnow_connection_status_callback(const char* message) {
     strncpy(connection_status, message, sizeof(connection_status) - 1);
@@ -160,20 +294,7 @@ static void dcnow_connection_status_callback(const char* message) {
 
     dcnow_vmu_show_status(message);
 
-    pvr_wait_ready();
-    pvr_scene_begin();
-
-    draw_set_list(PVR_LIST_OP_POLY);
-    pvr_list_begin(PVR_LIST_OP_POLY);
-    (*current_ui_draw_OP)();
-    pvr_list_finish();
-
-    draw_set_list(PVR_LIST_TR_POLY);
-    pvr_list_begin(PVR_LIST_TR_POLY);
-    (*current_ui_draw_TR)();
-    pvr_list_finish();
-
-    pvr_scene_finish();
+    draw_scene();
 }
 
 static void dcnow_start_connect_worker_or_sync(void) {
@@ -188,15 +309,13 @@ static void dcnow_start_connect_worker_or_sync(void) {
 
     if (net_result < 0) {
         DCNOW_DPRINTF("DC Now: Connection failed: %d\n", net_result);
-        memset(&dcnow_data, 0, sizeof(dcnow_data));
-        snprintf(dcnow_data.error_message, sizeof(dcnow_data.error_message),
+        snprintf(dcnow_error_message, sizeof(dcnow_error_message),
                 "Connection failed (error %d). Press A to retry", net_result);
-        dcnow_data.data_valid = false;
+        dcnow_data_valid = false;
     } else {
         DCNOW_DPRINTF("DC Now: Connection successful, starting fetch\n");
         dcnow_net_initialized = true;
-        memset(&dcnow_data, 0, sizeof(dcnow_data));
-        dcnow_data.data_valid = false;
+        dcnow_data_valid = false;
 
         dcnow_data_fetched = false;
         dcnow_is_loading = true;
@@ -215,6 +334,11 @@ dcnow_setup(enum draw_state* state, struct theme_color* _colors, int* timeout_pt
 
     popup_setup(state, _colors, timeout_ptr, title_color);
 
+    if (!dcnow_data) {
+        dcnow_data = dcnow_get_snapshot();
+        dcnow_sched_init(&dcnow_sched);
+    }
+
 #ifdef DCNOW_ASYNC
     if (!dcnow_worker_initialized) {
         dcnow_worker_init();
@@ -238,34 +362,37 @@ dcnow_setup(enum draw_state* state, struct theme_color* _colors, int* timeout_pt
     /* If network is already initialized and we haven't fetched data yet, try to fetch */
     if (dcnow_net_initialized && !dcnow_data_fetched && !dcnow_is_loading) {
         dcnow_is_loading = true;
-
+#ifdef DCNOW_ASYNC
+        /* Through the worker, it may be writing a snapshot right now */
+        dcnow_worker_start_fetch(&dcnow_worker_ctx, 5000, DCNOW_JOB_PRIO_USER);
+#else
         /* Show VMU refresh indicator while we block on the fetch */
         dcnow_vmu_show_refreshing();
 
         /* Attempt to fetch fresh data from dreamcast.online/now */
-        int result = dcnow_fetch_data(&dcnow_data, 5000);  /* 5 second timeout */
+        int result = dcnow_fetch_data(5000);  /* 5 second timeout */
 
         if (result == 0) {
             dcnow_data_fetched = true;
             /* Update VMU display with games list */
-            dcnow_vmu_update_display(&dcnow_data);
+            dcnow_take_snapshot();
             dcnow_last_fetch_ms = timer_ms_gettime64();
         } else {
-            /* Failed to fetch - try to use cached data */
-            if (!dcnow_get_cached_data(&dcnow_data)) {
-                /* No cached data available, show error */
-                memset(&dcnow_data, 0, sizeof(dcnow_data));
-                strcpy(dcnow_data.error_message, "Not connected - select Connect to begin");
-                dcnow_data.data_valid = false;
+            /* Failed to fetch - fall back to the last snapshot */
+            dcnow_data = dcnow_get_snapshot();
+            dcnow_data_valid = dcnow_data->data_valid;
+            if (!dcnow_data_valid) {
+                /* No earlier data available, show error */
+                strcpy(dcnow_error_message, "Not connected - select Connect to begin");
             }
         }
 
         dcnow_is_loading = false;
+#endif
     } else if (!dcnow_net_initialized) {
         /* Show message prompting user to connect */
-        memset(&dcnow_data, 0, sizeof(dcnow_data));
-        strcpy(dcnow_data.error_message, "Not connected");
-        dcnow_data.data_valid = false;
+        strcpy(dcnow_error_message, "Not connected");
+        dcnow_data_valid = false;
     }
 }
 
@@ -294,7 +421,7 @@ handle_input_dcnow(enum control input) {
                 connection_status[0] = '\0';
                 dcnow_view = DCNOW_VIEW_GAMES;  /* switch to games view so popup shows status */
                 if (dcnow_navigate_timeout) *dcnow_navigate_timeout = DCNOW_INPUT_TIMEOUT_INITIAL;
-            } else if (!dcnow_data.data_valid) {
+            } else if (!dcnow_data_valid) {
                 /* Fetch initial data */
                 DCNOW_DPRINTF("DC Now: Requesting initial fetch...\n");
                 dcnow_data_fetched = false;
@@ -302,11 +429,11 @@ handle_input_dcnow(enum control input) {
                 dcnow_choice = 0;
                 dcnow_scroll_offset = 0;
 #ifdef DCNOW_ASYNC
-                dcnow_worker_start_fetch(&dcnow_worker_ctx, 5000);
+                dcnow_worker_start_fetch(&dcnow_worker_ctx, 5000, DCNOW_JOB_PRIO_USER);
 #else
                 dcnow_needs_fetch = true;
 #endif
-            } else if (dcnow_view == DCNOW_VIEW_GAMES && dcnow_choice < dcnow_data.game_count) {
+            } else if (dcnow_view == DCNOW_VIEW_GAMES && dcnow_choice < dcnow_data->game_count) {
                 /* Drill down into selected game to show players */
                 dcnow_selected_game = dcnow_choice;
                 dcnow_view = DCNOW_VIEW_PLAYERS;
@@ -318,22 +445,22 @@ handle_input_dcnow(enum control input) {
                 if (dcnow_navigate_timeout) *dcnow_navigate_timeout = DCNOW_INPUT_TIMEOUT_INITIAL;
             } else {
                 DCNOW_DPRINTF("DC Now: A pressed but conditions not met - view=%d, choice=%d, game_count=%d, data_valid=%d\n",
-                       dcnow_view, dcnow_choice, dcnow_data.game_count, dcnow_data.data_valid);
+                       dcnow_view, dcnow_choice, dcnow_data->game_count, dcnow_data_valid);
             }
         } break;
         case X: {
             /* X button: Refresh data */
-            if (dcnow_net_initialized && dcnow_data.data_valid) {
+            if (dcnow_net_initialized && dcnow_data_valid) {
                 DCNOW_DPRINTF("DC Now: Requesting refresh...\n");
                 dcnow_data_fetched = false;
-                dcnow_data.data_valid = false;
+                dcnow_data_valid = false;
                 dcnow_is_loading = true;
                 dcnow_shown_loading = false;  /* Reset flag so loading screen shows */
                 dcnow_view = DCNOW_VIEW_GAMES;
                 dcnow_choice = 0;
                 dcnow_scroll_offset = 0;
 #ifdef DCNOW_ASYNC
-                dcnow_worker_start_fetch(&dcnow_worker_ctx, 5000);
+                dcnow_worker_start_fetch(&dcnow_worker_ctx, 5000, DCNOW_JOB_PRIO_USER);
 #else
                 dcnow_needs_fetch = true;
 #endif
@@ -377,7 +504,7 @@ handle_input_dcnow(enum control input) {
                 DCNOW_DPRINTF("DC Now: Going back to game list\n");
                 dcnow_view = DCNOW_VIEW_GAMES;
                 /* Restore previous selection, ensuring it's valid */
-                if (dcnow_selected_game >= 0 && dcnow_selected_game < dcnow_data.game_count) {
+                if (dcnow_selected_game >= 0 && dcnow_selected_game < dcnow_data->game_count) {
                     dcnow_choice = dcnow_selected_game;
                 } else {
                     dcnow_choice = 0;
@@ -424,11 +551,11 @@ handle_input_dcnow(enum control input) {
             } else {
                 int max_items = 0;
                 int total_items = 0;
-                if (dcnow_view == DCNOW_VIEW_GAMES && dcnow_data.data_valid) {
-                    total_items = dcnow_data.game_count;
+                if (dcnow_view == DCNOW_VIEW_GAMES && dcnow_data_valid) {
+                    total_items = dcnow_data->game_count;
                     max_items = total_items - 1;
                 } else if (dcnow_view == DCNOW_VIEW_PLAYERS && dcnow_selected_game >= 0) {
-                    total_items = dcnow_data.games[dcnow_selected_game].player_count;
+                    total_items = dcnow_data->games[dcnow_selected_game].player_count;
                     max_items = total_items - 1;
                 }
 
@@ -454,14 +581,14 @@ handle_input_dcnow(enum control input) {
         case TRIG_R: {
             /* L+R pressed together: manual refresh (same flow as X) */
             if (INPT_TriggerPressed(TRIGGER_L) && INPT_TriggerPressed(TRIGGER_R)) {
-                if (dcnow_net_initialized && dcnow_data.data_valid) {
+                if (dcnow_net_initialized && dcnow_data_valid) {
                     DCNOW_DPRINTF("DC Now: L+R refresh requested\n");
                     dcnow_data_fetched = false;
-                    dcnow_data.data_valid = false;
+                    dcnow_data_valid = false;
                     dcnow_is_loading = true;
                     dcnow_shown_loading = false;
 #ifdef DCNOW_ASYNC
-                    dcnow_worker_start_fetch(&dcnow_worker_ctx, 5000);
+                    dcnow_worker_start_fetch(&dcnow_worker_ctx, 5000, DCNOW_JOB_PRIO_USER);
 #else
                     dcnow_needs_fetch = true;
 #endif
@@ -476,15 +603,24 @@ handle_input_dcnow(enum control input) {
             /* Y button: Disconnect from network */
             if (dcnow_net_initialized) {
                 DCNOW_DPRINTF("DC Now: Disconnecting...\n");
+#ifdef DCNOW_ASYNC
+                /* Behind whatever the worker is doing, queued fetches are dropped */
+                dcnow_worker_submit(NULL, DCNOW_JOB_DISCONNECT, DCNOW_JOB_PRIO_CONNECTION, 0);
+                dcnow_is_loading = false;
+                dcnow_bg_fetch_active = false;
+#else
                 /* Disconnect modem/network - brief freeze (~700ms) is acceptable */
                 dcnow_net_disconnect();
+                dcnow_clear_cache();
+#endif
                 dcnow_net_initialized = false;
                 dcnow_data_fetched = false;
                 dcnow_last_fetch_ms = 0;
-                memset(&dcnow_data, 0, sizeof(dcnow_data));
-                snprintf(dcnow_data.error_message, sizeof(dcnow_data.error_message),
+                dcnow_sched_init(&dcnow_sched);
+                dcnow_vmu_set_refresh_due(0);
+                snprintf(dcnow_error_message, sizeof(dcnow_error_message),
                         "Disconnected. Press A to reconnect");
-                dcnow_data.data_valid = false;
+                dcnow_data_valid = false;
                 dcnow_view = DCNOW_VIEW_GAMES;
                 dcnow_choice = 0;
                 dcnow_scroll_offset = 0;
@@ -535,15 +671,14 @@ draw_dcnow_tr(void) {
 
             /* Auto-start data fetch */
             dcnow_is_loading = true;
-            dcnow_worker_start_fetch(&dcnow_worker_ctx, 10000);
+            dcnow_worker_start_fetch(&dcnow_worker_ctx, 10000, DCNOW_JOB_PRIO_USER);
         } else if (state == DCNOW_WORKER_ERROR) {
             dcnow_is_connecting = false;
             connection_status[0] = '\0';
-            memset(&dcnow_data, 0, sizeof(dcnow_data));
-            snprintf(dcnow_data.error_message, sizeof(dcnow_data.error_message),
+            snprintf(dcnow_error_message, sizeof(dcnow_error_message),
                     "Connection failed (error %d). Press A to retry",
                     dcnow_worker_ctx.error_code);
-            dcnow_data.data_valid = false;
+            dcnow_data_valid = false;
             DCNOW_DPRINTF("DC Now: Async connection failed: %d\n", dcnow_worker_ctx.error_code);
         }
     } else if (dcnow_is_connecting && !dcnow_connect_cooldown_pending && !dcnow_worker_is_busy()) {
@@ -560,18 +695,19 @@ draw_dcnow_tr(void) {
 
         if (state == DCNOW_WORKER_DONE) {
             dcnow_is_loading = false;
-            memcpy(&dcnow_data, &dcnow_worker_ctx.result_data, sizeof(dcnow_data));
             dcnow_data_fetched = true;
-            dcnow_vmu_update_display(&dcnow_data);
+            dcnow_take_snapshot();
             dcnow_last_fetch_ms = timer_ms_gettime64();
             DCNOW_DPRINTF("DC Now: Async fetch complete\n");
         } else if (state == DCNOW_WORKER_ERROR) {
             dcnow_is_loading = false;
+            dcnow_show_fetch_error();
             DCNOW_DPRINTF("DC Now: Async fetch failed: %d\n", dcnow_worker_ctx.error_code);
         }
     } else if (dcnow_is_loading && !dcnow_worker_is_busy() && !dcnow_needs_fetch) {
-        /* Worker finished between frames - catch up */
+        /* The fetch was dropped before it ran, nothing is coming */
         dcnow_worker_poll(&dcnow_worker_ctx);
+        dcnow_is_loading = false;
     }
 #endif
 
@@ -584,34 +720,35 @@ draw_dcnow_tr(void) {
         /* Show VMU refresh indicator while we block on the network */
         dcnow_vmu_show_refreshing();
 
-        int result = dcnow_fetch_data(&dcnow_data, 5000);
+        int result = dcnow_fetch_data(5000);
         if (result == 0) {
             dcnow_data_fetched = true;
-            dcnow_vmu_update_display(&dcnow_data);
+            dcnow_take_snapshot();
             dcnow_last_fetch_ms = timer_ms_gettime64();
             DCNOW_DPRINTF("DC Now: Data refreshed successfully\n");
         } else {
+            dcnow_show_fetch_error();
             DCNOW_DPRINTF("DC Now: Data refresh failed: %d\n", result);
         }
 
         dcnow_is_loading = false;
     }
 
-    /* Auto-refresh every 60 seconds while the popup is open with valid data */
-    if (dcnow_net_initialized && dcnow_data.data_valid && !dcnow_is_loading && dcnow_last_fetch_ms > 0) {
+    /* Auto-refresh while the popup is open with valid data, when the scheduler says so */
+    if (dcnow_net_initialized && dcnow_data_valid && !dcnow_is_loading && dcnow_last_fetch_ms > 0) {
         uint64_t now = timer_ms_gettime64();
-        if ((now - dcnow_last_fetch_ms) >= DCNOW_AUTO_REFRESH_MS) {
+        dcnow_sched_set_visible(&dcnow_sched, true);
+        if (dcnow_sched_due(&dcnow_sched, now)) {
             DCNOW_DPRINTF("DC Now: Auto-refresh triggered\n");
             dcnow_vmu_show_refreshing();
 
-            int result = dcnow_fetch_data(&dcnow_temp_data, 5000);
+            int result = dcnow_fetch_data(5000);
             if (result == 0) {
-                memcpy(&dcnow_data, &dcnow_temp_data, sizeof(dcnow_data));
-                dcnow_vmu_update_display(&dcnow_data);
+                dcnow_take_snapshot();
                 DCNOW_DPRINTF("DC Now: Auto-refresh completed successfully\n");
             } else {
-                /* Fetch failed — keep old data, restore old VMU display */
-                dcnow_vmu_update_display(&dcnow_data);
+                /* Fetch failed — keep old data */
+                dcnow_auto_refresh_failed();
                 DCNOW_DPRINTF("DC Now: Auto-refresh failed: %d\n", result);
             }
             dcnow_last_fetch_ms = timer_ms_gettime64();
@@ -637,31 +774,18 @@ draw_dcnow_tr(void) {
             max_line_len = instr_len;
         }
 
-        if (dcnow_data.data_valid) {
-            for (int i = 0; i < dcnow_data.game_count; i++) {
-                int len = strlen(dcnow_data.games[i].game_name) + 15;  /* name + " - 999 players" + margin */
-                if (len > max_line_len) {
-                    max_line_len = len;
-                }
+        if (dcnow_data_valid) {
+            dcnow_measure_lists();
+            int len = dcnow_widest_game_name + 15;  /* name + " - 999 players" + margin */
+            if (len > max_line_len) {
+                max_line_len = len;
             }
             /* Check player names and details in player view */
-            if (dcnow_view == DCNOW_VIEW_PLAYERS && dcnow_selected_game >= 0 &&
-                dcnow_selected_game < dcnow_data.game_count) {
-                int player_count = dcnow_data.games[dcnow_selected_game].player_count;
-                for (int i = 0; i < player_count && i < 64; i++) {
-                    int len = strlen(dcnow_data.games[dcnow_selected_game].player_names[i]);
-                    const json_player_details_t *details = &dcnow_data.games[dcnow_selected_game].player_details[i];
-                    /* Add space for " [Level | Country]" if present */
-                    if (details->level[0] != '\0' || details->country[0] != '\0') {
-                        len += strlen(details->level) + strlen(details->country) + 8;  /* " [ | ]" + margin */
-                    }
-                    if (len > max_line_len) {
-                        max_line_len = len;
-                    }
-                }
+            if (dcnow_view == DCNOW_VIEW_PLAYERS && dcnow_widest_player_line > max_line_len) {
+                max_line_len = dcnow_widest_player_line;
             }
         } else {
-            int err_len = strlen(dcnow_data.error_message);
+            int err_len = strlen(dcnow_error_message);
             if (err_len > max_line_len) {
                 max_line_len = err_len;
             }
@@ -670,10 +794,10 @@ draw_dcnow_tr(void) {
         const int width = (max_line_len * 8) + padding + icon_space;
 
         int num_lines = 2;  /* Title + total players line */
-        if (dcnow_data.data_valid) {
+        if (dcnow_data_valid) {
             if (dcnow_view == DCNOW_VIEW_PLAYERS && dcnow_selected_game >= 0) {
                 /* Player list view */
-                int player_count = dcnow_data.games[dcnow_selected_game].player_count;
+                int player_count = dcnow_data->games[dcnow_selected_game].player_count;
                 num_lines += 1;  /* Game title line */
                 num_lines += (player_count < max_visible_games ? player_count : max_visible_games);
                 if (player_count > max_visible_games) {
@@ -682,8 +806,8 @@ draw_dcnow_tr(void) {
                 num_lines += 3;  /* Separator + spacing + instructions */
             } else {
                 /* Game list view */
-                num_lines += (dcnow_data.game_count < max_visible_games ? dcnow_data.game_count : max_visible_games);
-                if (dcnow_data.game_count > max_visible_games) {
+                num_lines += (dcnow_data->game_count < max_visible_games ? dcnow_data->game_count : max_visible_games);
+                if (dcnow_data->game_count > max_visible_games) {
                     num_lines += 1;  /* Scroll indicator */
                 }
                 num_lines += 3;  /* Separator + spacing + instructions */
@@ -744,15 +868,15 @@ draw_dcnow_tr(void) {
                 dcnow_last_fetch_ms == 0 ? "Fetching initial data..." : "Refreshing... Please Wait");
             dcnow_shown_loading = true;  /* Mark that we've shown the loading screen */
             cur_y += line_height;
-        } else if (dcnow_data.data_valid) {
+        } else if (dcnow_data_valid) {
             if (dcnow_view == DCNOW_VIEW_PLAYERS && dcnow_selected_game >= 0) {
                 /* Show player list for selected game */
                 char game_name_buf[80];
                 char player_count_buf[20];
                 snprintf(game_name_buf, sizeof(game_name_buf), "%s - ",
-                         dcnow_data.games[dcnow_selected_game].game_name);
+                         dcnow_data->games[dcnow_selected_game].game_name);
                 snprintf(player_count_buf, sizeof(player_count_buf), "%d players",
-                         dcnow_data.games[dcnow_selected_game].player_count);
+                         dcnow_data->games[dcnow_selected_game].player_count);
 
                 /* Draw game name in white */
                 font_bmp_set_color(dcnow_text_color);
@@ -764,7 +888,7 @@ draw_dcnow_tr(void) {
                 font_bmp_draw_main(x_item + name_width, cur_y, player_count_buf);
                 cur_y += line_height;
 
-                int player_count = dcnow_data.games[dcnow_selected_game].player_count;
+                int player_count = dcnow_data->games[dcnow_selected_game].player_count;
                 int visible_count = (player_count < max_visible_games) ? player_count : max_visible_games;
 
                 for (int i = 0; i < visible_count; i++) {
@@ -772,11 +896,11 @@ draw_dcnow_tr(void) {
                     if (player_idx >= player_count) break;
 
                     font_bmp_set_color(player_idx == dcnow_choice ? 0xFFFF8800 : dcnow_text_color);  /* Bright orange for selection */
-                    font_bmp_draw_main(x_item, cur_y, dcnow_data.games[dcnow_selected_game].player_names[player_idx]);
+                    font_bmp_draw_main(x_item, cur_y, dcnow_data->games[dcnow_selected_game].players[player_idx].name);
 
                     /* Show level and country for highlighted player */
                     if (player_idx == dcnow_choice) {
-                        const json_player_details_t *details = &dcnow_data.games[dcnow_selected_game].player_details[player_idx];
+                        const dcnow_player_t *details = &dcnow_data->games[dcnow_selected_game].players[player_idx];
                         if (details->level[0] != '\0' || details->country[0] != '\0') {
                             char info[64];
                             if (details->level[0] != '\0' && details->country[0] != '\0') {
@@ -786,7 +910,7 @@ draw_dcnow_tr(void) {
                             } else {
                                 snprintf(info, sizeof(info), " [%s]", details->country);
                             }
-                            int name_width = strlen(dcnow_data.games[dcnow_selected_game].player_names[player_idx]) * 8;
+                            int name_width = strlen(dcnow_data->games[dcnow_selected_game].players[player_idx].name) * 8;
                             font_bmp_set_color(0xFF88CCFF);  /* Light blue for details */
                             font_bmp_draw_main(x_item + name_width, cur_y, info);
                         }
@@ -809,7 +933,7 @@ draw_dcnow_tr(void) {
                 char total_label[40];
                 char total_count[20];
                 snprintf(total_label, sizeof(total_label), "Total Active Players: ");
-                snprintf(total_count, sizeof(total_count), "%d", dcnow_data.total_players);
+                snprintf(total_count, sizeof(total_count), "%d", dcnow_data->total_players);
 
                 /* Draw label in light blue */
                 font_bmp_set_color(0xFF88CCFF);
@@ -822,27 +946,27 @@ draw_dcnow_tr(void) {
                 cur_y += line_height + 4;  /* Extra spacing after total */
 
                 /* Show game list */
-                if (dcnow_data.game_count == 0) {
+                if (dcnow_data->game_count == 0) {
                 font_bmp_set_color(dcnow_text_color);
                 font_bmp_draw_main(x_item, cur_y, "No active games");
                 cur_y += line_height;
             } else {
                 /* Show games with scrolling support */
-                int visible_count = (dcnow_data.game_count < max_visible_games) ?
-                                   dcnow_data.game_count : max_visible_games;
+                int visible_count = (dcnow_data->game_count < max_visible_games) ?
+                                   dcnow_data->game_count : max_visible_games;
 
                 for (int i = 0; i < visible_count; i++) {
                     int game_idx = dcnow_scroll_offset + i;
-                    if (game_idx >= dcnow_data.game_count) break;
+                    if (game_idx >= dcnow_data->game_count) break;
 
                     /* Try to load box art icon for this game */
                     image game_icon;
                     bool has_icon = false;
-                    if (dcnow_data.games[game_idx].game_code[0] != '\0') {
+                    if (dcnow_data->games[game_idx].game_code[0] != '\0') {
                         /* Map API code to product ID */
-                        const char* product_id = get_product_id_from_api_code(dcnow_data.games[game_idx].game_code);
+                        const char* product_id = get_product_id_from_api_code(dcnow_data->games[game_idx].game_code);
                         DCNOW_DPRINTF("DC Now UI: API code '%s' -> product ID '%s'\n",
-                               dcnow_data.games[game_idx].game_code, product_id);
+                               dcnow_data->games[game_idx].game_code, product_id);
 
                         if (product_id && txr_get_small(product_id, &game_icon) == 0) {
                             /* Check if we got a real texture or just the empty placeholder */
@@ -868,16 +992,16 @@ draw_dcnow_tr(void) {
                     /* Format game name and player count separately for better color coding */
                     char game_name_buf[80];
                     char player_count_buf[30];
-                    const char* status = dcnow_data.games[game_idx].is_active ? "" : " (offline)";
+                    const char* status = dcnow_data->games[game_idx].is_active ? "" : " (offline)";
 
-                    snprintf(game_name_buf, sizeof(game_name_buf), "%s - ", dcnow_data.games[game_idx].game_name);
+                    snprintf(game_name_buf, sizeof(game_name_buf), "%s - ", dcnow_data->games[game_idx].game_name);
 
-                    if (dcnow_data.games[game_idx].player_count == 1) {
+                    if (dcnow_data->games[game_idx].player_count == 1) {
                         snprintf(player_count_buf, sizeof(player_count_buf), "%d player%s",
-                                 dcnow_data.games[game_idx].player_count, status);
+                                 dcnow_data->games[game_idx].player_count, status);
                     } else {
                         snprintf(player_count_buf, sizeof(player_count_buf), "%d players%s",
-                                 dcnow_data.games[game_idx].player_count, status);
+                                 dcnow_data->games[game_idx].player_count, status);
                     }
 
                     /* Draw game name - white or bright orange when selected */
@@ -892,10 +1016,10 @@ draw_dcnow_tr(void) {
                 }
 
                 /* Show scroll indicators if needed */
-                if (dcnow_data.game_count > max_visible_games) {
+                if (dcnow_data->game_count > max_visible_games) {
                     char scroll_info[32];
                     snprintf(scroll_info, sizeof(scroll_info), "(%d/%d)",
-                             dcnow_choice + 1, dcnow_data.game_count);
+                             dcnow_choice + 1, dcnow_data->game_count);
                     font_bmp_set_color(0xFFBBBBBB);  /* Light gray for scroll info */
                     font_bmp_draw_main(x_item, cur_y, scroll_info);
                     cur_y += line_height;
@@ -935,7 +1059,7 @@ draw_dcnow_tr(void) {
         } else {
             /* Show error message or connection prompt */
             font_bmp_set_color(dcnow_text_color);
-            font_bmp_draw_main(x_item, cur_y, dcnow_data.error_message);
+            font_bmp_draw_main(x_item, cur_y, dcnow_error_message);
             cur_y += line_height;
             if (!dcnow_net_initialized) {
                 font_bmp_draw_main(x_item, cur_y, "Press A to connect");
@@ -974,7 +1098,7 @@ draw_dcnow_tr(void) {
             instr_x += 8;
             font_bmp_set_color(0xFFCCCCCC);
             font_bmp_draw_main(instr_x, cur_y, "=Close");
-        } else if (!dcnow_data.data_valid) {
+        } else if (!dcnow_data_valid) {
             /* A button - RED */
             font_bmp_set_color(0xFFDD2222);
             font_bmp_draw_main(instr_x, cur_y, "A");
@@ -1045,37 +1169,24 @@ draw_dcnow_tr(void) {
             max_line_len = instr_len;
         }
 
-        if (dcnow_data.data_valid) {
-            for (int i = 0; i < dcnow_data.game_count; i++) {
-                /* Estimate character width for vector font (~10 pixels/char) */
-                int len = strlen(dcnow_data.games[i].game_name) + 15;
-                if (len > max_line_len) {
-                    max_line_len = len;
-                }
+        if (dcnow_data_valid) {
+            dcnow_measure_lists();
+            /* Estimate character width for vector font (~10 pixels/char) */
+            int len = dcnow_widest_game_name + 15;
+            if (len > max_line_len) {
+                max_line_len = len;
             }
             /* Check player names and details in player view */
-            if (dcnow_view == DCNOW_VIEW_PLAYERS && dcnow_selected_game >= 0 &&
-                dcnow_selected_game < dcnow_data.game_count) {
-                int player_count = dcnow_data.games[dcnow_selected_game].player_count;
-                for (int i = 0; i < player_count && i < 64; i++) {
-                    int len = strlen(dcnow_data.games[dcnow_selected_game].player_names[i]);
-                    const json_player_details_t *details = &dcnow_data.games[dcnow_selected_game].player_details[i];
-                    /* Add space for " [Level | Country]" if present */
-                    if (details->level[0] != '\0' || details->country[0] != '\0') {
-                        len += strlen(details->level) + strlen(details->country) + 8;  /* " [ | ]" + margin */
-                    }
-                    if (len > max_line_len) {
-                        max_line_len = len;
-                    }
-                }
+            if (dcnow_view == DCNOW_VIEW_PLAYERS && dcnow_widest_player_line > max_line_len) {
+                max_line_len = dcnow_widest_player_line;
             }
         }
 
         int num_lines = 2;  /* Title + total */
-        if (dcnow_data.data_valid) {
+        if (dcnow_data_valid) {
             if (dcnow_view == DCNOW_VIEW_PLAYERS && dcnow_selected_game >= 0) {
                 /* Player list view */
-                int player_count = dcnow_data.games[dcnow_selected_game].player_count;
+                int player_count = dcnow_data->games[dcnow_selected_game].player_count;
                 num_lines += 1;  /* Game title line */
                 num_lines += (player_count < max_visible_games ? player_count : max_visible_games);
                 if (player_count > max_visible_games) {
@@ -1084,8 +1195,8 @@ draw_dcnow_tr(void) {
                 num_lines += 3;  /* Separator + spacing + instructions */
             } else {
                 /* Game list view */
-                num_lines += (dcnow_data.game_count < max_visible_games ? dcnow_data.game_count : max_visible_games);
-                if (dcnow_data.game_count > max_visible_games) {
+                num_lines += (dcnow_data->game_count < max_visible_games ? dcnow_data->game_count : max_visible_games);
+                if (dcnow_data->game_count > max_visible_games) {
                     num_lines += 1;  /* Scroll indicator */
                 }
                 num_lines += 3;  /* Separator + spacing + instructions */
@@ -1140,7 +1251,7 @@ draw_dcnow_tr(void) {
             font_bmf_draw(x_item, cur_y, dcnow_text_color,
                 dcnow_last_fetch_ms == 0 ? "Fetching initial data..." : "Refreshing... Please Wait");
             dcnow_shown_loading = true;  /* Mark that we've shown the loading screen */
-        } else if (dcnow_data.data_valid) {
+        } else if (dcnow_data_valid) {
             if (dcnow_view == DCNOW_VIEW_PLAYERS && dcnow_selected_game >= 0) {
                 /* Show player list for selected game */
                 cur_y += line_height;
@@ -1149,9 +1260,9 @@ draw_dcnow_tr(void) {
                 char game_name_buf[80];
                 char player_count_buf[20];
                 snprintf(game_name_buf, sizeof(game_name_buf), "%s - ",
-                         dcnow_data.games[dcnow_selected_game].game_name);
+                         dcnow_data->games[dcnow_selected_game].game_name);
                 snprintf(player_count_buf, sizeof(player_count_buf), "%d players",
-                         dcnow_data.games[dcnow_selected_game].player_count);
+                         dcnow_data->games[dcnow_selected_game].player_count);
 
                 /* Measure game name width for positioning */
                 int name_x = x_item;
@@ -1161,7 +1272,7 @@ draw_dcnow_tr(void) {
                 int count_x = name_x + (strlen(game_name_buf) * 10);
                 font_bmf_draw(count_x, cur_y, 0xFFAAFF00, player_count_buf);
 
-                int player_count = dcnow_data.games[dcnow_selected_game].player_count;
+                int player_count = dcnow_data->games[dcnow_selected_game].player_count;
                 int visible_count = (player_count < max_visible_games) ? player_count : max_visible_games;
 
                 for (int i = 0; i < visible_count; i++) {
@@ -1170,11 +1281,11 @@ draw_dcnow_tr(void) {
 
                     cur_y += line_height;
                     uint32_t color = (player_idx == dcnow_choice) ? 0xFFFF8800 : dcnow_text_color;  /* Bright orange for selection */
-                    font_bmf_draw(x_item, cur_y, color, dcnow_data.games[dcnow_selected_game].player_names[player_idx]);
+                    font_bmf_draw(x_item, cur_y, color, dcnow_data->games[dcnow_selected_game].players[player_idx].name);
 
                     /* Show level and country for highlighted player */
                     if (player_idx == dcnow_choice) {
-                        const json_player_details_t *details = &dcnow_data.games[dcnow_selected_game].player_details[player_idx];
+                        const dcnow_player_t *details = &dcnow_data->games[dcnow_selected_game].players[player_idx];
                         if (details->level[0] != '\0' || details->country[0] != '\0') {
                             char info[64];
                             if (details->level[0] != '\0' && details->country[0] != '\0') {
@@ -1184,7 +1295,7 @@ draw_dcnow_tr(void) {
                             } else {
                                 snprintf(info, sizeof(info), " [%s]", details->country);
                             }
-                            int name_x = x_item + (strlen(dcnow_data.games[dcnow_selected_game].player_names[player_idx]) * 10);
+                            int name_x = x_item + (strlen(dcnow_data->games[dcnow_selected_game].players[player_idx].name) * 10);
                             font_bmf_draw(name_x, cur_y, 0xFF88CCFF, info);  /* Light blue for details */
                         }
                     }
@@ -1204,7 +1315,7 @@ draw_dcnow_tr(void) {
                 char total_label[40];
                 char total_count[20];
                 snprintf(total_label, sizeof(total_label), "Total Active Players: ");
-                snprintf(total_count, sizeof(total_count), "%d", dcnow_data.total_players);
+                snprintf(total_count, sizeof(total_count), "%d", dcnow_data->total_players);
 
                 /* Draw label in light blue */
                 font_bmf_draw(x_item, cur_y, 0xFF88CCFF, total_label);
@@ -1216,26 +1327,26 @@ draw_dcnow_tr(void) {
                 cur_y += 6;  /* Extra spacing after total */
 
                 /* Game list */
-                if (dcnow_data.game_count == 0) {
+                if (dcnow_data->game_count == 0) {
                 cur_y += line_height;
                 font_bmf_draw(x_item, cur_y, dcnow_text_color, "No active games");
             } else {
                 /* Show games with scrolling support */
-                int visible_count = (dcnow_data.game_count < max_visible_games) ?
-                                   dcnow_data.game_count : max_visible_games;
+                int visible_count = (dcnow_data->game_count < max_visible_games) ?
+                                   dcnow_data->game_count : max_visible_games;
 
                 for (int i = 0; i < visible_count; i++) {
                     int game_idx = dcnow_scroll_offset + i;
-                    if (game_idx >= dcnow_data.game_count) break;
+                    if (game_idx >= dcnow_data->game_count) break;
 
                     cur_y += line_height;
 
                     /* Try to load box art icon for this game */
                     image game_icon;
                     bool has_icon = false;
-                    if (dcnow_data.games[game_idx].game_code[0] != '\0') {
+                    if (dcnow_data->games[game_idx].game_code[0] != '\0') {
                         /* Map API code to product ID */
-                        const char* product_id = get_product_id_from_api_code(dcnow_data.games[game_idx].game_code);
+                        const char* product_id = get_product_id_from_api_code(dcnow_data->games[game_idx].game_code);
 
                         if (product_id && txr_get_small(product_id, &game_icon) == 0) {
                             /* Check if we got a real texture or just the empty placeholder */
@@ -1256,16 +1367,16 @@ draw_dcnow_tr(void) {
                     /* Format game name and player count separately for better color coding */
                     char game_name_buf[80];
                     char player_count_buf[30];
-                    const char* status = dcnow_data.games[game_idx].is_active ? "" : " (offline)";
+                    const char* status = dcnow_data->games[game_idx].is_active ? "" : " (offline)";
 
-                    snprintf(game_name_buf, sizeof(game_name_buf), "%s - ", dcnow_data.games[game_idx].game_name);
+                    snprintf(game_name_buf, sizeof(game_name_buf), "%s - ", dcnow_data->games[game_idx].game_name);
 
-                    if (dcnow_data.games[game_idx].player_count == 1) {
+                    if (dcnow_data->games[game_idx].player_count == 1) {
                         snprintf(player_count_buf, sizeof(player_count_buf), "%d player%s",
-                                 dcnow_data.games[game_idx].player_count, status);
+                                 dcnow_data->games[game_idx].player_count, status);
                     } else {
                         snprintf(player_count_buf, sizeof(player_count_buf), "%d players%s",
-                                 dcnow_data.games[game_idx].player_count, status);
+                                 dcnow_data->games[game_idx].player_count, status);
                     }
 
                     /* Draw game name - white or bright orange when selected */
@@ -1278,11 +1389,11 @@ draw_dcnow_tr(void) {
                 }
 
                 /* Show scroll indicators if needed */
-                if (dcnow_data.game_count > max_visible_games) {
+                if (dcnow_data->game_count > max_visible_games) {
                     cur_y += line_height;
                     char scroll_info[32];
                     snprintf(scroll_info, sizeof(scroll_info), "(%d/%d)",
-                             dcnow_choice + 1, dcnow_data.game_count);
+                             dcnow_choice + 1, dcnow_data->game_count);
                     font_bmf_draw(x_item, cur_y, 0xFFBBBBBB, scroll_info);  /* Light gray */
                 }
                 }
@@ -1315,7 +1426,7 @@ draw_dcnow_tr(void) {
         } else {
             /* Error or connection prompt */
             cur_y += line_height;
-            font_bmf_draw(x_item, cur_y, dcnow_text_color, dcnow_data.error_message);
+            font_bmf_draw(x_item, cur_y, dcnow_text_color, dcnow_error_message);
             cur_y += line_height;
             if (!dcnow_net_initialized) {
                 font_bmf_draw(x_item, cur_y, dcnow_text_color, "Press A to connect");
@@ -1349,7 +1460,7 @@ draw_dcnow_tr(void) {
             font_bmf_draw(instr_x, cur_y, 0xFF3399FF, "B");
             instr_x += 12;
             font_bmf_draw(instr_x, cur_y, 0xFFCCCCCC, "=Close");
-        } else if (!dcnow_data.data_valid) {
+        } else if (!dcnow_data_valid) {
             /* A button - RED */
             font_bmf_draw(instr_x, cur_y, 0xFFDD2222, "A");
             instr_x += 12;
@@ -1390,20 +1501,26 @@ draw_dcnow_tr(void) {
 }
 
 /* Background auto-refresh for DC Now data (called from main loop)
- * This ensures data is refreshed every 60 seconds even when popup is closed */
+ * This keeps the data fresh even when popup is closed, dcnow_sched decides how often */
 void
 dcnow_background_tick(void) {
 #ifdef DCNOW_ASYNC
     /* Async: check if a background fetch completed */
-    if (dcnow_bg_fetch_active && !dcnow_worker_is_busy()) {
+    if (dcnow_bg_fetch_active) {
         dcnow_worker_state_t state = dcnow_worker_poll(&dcnow_worker_ctx);
+        if (state != DCNOW_WORKER_DONE && state != DCNOW_WORKER_ERROR) {
+            if (state == DCNOW_WORKER_IDLE) {
+                /* Dropped before it ran */
+                dcnow_bg_fetch_active = false;
+            }
+            return;
+        }
         if (state == DCNOW_WORKER_DONE) {
-            memcpy(&dcnow_data, &dcnow_worker_ctx.result_data, sizeof(dcnow_data));
-            dcnow_vmu_update_display(&dcnow_data);
+            dcnow_take_snapshot();
             DCNOW_DPRINTF("DC Now: Async background refresh completed\n");
         } else if (state == DCNOW_WORKER_ERROR) {
-            /* Keep old data, restore old VMU display */
-            dcnow_vmu_update_display(&dcnow_data);
+            /* Keep old data */
+            dcnow_auto_refresh_failed();
             DCNOW_DPRINTF("DC Now: Async background refresh failed: %d\n", dcnow_worker_ctx.error_code);
         }
         dcnow_bg_fetch_active = false;
@@ -1412,7 +1529,7 @@ dcnow_background_tick(void) {
 #endif
 
     /* Only refresh if network is initialized and we have valid data */
-    if (!dcnow_net_initialized || !dcnow_data.data_valid || dcnow_is_loading) {
+    if (!dcnow_net_initialized || !dcnow_data_valid || dcnow_is_loading) {
         return;
     }
 
@@ -1428,9 +1545,19 @@ dcnow_background_tick(void) {
         return;
     }
 
-    /* Check if 60 seconds have passed since last refresh */
+    /* Refreshes come sooner while someone is looking at the list */
+    const bool popup_open = dcnow_state_ptr && *dcnow_state_ptr == DRAW_DCNOW_PLAYERS;
+    dcnow_sched_set_visible(&dcnow_sched, popup_open);
+
     uint64_t now = timer_ms_gettime64();
-    if ((now - dcnow_last_fetch_ms) < DCNOW_AUTO_REFRESH_MS) {
+    if (!dcnow_sched_due(&dcnow_sched, now)) {
+#ifdef DCNOW_ASYNC
+        /* Resolve the host a little ahead so the refresh doesn't wait for it, once per round */
+        if (!dcnow_dns_prefetched && dcnow_sched_next_ms(&dcnow_sched) - now <= DCNOW_DNS_PREFETCH_LEAD_MS) {
+            dcnow_worker_submit(NULL, DCNOW_JOB_DNS_PREFETCH, DCNOW_JOB_PRIO_BACKGROUND, 0);
+            dcnow_dns_prefetched = true;
+        }
+#endif
         return;
     }
 
@@ -1440,21 +1567,21 @@ dcnow_background_tick(void) {
 
 #ifdef DCNOW_ASYNC
     /* Async: start background fetch without blocking */
-    if (dcnow_worker_start_fetch(&dcnow_worker_ctx, 5000) == 0) {
+    if (dcnow_worker_start_fetch(&dcnow_worker_ctx, 5000, DCNOW_JOB_PRIO_BACKGROUND) == 0) {
         dcnow_bg_fetch_active = true;
+        dcnow_dns_prefetched = false;
     } else {
         /* Worker busy, try again next tick */
         DCNOW_DPRINTF("DC Now: Background refresh deferred - worker busy\n");
     }
 #else
-    int result = dcnow_fetch_data(&dcnow_temp_data, 5000);
+    int result = dcnow_fetch_data(5000);
     if (result == 0) {
-        memcpy(&dcnow_data, &dcnow_temp_data, sizeof(dcnow_data));
-        dcnow_vmu_update_display(&dcnow_data);
+        dcnow_take_snapshot();
         DCNOW_DPRINTF("DC Now: Background auto-refresh completed successfully\n");
     } else {
-        /* Fetch failed — keep old data, restore old VMU display */
-        dcnow_vmu_update_display(&dcnow_data);
+        /* Fetch failed — keep old data */
+        dcnow_auto_refresh_failed();
         DCNOW_DPRINTF("DC Now: Background auto-refresh failed: %d\n", result);
     }
     dcnow_last_fetch_ms = timer_ms_gettime64();
@@ -1,5 +1,6 @@
 #include "dcnow_net_init.h"
 #include "dcnow_vmu.h"
+#include "dcnow_http.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -574,6 +575,9 @@ void dcnow_net_disconnect(void) {
     /* Restore VMU to OpenMenu logo when disconnecting */
     dcnow_vmu_restore_logo();
 
+    /* The kept HTTP connection can't outlive the link */
+    dcnow_http_disconnect();
+
     /* Check if we have a network device */
     if (!net_default_dev) {
         /* Leave SCIF state as-is (don't restore to 57600) so reconnect works.
@@ -0,0 +1,100 @@
+#ifndef DCNOW_PORT_H
+#define DCNOW_PORT_H
+
+/*
+ * What the DC Now network code needs from the platform: BSD sockets, a
+ * millisecond clock, a way to yield and a progress hook for slow steps.
+ * KOS provides them on the Dreamcast. A host build (DCNOW_HOST_BUILD) gets
+ * them from POSIX, which is how tools/dcnowbench runs the fetch path against
+ * a local server. DCNOW_NET is defined wherever there is a network to use.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#if defined(_arch_dreamcast)
+
+#include <kos.h>
+#include <kos/net.h>
+#include <kos/thread.h>
+#include <arch/timer.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "dcnow_vmu.h"
+
+#define DCNOW_NET 1
+
+/* How long the receive loop sleeps when nothing has arrived yet */
+#define DCNOW_PORT_RECV_SLICE_MS 10
+
+static inline uint64_t dcnow_port_ms(void) {
+    return timer_ms_gettime64();
+}
+
+static inline void dcnow_port_yield(void) {
+    thd_pass();
+}
+
+/* Keeps the VMU spinner turning through DNS, connect and receive */
+static inline void dcnow_port_progress(void) {
+    dcnow_vmu_show_refreshing();
+}
+
+/* A blocking recv() would wait forever on a connection the server dropped
+ * without a FIN, so the connected socket goes non blocking and the receive
+ * loop's own timeout decides. Called after connect(), which stays blocking. */
+static inline void dcnow_port_socket_setup(int sock) {
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+}
+
+static inline void dcnow_port_recv_wait(void) {
+    thd_sleep(DCNOW_PORT_RECV_SLICE_MS);
+}
+
+#elif defined(DCNOW_HOST_BUILD)
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <sched.h>
+#include <time.h>
+
+#define DCNOW_NET 1
+
+/* How long one recv() waits before the receive loop checks its timeout */
+#define DCNOW_PORT_RECV_SLICE_MS 100
+
+static inline uint64_t dcnow_port_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)(ts.tv_nsec / 1000000);
+}
+
+static inline void dcnow_port_yield(void) {
+    sched_yield();
+}
+
+static inline void dcnow_port_progress(void) {
+}
+
+/* A stalled server must not block recv() past the fetch timeout */
+static inline void dcnow_port_socket_setup(int sock) {
+    struct timeval tv = {0, DCNOW_PORT_RECV_SLICE_MS * 1000};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+}
+
+/* recv() already waited a slice */
+static inline void dcnow_port_recv_wait(void) {
+}
+
+#endif
+
+#endif /* DCNOW_PORT_H */
@@ -0,0 +1,108 @@
+#include "dcnow_sched.h"
+#include "dcnow_net_init.h"
+#include <stdio.h>
+
+static void sched_log(const dcnow_sched_t* s, const char* reason) {
+    DCNOW_DPRINTF("DC Now: Next refresh in %u ms (%s)\n",
+           (unsigned)(dcnow_sched_next_ms(s) - s->last_ms), reason);
+}
+
+void dcnow_sched_init(dcnow_sched_t* s) {
+    s->last_ms = 0;
+    s->interval_ms = DCNOW_SCHED_BASE_MS;
+    s->retry_ms = 0;
+    s->error_streak = 0;
+    s->unchanged_streak = 0;
+    s->visible = true;
+    s->reason = "no fetch yet";
+}
+
+void dcnow_sched_on_success(dcnow_sched_t* s, uint64_t now_ms, bool changed, bool counts_changed) {
+    s->last_ms = now_ms;
+    s->error_streak = 0;
+
+    if (counts_changed) {
+        /* Something is going on, halve towards the minimum */
+        s->unchanged_streak = 0;
+        s->interval_ms /= 2;
+        if (s->interval_ms < DCNOW_SCHED_MIN_MS) {
+            s->interval_ms = DCNOW_SCHED_MIN_MS;
+        }
+        s->reason = "counts changing";
+    } else if (changed) {
+        /* Only names or details moved, back to the usual pace */
+        s->unchanged_streak = 0;
+        s->interval_ms = DCNOW_SCHED_BASE_MS;
+        s->reason = "list changed";
+    } else {
+        /* Half as long again each time nothing changed */
+        s->unchanged_streak++;
+        s->interval_ms += s->interval_ms / 2;
+        if (s->interval_ms < DCNOW_SCHED_BASE_MS) {
+            s->interval_ms = DCNOW_SCHED_BASE_MS;
+        }
+        if (s->interval_ms > DCNOW_SCHED_MAX_MS) {
+            s->interval_ms = DCNOW_SCHED_MAX_MS;
+        }
+        s->reason = "unchanged";
+    }
+    sched_log(s, s->reason);
+}
+
+void dcnow_sched_on_error(dcnow_sched_t* s, uint64_t now_ms, uint32_t cooldown_ms) {
+    uint32_t backoff = DCNOW_SCHED_RETRY_MS;
+
+    s->last_ms = now_ms;
+    /* Stop doubling once the cap is reached, the shift would overflow eventually */
+    if (s->error_streak < 16) {
+        s->error_streak++;
+    }
+    for (int i = 1; i < s->error_streak && backoff < DCNOW_SCHED_RETRY_MAX_MS; i++) {
+        backoff *= 2;
+    }
+    if (backoff > DCNOW_SCHED_RETRY_MAX_MS) {
+        backoff = DCNOW_SCHED_RETRY_MAX_MS;
+    }
+
+    if (cooldown_ms > backoff) {
+        backoff = cooldown_ms;
+        s->reason = "PPP cooldown";
+    } else {
+        s->reason = "error backoff";
+    }
+    s->retry_ms = now_ms + backoff;
+    DCNOW_DPRINTF("DC Now: Error %d in a row\n", s->error_streak);
+    sched_log(s, s->reason);
+}
+
+void dcnow_sched_set_visible(dcnow_sched_t* s, bool visible) {
+    if (s->visible == visible) {
+        return;
+    }
+    s->visible = visible;
+    if (s->last_ms != 0) {
+        sched_log(s, visible ? "shown" : "hidden");
+    }
+}
+
+uint64_t dcnow_sched_next_ms(const dcnow_sched_t* s) {
+    if (s->last_ms == 0) {
+        return 0;
+    }
+    if (s->error_streak > 0) {
+        return s->retry_ms;
+    }
+    if (s->visible) {
+        return s->last_ms + s->interval_ms;
+    }
+
+    uint32_t hidden = s->interval_ms * DCNOW_SCHED_HIDDEN_FACTOR;
+    if (hidden > DCNOW_SCHED_HIDDEN_MAX_MS) {
+        hidden = DCNOW_SCHED_HIDDEN_MAX_MS;
+    }
+    return s->last_ms + hidden;
+}
+
+bool dcnow_sched_due(const dcnow_sched_t* s, uint64_t now_ms) {
+    return s->last_ms != 0 && now_ms >= dcnow_sched_next_ms(s);
+}
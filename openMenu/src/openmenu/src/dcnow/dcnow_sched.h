@@ -0,0 +1,61 @@
+#ifndef DCNOW_SCHED_H
+#define DCNOW_SCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * When to refresh DC Now in the background. The interval shrinks while player
+ * counts keep changing, grows while the list stays the same and grows further
+ * while the popup is closed. The VMU only shows totals, it keeps up at the
+ * slower pace and doesn't count as showing the list. Failed fetches back off
+ * exponentially and never retry inside the PPP reconnect cooldown.
+ *
+ * Nothing here reads a clock, every call is handed the time, so a host build
+ * can drive it with a made up one.
+ */
+
+#define DCNOW_SCHED_BASE_MS        60000   /* interval after a change, and the old fixed one */
+#define DCNOW_SCHED_MIN_MS         30000   /* while counts change refresh after refresh */
+#define DCNOW_SCHED_MAX_MS         180000  /* list unchanged for a while */
+#define DCNOW_SCHED_HIDDEN_FACTOR  4       /* nobody looking */
+#define DCNOW_SCHED_HIDDEN_MAX_MS  600000
+#define DCNOW_SCHED_RETRY_MS       15000   /* first retry after an error, doubles each time */
+#define DCNOW_SCHED_RETRY_MAX_MS   600000
+
+typedef struct {
+    uint64_t last_ms;          /* last fetch result, 0 before the first */
+    uint32_t interval_ms;      /* between successful refreshes while visible */
+    uint64_t retry_ms;         /* next attempt while error_streak > 0 */
+    int error_streak;
+    int unchanged_streak;
+    bool visible;              /* popup open */
+    const char* reason;        /* why the next refresh is when it is */
+} dcnow_sched_t;
+
+void dcnow_sched_init(dcnow_sched_t* s);
+
+/**
+ * A fetch succeeded
+ *
+ * @param changed A new snapshot was published
+ * @param counts_changed Games or player counts differ from the last one
+ */
+void dcnow_sched_on_success(dcnow_sched_t* s, uint64_t now_ms, bool changed, bool counts_changed);
+
+/**
+ * A fetch failed
+ *
+ * @param cooldown_ms What is left of the PPP reconnect cooldown
+ */
+void dcnow_sched_on_error(dcnow_sched_t* s, uint64_t now_ms, uint32_t cooldown_ms);
+
+/* Whether the list is on screen */
+void dcnow_sched_set_visible(dcnow_sched_t* s, bool visible);
+
+/* When the next refresh is due, 0 before the first fetch */
+uint64_t dcnow_sched_next_ms(const dcnow_sched_t* s);
+
+bool dcnow_sched_due(const dcnow_sched_t* s, uint64_t now_ms);
+
+#endif /* DCNOW_SCHED_H */
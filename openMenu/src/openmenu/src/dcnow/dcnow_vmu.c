@@ -1,7 +1,9 @@
 #include "dcnow_vmu.h"
+#include "dcnow_delta.h"
 #include "dcnow_net_init.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <openmenu_settings.h>
 
 #ifdef _arch_dreamcast
@@ -95,14 +97,25 @@ static int scroll_frame_counter = 0;    /* Frame counter for scroll timing */
 static int cached_game_count = 0;       /* Cached number of games for scroll calculation */
 static int cached_total_players = 0;    /* Cached total players for header */
 
-/* Cached game data for scrolling display */
-#define MAX_CACHED_GAMES 32
-static char cached_game_names[MAX_CACHED_GAMES][8];  /* Short game names */
-static int cached_player_counts[MAX_CACHED_GAMES];   /* Player counts per game */
+/* Cached game data for scrolling display, grown to the longest list seen */
+typedef struct {
+    char name[8];       /* Short game name */
+    int player_count;
+} vmu_cached_game_t;
+
+static vmu_cached_game_t *cached_games = NULL;
+static int cached_game_capacity = 0;
 
 /* Timestamp for "last updated" display */
 static uint64_t last_update_time_ms = 0;  /* Time of last data update in milliseconds */
 
+/* When the scheduler plans the next refresh, 0 for the old fixed minute */
+static uint64_t refresh_due_ms = 0;
+
+/* Snapshot the cache was filled from */
+static uint32_t cached_seq = 0;
+static bool cached_seq_valid = false;
+
 /* Set a pixel in the VMU bitmap (raw, no clipping) */
 static void vmu_set_pixel_raw(int x, int y, int on) {
     if (x < 0 || x >= VMU_WIDTH || y < 0 || y >= VMU_HEIGHT) return;
@@ -299,17 +312,24 @@ static void vmu_draw_header(int total_players, bool show_spinner) {
         vmu_draw_spinner(VMU_WIDTH - 7, 1);
     } else if (last_update_time_ms > 0) {
         /* Draw countdown timer showing seconds until next auto-refresh
-         * Counts down from 60 to 0, then refresh happens and resets
+         * Counts down to 0, then refresh happens and resets
          * Position: right-aligned in header, using tiny 3x5 font
          * Vertically centered in header: (8 - 5) / 2 = 1.5 → y=1 */
         uint64_t now_ms = timer_ms_gettime64();
-        uint64_t elapsed_ms = now_ms - last_update_time_ms;
-        int elapsed_seconds = (int)(elapsed_ms / 1000);
-        int remaining = 60 - elapsed_seconds;
+        int remaining;
+        if (refresh_due_ms > 0) {
+            remaining = (refresh_due_ms > now_ms) ? (int)((refresh_due_ms - now_ms + 999) / 1000) : 0;
+            /* Three digits fit next to the total */
+            if (remaining > 999) remaining = 999;
+        } else {
+            uint64_t elapsed_ms = now_ms - last_update_time_ms;
+            int elapsed_seconds = (int)(elapsed_ms / 1000);
+            remaining = 60 - elapsed_seconds;
 
-        /* Clamp to 0-60 range */
-        if (remaining < 0) remaining = 0;
-        if (remaining > 60) remaining = 60;
+            /* Clamp to 0-60 range */
+            if (remaining < 0) remaining = 0;
+            if (remaining > 60) remaining = 60;
+        }
 
         char time_str[8];
         snprintf(time_str, sizeof(time_str), "%d", remaining);
@@ -349,7 +369,7 @@ static void vmu_draw_scrolling_list(void) {
 
         /* Format game entry: "NAME:##" */
         char entry[16];
-        snprintf(entry, sizeof(entry), "%.5s:%d", cached_game_names[i], cached_player_counts[i]);
+        snprintf(entry, sizeof(entry), "%.5s:%d", cached_games[i].name, cached_games[i].player_count);
 
         /* Draw the entry (vmu_plot will clip at y < VIEWPORT_TOP) */
         vmu_draw_string_viewport(1, screen_y, entry, 1);  /* Black text */
@@ -378,6 +398,7 @@ static void vmu_overlay_refresh_indicator(void) {
         /* Nothing on VMU yet — set up placeholder data */
         cached_game_count = 0;
         cached_total_players = 0;
+        cached_seq_valid = false;
     }
 
     /* Render frame with spinner */
@@ -389,26 +410,59 @@ static void vmu_overlay_refresh_indicator(void) {
     dcnow_vmu_active = true;
 }
 
+static void vmu_cache_game_row(const dcnow_data_t *data, int i) {
+    /* Use game code if available, otherwise truncate game name */
+    const char *name = (data->games[i].game_code[0] != '\0') ?
+                       data->games[i].game_code : data->games[i].game_name;
+
+    /* Copy and truncate name to fit display */
+    strncpy(cached_games[i].name, name, 7);
+    cached_games[i].name[7] = '\0';
+
+    cached_games[i].player_count = data->games[i].player_count;
+}
+
 /* Cache game data for scrolling display */
 static void vmu_cache_game_data(const dcnow_data_t *data) {
-    cached_game_count = (data->game_count < MAX_CACHED_GAMES) ? data->game_count : MAX_CACHED_GAMES;
-    cached_total_players = data->total_players;
+    int game_count = data->game_count;
 
-    for (int i = 0; i < cached_game_count; i++) {
-        /* Use game code if available, otherwise truncate game name */
-        const char *name = (data->games[i].game_code[0] != '\0') ?
-                           data->games[i].game_code : data->games[i].game_name;
+    if (game_count > cached_game_capacity) {
+        vmu_cached_game_t *grown = realloc(cached_games, game_count * sizeof(vmu_cached_game_t));
+        if (grown) {
+            cached_games = grown;
+            cached_game_capacity = game_count;
+        } else {
+            /* Scroll through as many as fit */
+            game_count = cached_game_capacity;
+        }
+    }
 
-        /* Copy and truncate name to fit display */
-        strncpy(cached_game_names[i], name, 7);
-        cached_game_names[i][7] = '\0';
+    if (cached_seq_valid && data->seq == cached_seq) {
+        /* Same snapshot again, e.g. after a failed refresh: keep the scroll going */
+    } else if (cached_seq_valid && data->delta.base_seq == cached_seq) {
+        /* Only the rows that changed, and the scroll only restarts if the list length did */
+        for (int i = 0; i < game_count; i++) {
+            if (dcnow_delta_row_changed(&data->delta, i)) {
+                vmu_cache_game_row(data, i);
+            }
+        }
+        if (game_count != cached_game_count) {
+            scroll_offset = 0;
+            scroll_frame_counter = 0;
+        }
+    } else {
+        for (int i = 0; i < game_count; i++) {
+            vmu_cache_game_row(data, i);
+        }
 
-        cached_player_counts[i] = data->games[i].player_count;
+        /* Reset scroll position when new data arrives */
+        scroll_offset = 0;
+        scroll_frame_counter = 0;
     }
-
-    /* Reset scroll position when new data arrives */
-    scroll_offset = 0;
-    scroll_frame_counter = 0;
+    cached_game_count = game_count;
+    cached_total_players = data->total_players;
+    cached_seq = data->seq;
+    cached_seq_valid = true;
 
     /* Update the "last updated" timestamp */
     last_update_time_ms = timer_ms_gettime64();
@@ -532,6 +586,14 @@ void dcnow_vmu_tick_scroll(void) {
 #endif
 }
 
+void dcnow_vmu_set_refresh_due(uint64_t due_ms) {
+#ifdef _arch_dreamcast
+    refresh_due_ms = due_ms;
+#else
+    (void)due_ms;
+#endif
+}
+
 void dcnow_vmu_reset_scroll(void) {
 #ifdef _arch_dreamcast
     scroll_offset = 0;
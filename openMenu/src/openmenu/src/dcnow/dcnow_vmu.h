@@ -3,6 +3,7 @@
 
 #include "dcnow_api.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 /**
  * Update VMU display with DC Now games list
@@ -49,6 +50,13 @@ void dcnow_vmu_tick_scroll(void);
  */
 void dcnow_vmu_show_status(const char* status);
 
+/**
+ * Set when the next background refresh is due, for the header countdown.
+ *
+ * @param due_ms timer_ms_gettime64() time of the refresh, 0 for none planned
+ */
+void dcnow_vmu_set_refresh_due(uint64_t due_ms);
+
 /**
  * Reset the scroll position to the top of the list.
  * Useful when returning to the DC Now screen or after data refresh.
@@ -9,56 +9,150 @@
 #ifdef _arch_dreamcast
 #include <kos/thread.h>
 #include <kos/mutex.h>
-#include <arch/timer.h>
-#endif
+#include <kos/cond.h>
 
-#ifdef _arch_dreamcast
 /* Worker thread handle - kept for thd_join() */
 static kthread_t* worker_thread = NULL;
 
-/* Mutex for thread-safe access to shared state */
+/* Mutex for thread-safe access to shared state, the condition wakes the worker */
 static mutex_t worker_mutex = MUTEX_INITIALIZER;
+static condvar_t worker_cond = COND_INITIALIZER;
+
+#define WORKER_LOCK() mutex_lock(&worker_mutex)
+#define WORKER_UNLOCK() mutex_unlock(&worker_mutex)
+#define WORKER_WAIT() cond_wait(&worker_cond, &worker_mutex)
+#define WORKER_WAKE() cond_broadcast(&worker_cond)
+#else
+#include <pthread.h>
+
+static pthread_t worker_thread;
+
+static pthread_mutex_t worker_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t worker_cond = PTHREAD_COND_INITIALIZER;
+
+#define WORKER_LOCK() pthread_mutex_lock(&worker_mutex)
+#define WORKER_UNLOCK() pthread_mutex_unlock(&worker_mutex)
+#define WORKER_WAIT() pthread_cond_wait(&worker_cond, &worker_mutex)
+#define WORKER_WAKE() pthread_cond_broadcast(&worker_cond)
 #endif
 
-/* Active context pointer (set when worker is running) */
-static volatile dcnow_worker_context_t* active_ctx = NULL;
+typedef struct {
+    dcnow_job_type_t type;
+    dcnow_job_priority_t priority;
+    dcnow_worker_context_t* ctx;
+    uint32_t param;
+} dcnow_job_t;
 
-/* Parameters passed to worker thread */
-static dcnow_connection_method_t worker_conn_method;
-static uint32_t worker_fetch_timeout_ms = 5000;
+/* Queued jobs in submission order, everything below is guarded by worker_mutex */
+static dcnow_job_t queue[DCNOW_WORKER_QUEUE_LEN];
+static int queue_count = 0;
+
+static dcnow_job_t running_job;
+static bool job_running = false;
+static int results_pending = 0;
+static bool worker_started = false;
+static bool worker_quit = false;
 
 /* Forward declarations */
-static void* connect_worker_func(void* arg);
-static void* fetch_worker_func(void* arg);
+static void* worker_main(void* arg);
 static void worker_status_callback(const char* message);
 
+static void set_status(dcnow_worker_context_t* ctx, const char* message) {
+    strncpy((char*)ctx->status_message, message, 127);
+    ((char*)ctx->status_message)[127] = '\0';
+}
+
+static void queue_remove(int index) {
+    memmove(&queue[index], &queue[index + 1], (queue_count - index - 1) * sizeof(dcnow_job_t));
+    queue_count--;
+}
+
+static bool ctx_has_queued_job(const dcnow_worker_context_t* ctx) {
+    for (int i = 0; i < queue_count; i++) {
+        if (queue[i].ctx == ctx) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* A context whose jobs were all dropped goes back to idle, unless a result still waits in it */
+static void ctx_dropped(dcnow_worker_context_t* ctx) {
+    if (ctx && !ctx->result_pending && !ctx_has_queued_job(ctx) &&
+        !(job_running && running_job.ctx == ctx)) {
+        ctx->state = DCNOW_WORKER_IDLE;
+    }
+}
+
+/* Highest priority first, oldest first within a priority. A context still holding
+ * an unpolled result has its next job wait so that result isn't overwritten */
+static int queue_pick(void) {
+    int best = -1;
+
+    for (int i = 0; i < queue_count; i++) {
+        if (queue[i].ctx && queue[i].ctx->result_pending) {
+            continue;
+        }
+        if (best < 0 || queue[i].priority > queue[best].priority) {
+            best = i;
+        }
+    }
+    return best;
+}
+
 void dcnow_worker_init(void) {
+    WORKER_LOCK();
+    if (worker_started) {
+        WORKER_UNLOCK();
+        return;
+    }
+    queue_count = 0;
+    job_running = false;
+    results_pending = 0;
+    worker_quit = false;
+    WORKER_UNLOCK();
+
 #ifdef _arch_dreamcast
-    mutex_init(&worker_mutex, MUTEX_TYPE_NORMAL);
-    worker_thread = NULL;
+    worker_thread = thd_create(0, worker_main, NULL);
+    worker_started = (worker_thread != NULL);
+#else
+    worker_started = (pthread_create(&worker_thread, NULL, worker_main, NULL) == 0);
 #endif
-    active_ctx = NULL;
-    DCNOW_DPRINTF("DC Now Worker: Initialized\n");
+
+    if (worker_started) {
+        DCNOW_DPRINTF("DC Now Worker: Initialized\n");
+    } else {
+        DCNOW_DPRINTF("DC Now Worker: Failed to create worker thread\n");
+    }
 }
 
 void dcnow_worker_shutdown(void) {
-#ifdef _arch_dreamcast
-    mutex_lock(&worker_mutex);
-    if (active_ctx) {
-        ((dcnow_worker_context_t*)active_ctx)->cancel_requested = true;
+    if (!worker_started) {
+        return;
     }
-    mutex_unlock(&worker_mutex);
 
-    /* Join worker thread if it's running */
-    if (worker_thread) {
-        DCNOW_DPRINTF("DC Now Worker: Joining worker thread for shutdown...\n");
-        thd_join(worker_thread, NULL);
-        worker_thread = NULL;
+    WORKER_LOCK();
+    while (queue_count > 0) {
+        dcnow_worker_context_t* ctx = queue[queue_count - 1].ctx;
+        queue_count--;
+        ctx_dropped(ctx);
     }
+    if (job_running && running_job.ctx) {
+        running_job.ctx->cancel_requested = true;
+    }
+    worker_quit = true;
+    WORKER_WAKE();
+    WORKER_UNLOCK();
 
-    mutex_destroy(&worker_mutex);
+    /* Waits for the running job, a fetch stops early but other blocking calls can't be interrupted */
+    DCNOW_DPRINTF("DC Now Worker: Joining worker thread for shutdown...\n");
+#ifdef _arch_dreamcast
+    thd_join(worker_thread, NULL);
+    worker_thread = NULL;
+#else
+    pthread_join(worker_thread, NULL);
 #endif
-    active_ctx = NULL;
+    worker_started = false;
     DCNOW_DPRINTF("DC Now Worker: Shutdown complete\n");
 }
 
@@ -67,30 +161,15 @@ void dcnow_worker_shutdown(void) {
  * Only writes to the status_message buffer - NO rendering, NO sleeps.
  */
 static void worker_status_callback(const char* message) {
-#ifdef _arch_dreamcast
-    mutex_lock(&worker_mutex);
-    if (active_ctx) {
-        strncpy((char*)active_ctx->status_message, message, 127);
-        ((char*)active_ctx->status_message)[127] = '\0';
+    WORKER_LOCK();
+    if (job_running && running_job.ctx) {
+        set_status(running_job.ctx, message);
     }
-    mutex_unlock(&worker_mutex);
-#endif
+    WORKER_UNLOCK();
 }
 
-/**
- * Worker thread entry point for PPP/modem connection.
- */
-static void* connect_worker_func(void* arg) {
-#ifdef _arch_dreamcast
-    dcnow_worker_context_t* ctx = (dcnow_worker_context_t*)arg;
-
-    DCNOW_DPRINTF("DC Now Worker: Connect thread started (method=%d)\n", worker_conn_method);
-
-    mutex_lock(&worker_mutex);
-    ctx->state = DCNOW_WORKER_CONNECTING;
-    strncpy((char*)ctx->status_message, "Starting connection...", 127);
-    active_ctx = ctx;
-    mutex_unlock(&worker_mutex);
+static int run_connect(dcnow_connection_method_t method) {
+    DCNOW_DPRINTF("DC Now Worker: Connecting (method=%d)\n", method);
 
     /* Disable status sleeps - main thread renders at 60fps */
     dcnow_set_status_sleep_enabled(false);
@@ -99,176 +178,220 @@ static void* connect_worker_func(void* arg) {
     dcnow_set_status_callback(worker_status_callback);
 
     /* This is the blocking call - runs in worker thread */
-    int result = dcnow_net_init_with_method(worker_conn_method);
+    int result = dcnow_net_init_with_method(method);
 
     /* Clear status callback and restore sleep behavior */
     dcnow_set_status_callback(NULL);
     dcnow_set_status_sleep_enabled(true);
 
-    mutex_lock(&worker_mutex);
-    if (result < 0) {
-        ctx->state = DCNOW_WORKER_ERROR;
-        ctx->error_code = result;
-        snprintf((char*)ctx->status_message, 127, "Connection failed (error %d)", result);
-        DCNOW_DPRINTF("DC Now Worker: Connection failed with error %d\n", result);
-    } else {
-        ctx->state = DCNOW_WORKER_DONE;
-        ctx->error_code = 0;
-        strncpy((char*)ctx->status_message, "Connected!", 127);
-        DCNOW_DPRINTF("DC Now Worker: Connection successful\n");
-    }
-    active_ctx = NULL;
-    mutex_unlock(&worker_mutex);
-#endif
-    return NULL;
+    return result;
 }
 
-/**
- * Worker thread entry point for HTTP data fetch.
- */
-static void* fetch_worker_func(void* arg) {
-#ifdef _arch_dreamcast
-    dcnow_worker_context_t* ctx = (dcnow_worker_context_t*)arg;
-
-    DCNOW_DPRINTF("DC Now Worker: Fetch thread started\n");
-
-    mutex_lock(&worker_mutex);
-    ctx->state = DCNOW_WORKER_FETCHING;
-    strncpy((char*)ctx->status_message, "Fetching data...", 127);
-    active_ctx = ctx;
-    mutex_unlock(&worker_mutex);
+/* Runs one job with the mutex released and stores the result in its context */
+static void run_job(const dcnow_job_t* job) {
+    dcnow_worker_context_t* ctx = job->ctx;
+    int result = 0;
+
+    switch (job->type) {
+        case DCNOW_JOB_CONNECT:
+            result = run_connect((dcnow_connection_method_t)job->param);
+            break;
+        case DCNOW_JOB_FETCH:
+            /* Success publishes a new snapshot, see dcnow_get_snapshot(). A cancel stops the
+             * request where it waits instead of after its timeout */
+            dcnow_set_cancel_flag(ctx ? &ctx->cancel_requested : NULL);
+            result = dcnow_fetch_data(job->param);
+            dcnow_set_cancel_flag(NULL);
+            break;
+        case DCNOW_JOB_DISCONNECT:
+            DCNOW_DPRINTF("DC Now Worker: Disconnecting\n");
+            dcnow_net_disconnect();
+            /* A reconnect starts from an empty list, not a 304 on the old one */
+            dcnow_clear_cache();
+            break;
+        case DCNOW_JOB_DNS_PREFETCH:
+            result = dcnow_prefetch_dns();
+            break;
+    }
 
-    /* This is the blocking call - runs in worker thread */
-    int result = dcnow_fetch_data(&ctx->result_data, worker_fetch_timeout_ms);
-
-    mutex_lock(&worker_mutex);
-    if (result < 0) {
-        ctx->state = DCNOW_WORKER_ERROR;
-        ctx->error_code = result;
-        if (ctx->result_data.error_message[0] != '\0') {
-            strncpy((char*)ctx->status_message, ctx->result_data.error_message, 127);
+    WORKER_LOCK();
+    job_running = false;
+    if (ctx) {
+        if (ctx->cancel_requested) {
+            /* Nobody waits for this result any more */
+            DCNOW_DPRINTF("DC Now Worker: Job %d cancelled, result dropped\n", job->type);
+            ctx->state = ctx_has_queued_job(ctx) ? DCNOW_WORKER_QUEUED : DCNOW_WORKER_IDLE;
         } else {
-            snprintf((char*)ctx->status_message, 127, "Fetch failed (error %d)", result);
+            ctx->error_code = result < 0 ? result : 0;
+            if (result < 0) {
+                if (job->type == DCNOW_JOB_FETCH && dcnow_get_last_error()[0] != '\0') {
+                    set_status(ctx, dcnow_get_last_error());
+                } else if (job->type == DCNOW_JOB_CONNECT) {
+                    snprintf((char*)ctx->status_message, 127, "Connection failed (error %d)", result);
+                } else {
+                    snprintf((char*)ctx->status_message, 127, "Failed (error %d)", result);
+                }
+            } else if (job->type == DCNOW_JOB_CONNECT) {
+                set_status(ctx, "Connected!");
+            } else if (job->type == DCNOW_JOB_FETCH) {
+                set_status(ctx, "Data updated");
+            } else {
+                set_status(ctx, "Done");
+            }
+            ctx->state = (result < 0) ? DCNOW_WORKER_ERROR : DCNOW_WORKER_DONE;
+            ctx->result_pending = true;
+            results_pending++;
         }
-        DCNOW_DPRINTF("DC Now Worker: Fetch failed with error %d\n", result);
-    } else {
-        ctx->state = DCNOW_WORKER_DONE;
-        ctx->error_code = 0;
-        snprintf((char*)ctx->status_message, 127, "Loaded %d games", ctx->result_data.game_count);
-        DCNOW_DPRINTF("DC Now Worker: Fetch successful, %d games\n", ctx->result_data.game_count);
     }
-    active_ctx = NULL;
-    mutex_unlock(&worker_mutex);
-#endif
-    return NULL;
+    DCNOW_DPRINTF("DC Now Worker: Job %d finished with %d\n", job->type, result);
+    WORKER_UNLOCK();
 }
 
-int dcnow_worker_start_connect(dcnow_worker_context_t* ctx, dcnow_connection_method_t method) {
-#ifdef _arch_dreamcast
-    mutex_lock(&worker_mutex);
+static void* worker_main(void* arg) {
+    (void)arg;
 
-    /* Check if already busy */
-    if (worker_thread != NULL) {
-        mutex_unlock(&worker_mutex);
-        DCNOW_DPRINTF("DC Now Worker: Cannot start connect - worker busy\n");
-        return -1;
-    }
+    DCNOW_DPRINTF("DC Now Worker: Thread started\n");
 
-    /* Store connection method for worker thread */
-    worker_conn_method = method;
+    WORKER_LOCK();
+    while (!worker_quit) {
+        const int index = queue_pick();
+        if (index < 0) {
+            WORKER_WAIT();
+            continue;
+        }
 
-    /* Initialize context */
-    memset(ctx, 0, sizeof(dcnow_worker_context_t));
-    ctx->state = DCNOW_WORKER_CONNECTING;
-    ctx->cancel_requested = false;
-    strncpy((char*)ctx->status_message, "Initializing...", 127);
+        running_job = queue[index];
+        queue_remove(index);
+        job_running = true;
+
+        dcnow_worker_context_t* ctx = running_job.ctx;
+        if (ctx) {
+            ctx->cancel_requested = false;
+            ctx->error_code = 0;
+            switch (running_job.type) {
+                case DCNOW_JOB_CONNECT:
+                    ctx->state = DCNOW_WORKER_CONNECTING;
+                    set_status(ctx, "Starting connection...");
+                    break;
+                case DCNOW_JOB_DISCONNECT:
+                    ctx->state = DCNOW_WORKER_CONNECTING;
+                    set_status(ctx, "Disconnecting...");
+                    break;
+                default:
+                    ctx->state = DCNOW_WORKER_FETCHING;
+                    set_status(ctx, "Fetching data...");
+                    break;
+            }
+        }
 
-    mutex_unlock(&worker_mutex);
+        /* Local copy, running_job may be looked at by the main thread meanwhile */
+        const dcnow_job_t job = running_job;
+        WORKER_UNLOCK();
+        run_job(&job);
+        WORKER_LOCK();
+    }
+    WORKER_UNLOCK();
 
-    /* Create worker thread */
-    worker_thread = thd_create(0, connect_worker_func, ctx);
-    if (!worker_thread) {
-        DCNOW_DPRINTF("DC Now Worker: Failed to create connect thread\n");
-        ctx->state = DCNOW_WORKER_ERROR;
-        ctx->error_code = -2;
+    DCNOW_DPRINTF("DC Now Worker: Thread exiting\n");
+    return NULL;
+}
+
+int dcnow_worker_submit(dcnow_worker_context_t* ctx, dcnow_job_type_t type,
+                        dcnow_job_priority_t priority, uint32_t param) {
+    if (!worker_started) {
+        if (ctx) {
+            ctx->state = DCNOW_WORKER_ERROR;
+            ctx->error_code = -2;
+        }
         return -2;
     }
 
-    DCNOW_DPRINTF("DC Now Worker: Connect thread created\n");
-    return 0;
-#else
-    ctx->state = DCNOW_WORKER_ERROR;
-    ctx->error_code = -100;
-    return -100;
-#endif
-}
+    WORKER_LOCK();
 
-int dcnow_worker_start_fetch(dcnow_worker_context_t* ctx, uint32_t timeout_ms) {
-#ifdef _arch_dreamcast
-    mutex_lock(&worker_mutex);
+    if (type == DCNOW_JOB_FETCH) {
+        /* Ride along with a fetch already on its way */
+        if (job_running && running_job.type == DCNOW_JOB_FETCH && running_job.ctx == ctx && ctx &&
+            !ctx->cancel_requested) {
+            WORKER_UNLOCK();
+            DCNOW_DPRINTF("DC Now Worker: Fetch already running\n");
+            return 0;
+        }
+        for (int i = 0; i < queue_count; i++) {
+            if (queue[i].type == DCNOW_JOB_FETCH && queue[i].ctx == ctx) {
+                if (priority > queue[i].priority) {
+                    queue[i].priority = priority;
+                }
+                if (param > queue[i].param) {
+                    queue[i].param = param;
+                }
+                WORKER_UNLOCK();
+                DCNOW_DPRINTF("DC Now Worker: Fetch merged into a queued one\n");
+                return 0;
+            }
+        }
+    } else if (type == DCNOW_JOB_DISCONNECT) {
+        for (int i = queue_count - 1; i >= 0; i--) {
+            if (queue[i].type == DCNOW_JOB_FETCH || queue[i].type == DCNOW_JOB_DNS_PREFETCH) {
+                dcnow_worker_context_t* dropped = queue[i].ctx;
+                queue_remove(i);
+                ctx_dropped(dropped);
+            }
+        }
+        if (job_running && running_job.type == DCNOW_JOB_FETCH && running_job.ctx) {
+            running_job.ctx->cancel_requested = true;
+        }
+    }
 
-    /* Check if already busy */
-    if (worker_thread != NULL) {
-        mutex_unlock(&worker_mutex);
-        DCNOW_DPRINTF("DC Now Worker: Cannot start fetch - worker busy\n");
+    if (queue_count == DCNOW_WORKER_QUEUE_LEN) {
+        WORKER_UNLOCK();
+        DCNOW_DPRINTF("DC Now Worker: Queue full, job %d refused\n", type);
         return -1;
     }
 
-    /* Store timeout for worker thread */
-    worker_fetch_timeout_ms = timeout_ms;
-
-    /* Initialize context */
-    ctx->state = DCNOW_WORKER_FETCHING;
-    ctx->error_code = 0;
-    ctx->cancel_requested = false;
-    strncpy((char*)ctx->status_message, "Starting fetch...", 127);
+    queue[queue_count].type = type;
+    queue[queue_count].priority = priority;
+    queue[queue_count].ctx = ctx;
+    queue[queue_count].param = param;
+    queue_count++;
 
-    mutex_unlock(&worker_mutex);
-
-    /* Create worker thread */
-    worker_thread = thd_create(0, fetch_worker_func, ctx);
-    if (!worker_thread) {
-        DCNOW_DPRINTF("DC Now Worker: Failed to create fetch thread\n");
-        ctx->state = DCNOW_WORKER_ERROR;
-        ctx->error_code = -2;
-        return -2;
+    /* An unpolled result keeps showing until poll has returned it */
+    if (ctx && !ctx->result_pending && !(job_running && running_job.ctx == ctx)) {
+        ctx->state = DCNOW_WORKER_QUEUED;
+        set_status(ctx, "Waiting...");
     }
 
-    DCNOW_DPRINTF("DC Now Worker: Fetch thread created\n");
+    WORKER_WAKE();
+    WORKER_UNLOCK();
+
+    DCNOW_DPRINTF("DC Now Worker: Job %d queued (priority %d)\n", type, priority);
     return 0;
-#else
-    ctx->state = DCNOW_WORKER_ERROR;
-    ctx->error_code = -100;
-    return -100;
-#endif
+}
+
+int dcnow_worker_start_connect(dcnow_worker_context_t* ctx, dcnow_connection_method_t method) {
+    return dcnow_worker_submit(ctx, DCNOW_JOB_CONNECT, DCNOW_JOB_PRIO_CONNECTION, (uint32_t)method);
+}
+
+int dcnow_worker_start_fetch(dcnow_worker_context_t* ctx, uint32_t timeout_ms, dcnow_job_priority_t priority) {
+    return dcnow_worker_submit(ctx, DCNOW_JOB_FETCH, priority, timeout_ms);
 }
 
 dcnow_worker_state_t dcnow_worker_poll(dcnow_worker_context_t* ctx) {
     dcnow_worker_state_t state;
 
-#ifdef _arch_dreamcast
-    mutex_lock(&worker_mutex);
+    WORKER_LOCK();
     state = ctx->state;
 
-    /* If operation completed and worker has cleared active_ctx, join the thread */
-    if ((state == DCNOW_WORKER_DONE || state == DCNOW_WORKER_ERROR) &&
-        active_ctx == NULL && worker_thread != NULL) {
-        kthread_t* thread_to_join = worker_thread;
-        worker_thread = NULL;
-        mutex_unlock(&worker_mutex);
-
-        /* Join outside mutex to avoid potential deadlock */
-        DCNOW_DPRINTF("DC Now Worker: Joining completed thread\n");
-        thd_join(thread_to_join, NULL);
-        DCNOW_DPRINTF("DC Now Worker: Thread joined successfully\n");
-        return state;
+    /* Hand the result over once, the context's next job may start now */
+    if (ctx->result_pending) {
+        ctx->result_pending = false;
+        results_pending--;
+        if (ctx_has_queued_job(ctx)) {
+            ctx->state = DCNOW_WORKER_QUEUED;
+        }
+        WORKER_WAKE();
     }
 
-    mutex_unlock(&worker_mutex);
-#else
-    state = ctx->state;
-#endif
-
+    WORKER_UNLOCK();
     return state;
 }
 
@@ -277,26 +400,30 @@ const char* dcnow_worker_get_status(dcnow_worker_context_t* ctx) {
 }
 
 void dcnow_worker_cancel(dcnow_worker_context_t* ctx) {
-#ifdef _arch_dreamcast
-    mutex_lock(&worker_mutex);
-    ctx->cancel_requested = true;
+    WORKER_LOCK();
+    for (int i = queue_count - 1; i >= 0; i--) {
+        if (queue[i].ctx == ctx) {
+            queue_remove(i);
+        }
+    }
+    if (job_running && running_job.ctx == ctx) {
+        ctx->cancel_requested = true;
+    }
+    if (ctx->result_pending) {
+        ctx->result_pending = false;
+        results_pending--;
+    }
+    ctx_dropped(ctx);
     DCNOW_DPRINTF("DC Now Worker: Cancellation requested\n");
-    mutex_unlock(&worker_mutex);
-#else
-    ctx->cancel_requested = true;
-#endif
+    WORKER_UNLOCK();
 }
 
 bool dcnow_worker_is_busy(void) {
-#ifdef _arch_dreamcast
     bool busy;
-    mutex_lock(&worker_mutex);
-    busy = (worker_thread != NULL);
-    mutex_unlock(&worker_mutex);
+    WORKER_LOCK();
+    busy = job_running || queue_count > 0 || results_pending > 0;
+    WORKER_UNLOCK();
     return busy;
-#else
-    return false;
-#endif
 }
 
 #endif /* DCNOW_ASYNC */
@@ -8,68 +8,108 @@
 #include "dcnow_api.h"
 #include "dcnow_net_init.h"
 
+/*
+ * One network thread lives from dcnow_worker_init() to dcnow_worker_shutdown()
+ * and works through a small queue of jobs, highest priority first and in
+ * submission order within a priority. Connecting, fetching and disconnecting
+ * therefore never overlap, and starting a job costs no thread creation.
+ *
+ * The queue only depends on a mutex, a condition variable and a thread, which
+ * come from KOS on the Dreamcast and from pthreads anywhere else, so it can be
+ * driven on a host build as well.
+ */
+
+#define DCNOW_WORKER_QUEUE_LEN 8
+
 /**
  * Worker thread states for non-blocking network operations
  */
 typedef enum {
     DCNOW_WORKER_IDLE,          /* No operation in progress */
+    DCNOW_WORKER_QUEUED,        /* Job waiting for the worker */
     DCNOW_WORKER_CONNECTING,    /* PPP/modem connection in progress */
     DCNOW_WORKER_FETCHING,      /* HTTP data fetch in progress */
     DCNOW_WORKER_DONE,          /* Operation completed successfully */
     DCNOW_WORKER_ERROR          /* Operation failed */
 } dcnow_worker_state_t;
 
+typedef enum {
+    DCNOW_JOB_CONNECT,          /* param: dcnow_connection_method_t */
+    DCNOW_JOB_FETCH,            /* param: HTTP timeout in ms */
+    DCNOW_JOB_DISCONNECT,
+    DCNOW_JOB_DNS_PREFETCH,     /* warm the DNS cache for the next fetch */
+} dcnow_job_type_t;
+
+typedef enum {
+    DCNOW_JOB_PRIO_BACKGROUND = 0,  /* auto refresh, prefetching */
+    DCNOW_JOB_PRIO_USER,            /* something the user is waiting for */
+    DCNOW_JOB_PRIO_CONNECTION,      /* connection changes */
+} dcnow_job_priority_t;
+
 /**
  * Worker thread context - shared between main and worker threads.
  * Volatile fields are written by the worker and read by the main thread.
+ * A finished job's result stays in the context until dcnow_worker_poll() has
+ * returned it, and the next job for the same context waits until then.
  */
 typedef struct {
     volatile dcnow_worker_state_t state;
     volatile char status_message[128];  /* Current status for UI display */
-    dcnow_data_t result_data;           /* Fetch result (only valid when state == DONE after fetch) */
     volatile int error_code;            /* Error code if state == ERROR */
     volatile bool cancel_requested;     /* Set by main thread to request cancellation */
+    volatile bool result_pending;       /* DONE or ERROR not yet returned by poll */
 } dcnow_worker_context_t;
 
 /**
- * Initialize the worker thread system.
+ * Initialize the worker thread system and start the worker thread.
  * Must be called once before using any worker functions.
  */
 void dcnow_worker_init(void);
 
 /**
  * Shutdown the worker thread system.
- * Cancels any pending operation and joins the worker thread.
+ * Drops queued jobs, cancels the running one and joins the worker thread.
  */
 void dcnow_worker_shutdown(void);
 
 /**
- * Start async network connection in worker thread.
+ * Queue a job.
+ * A fetch for a context that already has one queued or running is merged
+ * into it, taking the higher priority. A disconnect drops queued fetches and
+ * prefetches, they would run against a connection that is going away.
+ *
+ * @param ctx - Context to receive status updates and results, NULL for none
+ * @return 0 on success (job queued or merged), negative on error:
+ *         -1: Queue full
+ *         -2: Worker not running
+ */
+int dcnow_worker_submit(dcnow_worker_context_t* ctx, dcnow_job_type_t type,
+                        dcnow_job_priority_t priority, uint32_t param);
+
+/**
+ * Queue an async network connection.
  *
  * @param ctx - Context structure to receive status updates and results
  * @param method - Connection method (serial or modem)
- * @return 0 on success (worker started), negative on error:
- *         -1: Worker already busy
- *         -2: Thread creation failed
+ * @return see dcnow_worker_submit
  */
 int dcnow_worker_start_connect(dcnow_worker_context_t* ctx, dcnow_connection_method_t method);
 
 /**
- * Start async data fetch in worker thread.
- * Network must already be connected.
+ * Queue an async data fetch.
+ * Network must already be connected when the job runs.
  *
  * @param ctx - Context structure to receive status updates and results
  * @param timeout_ms - HTTP timeout in milliseconds
- * @return 0 on success (worker started), negative on error:
- *         -1: Worker already busy
- *         -2: Thread creation failed
+ * @param priority - DCNOW_JOB_PRIO_USER for a refresh the user asked for
+ * @return see dcnow_worker_submit
  */
-int dcnow_worker_start_fetch(dcnow_worker_context_t* ctx, uint32_t timeout_ms);
+int dcnow_worker_start_fetch(dcnow_worker_context_t* ctx, uint32_t timeout_ms, dcnow_job_priority_t priority);
 
 /**
- * Poll worker thread status (call from main loop each frame).
- * When DONE or ERROR is returned, the worker thread is joined and
- * the worker slot is freed for reuse.
+ * Poll a context's state (call from main loop each frame).
+ * DONE or ERROR is returned once per finished job, which frees the context
+ * for its next queued job.
  *
  * @param ctx - Context structure
  * @return Current worker state
@@ -85,7 +125,9 @@ dcnow_worker_state_t dcnow_worker_poll(dcnow_worker_context_t* ctx);
 const char* dcnow_worker_get_status(dcnow_worker_context_t* ctx);
 
 /**
- * Request cancellation of current operation.
+ * Cancel a context's jobs.
+ * Queued ones are dropped, a running one has its result discarded. A running
+ * fetch also stops waiting on the network within one receive slice.
  * Note: Some blocking operations (like ppp_connect) cannot be interrupted.
  *
  * @param ctx - Context structure
@@ -95,7 +137,7 @@ void dcnow_worker_cancel(dcnow_worker_context_t* ctx);
 /**
  * Check if worker is currently busy.
  *
- * @return true if a worker operation is in progress
+ * @return true while a job is queued or running, or a result waits for poll
  */
 bool dcnow_worker_is_busy(void);
 
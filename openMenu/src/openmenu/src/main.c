@@ -28,9 +28,13 @@
 #include "backend/gdemu_sdk.h"
 #include "ui/common.h"
 #include "ui/dc/input.h"
+#include "ui/draw_batch.h"
 #include "ui/draw_prototypes.h"
+#include "ui/profiler.h"
+#include "ui/text_cache.h"
 #include "ui/ui_common.h"
 #include "ui/ui_menu_credits.h"
+#include "ui/ui_script.h"
 #include "vm2/vm2_api.h"
 #include "dcnow/dcnow_net_init.h"
 #include "dcnow/dcnow_vmu.h"
@@ -186,32 +190,60 @@ init() {
     return ret;
 }
 
-static void
-draw(void) {
+/* Submits one frame of the current UI, also used to keep the screen alive while DC Now dials */
+void
+draw_scene(void) {
+    prof_begin(PROF_PVR_WAIT);
     pvr_wait_ready();
+    prof_end(PROF_PVR_WAIT);
     pvr_scene_begin();
 
+    prof_begin(PROF_DRAW_OP);
     draw_set_list(PVR_LIST_OP_POLY);
     pvr_list_begin(PVR_LIST_OP_POLY);
 
     (*current_ui_draw_OP)();
 
+    draw_batch_flush();
     pvr_list_finish();
+    prof_end(PROF_DRAW_OP);
 
+    prof_begin(PROF_DRAW_TR);
     draw_set_list(PVR_LIST_TR_POLY);
     pvr_list_begin(PVR_LIST_TR_POLY);
 
     (*current_ui_draw_TR)();
+    prof_draw_overlay();
 
+    draw_batch_flush();
     pvr_list_finish();
+    prof_end(PROF_DRAW_TR);
 
+    prof_begin(PROF_SCENE_END);
     pvr_scene_finish();
+    draw_batch_frame_end();
+    text_cache_frame_end();
+    prof_end(PROF_SCENE_END);
+}
+
+static void
+draw(void) {
+    draw_scene();
+
+    /* Stream in prefetched textures now that visible ones are done */
+    prof_begin(PROF_TXR_TICK);
+    txr_frame_tick();
+    prof_end(PROF_TXR_TICK);
 
     /* Update VMU display (scroll animation + time indicator) if DC Now is active */
+    prof_begin(PROF_VMU);
     dcnow_vmu_tick_scroll();
+    prof_end(PROF_VMU);
 
-    /* Background auto-refresh for DC Now data (every 60 seconds) */
+    /* Background auto-refresh for DC Now data (interval set by dcnow_sched) */
+    prof_begin(PROF_DCNOW);
     dcnow_background_tick();
+    prof_end(PROF_DCNOW);
 }
 
 static void
@@ -304,6 +336,20 @@ translate_input(void) {
         arch_exec_at(bloader_data, bloader_size, 0xacf00000);
     }
 
+#ifdef OPENMENU_PROFILE
+    /* Both triggers held: Start shows the profiler overlay, Y dumps its history. F1/F2 on a keyboard */
+    if ((INPT_TriggerPressed(TRIGGER_L) && INPT_TriggerPressed(TRIGGER_R) && INPT_ButtonEx(BTN_START, BTN_PRESS))
+        || INPT_KeyboardButtonPress(KBD_KEY_F1)) {
+        prof_toggle_overlay();
+        return NONE;
+    }
+    if ((INPT_TriggerPressed(TRIGGER_L) && INPT_TriggerPressed(TRIGGER_R) && INPT_ButtonEx(BTN_Y, BTN_PRESS))
+        || INPT_KeyboardButtonPress(KBD_KEY_F2)) {
+        prof_dump(PROF_DUMP_PATH);
+        return NONE;
+    }
+#endif
+
     /* D-Pad directions */
     if (INPT_DPADDirection(DPAD_LEFT)) {
         return LEFT;
@@ -478,9 +524,14 @@ main(int argc, char* argv[]) {
     }
 
     for (;;) {
+        prof_frame_mark();
         z_reset();
-        (*current_ui_handle_input)(translate_input());
+        prof_begin(PROF_INPUT);
+        (*current_ui_handle_input)(ui_script_input(translate_input()));
+        prof_end(PROF_INPUT);
+        prof_begin(PROF_VBLANK);
         vid_waitvbl();
+        prof_end(PROF_VBLANK);
         if (need_reload_ui) {
             ui_set_choice(sf_ui[0]);
         } else {
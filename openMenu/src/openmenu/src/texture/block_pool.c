@@ -15,6 +15,9 @@
 
 #include "block_pool.h"
 
+/* state holds the run length at the first slot of an allocation, RUN_CONTINUED for the rest */
+#define RUN_CONTINUED (0xFF)
+
 static inline void
 _pool_mark_used(block_pool* pool, unsigned int slot_num) {
     pool->state[slot_num] = 1;
@@ -70,6 +73,50 @@ pool_get_next_free(block_pool* pool, unsigned int* slot_num, void** ptr) {
     *ptr = NULL;
 }
 
+/* Slots needed for size bytes, rounded up to a power of two so runs can be kept aligned */
+unsigned int
+pool_slots_for_size(const block_pool* pool, unsigned int size) {
+    unsigned int needed = (size + pool->slot_size - 1) / pool->slot_size;
+    unsigned int count = 1;
+    while (count < needed) {
+        count <<= 1;
+    }
+    return count;
+}
+
+/* Allocates count contiguous slots aligned to count, returns -1 if no such run is free */
+int
+pool_alloc_run(block_pool* pool, unsigned int count, unsigned int* slot_num, void** ptr) {
+    if (!count || count > pool->slots || count >= RUN_CONTINUED) {
+        return -1;
+    }
+
+    for (unsigned int i = 0; i + count <= pool->slots; i += count) {
+        unsigned int j;
+        for (j = 0; j < count; j++) {
+            if (pool->state[i + j]) {
+                break;
+            }
+        }
+        if (j != count) {
+            continue;
+        }
+
+        pool->state[i] = count;
+        for (j = 1; j < count; j++) {
+            pool->state[i + j] = RUN_CONTINUED;
+        }
+        if (slot_num) {
+            *slot_num = i;
+        }
+        if (ptr) {
+            *ptr = (void*)((uintptr_t)pool->base + i * pool->slot_size);
+        }
+        return 0;
+    }
+    return -1;
+}
+
 void
 pool_dealloc_all(block_pool* pool) {
     for (unsigned int i = 0; i < pool->slots; i++) {
@@ -79,8 +126,11 @@ pool_dealloc_all(block_pool* pool) {
 
 void
 pool_dealloc_slot(block_pool* pool, unsigned int slot_num) {
-    if (slot_num < pool->slots) {
-        _pool_mark_open(pool, slot_num);
+    if (slot_num < pool->slots && pool->state[slot_num] != RUN_CONTINUED) {
+        const unsigned int count = pool->state[slot_num] ? pool->state[slot_num] : 1;
+        for (unsigned int i = 0; i < count && slot_num + i < pool->slots; i++) {
+            _pool_mark_open(pool, slot_num + i);
+        }
     }
 }
 
@@ -47,7 +47,8 @@ find_in_cache(cache_instance* cache, const char* key) {
     HASH_FIND_STR(cache->cache, key, entry);
     if (entry) {
         // remove it (so the subsequent add will throw it on the front of the list)
-        if (entry != cache->cache) {
+        // the list runs oldest first, only the newest entry is already in place
+        if (entry->hh.next) {
             HASH_DELETE(hh, cache->cache, entry);
             HASH_ADD_STR(cache->cache, key, entry);
         }
@@ -56,6 +57,45 @@ find_in_cache(cache_instance* cache, const char* key) {
     return -1;
 }
 
+/* Same as find_in_cache but leaves the LRU order untouched */
+int
+peek_in_cache(cache_instance* cache, const char* key) {
+    struct CacheEntry* entry;
+    if (!cache || !key) {
+        return -1;
+    }
+    HASH_FIND_STR(cache->cache, key, entry);
+    if (entry) {
+        return entry->value;
+    }
+    return -1;
+}
+
+/* Returns the value of the least recently used entry, or -1 if the cache is empty */
+int
+peek_oldest_in_cache(cache_instance* cache) {
+    if (!cache || !cache->cache) {
+        return -1;
+    }
+    return cache->cache->value;
+}
+
+/* Drops the least recently used entry, for callers that manage space themselves */
+void
+evict_oldest_in_cache(cache_instance* cache) {
+    struct CacheEntry* entry = cache->cache;
+    if (!entry) {
+        return;
+    }
+    HASH_DELETE(hh, cache->cache, entry);
+    DBG_PRINT("-del_from_cache( %s )\n", entry->key);
+    if (cache->callback_del) {
+        (*cache->callback_del)(entry->key, &entry->value, cache->callback_data);
+    }
+    free(entry->key);
+    free(entry);
+}
+
 void
 add_to_cache(cache_instance* cache, const char* key, int value) {
     DBG_PRINT("+%s( %s )\n", __func__, key);
@@ -91,8 +131,8 @@ add_to_cache(cache_instance* cache, const char* key, int value) {
                 (*cache->callback_del)(entry->key, &entry->value, cache->callback_data);
                 if (cache->callback_add) {
                     cb_return = (*cache->callback_add)(key, cache->callback_data);
+                    new_entry->value = cb_return;
                 }
-                new_entry->value = cb_return;
             }
 
             free(entry->key);
@@ -26,5 +26,8 @@ void cache_callback_add(cache_instance* cache, user_add_cb callback);
 void cache_callback_del(cache_instance* cache, user_del_cb callback);
 
 int find_in_cache(cache_instance* cache, const char* key);
+int peek_in_cache(cache_instance* cache, const char* key);
+int peek_oldest_in_cache(cache_instance* cache);
+void evict_oldest_in_cache(cache_instance* cache);
 void add_to_cache(cache_instance* cache, const char* key, int value);
 void empty_cache(cache_instance* cache);
@@ -15,6 +15,7 @@
 
 #include "texture/simple_texture_allocator.h"
 #include "texture/txr_manager.h"
+#include "ui/draw_batch.h"
 
 static struct Simple_Texture textures[32];
 static void* tex_buffer = NULL;
@@ -38,6 +39,7 @@ texman_reset(void* buf, uint32_t size) {
     tex_number = 0;
     tex_buffer = tex_buffer_start = buf;
     tex_buffer_max = buf + size;
+    draw_header_invalidate_all();
 #ifdef DEBUG
     char msg[64];
     sprintf(msg, "TEXMAN: reset @ %p size %d bytes\n", buf, size);
@@ -50,6 +52,8 @@ texman_clear(void) {
     memset(textures, 0, sizeof(textures));
     tex_number = 0;
     tex_buffer = tex_buffer_start;
+    /* Textures loaded from here on land on the old addresses */
+    draw_header_invalidate_all();
 #ifdef DEBUG
     char msg[64];
     sprintf(msg, "TEXMAN: clear %p size %d bytes!\n", tex_buffer, TEXMAN_BUFFER_SIZE);
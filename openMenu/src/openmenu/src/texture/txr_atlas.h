@@ -0,0 +1,25 @@
+/*
+ * File: txr_atlas.h
+ * Project: texture
+ * -----
+ * Small pool geometry as 512x512 atlas pages
+ */
+
+#pragma once
+
+/* Small pool viewed as 512x512 twiddled atlas pages. A twiddled square block inside a twiddled
+ * texture is laid out exactly like a standalone twiddled texture of that size, and runs are
+ * aligned to their size, so the pool already forms the page and only UVs need working out. */
+#define ATLAS_EDGE      (512)
+#define ATLAS_TILE_EDGE (128)
+#define ATLAS_PAGE_SIZE (ATLAS_EDGE * ATLAS_EDGE * 2)
+
+/* Slot index in page is the twiddled block index, x in the odd bits and y in the even bits */
+static inline unsigned int
+atlas_untwiddle(unsigned int idx) {
+    unsigned int ret = 0;
+    for (unsigned int bit = 0; idx; bit++, idx >>= 2) {
+        ret |= (idx & 1) << bit;
+    }
+    return ret;
+}
@@ -10,50 +10,102 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <dc/pvr.h>
 
 #include <backend/dat_format.h>
+#include "ui/draw_batch.h"
 #include "ui/draw_kos.h"
 #include "ui/draw_prototypes.h"
+#include "ui/profiler.h"
 #include "block_pool.h"
 #include "lru.h"
+#include "txr_atlas.h"
 #include <texture/serial_sanitize.h>
 
 #include "txr_manager.h"
 
-/* CFG for small pvr pool (128x128 16bit, 16 spaces) */
-#define SM_SLOT_NUM  (16)
+#define PVR_HDR_SIZE (0x20)
+
+/* Pools are split into units and textures take a power of two run of them sized by their actual
+ * upload size, so VQ art packs several times denser than raw 16bit art */
+
+/* CFG for small pvr pool (16 spaces of 128x128 16bit, 64 of 64x64 16bit or 128x128 VQ) */
 #define SM_SLOT_SIZE (128 * 128 * 2)
-#define SM_POOL_SIZE (SM_SLOT_NUM * SM_SLOT_SIZE * sizeof(char))
+#define SM_UNIT_SIZE (64 * 64 * 2)
+#define SM_UNIT_NUM  (64)
+#define SM_POOL_SIZE (SM_UNIT_NUM * SM_UNIT_SIZE * sizeof(char))
+
+/* CFG for large pvr pool (4 spaces of 256x256 16bit, 16 of 256x256 VQ) */
+#define LG_UNIT_SIZE (128 * 128 * 2)
+#define LG_UNIT_NUM  (16)
+#define LG_POOL_SIZE (LG_UNIT_NUM * LG_UNIT_SIZE * sizeof(char))
+
+#if ((SM_UNIT_NUM * SM_UNIT_SIZE) % ATLAS_PAGE_SIZE)
+#error "Small pool layout doesn't match atlas pages"
+#endif
+
+/* Prefetch queue per pool, serviced from txr_frame_tick */
+#define PREFETCH_QUEUE_LEN   (32)
+#define PREFETCH_PER_FRAME   (1)  /* DAT reads per frame spent on prefetching */
+#define ONSCREEN_FRAMES      (1)  /* Slot drawn within this many frames is treated as on screen */
+#define PREFETCH_STATS_EVERY (60 * 10) /* OPENMENU_PROFILE builds print the stats this often */
 
-/* CFG for large pvr pool (256x256 16bit, 4 spaces) */
-#define LG_SLOT_NUM  (4)
-#define LG_SLOT_SIZE (256 * 256 * 2)
-#define LG_POOL_SIZE (LG_SLOT_NUM * LG_SLOT_SIZE * sizeof(char))
+/* Focus dwell prediction: frames to wait on an item before streaming its large art. Tracks how long
+ * focus usually rests on an item while navigating so held scrolling doesn't load art for every item
+ * passed, but stopping on one starts the load within a few frames. */
+#define DWELL_MIN_FRAMES (4)
+#define DWELL_MAX_FRAMES (30)
+
+/* Default per frame streaming budget, two raw small icons worth of texture data */
+#ifdef TXR_FRAME_BUDGET
+#define FRAME_BUDGET_DEFAULT (TXR_FRAME_BUDGET)
+#else
+#define FRAME_BUDGET_DEFAULT (SM_SLOT_SIZE * 2)
+#endif
+
+/* Tracked on the first unit of each run */
+typedef struct slot_info {
+    pvr_ptr_t texture;        /* Texture address, before the run for small VQ codebooks */
+    unsigned int last_frame;  /* Last frame a visible request used this slot */
+    unsigned char prefetched; /* Loaded ahead of time and not displayed yet */
+} slot_info;
+
+typedef struct prefetch_queue {
+    char ids[PREFETCH_QUEUE_LEN][12];
+    int count;
+    int next;
+} prefetch_queue;
 
 typedef struct dat_system {
     cache_instance cache;
     block_pool pool;
     struct dat_file addon;
     struct dat_file primary;
+    slot_info* slots;
+    prefetch_queue prefetch;
 } dat_system;
 
 static dat_system icon_system;
 static dat_system box_system;
 
-unsigned int
-block_pool_add_cb(const char* key, void* user) {
-    /* unused here but could be good info to know */
-    (void)key;
+static unsigned int txr_frame = 1;
+static txr_prefetch_stats prefetch_stats;
 
-    block_pool* pool = (block_pool*)user;
-    unsigned int ret;
-    char* ptr;
-    pool_get_next_free(pool, &ret, (void**)&ptr);
-    return ret;
-}
+/* Frame budget state, reset every txr_frame_tick */
+static unsigned int frame_budget = FRAME_BUDGET_DEFAULT;
+static unsigned int frame_bytes;
+static unsigned int frame_loads;
+static unsigned int frame_deferred;
+static char focus_id[12];
+static txr_stream_stats stream_stats;
+
+/* Dwell state, updated every txr_frame_tick */
+static char dwell_id[12];
+static unsigned int dwell_frames;
+static unsigned int dwell_step_avg = DWELL_MAX_FRAMES;
 
 unsigned int
 block_pool_del_cb(const char* key, void* value, void* user) {
@@ -86,12 +138,15 @@ txr_load_DATs(void) {
 int
 txr_create_small_pool(void) {
     void* buffer = pvr_mem_malloc(SM_POOL_SIZE);
-    pool_create(&icon_system.pool, buffer, SM_POOL_SIZE, SM_SLOT_NUM);
+    pool_create(&icon_system.pool, buffer, SM_POOL_SIZE, SM_UNIT_NUM);
     icon_system.cache.cache = NULL;
-    cache_set_size(&icon_system.cache, SM_SLOT_NUM);
+    /* Space is handed out by txr_alloc_run, every entry holds at least one unit so the cache never
+     * evicts on its own */
+    cache_set_size(&icon_system.cache, SM_UNIT_NUM);
     cache_callback_userdata(&icon_system.cache, &icon_system.pool);
-    cache_callback_add(&icon_system.cache, block_pool_add_cb);
     cache_callback_del(&icon_system.cache, block_pool_del_cb);
+    icon_system.slots = calloc(SM_UNIT_NUM, sizeof(slot_info));
+    icon_system.prefetch.count = icon_system.prefetch.next = 0;
 
     return 0;
 }
@@ -101,12 +156,15 @@ txr_create_small_pool(void) {
 int
 txr_create_large_pool(void) {
     void* buffer = pvr_mem_malloc(LG_POOL_SIZE);
-    pool_create(&box_system.pool, buffer, LG_POOL_SIZE, LG_SLOT_NUM);
+    pool_create(&box_system.pool, buffer, LG_POOL_SIZE, LG_UNIT_NUM);
     box_system.cache.cache = NULL;
-    cache_set_size(&box_system.cache, LG_SLOT_NUM);
+    /* Space is handed out by txr_alloc_run, every entry holds at least one unit so the cache never
+     * evicts on its own */
+    cache_set_size(&box_system.cache, LG_UNIT_NUM);
     cache_callback_userdata(&box_system.cache, &box_system.pool);
-    cache_callback_add(&box_system.cache, block_pool_add_cb);
     cache_callback_del(&box_system.cache, block_pool_del_cb);
+    box_system.slots = calloc(LG_UNIT_NUM, sizeof(slot_info));
+    box_system.prefetch.count = box_system.prefetch.next = 0;
     return 0;
 }
 
@@ -114,30 +172,92 @@ void
 txr_empty_small_pool(void) {
     empty_cache(&icon_system.cache);
     pool_dealloc_all(&icon_system.pool);
+    draw_header_invalidate_all();
+    memset(icon_system.slots, 0, SM_UNIT_NUM * sizeof(slot_info));
+    icon_system.prefetch.count = icon_system.prefetch.next = 0;
 }
 
 void
 txr_empty_large_pool(void) {
     empty_cache(&box_system.cache);
     pool_dealloc_all(&box_system.pool);
+    draw_header_invalidate_all();
+    memset(box_system.slots, 0, LG_UNIT_NUM * sizeof(slot_info));
+    box_system.prefetch.count = box_system.prefetch.next = 0;
 }
 
+static const dat_file*
+txr_find_dat_source(const char* id_santized, const dat_system* system) {
+    /* Initially check addon then fall back to regular */
+    if (DAT_get_offset_by_ID(&system->addon, id_santized)) {
+        return &system->addon;
+    }
+    if (DAT_get_offset_by_ID(&system->primary, id_santized)) {
+        return &system->primary;
+    }
+    return NULL;
+}
+
+/* Evicts least recently used textures until a run of units fits, returns -1 if it never will.
+ * Prefetches give up instead of evicting something on screen or an unused prefetch. */
 static int
-txr_get_from_dat_set(const char* id, struct image* img, dat_system* system) {
+txr_alloc_run(unsigned int units, int prefetch, dat_system* system, unsigned int* slot_num) {
     void* txr_ptr;
-    int slot_num;
-    const char* id_santized = serial_santize_art(id);
 
-    /* Initially check addon then fall back to regular */
-    uint32_t temp_offset = DAT_get_offset_by_ID(&system->addon, id_santized);
-    const dat_file* dat_source = &system->addon;
-    if (!temp_offset) {
-        temp_offset = DAT_get_offset_by_ID(&system->primary, id_santized);
-        dat_source = &system->primary;
-        if (!temp_offset) {
-            dat_source = NULL;
+    if (units > system->pool.slots) {
+        return -1;
+    }
+    while (pool_alloc_run(&system->pool, units, slot_num, &txr_ptr) == -1) {
+        int victim = peek_oldest_in_cache(&system->cache);
+        if (victim < 0) {
+            return -1;
+        }
+        if (prefetch
+            && (system->slots[victim].prefetched || system->slots[victim].last_frame + ONSCREEN_FRAMES >= txr_frame)) {
+            return -1;
+        }
+
+        /* Whatever gets evicted here was never shown if it is still marked as prefetched */
+        if (system->slots[victim].prefetched) {
+            prefetch_stats.wasted++;
         }
+        draw_header_invalidate(system->slots[victim].texture);
+        evict_oldest_in_cache(&system->cache);
     }
+    return 0;
+}
+
+static int
+txr_load_to_cache(const char* id_santized, struct image* img, const dat_file* dat_source, dat_system* system,
+                  int prefetch) {
+    unsigned int slot_num;
+    const uint32_t size = DAT_get_size_by_ID(dat_source, id_santized);
+
+    /* Pool space goes by what actually gets uploaded, the PVR header stays in main ram */
+    const unsigned int units = pool_slots_for_size(&system->pool, size > PVR_HDR_SIZE ? size - PVR_HDR_SIZE : size);
+    if (txr_alloc_run(units, prefetch, system, &slot_num) == -1) {
+        return -1;
+    }
+    add_to_cache(&system->cache, id_santized, slot_num);
+
+    /* now load the texture into vram */
+    prof_begin(PROF_TXR_LOAD);
+    draw_load_texture_from_DAT_to_buffer(dat_source, id_santized, img, pool_get_slot_addr(&system->pool, slot_num));
+    prof_end(PROF_TXR_LOAD);
+    pool_set_slot_format(&system->pool, slot_num, img->width, img->height, img->format);
+    system->slots[slot_num].texture = img->texture;
+    system->slots[slot_num].prefetched = 0;
+
+    frame_bytes += size;
+    frame_loads++;
+    return slot_num;
+}
+
+static int
+txr_get_from_dat_set(const char* id, struct image* img, dat_system* system) {
+    int slot_num;
+    const char* id_santized = serial_santize_art(id);
+    const dat_file* dat_source = txr_find_dat_source(id_santized, system);
 
     /* check if exists in DAT and if not, return missing image */
     if (!dat_source) {
@@ -146,19 +266,79 @@ txr_get_from_dat_set(const char* id, struct image* img, dat_system* system) {
     }
     slot_num = find_in_cache(&system->cache, id_santized);
     if (slot_num == -1) {
-        add_to_cache(&system->cache, id_santized, 0);
-        slot_num = find_in_cache(&system->cache, id_santized);
-        txr_ptr = pool_get_slot_addr(&system->pool, slot_num);
-
-        /* now load the texture into vram */
-        draw_load_texture_from_DAT_to_buffer(dat_source, id_santized, img, txr_ptr);
-        pool_set_slot_format(&system->pool, slot_num, img->width, img->height, img->format);
+        /* Out of budget: draw the placeholder this frame, the UI asks again next frame.
+         * Focused item always loads and every frame gets at least one load. */
+        if (frame_loads && frame_bytes >= frame_budget && strcmp(id, focus_id)) {
+            draw_load_missing_icon(img);
+            frame_deferred++;
+            return 0;
+        }
+        slot_num = txr_load_to_cache(id_santized, img, dat_source, system, 0);
+        if (slot_num == -1) {
+            draw_load_missing_icon(img);
+            return 0;
+        }
+        prefetch_stats.misses++;
     } else {
         const slot_format* fmt = pool_get_slot_format(&system->pool, slot_num);
         img->width = fmt->width;
         img->height = fmt->height;
         img->format = fmt->format;
-        img->texture = pool_get_slot_addr(&system->pool, slot_num);
+        img->texture = system->slots[slot_num].texture;
+        if (system->slots[slot_num].prefetched) {
+            system->slots[slot_num].prefetched = 0;
+            prefetch_stats.hits++;
+        }
+    }
+    system->slots[slot_num].last_frame = txr_frame;
+    return 0;
+}
+
+static void
+txr_prefetch_set(const char* const* ids, int count, dat_system* system) {
+    prefetch_queue* queue = &system->prefetch;
+
+    queue->count = 0;
+    queue->next = 0;
+    for (int i = 0; i < count && queue->count < PREFETCH_QUEUE_LEN; i++) {
+        if (!ids[i] || ids[i][0] == '\0') {
+            continue;
+        }
+        strncpy(queue->ids[queue->count], ids[i], sizeof(queue->ids[0]) - 1);
+        queue->ids[queue->count][sizeof(queue->ids[0]) - 1] = '\0';
+        queue->count++;
+    }
+    prefetch_stats.requested += queue->count;
+}
+
+/* Loads at most one queued texture, returns 1 if a DAT read was spent */
+static int
+txr_prefetch_service(dat_system* system) {
+    prefetch_queue* queue = &system->prefetch;
+
+    while (queue->next < queue->count) {
+        const char* id_santized = serial_santize_art(queue->ids[queue->next]);
+        const dat_file* dat_source = txr_find_dat_source(id_santized, system);
+
+        /* Already resident or nothing to load, doesn't cost us anything */
+        if (!dat_source || peek_in_cache(&system->cache, id_santized) != -1) {
+            queue->next++;
+            continue;
+        }
+
+        /* Never evict something being drawn or an earlier prefetch that hasn't been used yet */
+        image img;
+        int slot_num = txr_load_to_cache(id_santized, &img, dat_source, system, 1);
+        if (slot_num == -1) {
+            prefetch_stats.blocked += queue->count - queue->next;
+            queue->next = queue->count;
+            return 0;
+        }
+        system->slots[slot_num].prefetched = 1;
+        system->slots[slot_num].last_frame = 0;
+        prefetch_stats.loaded++;
+        queue->next++;
+        return 1;
     }
     return 0;
 }
@@ -176,3 +356,193 @@ int
 txr_get_large(const char* id, struct image* img) {
     return txr_get_from_dat_set(id, img, &box_system);
 }
+
+void
+txr_prefetch_small(const char* const* ids, int count) {
+    txr_prefetch_set(ids, count, &icon_system);
+}
+
+void
+txr_prefetch_large(const char* const* ids, int count) {
+    txr_prefetch_set(ids, count, &box_system);
+}
+
+static unsigned int
+txr_dwell_threshold(void) {
+    const unsigned int threshold = dwell_step_avg + (dwell_step_avg / 2);
+    if (threshold < DWELL_MIN_FRAMES) {
+        return DWELL_MIN_FRAMES;
+    }
+    return threshold > DWELL_MAX_FRAMES ? DWELL_MAX_FRAMES : threshold;
+}
+
+static void
+txr_dwell_update(void) {
+    if (!strcmp(dwell_id, focus_id)) {
+        dwell_frames++;
+        return;
+    }
+
+    /* Focus moved, fold how long it rested into the average step */
+    if (dwell_id[0]) {
+        const unsigned int step = dwell_frames < DWELL_MAX_FRAMES ? dwell_frames : DWELL_MAX_FRAMES;
+        dwell_step_avg = ((dwell_step_avg * 3) + step) / 4;
+    }
+    strcpy(dwell_id, focus_id);
+    dwell_frames = 0;
+}
+
+/* Streams the focused item's large art once focus has settled on it, returns 1 if it was loaded */
+static int
+txr_hires_service(void) {
+    if (!focus_id[0] || !txr_focus_settled()) {
+        return 0;
+    }
+
+    const char* id_santized = serial_santize_art(focus_id);
+    const dat_file* dat_source = txr_find_dat_source(id_santized, &box_system);
+    if (!dat_source || peek_in_cache(&box_system.cache, id_santized) != -1) {
+        return 0;
+    }
+
+    image img;
+    int slot_num = txr_load_to_cache(id_santized, &img, dat_source, &box_system, 0);
+    if (slot_num == -1) {
+        return 0;
+    }
+    box_system.slots[slot_num].last_frame = txr_frame;
+    stream_stats.hires++;
+    return 1;
+}
+
+void
+txr_frame_tick(void) {
+    txr_dwell_update();
+
+    /* Visible requests for this frame are done, the settled focus gets first pick of what's left */
+    if (frame_bytes < frame_budget) {
+        txr_hires_service();
+    }
+
+    /* Then spend the rest on prefetching */
+    for (int i = 0; i < PREFETCH_PER_FRAME && frame_bytes < frame_budget; i++) {
+        if (!txr_prefetch_service(&box_system) && !txr_prefetch_service(&icon_system)) {
+            break;
+        }
+    }
+
+    stream_stats.frames++;
+    stream_stats.loads += frame_loads;
+    stream_stats.bytes += frame_bytes;
+    stream_stats.deferred += frame_deferred;
+    stream_stats.last_deferred = frame_deferred;
+    if (frame_deferred) {
+        stream_stats.deferred_frames++;
+    }
+    if (frame_deferred > stream_stats.deferred_peak) {
+        stream_stats.deferred_peak = frame_deferred;
+    }
+    if (frame_bytes > frame_budget) {
+        stream_stats.over_budget_frames++;
+    }
+    frame_bytes = frame_loads = frame_deferred = 0;
+
+#ifdef OPENMENU_PROFILE
+    static unsigned int last_reported;
+    if (!(txr_frame % PREFETCH_STATS_EVERY) && prefetch_stats.requested != last_reported) {
+        last_reported = prefetch_stats.requested;
+        printf("TXR: prefetch req=%u loaded=%u hits=%u misses=%u wasted=%u blocked=%u\n", prefetch_stats.requested,
+               prefetch_stats.loaded, prefetch_stats.hits, prefetch_stats.misses, prefetch_stats.wasted,
+               prefetch_stats.blocked);
+        printf("TXR: stream loads=%u bytes=%u deferred=%u (%u frames, peak %u/frame) over_budget=%u hires=%u "
+               "dwell=%u\n",
+               stream_stats.loads, stream_stats.bytes, stream_stats.deferred, stream_stats.deferred_frames,
+               stream_stats.deferred_peak, stream_stats.over_budget_frames, stream_stats.hires, txr_dwell_threshold());
+    }
+#endif
+    txr_frame++;
+}
+
+void
+txr_get_prefetch_stats(txr_prefetch_stats* stats) {
+    *stats = prefetch_stats;
+}
+
+void
+txr_reset_prefetch_stats(void) {
+    memset(&prefetch_stats, 0, sizeof(prefetch_stats));
+}
+
+void
+txr_set_frame_budget(unsigned int bytes) {
+    frame_budget = bytes;
+}
+
+unsigned int
+txr_get_frame_budget(void) {
+    return frame_budget;
+}
+
+void
+txr_set_focus(const char* id) {
+    if (!id) {
+        focus_id[0] = '\0';
+        return;
+    }
+    strncpy(focus_id, id, sizeof(focus_id) - 1);
+    focus_id[sizeof(focus_id) - 1] = '\0';
+}
+
+int
+txr_focus_settled(void) {
+    return focus_id[0] && !strcmp(dwell_id, focus_id) && dwell_frames >= txr_dwell_threshold();
+}
+
+int
+txr_get_progressive(const char* id, struct image* img) {
+    /* Large art is only ever loaded by txr_hires_service, until then the icon stands in for it */
+    if (peek_in_cache(&box_system.cache, serial_santize_art(id)) != -1) {
+        txr_get_large(id, img);
+        return 1;
+    }
+    txr_get_small(id, img);
+    return 0;
+}
+
+void
+txr_get_stream_stats(txr_stream_stats* stats) {
+    *stats = stream_stats;
+}
+
+void
+txr_reset_stream_stats(void) {
+    memset(&stream_stats, 0, sizeof(stream_stats));
+}
+
+int
+txr_get_small_atlas(const char* id, struct image* img, struct dimen_RECT* uv) {
+    txr_get_from_dat_set(id, img, &icon_system);
+
+    uv->x = uv->y = 0;
+    uv->w = img->width;
+    uv->h = img->height;
+
+    /* Only square twiddled textures that fit a tile can be addressed through the page, VQ textures
+     * need their own codebook so they are drawn on their own */
+    const uintptr_t base = (uintptr_t)icon_system.pool.base;
+    const uintptr_t addr = (uintptr_t)img->texture;
+    if (addr < base || addr >= base + icon_system.pool.size || img->width != img->height
+        || img->width > ATLAS_TILE_EDGE || (img->format & (PVR_TXRFMT_NONTWIDDLED | PVR_TXRFMT_VQ_ENABLE))) {
+        return 0;
+    }
+
+    /* Runs are aligned to their size, so the offset in the page is a whole number of tiles */
+    const uintptr_t page_base = base + ((addr - base) / ATLAS_PAGE_SIZE) * ATLAS_PAGE_SIZE;
+    const unsigned int tile = (addr - page_base) / (img->width * img->height * 2);
+
+    uv->x = atlas_untwiddle(tile >> 1) * img->width;
+    uv->y = atlas_untwiddle(tile) * img->width;
+    img->texture = (pvr_ptr_t)page_base;
+    img->width = img->height = ATLAS_EDGE;
+    return 0;
+}
@@ -11,6 +11,7 @@
 #pragma once
 
 struct image;
+struct dimen_RECT;
 
 int txr_create_small_pool(void);
 int txr_create_large_pool(void);
@@ -21,3 +22,48 @@ int txr_load_DATs(void); /* Loads our DAT files full of images */
 
 int txr_get_small(const char* id, struct image* img);
 int txr_get_large(const char* id, struct image* img);
+/* Same as txr_get_small but returns the atlas page as img and the icon's place on it in uv.
+ * Icons on the same page can then be drawn with draw_draw_atlas under a single header. */
+int txr_get_small_atlas(const char* id, struct image* img, struct dimen_RECT* uv);
+
+/* Prefetching: ids are queued in priority order and loaded in txr_frame_tick, a few per frame.
+ * A new call replaces the previous queue. Prefetches never evict textures drawn in the last frame. */
+typedef struct txr_prefetch_stats {
+    unsigned int requested; /* ids handed to txr_prefetch_* */
+    unsigned int loaded;    /* textures streamed in ahead of use */
+    unsigned int hits;      /* visible requests served by a prefetched texture */
+    unsigned int misses;    /* visible requests that had to load synchronously */
+    unsigned int wasted;    /* prefetched textures evicted before being drawn */
+    unsigned int blocked;   /* prefetches dropped to protect on screen textures */
+} txr_prefetch_stats;
+
+void txr_prefetch_small(const char* const* ids, int count);
+void txr_prefetch_large(const char* const* ids, int count);
+void txr_frame_tick(void); /* Call once per frame after the scene is submitted */
+void txr_get_prefetch_stats(txr_prefetch_stats* stats);
+void txr_reset_prefetch_stats(void);
+
+/* Streaming budget: cache misses past the per frame byte budget get the placeholder and load on a
+ * later frame. The focused id is exempt and at least one load per frame always goes through. */
+typedef struct txr_stream_stats {
+    unsigned int frames;
+    unsigned int loads;              /* textures uploaded, visible and prefetch */
+    unsigned int bytes;              /* texture bytes uploaded */
+    unsigned int deferred;           /* visible requests pushed to a later frame */
+    unsigned int deferred_frames;    /* frames that deferred at least one load */
+    unsigned int deferred_peak;      /* most loads deferred in a single frame */
+    unsigned int last_deferred;      /* loads deferred in the previous frame */
+    unsigned int over_budget_frames; /* frames that went past the budget on forced or focused loads */
+    unsigned int hires;              /* large art streamed in after focus settled */
+} txr_stream_stats;
+
+void txr_set_frame_budget(unsigned int bytes);
+unsigned int txr_get_frame_budget(void);
+void txr_set_focus(const char* id); /* id of the focused item, never deferred */
+/* Progressive art: returns the large art if it is resident, otherwise the small icon right away. The
+ * large art streams in from txr_frame_tick once focus has rested on the item for a predicted number
+ * of frames, and is returned from then on. Returns 1 when img holds the large art. */
+int txr_get_progressive(const char* id, struct image* img);
+int txr_focus_settled(void); /* focus has rested long enough that the user is likely to stay */
+void txr_get_stream_stats(txr_stream_stats* stats);
+void txr_reset_stream_stats(void);
@@ -7,10 +7,15 @@
  * Copyright (c) 2019 Hayden Kowalchuk
  */
 
+#include <string.h>
+
 #include <dc/pvr.h>
 
 #include <dbgprint.h>
+#include "ui/draw_batch.h"
 #include "ui/draw_prototypes.h"
+#include "ui/profiler.h"
+#include "ui/text_cache.h"
 
 typedef struct bitmap_font {
     int char_width;
@@ -22,19 +27,15 @@ static bitmap_font font;
 static uint32_t font_color;
 
 #define FONT_PERROW(font) (font.texture.width / font.char_width)
-#define BUFFER_MAX_CHARS  (128)
 
 #ifdef KOS_SPRITE
-static pvr_sprite_hdr_t font_header;
-#define VERT_PER_CHAR (1)
-static pvr_sprite_txr_t charbuf[BUFFER_MAX_CHARS * VERT_PER_CHAR] __attribute__((aligned(32)));
+#define FONT_FILTER (PVR_FILTER_NONE)
 #else
-static pvr_poly_hdr_t font_header;
-#define VERT_PER_CHAR (4)
-static pvr_vertex_t charbuf[BUFFER_MAX_CHARS * VERT_PER_CHAR] __attribute__((aligned(32)));
+#define FONT_FILTER (PVR_FILTER_BILINEAR)
 #endif
 
-static int charbuffered;
+/* Texture coordinates of every character, the grid never changes once loaded */
+static draw_glyph_uv glyph_uv[256];
 
 int
 font_bmp_init(const char* filename, int char_width, int char_height) {
@@ -47,23 +48,24 @@ font_bmp_init(const char* filename, int char_width, int char_height) {
 
     font_color = 0xFFFFFFFF; // White
 
+    for (int ch = 0; ch < 256; ch++) {
+        const int index = ch - 32;
+        const int ix = (index % FONT_PERROW(font)) * font.char_width;
+        const int iy = (index / FONT_PERROW(font)) * font.char_height;
+        draw_glyph_uv_set(&glyph_uv[ch], ix * 1.0f / font.texture.width, iy * 1.0f / font.texture.height,
+                          (ix + font.char_width) * 1.0f / font.texture.width,
+                          (iy + font.char_height) * 1.0f / font.texture.height);
+    }
+
+    /* Cached layouts were made with the old glyph size */
+    text_cache_clear();
+
     return 0;
 }
 
 void
 font_bmp_begin_draw() {
-    /* Make a polygon header */
-#ifdef KOS_SPRITE
-    pvr_sprite_cxt_t tmp;
-    pvr_sprite_cxt_txr(&tmp, draw_get_list(), font.texture.format, font.texture.width, font.texture.height,
-                       font.texture.texture, PVR_FILTER_NONE);
-    pvr_sprite_compile(&font_header, &tmp);
-#else
-    pvr_poly_cxt_t tmp;
-    pvr_poly_cxt_txr(&tmp, draw_get_list(), font.texture.format, font.texture.width, font.texture.height,
-                     font.texture.texture, PVR_FILTER_BILINEAR);
-    pvr_poly_compile(&font_header, &tmp);
-#endif
+    /* Text is queued as glyph runs, see draw_text_begin */
 }
 
 void
@@ -71,11 +73,6 @@ font_bmp_set_color(uint32_t color) {
     /*@Note: Either lxdream-nitro weirdness or something is wrong in how we draw,
    * set both to 0xFFFFFFFF */
     font_color = color;
-#ifdef KOS_SPRITE
-    font_header.argb = color;
-#endif
-    /* Start a textured polygon set (with the font texture and color) */
-    pvr_prim(&font_header, sizeof(font_header));
 }
 
 void
@@ -88,112 +85,89 @@ font_bmp_set_color_components(int r, int g, int b, int a) {
     font_color = PVR_PACK_ARGB(a, r, g, b);
 }
 
-/* Draws a font letter using two triangle strips */
 static void
-font_bmp_draw_char(int x, int y, unsigned char ch) {
-    const int index = ch - 32;
-    const int ix = (index % FONT_PERROW(font)) * font.char_width;
-    const int iy = (index / FONT_PERROW(font)) * font.char_height;
-
-    /* Upper left */
-    const float x1 = x;
-    const float y1 = y;
-    const float u1 = ix * 1.0f / font.texture.width;
-    const float v1 = iy * 1.0f / font.texture.height;
-
-    /* Lower right */
-    const float x2 = x1 + font.char_width;
-    const float y2 = y1 + font.char_height;
-    const float u2 = (ix + font.char_width) * 1.0f / font.texture.width;
-    const float v2 = (iy + font.char_height) * 1.0f / font.texture.height;
-
-    const float z = z_get();
-
-    if (index == -1) {
+_font_bmp_draw_string(int x1, int y1, const char* str) {
+    const float z = z_inc();
+    text_layout* layout = text_cache_get(str, TEXT_FONT_BMP, 1.0f, 0);
+    if (text_layout_draw(layout, &font.texture, FONT_FILTER, x1, y1, z, font_color)) {
         return;
     }
 
-#ifdef KOS_SPRITE
-    pvr_sprite_txr_t vert = {
-        .flags = PVR_CMD_VERTEX_EOL, /* Always? */
-        /*  upper left */
-        .ax = x1,
-        .ay = y1,
-        .az = z,
-        /* upper right */
-        .bx = x2,
-        .by = y1,
-        .bz = z,
-        /* lower left */
-        .cx = x2,
-        .cy = y2,
-        .cz = z,
-        /* interpolated */
-        .dx = x1,
-        .dy = y2,
-        .auv = PVR_PACK_16BIT_UV(u1, v1), /* UVS */
-        .buv = PVR_PACK_16BIT_UV(u2, v1), /* UVS */
-        .cuv = PVR_PACK_16BIT_UV(u2, v2), /* UVS */
-    };
-
-    charbuf[charbuffered] = vert;
-#else
-    pvr_vertex_t *vert1, *vert2, *vert3, *vert4;
-    vert1 = &charbuf[charbuffered + 0];
-    vert2 = &charbuf[charbuffered + 1];
-    vert3 = &charbuf[charbuffered + 2];
-    vert4 = &charbuf[charbuffered + 3];
-
-    vert1->flags = PVR_CMD_VERTEX;
-    vert1->x = x1;
-    vert1->y = y2;
-    vert1->z = z;
-    vert1->u = u1;
-    vert1->v = v2;
-    vert1->argb = font_color;
-    vert1->oargb = 0;
-
-    vert2->flags = PVR_CMD_VERTEX;
-    vert2->x = x1;
-    vert2->y = y1;
-    vert2->z = z;
-    vert2->u = u1;
-    vert2->v = v1;
-    vert2->argb = font_color;
-    vert2->oargb = 0;
-
-    vert3->flags = PVR_CMD_VERTEX;
-    vert3->x = x2;
-    vert3->y = y2;
-    vert3->z = z;
-    vert3->u = u2;
-    vert3->v = v2;
-    vert3->argb = font_color;
-    vert3->oargb = 0;
-
-    vert4->flags = PVR_CMD_VERTEX_EOL;
-    vert4->x = x2;
-    vert4->y = y1;
-    vert4->z = z;
-    vert4->u = u2;
-    vert4->v = v1;
-    vert4->argb = font_color;
-    vert4->oargb = 0;
-#endif
-    charbuffered += VERT_PER_CHAR;
-}
-
-static void
-_font_bmp_draw_string(int x1, int y1, const char* str) {
-    z_inc();
-    charbuffered = 0;
+    prof_begin(PROF_TEXT);
+    const int x_start = x1;
+    draw_text_begin(&font.texture, FONT_FILTER, font_color, z, layout);
 
     do {
         unsigned char chr = (*str);
-        font_bmp_draw_char(x1, y1, chr);
+        /* Character 31 maps to the cell before the grid */
+        if (chr != 31) {
+            draw_text_glyph(x1, y1, x1 + font.char_width, y1 + font.char_height, &glyph_uv[chr]);
+        }
         x1 += (int)(font.char_width);
     } while (*++str);
-    pvr_prim(charbuf, charbuffered * sizeof(charbuf[0]));
+
+    draw_text_end();
+    text_layout_finish(layout, x_start, y1, z, font_color);
+    prof_end(PROF_TEXT);
+}
+
+void
+font_bmp_draw_clipped(int x1, int y1, const char* str, int length, int scroll, int width) {
+    const int char_width = font.char_width;
+    const float clip_x2 = x1 + width;
+    const float z = z_inc();
+    char line[256];
+
+    /* The whole line is laid out once, each frame replays it scrolled and trimmed to the window */
+    text_layout* layout = NULL;
+    if (length >= 0 && length < (int)sizeof(line)) {
+        memcpy(line, str, length);
+        line[length] = '\0';
+        layout = text_cache_get(line, TEXT_FONT_BMP_MARQUEE, 1.0f, 0);
+    }
+    if (text_layout_draw_clipped(layout, &font.texture, FONT_FILTER, x1 - scroll, y1, z, font_color, x1, clip_x2)) {
+        return;
+    }
+    if (layout) {
+        prof_begin(PROF_TEXT);
+        draw_text_layout_begin(&font.texture, FONT_FILTER, font_color, z, layout);
+        for (int i = 0; i < length; i++) {
+            const unsigned char chr = line[i];
+            const int x = x1 + (i * char_width);
+            if (chr != 31) {
+                draw_text_glyph(x, y1, x + char_width, y1 + font.char_height, &glyph_uv[chr]);
+            }
+        }
+        draw_text_end();
+        text_layout_finish(layout, x1, y1, z, font_color);
+        prof_end(PROF_TEXT);
+        if (text_layout_draw_clipped(layout, &font.texture, FONT_FILTER, x1 - scroll, y1, z, font_color, x1,
+                                     clip_x2)) {
+            return;
+        }
+    }
+
+    /* Fixed width, only the characters that can show are visited */
+    int first = scroll / char_width;
+    int last = (scroll + width + char_width - 1) / char_width;
+    if (first < 0) {
+        first = 0;
+    }
+    if (last > length) {
+        last = length;
+    }
+
+    prof_begin(PROF_TEXT);
+    draw_text_begin(&font.texture, FONT_FILTER, font_color, z, NULL);
+    for (int i = first; i < last; i++) {
+        const unsigned char chr = str[i];
+        const int x = x1 - scroll + (i * char_width);
+        if (chr != 31) {
+            draw_text_glyph_clipped(x, y1, x + char_width, y1 + font.char_height, &glyph_uv[chr], x1, clip_x2);
+        }
+    }
+    draw_text_end();
+    prof_end(PROF_TEXT);
 }
 
 /* @Note: revisit this */
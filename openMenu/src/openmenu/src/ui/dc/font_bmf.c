@@ -16,7 +16,10 @@
 #include <string.h>
 
 #include <dbgprint.h>
+#include "ui/draw_batch.h"
 #include "ui/draw_prototypes.h"
+#include "ui/profiler.h"
+#include "ui/text_cache.h"
 
 #define PRINT_MEMBER(struct, member)                                                                                   \
     do {                                                                                                               \
@@ -116,7 +119,6 @@ typedef struct __attribute__((__packed__)) bm_char_ex {
     int16_t xadvance;
     uint8_t page;
     uint8_t chnl;
-    bm_kern_pair* kerns;
 } bm_char_ex;
 
 typedef struct __attribute__((__packed__)) bm_font {
@@ -131,9 +133,34 @@ typedef struct __attribute__((__packed__)) bm_font {
 } bm_font;
 
 static bm_font font_basilea;
+
+/* Everything the string renderer needs per glyph, built once the font is loaded so drawing is
+ * only multiplies and adds. Offsets are from the pen position and unscaled. */
+typedef struct bmf_glyph {
+    draw_glyph_uv uv;
+    float x1, y1, x2, y2;
+    float advance;
+} bmf_glyph;
+
+static bmf_glyph glyphs[256];
+static float space_width;
+
+/* Kerning pairs hashed by first << 8 | second with linear probing, key 0 marks an empty slot.
+ * kern_first flags characters that start any pair so most lookups never touch the table. */
+typedef struct bmf_kern_slot {
+    uint16_t key;
+    int16_t amount;
+} bmf_kern_slot;
+
+#define KERN_HASH_MIN (64)
+#define KERN_HASH(key) (((uint32_t)(key) * 2654435761u) >> 16)
+
+static bmf_kern_slot* kern_hash;
+static uint32_t kern_hash_mask;
+static uint8_t kern_first[256];
+
 static int font_loaded = 0;
 static float current_scale = 1.0;
-static unsigned int current_color;
 
 static int
 BMF_parse_info(file_t fd, size_t block_size, bm_font* font) {
@@ -234,7 +261,6 @@ BMF_parse_chars(file_t fd, size_t block_size, bm_font* font) {
 #endif
 
             font->chars[temp_char.id] = temp_char;
-            font->chars[temp_char.id].kerns = NULL;
         }
     }
 
@@ -243,13 +269,57 @@ BMF_parse_chars(file_t fd, size_t block_size, bm_font* font) {
 }
 
 static int
-_kern_pair_sort(const void* a, const void* b) {
-    const bm_kern_pair* ia = (const bm_kern_pair*)a;
-    const bm_kern_pair* ib = (const bm_kern_pair*)b;
-    if (ia->first == ib->first) {
-        return ia->second - ib->second;
+BMF_build_kern_hash(const bm_kern_pair* pairs, int num_pairs) {
+    uint32_t slots = KERN_HASH_MIN;
+    while (slots < (uint32_t)num_pairs * 2) {
+        slots <<= 1;
+    }
+
+    free(kern_hash);
+    memset(kern_first, 0, sizeof(kern_first));
+    kern_hash = calloc(slots, sizeof(bmf_kern_slot));
+    if (!kern_hash) {
+        printf("%s no free memory\n", __func__);
+        return 1;
+    }
+    kern_hash_mask = slots - 1;
+
+    for (int i = 0; i < num_pairs; i++) {
+        const bm_kern_pair* pair = &pairs[i];
+        /* The renderer only deals in single bytes, and first 0 is the start of a string */
+        if (!pair->first || pair->first > 255 || pair->second > 255) {
+            continue;
+        }
+        const uint16_t key = (uint16_t)(pair->first << 8 | pair->second);
+        uint32_t idx = KERN_HASH(key) & kern_hash_mask;
+        while (kern_hash[idx].key && kern_hash[idx].key != key) {
+            idx = (idx + 1) & kern_hash_mask;
+        }
+        kern_hash[idx].key = key;
+        kern_hash[idx].amount = pair->amount;
+        kern_first[pair->first] = 1;
+    }
+    return 0;
+}
+
+static void
+BMF_build_glyphs(const bm_font* font) {
+    const float tex_w = font->width ? (float)font->width : 1.0f;
+    const float tex_h = font->height ? (float)font->height : 1.0f;
+
+    for (int i = 0; i < 256; i++) {
+        const bm_char_ex* chr = &font->chars[i];
+        bmf_glyph* glyph = &glyphs[i];
+
+        draw_glyph_uv_set(&glyph->uv, (float)chr->x / tex_w, (float)chr->y / tex_h,
+                          (float)(chr->x + chr->width) / tex_w, (float)(chr->y + chr->height) / tex_h);
+        glyph->x1 = (float)chr->xoffset;
+        glyph->y1 = (float)chr->yoffset;
+        glyph->x2 = (float)(chr->width + chr->xoffset);
+        glyph->y2 = (float)(chr->height + chr->yoffset);
+        glyph->advance = (float)chr->xadvance;
     }
-    return ia->first - ib->first;
+    space_width = (float)font->chars[' '].width;
 }
 
 static int
@@ -269,26 +339,23 @@ BMF_parse_kerning(file_t fd, size_t block_size, bm_font* font) {
     font->num_kerns = num_pairs;
     fs_read(fd, font->kerns, num_pairs * sizeof(bm_kern_pair));
 
-    /* Sort Kerning pairs */
-    qsort(font->kerns, num_pairs, sizeof(bm_kern_pair), _kern_pair_sort);
+    BMF_build_kern_hash(font->kerns, num_pairs);
 
-    /* List the now sorted pairs*/
+#if defined(DBG_KERN_INFO) && DBG_KERN_INFO
     for (int i = 0; i < num_pairs; i++) {
         bm_kern_pair* pair = &font->kerns[i];
-
-        if (pair->first < 256) {
-            font->chars[pair->first].kerns = pair;
-        }
-
-#if defined(DBG_KERN_INFO) && DBG_KERN_INFO
         char first = (char)pair->first;
         char second = (char)pair->second;
         DBG_PRINT("First: %c\n", first);
         DBG_PRINT("Second: %c\n", second);
         DBG_PRINT("amount: %d\n", pair->amount);
         DBG_PRINT("\n");
-#endif
     }
+#endif
+
+    /* Lookups only use the hash from here on */
+    free(font->kerns);
+    font->kerns = NULL;
 
     DBG_PRINT("\n");
     return 0;
@@ -342,20 +409,24 @@ BMF_load(const char* file, bm_font* font) {
 
     fs_close(fd);
 
+    BMF_build_glyphs(font);
     font_loaded = 1;
 
     return 0;
 }
 
-int
-BMF_adjust_kerning(unsigned char first, unsigned char second, bm_font* font) {
-    const bm_kern_pair* kern_pairs = font->chars[first].kerns;
-    if (kern_pairs) {
-        do {
-            if (kern_pairs->second == second) {
-                return kern_pairs->amount;
-            }
-        } while ((unsigned char)(kern_pairs++)->first == first);
+static inline int
+BMF_kerning(unsigned char first, unsigned char second) {
+    if (!kern_first[first]) {
+        return 0;
+    }
+    const uint16_t key = (uint16_t)(first << 8 | second);
+    uint32_t idx = KERN_HASH(key) & kern_hash_mask;
+    while (kern_hash[idx].key) {
+        if (kern_hash[idx].key == key) {
+            return kern_hash[idx].amount;
+        }
+        idx = (idx + 1) & kern_hash_mask;
     }
     return 0;
 }
@@ -382,13 +453,6 @@ font_bmf_set_scale(float scale) {
 #define X_SCALE_16_9 (0.74941452f)
 static float X_SCALE;
 
-#ifdef KOS_SPRITE
-static pvr_sprite_hdr_t font_header;
-#define VERT_PER_CHAR (1)
-#else
-static pvr_poly_hdr_t font_header;
-#define VERT_PER_CHAR (4)
-#endif
 static image font_texture;
 
 /* Font prototype generics */
@@ -407,6 +471,8 @@ font_bmf_init(const char* fnt, const char* texture, int is_wide) {
     if (!font_loaded) {
         ret += BMF_load(temp_fnt, &font_basilea);
     }
+    /* Cached layouts were made with the old aspect */
+    text_cache_clear();
 
     unsigned int temp = texman_create();
     draw_load_texture_buffer(texture, &font_texture, texman_get_tex_data(temp));
@@ -420,220 +486,147 @@ font_bmf_destroy(void) { /*@Todo: release safely */ }
 
 void
 font_bmf_begin_draw(void) {
-    /* Make a polygon header */
-#ifdef KOS_SPRITE
-    pvr_sprite_cxt_t tmp;
-    pvr_sprite_cxt_txr(&tmp, draw_get_list(), font_texture.format, font_texture.width, font_texture.height,
-                       font_texture.texture, PVR_FILTER_BILINEAR);
-    pvr_sprite_compile(&font_header, &tmp);
-#else
-    pvr_poly_cxt_t tmp;
-    pvr_poly_cxt_txr(&tmp, draw_get_list(), font_texture.format, font_texture.width, font_texture.height,
-                     font_texture.texture, PVR_FILTER_BILINEAR);
-    if (tmp.txr.enable != PVR_TEXTURE_DISABLE) {
-        switch (tmp.txr.width) {
-            case 8:
-            case 16:
-            case 32:
-            case 64:
-            case 128:
-            case 256:
-            case 512:
-            case 1024: break;
-            default:
-                printf("%s error tex size %d(%ld) %d(%ld)\n", __func__, tmp.txr.width, font_texture.width,
-                       tmp.txr.height, font_texture.height);
-                return;
-                break;
-        }
+    /* Text is queued as glyph runs, nothing to submit here, only reset the defaults */
+#ifndef KOS_SPRITE
+    switch (font_texture.width) {
+        case 8:
+        case 16:
+        case 32:
+        case 64:
+        case 128:
+        case 256:
+        case 512:
+        case 1024: break;
+        default:
+            printf("%s error tex size %ld %ld\n", __func__, font_texture.width, font_texture.height);
+            break;
     }
-    pvr_poly_compile(&font_header, &tmp);
 #endif
     font_bmf_set_height_default();
-    pvr_prim(&font_header, sizeof(font_header));
-    current_color = PVR_PACK_ARGB(0xff, 0xff, 0xff, 0xff);
 }
 
-#define BUFFER_MAX_CHARS (128)
-#ifdef KOS_SPRITE
-static pvr_sprite_txr_t charbuf[BUFFER_MAX_CHARS * VERT_PER_CHAR] __attribute__((aligned(32)));
-#else
-static pvr_vertex_t charbuf[BUFFER_MAX_CHARS * VERT_PER_CHAR] __attribute__((aligned(32)));
-#endif
-static int charbuffered;
-
-/* Draws a font letter using two triangle strips */
-static int
-font_bmf_draw_char(int x, int y, unsigned char chr) {
-    bm_font* font = &font_basilea;
-
+/* Adds a font letter to the current text run, sx/sy are the current scale with aspect applied */
+static inline int
+font_bmf_draw_char(int x, int y, const bmf_glyph* glyph, float sx, float sy) {
     /* Upper left */
-    const float x1 = round(x + (current_scale * (float)font->chars[chr].xoffset) * X_SCALE);
-    const float y1 = round(y + current_scale * (float)font->chars[chr].yoffset);
-    const float u1 = (float)font->chars[chr].x / (float)font->width;
-    const float v1 = (float)font->chars[chr].y / (float)font->height;
+    const float x1 = round(x + glyph->x1 * sx);
+    const float y1 = round(y + glyph->y1 * sy);
 
     /* Lower right */
-    const float x2 = round(x + (current_scale * ((float)font->chars[chr].width + font->chars[chr].xoffset)) * X_SCALE);
-    const float y2 = round(y + current_scale * ((float)font->chars[chr].height + font->chars[chr].yoffset));
-    const float u2 = (float)(font->chars[chr].x + font->chars[chr].width) / (float)font->width;
-    const float v2 = (float)(font->chars[chr].y + font->chars[chr].height) / (float)font->height;
-
-    const float z = z_get();
-
-    if (charbuffered > BUFFER_MAX_CHARS) {
-        pvr_prim(charbuf, charbuffered * sizeof(charbuf[0]));
-        charbuffered = 0;
-    }
+    const float x2 = round(x + glyph->x2 * sx);
+    const float y2 = round(y + glyph->y2 * sy);
 
-#ifdef KOS_SPRITE
-    pvr_sprite_txr_t vert = {
-        .flags = PVR_CMD_VERTEX_EOL, /* Always? */
-        /*  upper left */
-        .ax = x1,
-        .ay = y1,
-        .az = z,
-        /* upper right */
-        .bx = x2,
-        .by = y1,
-        .bz = z,
-        /* lower left */
-        .cx = x2,
-        .cy = y2,
-        .cz = z,
-        /* interpolatied */
-        .dx = x1,
-        .dy = y2,
-        .auv = PVR_PACK_16BIT_UV(u1, v1), /* UVS */
-        .buv = PVR_PACK_16BIT_UV(u2, v1), /* UVS */
-        .cuv = PVR_PACK_16BIT_UV(u2, v2), /* UVS */
-    };
-
-    charbuf[charbuffered] = vert;
-#else
-    pvr_vertex_t *vert1, *vert2, *vert3, *vert4;
-    vert1 = &charbuf[charbuffered + 0];
-    vert2 = &charbuf[charbuffered + 1];
-    vert3 = &charbuf[charbuffered + 2];
-    vert4 = &charbuf[charbuffered + 3];
-
-    vert1->flags = PVR_CMD_VERTEX;
-    vert1->x = x1;
-    vert1->y = y2;
-    vert1->z = z;
-    vert1->u = u1;
-    vert1->v = v2;
-    vert1->argb = current_color;
-    vert1->oargb = 0;
-
-    vert2->flags = PVR_CMD_VERTEX;
-    vert2->x = x1;
-    vert2->y = y1;
-    vert2->z = z;
-    vert2->u = u1;
-    vert2->v = v1;
-    vert2->argb = current_color;
-    vert2->oargb = 0;
-
-    vert3->flags = PVR_CMD_VERTEX;
-    vert3->x = x2;
-    vert3->y = y2;
-    vert3->z = z;
-    vert3->u = u2;
-    vert3->v = v2;
-    vert3->argb = current_color;
-    vert3->oargb = 0;
-
-    vert4->flags = PVR_CMD_VERTEX_EOL;
-    vert4->x = x2;
-    vert4->y = y1;
-    vert4->z = z;
-    vert4->u = u2;
-    vert4->v = v1;
-    vert4->argb = current_color;
-    vert4->oargb = 0;
-#endif
-    charbuffered += VERT_PER_CHAR;
+    draw_text_glyph(x1, y1, x2, y2, &glyph->uv);
 
-    return (current_scale * font->chars[chr].xadvance) * X_SCALE;
+    return glyph->advance * sx;
 }
 
-static void
-_font_bmf_draw_string(int x1, int y1, uint32_t color, const char* str) {
-    current_color = color;
-    charbuffered = 0;
-    z_inc();
+/* Lays out every character in [str, end) starting at the pen position, returns the pen position
+ * after the last one. Call between draw_text_begin and draw_text_end */
+static int
+font_bmf_draw_run(int x, int y, const unsigned char* str, const unsigned char* end) {
+    const float sx = current_scale * X_SCALE;
+    const float sy = current_scale;
+    const float space = current_scale * space_width;
 
     unsigned char prev = 0;
-    do {
-        unsigned char chr = *str;
+    while (str < end) {
+        const unsigned char chr = *str++;
         if (chr != ' ') {
             /* Add possible kerning adjustment */
-            x1 += round(current_scale * BMF_adjust_kerning(prev, chr, &font_basilea));
-            x1 += font_bmf_draw_char(x1, y1, chr);
+            x += round(current_scale * BMF_kerning(prev, chr));
+            x += font_bmf_draw_char(x, y, &glyphs[chr], sx, sy);
         } else {
-            x1 += round(current_scale * (float)font_basilea.chars[' '].width);
+            x += round(space);
         }
-
         prev = chr;
-    } while (*++str);
+    }
+    return x;
+}
+
+/* layout is the cache entry for str at the current scale, from text_cache_get */
+static void
+_font_bmf_draw_layout(int x1, int y1, uint32_t color, const char* str, text_layout* layout) {
+    const float z = z_inc();
+
+    if (text_layout_draw(layout, &font_texture, PVR_FILTER_BILINEAR, x1, y1, z, color)) {
+        return;
+    }
 
-    pvr_prim(charbuf, charbuffered * sizeof(charbuf[0]));
+    prof_begin(PROF_TEXT);
+    draw_text_begin(&font_texture, PVR_FILTER_BILINEAR, color, z, layout);
+    font_bmf_draw_run(x1, y1, (const unsigned char*)str, (const unsigned char*)str + strlen(str));
+    draw_text_end();
+    text_layout_finish(layout, x1, y1, z, color);
+    prof_end(PROF_TEXT);
+}
+
+static void
+_font_bmf_draw_string(int x1, int y1, uint32_t color, const char* str) {
+    _font_bmf_draw_layout(x1, y1, color, str, text_cache_get(str, TEXT_FONT_BMF, current_scale, 0));
 }
 
 static float
 _font_bmf_calculate_length_full(const char* str, int length) {
-    /* Not sure if its worth calculating kerning for this */
     float width = 0;
-    char prev = 0;
-    bm_font* font = &font_basilea;
+    unsigned char prev = 0;
+    const unsigned char* iter = (const unsigned char*)str;
     int cursor = 0;
 
-    while (*str && cursor++ < length) {
-        int chr = *str;
+    while (*iter && cursor++ < length) {
+        const unsigned char chr = *iter++;
         /* Add possible kerning adjustment */
-        width += BMF_adjust_kerning(prev, chr, &font_basilea); /* slow */
-        width += font->chars[chr].xadvance;
+        width += BMF_kerning(prev, chr);
+        width += glyphs[chr].advance;
 
         prev = chr;
-        str++;
     }
 
     return round(current_scale * round(width)) * X_SCALE;
 }
 
 static float
-_font_bmf_calculate_length(const char* str) {
-    return _font_bmf_calculate_length_full(str, strlen(str));
+_font_bmf_calculate_length(const char* str, text_layout* layout) {
+    float width = text_layout_width(layout);
+    if (width < 0.0f) {
+        width = _font_bmf_calculate_length_full(str, strlen(str));
+        text_layout_set_width(layout, width);
+    }
+    return width;
 }
 
 void
 font_bmf_draw_auto_size(int x1, int y1, uint32_t color, const char* str, int width) {
     float save_scale = current_scale;
-    float temp = _font_bmf_calculate_length(str);
+    text_layout* layout = text_cache_get(str, TEXT_FONT_BMF, current_scale, 0);
+    float temp = _font_bmf_calculate_length(str, layout);
     if (temp > width) {
         const float scale = ((float)width / temp);
         font_bmf_set_scale(scale);
+        layout = text_cache_get(str, TEXT_FONT_BMF, current_scale, 0);
     }
-    _font_bmf_draw_string(x1, y1, color, str);
+    _font_bmf_draw_layout(x1, y1, color, str, layout);
     current_scale = save_scale;
 }
 
 void
 font_bmf_draw_centered(int x1, int y1, uint32_t color, const char* str) {
-    int temp = (int)_font_bmf_calculate_length(str);
-    _font_bmf_draw_string(x1 - (temp / 2), y1, color, str);
+    text_layout* layout = text_cache_get(str, TEXT_FONT_BMF, current_scale, 0);
+    int temp = (int)_font_bmf_calculate_length(str, layout);
+    _font_bmf_draw_layout(x1 - (temp / 2), y1, color, str, layout);
 }
 
 void
 font_bmf_draw_centered_auto_size(int x1, int y1, uint32_t color, const char* str, int width) {
     float save_scale = current_scale;
-    float temp = _font_bmf_calculate_length(str);
+    text_layout* layout = text_cache_get(str, TEXT_FONT_BMF, current_scale, 0);
+    float temp = _font_bmf_calculate_length(str, layout);
     if (temp > (float)width) {
         const float scale = ((float)width / temp);
         font_bmf_set_scale(scale);
+        layout = text_cache_get(str, TEXT_FONT_BMF, current_scale, 0);
     }
-    _font_bmf_draw_string(x1 - ((int)temp / 2), y1, color, str);
+    _font_bmf_draw_layout(x1 - ((int)temp / 2), y1, color, str, layout);
     current_scale = save_scale;
 }
 
@@ -656,15 +649,20 @@ font_bmf_draw_sub(int x1, int y1, uint32_t color, const char* str) {
 
 void
 font_bmf_draw_sub_wrap(int x1, int y1, uint32_t color, const char* str, int width) {
-    z_inc();
-    current_color = color;
+    const float z = z_inc();
+
+    text_layout* layout = text_cache_get(str, TEXT_FONT_BMF, current_scale, width);
+    if (text_layout_draw(layout, &font_texture, PVR_FILTER_BILINEAR, x1, y1, z, color)) {
+        return;
+    }
+    prof_begin(PROF_TEXT);
+    const int y_start = y1;
+    draw_text_begin(&font_texture, PVR_FILTER_BILINEAR, color, z, layout);
     unsigned char prev = ' ';
     unsigned int current_char = 0;
 
-    const int x_start = x1;
     const char* text_end = strrchr(str, '\0');
     const char* current_text_start = str;
-    const char* current_text_temp = str;
     const char* last_known_space = str;
     int current_text_len = 0;
 
@@ -673,7 +671,7 @@ font_bmf_draw_sub_wrap(int x1, int y1, uint32_t color, const char* str, int widt
         float current_text_width = 0.0f;
         prev = ' ';
         do {
-            current_char = *(current_text_start + current_text_len);
+            current_char = *(const unsigned char*)(current_text_start + current_text_len);
             if (current_char == ' ') {
                 last_known_space = current_text_start + current_text_len;
             }
@@ -686,35 +684,22 @@ font_bmf_draw_sub_wrap(int x1, int y1, uint32_t color, const char* str, int widt
                 last_known_space = text_end;
                 break;
             }
-            current_text_width += (int)((current_scale * font_basilea.chars[current_char].xadvance) * X_SCALE);
-            current_text_width += round(current_scale * BMF_adjust_kerning(prev, current_char, &font_basilea));
+            current_text_width += (int)((current_scale * glyphs[current_char].advance) * X_SCALE);
+            current_text_width += round(current_scale * BMF_kerning(prev, current_char));
             prev = current_char;
             current_text_len++;
         } while (current_text_width < width);
 
-        current_text_temp = current_text_start;
-        charbuffered = 0;
-        prev = 0;
-
-        do {
-            unsigned char chr = (*current_text_temp++);
-            if (chr != ' ') {
-                /* Add possible kerning adjustment */
-                x1 += round(current_scale * BMF_adjust_kerning(prev, chr, &font_basilea));
-                x1 += font_bmf_draw_char(x1, y1, chr);
-            } else {
-                x1 += round(current_scale * (float)font_basilea.chars[' '].width);
-            }
-            prev = chr;
-        } while (current_text_temp < last_known_space);
-
-        pvr_prim(charbuf, charbuffered * sizeof(charbuf[0]));
+        font_bmf_draw_run(x1, y1, (const unsigned char*)current_text_start, (const unsigned char*)last_known_space);
 
         /* prepare for next row */
         y1 += (current_scale * font_basilea.lineHeight * 1.2f /* Makes Text more natural */);
-        x1 = x_start;
         current_text_start = last_known_space + 1;
         current_text_len = 0;
         prev = 0;
     } while (current_text_start < text_end);
+
+    draw_text_end();
+    text_layout_finish(layout, x1, y_start, z, color);
+    prof_end(PROF_TEXT);
 }
@@ -11,15 +11,34 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <backend/dat_format.h>
 #include "pvr_texture.h"
 
 #define PVR_HDR_SIZE 0x20
 
+/* VQ textures always address a 256 entry codebook of 2x2 16bit texels */
+#define VQ_CODEBOOK_SIZE (256 * 8)
+
 static unsigned char* _internal_buf = NULL;
 static char filename_safe[128];
 
+/* Small VQ stores only as many codebook entries as the texture size needs */
+static uint32_t
+pvr_small_vq_codebook_size(int texW) {
+    if (texW <= 16) {
+        return 16 * 8;
+    } else if (texW == 32) {
+        return 32 * 8;
+    } else if (texW == 64) {
+        return 128 * 8;
+    }
+    return VQ_CODEBOOK_SIZE;
+}
+
+/* Returns bytes to upload, codebook_skip is how far before the upload the texture address has to
+ * point so a small VQ codebook lines up with the end of the 256 entry codebook the PVR expects */
 static uint32_t
-pvr_get_texture_size(const void* input, uint32_t* w, uint32_t* h, uint32_t* txrFormat) {
+pvr_get_texture_size(const void* input, uint32_t* w, uint32_t* h, uint32_t* txrFormat, uint32_t* codebook_skip) {
     unsigned char* texBuf = (unsigned char*)input;
 
     const int texW = texBuf[PVR_HDR_SIZE - 4] | texBuf[PVR_HDR_SIZE - 3] << 8;
@@ -80,12 +99,21 @@ pvr_get_texture_size(const void* input, uint32_t* w, uint32_t* h, uint32_t* txrF
 
         case 0x0D: texFormat = PVR_TXRFMT_TWIDDLED; break; // RECTANGULAR TWIDDLED
 
-        case 0x10: texFormat = PVR_TXRFMT_VQ_ENABLE | PVR_TXRFMT_NONTWIDDLED; break; // SMALL VQ
+        case 0x10: texFormat = PVR_TXRFMT_VQ_ENABLE; break; // SMALL VQ (TWIDDLED)
 
         default: texFormat = PVR_TXRFMT_NONE; break;
     }
 
-    const int txr_size = texW * texH * bpp;
+    /* VQ is a codebook followed by one byte per 2x2 block */
+    int txr_size = texW * texH * bpp;
+    *codebook_skip = 0;
+    if (texBuf[PVR_HDR_SIZE - 7] == 0x03) {
+        txr_size = VQ_CODEBOOK_SIZE + ((texW * texH) / 4);
+    } else if (texBuf[PVR_HDR_SIZE - 7] == 0x10) {
+        const uint32_t codebook_size = pvr_small_vq_codebook_size(texW);
+        txr_size = codebook_size + ((texW * texH) / 4);
+        *codebook_skip = VQ_CODEBOOK_SIZE - codebook_size;
+    }
     *w = texW;
     *h = texH;
     *txrFormat = texFormat | texColor;
@@ -101,28 +129,32 @@ pvr_get_texture_size(const void* input, uint32_t* w, uint32_t* h, uint32_t* txrF
 pvr_ptr_t
 load_pvr_from_buffer_to_buffer(const void* input, uint32_t* w, uint32_t* h, uint32_t* txrFormat, void* buffer) {
     unsigned char* texBuf = (unsigned char*)input;
-    uint32_t txr_size = pvr_get_texture_size(input, w, h, txrFormat);
+    uint32_t codebook_skip;
+    uint32_t txr_size = pvr_get_texture_size(input, w, h, txrFormat, &codebook_skip);
 
     pvr_txr_load(texBuf + PVR_HDR_SIZE, (pvr_ptr_t)buffer, txr_size);
 
-    return buffer;
+    /* Entries before a small codebook are never read, so pointing below the buffer is fine */
+    return (pvr_ptr_t)((uintptr_t)buffer - codebook_skip);
 }
 
 pvr_ptr_t
 load_pvr_from_buffer(const void* input, uint32_t* w, uint32_t* h, uint32_t* txrFormat) {
     pvr_ptr_t rv;
     unsigned char* texBuf = (unsigned char*)input;
-    uint32_t txr_size = pvr_get_texture_size(input, w, h, txrFormat);
+    uint32_t codebook_skip;
+    uint32_t txr_size = pvr_get_texture_size(input, w, h, txrFormat, &codebook_skip);
 
     if (!txr_size) {
         return NULL;
     }
 
-    if (!(rv = pvr_mem_malloc(txr_size))) {
+    /* Allocate the full codebook for small VQ so the adjusted address stays inside our block */
+    if (!(rv = pvr_mem_malloc(txr_size + codebook_skip))) {
         printf("PVR: Couldn't allocate memory for texture!\n");
         return NULL;
     }
-    pvr_txr_load(texBuf + PVR_HDR_SIZE, rv, txr_size);
+    pvr_txr_load(texBuf + PVR_HDR_SIZE, (pvr_ptr_t)((uintptr_t)rv + codebook_skip), txr_size);
 
     return rv;
 }
@@ -130,7 +162,7 @@ load_pvr_from_buffer(const void* input, uint32_t* w, uint32_t* h, uint32_t* txrF
 void*
 pvr_get_internal_buffer(void) {
     if (!_internal_buf) {
-        _internal_buf = malloc(512 * 512 * 2);
+        _internal_buf = malloc(DAT_MAX_ITEM_SIZE);
         if (!_internal_buf) {
             printf("%s no free memory\n", __func__);
             return NULL;
@@ -0,0 +1,996 @@
+/*
+ * File: draw_batch.c
+ * Project: ui
+ * -----
+ * Quad batching and state sorting for the KOS draw backend
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <arch/timer.h>
+#include <dc/pvr.h>
+
+#include "ui/draw_prototypes.h"
+
+#include "ui/draw_batch.h"
+#include "ui/draw_trace.h"
+#include "ui/text_cache.h"
+
+#define BATCH_MAX_QUADS    (256)
+#define BATCH_MAX_STATES   (32)
+#define BATCH_STREAM_QUADS (32) /* quads of vertices handed to pvr_prim at once */
+#define BATCH_STATS_EVERY  (60 * 10) /* OPENMENU_PROFILE builds print the stats this often */
+#define HEADER_CACHE_SIZE  (64) /* direct mapped, power of two */
+#define LAYER_MAX_SIZE     (128 * 1024)
+#define EVICT_LOG_SIZE     (32) /* invalidations a retained layer can be checked against */
+#define GLYPH_MAX_VERTS    (1024 * DRAW_TEXT_VERT_PER_CHAR) /* one frame's worth of text usually fits */
+#define GLYPH_MAX_RUNS     (64)
+#define TEXT_CHUNK_VERTS   (128 * DRAW_TEXT_VERT_PER_CHAR) /* room reserved at a time while laying out */
+
+#if defined(DRAW_SUBMIT_DR) && defined(DRAW_SUBMIT_RECORD)
+#error "Pick one of DRAW_SUBMIT_DR and DRAW_SUBMIT_RECORD"
+#elif defined(DRAW_SUBMIT_DR)
+#define DRAW_SUBMIT_NAME "dr"
+#elif defined(DRAW_SUBMIT_RECORD)
+#define DRAW_SUBMIT_NAME "record"
+#else
+#define DRAW_SUBMIT_NAME "prim"
+#endif
+
+/* Everything that needs a new header when it changes */
+typedef struct batch_state {
+    pvr_ptr_t texture; /* NULL for untextured */
+    uint32_t format;
+    uint32_t width, height;
+    int filter;
+    uint32_t color; /* untextured sprites carry their color in the header */
+} batch_state;
+
+typedef struct batch_quad {
+    float x1, y1, x2, y2, z;
+    float u1, v1, u2, v2;
+    uint32_t color;
+    int state;
+} batch_quad;
+
+typedef struct header_entry {
+    batch_state key;
+    int list;
+    int valid;
+    draw_hdr_t header;
+} header_entry;
+
+static header_entry header_cache[HEADER_CACHE_SIZE];
+
+static batch_state states[BATCH_MAX_STATES];
+static int state_count;
+static batch_quad quads[BATCH_MAX_QUADS];
+static int quad_count;
+static int batch_list;
+
+static draw_batch_stats frame_stats;
+static draw_batch_stats last_stats;
+#ifdef OPENMENU_PROFILE
+static unsigned int batch_frame;
+#endif
+
+/* Glyph runs, text from both fonts waiting for the list. Consecutive glyphs with the same font
+ * texture and filter share a run, and a header, sprites also need the same color. */
+typedef struct glyph_run {
+    batch_state state;
+    unsigned int first, count; /* vertices in glyph_verts */
+} glyph_run;
+
+static draw_text_vert_t glyph_verts[GLYPH_MAX_VERTS] __attribute__((aligned(32)));
+static unsigned int glyph_vert_count;
+static unsigned int glyph_reserved; /* vertices handed out by the last reserve, not yet committed */
+static glyph_run glyph_runs[GLYPH_MAX_RUNS];
+static int glyph_run_count;
+static int glyph_list;
+
+/* Text being laid out by draw_text_glyph, written straight into glyph_verts */
+static const image* text_font;
+static int text_filter;
+static uint32_t text_color;
+static float text_z;
+static text_layout* text_record;
+static int text_record_only; /* glyphs are recorded but not drawn */
+static draw_text_vert_t* text_verts;
+static unsigned int text_count;
+
+/* Layer being recorded, everything submitted goes into it instead of the TA */
+static draw_layer* recording;
+
+/* Bumped whenever a texture address may have been reused. The last EVICT_LOG_SIZE textures are
+ * kept, so a retained layer built before only goes stale when one of them is a texture it uses */
+typedef struct evict_entry {
+    pvr_ptr_t texture;
+    int all; /* every texture at once */
+} evict_entry;
+
+static evict_entry evict_log[EVICT_LOG_SIZE];
+static unsigned int layer_generation = 1;
+
+static int
+batch_find_state(const batch_state* state) {
+    /* Newest first, consecutive draws usually share state */
+    for (int i = state_count - 1; i >= 0; i--) {
+        if (!memcmp(&states[i], state, sizeof(*state))) {
+            return i;
+        }
+    }
+    if (state_count == BATCH_MAX_STATES) {
+        return -1;
+    }
+    states[state_count] = *state;
+    return state_count++;
+}
+
+static void
+header_compile(draw_hdr_t* header, int list, const batch_state* key) {
+#ifdef KOS_SPRITE
+    pvr_sprite_cxt_t context;
+
+    if (key->texture) {
+        pvr_sprite_cxt_txr(&context, list, key->format, key->width, key->height, key->texture, key->filter);
+    } else {
+        pvr_sprite_cxt_col(&context, list);
+    }
+    pvr_sprite_compile(header, &context);
+#else
+    pvr_poly_cxt_t context;
+
+    if (key->texture) {
+        pvr_poly_cxt_txr(&context, list, key->format, key->width, key->height, key->texture, key->filter);
+    } else {
+        pvr_poly_cxt_col(&context, list);
+    }
+    pvr_poly_compile(header, &context);
+#endif
+    frame_stats.header_compiles++;
+}
+
+/* key color is ignored, callers patch it into their copy */
+static const draw_hdr_t*
+header_lookup(int list, const batch_state* key) {
+    const unsigned int hash = ((uintptr_t)key->texture >> 5) ^ key->format ^ key->width ^ (list << 3) ^ key->filter;
+    header_entry* entry = &header_cache[hash & (HEADER_CACHE_SIZE - 1)];
+
+    if (!entry->valid || entry->list != list || entry->key.texture != key->texture
+        || entry->key.format != key->format || entry->key.width != key->width || entry->key.height != key->height
+        || entry->key.filter != key->filter) {
+        entry->key = *key;
+        entry->list = list;
+        entry->valid = 1;
+        header_compile(&entry->header, list, key);
+    }
+    return &entry->header;
+}
+
+void
+draw_header_get(draw_hdr_t* header, int list, const image* img, int filter) {
+    batch_state key;
+
+    memset(&key, 0, sizeof(key));
+    if (img) {
+        key.texture = img->texture;
+        key.format = img->format;
+        key.width = img->width;
+        key.height = img->height;
+        key.filter = filter;
+    }
+    *header = *header_lookup(list, &key);
+}
+
+void
+draw_header_invalidate(pvr_ptr_t texture) {
+    layer_generation++;
+    evict_log[layer_generation % EVICT_LOG_SIZE] = (evict_entry){texture, 0};
+    for (int i = 0; i < HEADER_CACHE_SIZE; i++) {
+        if (header_cache[i].key.texture == texture) {
+            header_cache[i].valid = 0;
+        }
+    }
+}
+
+void
+draw_header_invalidate_all(void) {
+    layer_generation++;
+    evict_log[layer_generation % EVICT_LOG_SIZE] = (evict_entry){NULL, 1};
+    for (int i = 0; i < HEADER_CACHE_SIZE; i++) {
+        header_cache[i].valid = 0;
+    }
+}
+
+/* Vertex submission backends behind submit_begin/header/quad/end, picked at build time so they
+ * can be compared on the frame stats. The default queues vertices in ram and hands them to pvr_prim
+ * in blocks, DRAW_SUBMIT_DR writes each one straight into the store queues with direct render.
+ * DRAW_SUBMIT_RECORD takes the default path but sends the blocks to draw_trace instead of the PVR. */
+#ifndef KOS_SPRITE
+static inline void
+batch_set_vertex(pvr_vertex_t* vert, uint32_t flags, float x, float y, float u, float v, const batch_quad* quad) {
+    vert->flags = flags;
+    vert->x = x;
+    vert->y = y;
+    vert->z = quad->z;
+    vert->u = u;
+    vert->v = v;
+    vert->argb = quad->color;
+    vert->oargb = 0;
+}
+#endif
+
+#ifdef KOS_SPRITE
+typedef union batch_vert {
+    pvr_sprite_txr_t txr;
+    pvr_sprite_col_t col;
+} batch_vert;
+#define VERT_PER_QUAD (1)
+#else
+typedef pvr_vertex_t batch_vert;
+#define VERT_PER_QUAD (4)
+#endif
+
+/* Writes a quad's vertices to ram, used for pvr_prim and for recording layers */
+static void
+batch_build_quad(batch_vert* vert, const batch_quad* quad) {
+#ifdef KOS_SPRITE
+    if (states[quad->state].texture) {
+        vert->txr = (pvr_sprite_txr_t){
+            .flags = PVR_CMD_VERTEX_EOL,
+            /*  upper left */
+            .ax = quad->x1,
+            .ay = quad->y1,
+            .az = quad->z,
+            /* upper right */
+            .bx = quad->x2,
+            .by = quad->y1,
+            .bz = quad->z,
+            /* lower left */
+            .cx = quad->x2,
+            .cy = quad->y2,
+            .cz = quad->z,
+            /* interpolated */
+            .dx = quad->x1,
+            .dy = quad->y2,
+            .auv = PVR_PACK_16BIT_UV(quad->u1, quad->v1),
+            .buv = PVR_PACK_16BIT_UV(quad->u2, quad->v1),
+            .cuv = PVR_PACK_16BIT_UV(quad->u2, quad->v2),
+        };
+    } else {
+        vert->col = (pvr_sprite_col_t){
+            .flags = PVR_CMD_VERTEX_EOL,
+            .ax = quad->x1,
+            .ay = quad->y1,
+            .az = quad->z,
+            .bx = quad->x2,
+            .by = quad->y1,
+            .bz = quad->z,
+            .cx = quad->x2,
+            .cy = quad->y2,
+            .cz = quad->z,
+            .dx = quad->x1,
+            .dy = quad->y2,
+        };
+    }
+#else
+    /* Strip order: lower left, upper left, lower right, upper right */
+    batch_set_vertex(&vert[0], PVR_CMD_VERTEX, quad->x1, quad->y2, quad->u1, quad->v2, quad);
+    batch_set_vertex(&vert[1], PVR_CMD_VERTEX, quad->x1, quad->y1, quad->u1, quad->v1, quad);
+    batch_set_vertex(&vert[2], PVR_CMD_VERTEX, quad->x2, quad->y2, quad->u2, quad->v2, quad);
+    batch_set_vertex(&vert[3], PVR_CMD_VERTEX_EOL, quad->x2, quad->y1, quad->u2, quad->v1, quad);
+#endif
+}
+
+/* Everything outside direct render reaches the PVR through here */
+static inline void
+batch_prim(const void* data, unsigned int size) {
+#ifdef DRAW_SUBMIT_RECORD
+    draw_trace_submit(draw_get_list(), data, size);
+#else
+    pvr_prim((void*)data, size);
+#endif
+}
+
+#ifdef DRAW_SUBMIT_DR
+#ifdef KOS_SPRITE
+#error "DRAW_SUBMIT_DR only writes polygon vertices, build without KOS_SPRITE"
+#endif
+
+static pvr_dr_state_t dr_state;
+
+static void
+submit_begin(void) {
+    /* pvr_prim from the fonts may have moved the store queues since the last flush */
+    pvr_dr_init(&dr_state);
+}
+
+static void
+submit_header(const draw_hdr_t* header) {
+    pvr_poly_hdr_t* target = (pvr_poly_hdr_t*)pvr_dr_target(dr_state);
+    *target = *header;
+    pvr_dr_commit(target);
+}
+
+/* Strip order: lower left, upper left, lower right, upper right */
+static void
+submit_quad(const batch_quad* quad) {
+    pvr_vertex_t* vert;
+
+    vert = pvr_dr_target(dr_state);
+    batch_set_vertex(vert, PVR_CMD_VERTEX, quad->x1, quad->y2, quad->u1, quad->v2, quad);
+    pvr_dr_commit(vert);
+
+    vert = pvr_dr_target(dr_state);
+    batch_set_vertex(vert, PVR_CMD_VERTEX, quad->x1, quad->y1, quad->u1, quad->v1, quad);
+    pvr_dr_commit(vert);
+
+    vert = pvr_dr_target(dr_state);
+    batch_set_vertex(vert, PVR_CMD_VERTEX, quad->x2, quad->y2, quad->u2, quad->v2, quad);
+    pvr_dr_commit(vert);
+
+    vert = pvr_dr_target(dr_state);
+    batch_set_vertex(vert, PVR_CMD_VERTEX_EOL, quad->x2, quad->y1, quad->u2, quad->v1, quad);
+    pvr_dr_commit(vert);
+}
+
+static void
+submit_end(void) {
+    pvr_dr_finish();
+}
+#else
+static batch_vert vertbuf[BATCH_STREAM_QUADS * VERT_PER_QUAD] __attribute__((aligned(32)));
+static int vertbuffered;
+
+static void
+submit_vertices(void) {
+    if (vertbuffered) {
+        batch_prim(vertbuf, vertbuffered * sizeof(vertbuf[0]));
+        vertbuffered = 0;
+    }
+}
+
+static void
+submit_begin(void) {
+    vertbuffered = 0;
+}
+
+static void
+submit_header(const draw_hdr_t* header) {
+    submit_vertices();
+    batch_prim(header, sizeof(*header));
+}
+
+static void
+submit_quad(const batch_quad* quad) {
+    if (vertbuffered == BATCH_STREAM_QUADS * VERT_PER_QUAD) {
+        submit_vertices();
+    }
+    batch_build_quad(&vertbuf[vertbuffered], quad);
+    vertbuffered += VERT_PER_QUAD;
+}
+
+static void
+submit_end(void) {
+    submit_vertices();
+}
+#endif
+
+static void
+layer_append(const void* data, unsigned int size) {
+    draw_layer* layer = recording;
+
+    if (layer->overflow) {
+        batch_prim(data, size);
+        return;
+    }
+    if (layer->size + size > layer->capacity) {
+        unsigned int capacity = layer->capacity ? layer->capacity * 2 : 1024;
+        while (capacity < layer->size + size) {
+            capacity *= 2;
+        }
+        void* grown = (capacity <= LAYER_MAX_SIZE) ? realloc(layer->data, capacity) : NULL;
+        if (!grown) {
+            /* Too big to retain, send what we have and pass the rest straight through */
+            printf("%s layer over %u bytes, drawing it directly\n", __func__, LAYER_MAX_SIZE);
+            if (layer->size) {
+                batch_prim(layer->data, layer->size);
+            }
+            batch_prim(data, size);
+            layer->overflow = 1;
+            return;
+        }
+        layer->data = grown;
+        layer->capacity = capacity;
+    }
+    memcpy((uint8_t*)layer->data + layer->size, data, size);
+    layer->size += size;
+}
+
+/* Notes a texture the recording layer's headers point at */
+static void
+layer_use_texture(pvr_ptr_t texture) {
+    draw_layer* layer = recording;
+
+    if (!layer || !texture || layer->texture_count > DRAW_LAYER_TEXTURES) {
+        return;
+    }
+    for (int i = 0; i < layer->texture_count; i++) {
+        if (layer->textures[i] == texture) {
+            return;
+        }
+    }
+    if (layer->texture_count == DRAW_LAYER_TEXTURES) {
+        /* Too many to track, any invalidation makes it stale */
+        layer->texture_count++;
+        return;
+    }
+    layer->textures[layer->texture_count++] = texture;
+}
+
+static int
+layer_uses_texture(const draw_layer* layer, pvr_ptr_t texture) {
+    if (layer->texture_count > DRAW_LAYER_TEXTURES) {
+        return 1;
+    }
+    for (int i = 0; i < layer->texture_count; i++) {
+        if (layer->textures[i] == texture) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Whether a texture the layer uses was invalidated since it was last checked */
+static int
+layer_stale(const draw_layer* layer) {
+    const unsigned int missed = layer_generation - layer->generation;
+
+    if (missed > EVICT_LOG_SIZE) {
+        return 1;
+    }
+    for (unsigned int i = 1; i <= missed; i++) {
+        const evict_entry* entry = &evict_log[(layer->generation + i) % EVICT_LOG_SIZE];
+        if (entry->all || layer_uses_texture(layer, entry->texture)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void
+batch_emit_header(const batch_state* state) {
+    const draw_hdr_t* header = header_lookup(batch_list, state);
+#ifdef KOS_SPRITE
+    /* Untextured sprites take their color from the header */
+    draw_hdr_t colored;
+    if (!state->texture) {
+        colored = *header;
+        colored.argb = state->color;
+        header = &colored;
+    }
+#endif
+    if (recording) {
+        layer_use_texture(state->texture);
+        layer_append(header, sizeof(*header));
+    } else {
+        submit_header(header);
+    }
+    frame_stats.headers++;
+}
+
+static void
+batch_stream_quad(const batch_quad* quad) {
+    if (recording) {
+        batch_vert vert[VERT_PER_QUAD];
+        batch_build_quad(vert, quad);
+        layer_append(vert, sizeof(vert));
+    } else {
+        submit_quad(quad);
+    }
+    frame_stats.quads++;
+}
+
+/* Into the recording layer if there is one, else to the list */
+static void
+batch_write(const void* data, unsigned int size) {
+    if (recording) {
+        layer_append(data, size);
+    } else {
+        batch_prim(data, size);
+    }
+}
+
+static void
+glyph_flush(void) {
+    for (int i = 0; i < glyph_run_count; i++) {
+        const glyph_run* run = &glyph_runs[i];
+        if (!run->count) {
+            continue;
+        }
+        const draw_hdr_t* header = header_lookup(glyph_list, &run->state);
+#ifdef KOS_SPRITE
+        /* Sprites take their color from the header */
+        draw_hdr_t colored = *header;
+        colored.argb = run->state.color;
+        header = &colored;
+#endif
+        layer_use_texture(run->state.texture);
+        batch_write(header, sizeof(*header));
+        batch_write(&glyph_verts[run->first], run->count * sizeof(glyph_verts[0]));
+        frame_stats.headers++;
+        frame_stats.glyphs += run->count / DRAW_TEXT_VERT_PER_CHAR;
+        frame_stats.glyph_runs++;
+    }
+    glyph_vert_count = 0;
+    glyph_run_count = 0;
+}
+
+/* Room for count vertices at the end of the current run, count up to GLYPH_MAX_VERTS always fits.
+ * Nothing else may be drawn before the matching commit */
+static draw_text_vert_t*
+glyph_reserve(const image* img, int filter, uint32_t color, unsigned int count) {
+    batch_state state;
+    const int list = draw_get_list();
+
+    /* Quads queued before this text have to reach the list first */
+    if (quad_count) {
+        draw_batch_flush();
+    }
+    if (glyph_run_count
+        && (list != glyph_list || glyph_vert_count + count > GLYPH_MAX_VERTS || glyph_run_count == GLYPH_MAX_RUNS)) {
+        glyph_flush();
+    }
+    glyph_list = list;
+
+    memset(&state, 0, sizeof(state));
+    state.texture = img->texture;
+    state.format = img->format;
+    state.width = img->width;
+    state.height = img->height;
+    state.filter = filter;
+#ifdef KOS_SPRITE
+    state.color = color;
+#else
+    (void)color; /* carried by each vertex */
+#endif
+
+    glyph_run* run = glyph_run_count ? &glyph_runs[glyph_run_count - 1] : NULL;
+    if (!run || memcmp(&run->state, &state, sizeof(state))) {
+        run = &glyph_runs[glyph_run_count++];
+        run->state = state;
+        run->first = glyph_vert_count;
+        run->count = 0;
+    }
+    glyph_reserved = count;
+    return &glyph_verts[glyph_vert_count];
+}
+
+static void
+glyph_commit(unsigned int count) {
+    if (count > glyph_reserved) {
+        count = glyph_reserved;
+    }
+    glyph_runs[glyph_run_count - 1].count += count;
+    glyph_vert_count += count;
+    glyph_reserved = 0;
+}
+
+void
+draw_glyphs(const image* img, int filter, uint32_t color, const draw_text_vert_t* verts, unsigned int count) {
+    while (count) {
+        const unsigned int chunk = count < GLYPH_MAX_VERTS ? count : GLYPH_MAX_VERTS;
+        draw_text_vert_t* dst = glyph_reserve(img, filter, color, chunk);
+        memcpy(dst, verts, chunk * sizeof(*dst));
+        glyph_commit(chunk);
+        verts += chunk;
+        count -= chunk;
+    }
+}
+
+void
+draw_glyph_uv_set(draw_glyph_uv* uv, float u1, float v1, float u2, float v2) {
+#ifdef KOS_SPRITE
+    uv->a = PVR_PACK_16BIT_UV(u1, v1);
+    uv->b = PVR_PACK_16BIT_UV(u2, v1);
+    uv->c = PVR_PACK_16BIT_UV(u2, v2);
+#else
+    uv->u1 = u1;
+    uv->v1 = v1;
+    uv->u2 = u2;
+    uv->v2 = v2;
+#endif
+}
+
+static void
+draw_glyph_uv_get(const draw_glyph_uv* uv, float* u1, float* v1, float* u2, float* v2) {
+#ifdef KOS_SPRITE
+    /* Packed UVs are the upper halves of the floats */
+    union {
+        uint32_t bits;
+        float value;
+    } unpack;
+    unpack.bits = uv->a & 0xFFFF0000;
+    *u1 = unpack.value;
+    unpack.bits = uv->a << 16;
+    *v1 = unpack.value;
+    unpack.bits = uv->c & 0xFFFF0000;
+    *u2 = unpack.value;
+    unpack.bits = uv->c << 16;
+    *v2 = unpack.value;
+#else
+    *u1 = uv->u1;
+    *v1 = uv->v1;
+    *u2 = uv->u2;
+    *v2 = uv->v2;
+#endif
+}
+
+static void
+text_chunk_begin(void) {
+    text_verts = glyph_reserve(text_font, text_filter, text_color, TEXT_CHUNK_VERTS);
+    text_count = 0;
+}
+
+static void
+text_chunk_end(void) {
+    text_layout_record(text_record, text_verts, text_count);
+    glyph_commit(text_record_only ? 0 : text_count);
+}
+
+void
+draw_text_begin(const image* font, int filter, uint32_t color, float z, text_layout* record) {
+    text_font = font;
+    text_filter = filter;
+    text_color = color;
+    text_z = z;
+    text_record = record;
+    text_record_only = 0;
+    text_chunk_begin();
+}
+
+void
+draw_text_layout_begin(const image* font, int filter, uint32_t color, float z, text_layout* record) {
+    draw_text_begin(font, filter, color, z, record);
+    text_record_only = 1;
+}
+
+void
+draw_text_glyph(float x1, float y1, float x2, float y2, const draw_glyph_uv* uv) {
+    if (text_count == TEXT_CHUNK_VERTS) {
+        text_chunk_end();
+        text_chunk_begin();
+    }
+
+#ifdef KOS_SPRITE
+    pvr_sprite_txr_t* vert = &text_verts[text_count];
+    vert->flags = PVR_CMD_VERTEX_EOL;
+    /*  upper left */
+    vert->ax = x1;
+    vert->ay = y1;
+    vert->az = text_z;
+    /* upper right */
+    vert->bx = x2;
+    vert->by = y1;
+    vert->bz = text_z;
+    /* lower left */
+    vert->cx = x2;
+    vert->cy = y2;
+    vert->cz = text_z;
+    /* interpolated */
+    vert->dx = x1;
+    vert->dy = y2;
+    vert->auv = uv->a;
+    vert->buv = uv->b;
+    vert->cuv = uv->c;
+#else
+    /* Strip order: lower left, upper left, lower right, upper right */
+    pvr_vertex_t* vert = &text_verts[text_count];
+    vert[0].flags = PVR_CMD_VERTEX;
+    vert[0].x = x1;
+    vert[0].y = y2;
+    vert[0].z = text_z;
+    vert[0].u = uv->u1;
+    vert[0].v = uv->v2;
+    vert[0].argb = text_color;
+    vert[0].oargb = 0;
+
+    vert[1].flags = PVR_CMD_VERTEX;
+    vert[1].x = x1;
+    vert[1].y = y1;
+    vert[1].z = text_z;
+    vert[1].u = uv->u1;
+    vert[1].v = uv->v1;
+    vert[1].argb = text_color;
+    vert[1].oargb = 0;
+
+    vert[2].flags = PVR_CMD_VERTEX;
+    vert[2].x = x2;
+    vert[2].y = y2;
+    vert[2].z = text_z;
+    vert[2].u = uv->u2;
+    vert[2].v = uv->v2;
+    vert[2].argb = text_color;
+    vert[2].oargb = 0;
+
+    vert[3].flags = PVR_CMD_VERTEX_EOL;
+    vert[3].x = x2;
+    vert[3].y = y1;
+    vert[3].z = text_z;
+    vert[3].u = uv->u2;
+    vert[3].v = uv->v1;
+    vert[3].argb = text_color;
+    vert[3].oargb = 0;
+#endif
+    text_count += DRAW_TEXT_VERT_PER_CHAR;
+}
+
+void
+draw_text_glyph_clipped(float x1, float y1, float x2, float y2, const draw_glyph_uv* uv, float clip_x1,
+                        float clip_x2) {
+    if (x1 >= clip_x1 && x2 <= clip_x2) {
+        draw_text_glyph(x1, y1, x2, y2, uv);
+        return;
+    }
+    if (x2 <= clip_x1 || x1 >= clip_x2) {
+        return;
+    }
+
+    float u1, v1, u2, v2;
+    draw_glyph_uv_get(uv, &u1, &v1, &u2, &v2);
+    const float u_per_x = (u2 - u1) / (x2 - x1);
+    if (x1 < clip_x1) {
+        u1 += (clip_x1 - x1) * u_per_x;
+        x1 = clip_x1;
+    }
+    if (x2 > clip_x2) {
+        u2 -= (x2 - clip_x2) * u_per_x;
+        x2 = clip_x2;
+    }
+
+    draw_glyph_uv clipped;
+    draw_glyph_uv_set(&clipped, u1, v1, u2, v2);
+    draw_text_glyph(x1, y1, x2, y2, &clipped);
+}
+
+void
+draw_text_end(void) {
+    text_chunk_end();
+    text_record = NULL;
+    text_record_only = 0;
+}
+
+void
+draw_glyphs_clipped(const image* img, int filter, uint32_t color, float z, const draw_text_vert_t* verts,
+                    unsigned int count, float dx, float dy, float clip_x1, float clip_x2) {
+    draw_glyph_uv uv;
+
+    draw_text_begin(img, filter, color, z, NULL);
+    for (unsigned int i = 0; i < count; i += DRAW_TEXT_VERT_PER_CHAR) {
+        const draw_text_vert_t* vert = &verts[i];
+#ifdef KOS_SPRITE
+        const float x1 = vert->ax + dx, y1 = vert->ay + dy, x2 = vert->cx + dx, y2 = vert->cy + dy;
+        uv.a = vert->auv;
+        uv.b = vert->buv;
+        uv.c = vert->cuv;
+#else
+        /* Upper left and lower right corners of the strip */
+        const float x1 = vert[1].x + dx, y1 = vert[1].y + dy, x2 = vert[2].x + dx, y2 = vert[2].y + dy;
+        uv.u1 = vert[1].u;
+        uv.v1 = vert[1].v;
+        uv.u2 = vert[2].u;
+        uv.v2 = vert[2].v;
+#endif
+        if (x2 <= clip_x1) {
+            continue;
+        }
+        if (x1 >= clip_x2) {
+            break;
+        }
+        draw_text_glyph_clipped(x1, y1, x2, y2, &uv, clip_x1, clip_x2);
+    }
+    draw_text_end();
+}
+
+void
+draw_batch_quad(const image* img, float x1, float y1, float x2, float y2, float z, float u1, float v1, float u2,
+                float v2, uint32_t color) {
+    batch_state state;
+    const int list = draw_get_list();
+
+    /* States are compared with memcmp, keep the padding clear */
+    memset(&state, 0, sizeof(state));
+
+    if (img) {
+        state.texture = img->texture;
+        state.format = img->format;
+        state.width = img->width;
+        state.height = img->height;
+        state.filter = PVR_FILTER_BILINEAR;
+    }
+#ifdef KOS_SPRITE
+    else {
+        state.color = color;
+    }
+#endif
+
+    /* Text queued before this quad goes first */
+    if (glyph_run_count) {
+        glyph_flush();
+    }
+    if (quad_count && (list != batch_list || quad_count == BATCH_MAX_QUADS)) {
+        draw_batch_flush();
+    }
+    batch_list = list;
+
+    int state_num = batch_find_state(&state);
+    if (state_num == -1) {
+        draw_batch_flush();
+        state_num = batch_find_state(&state);
+    }
+
+    quads[quad_count++] = (batch_quad){.x1 = x1,
+                                       .y1 = y1,
+                                       .x2 = x2,
+                                       .y2 = y2,
+                                       .z = z,
+                                       .u1 = u1,
+                                       .v1 = v1,
+                                       .u2 = u2,
+                                       .v2 = v2,
+                                       .color = color,
+                                       .state = state_num};
+}
+
+void
+draw_batch_flush(void) {
+    /* At most one of text and quads is queued, each flushes the other when it starts */
+    if (glyph_run_count) {
+        glyph_flush();
+    }
+    if (!quad_count) {
+        state_count = 0;
+        return;
+    }
+
+    const uint64_t start_us = timer_us_gettime64();
+    if (!recording) {
+        submit_begin();
+    }
+
+    if (batch_list == PVR_LIST_OP_POLY) {
+        /* Depth test sorts opaque polys for us, so every quad of a state goes under one header */
+        for (int s = 0; s < state_count; s++) {
+            batch_emit_header(&states[s]);
+            for (int i = 0; i < quad_count; i++) {
+                if (quads[i].state == s) {
+                    batch_stream_quad(&quads[i]);
+                }
+            }
+        }
+    } else {
+        /* Translucent polys blend in submission order, only merge neighbours */
+        int current = -1;
+        for (int i = 0; i < quad_count; i++) {
+            if (quads[i].state != current) {
+                current = quads[i].state;
+                batch_emit_header(&states[current]);
+            }
+            batch_stream_quad(&quads[i]);
+        }
+    }
+    if (!recording) {
+        submit_end();
+    }
+
+    quad_count = 0;
+    state_count = 0;
+    frame_stats.flushes++;
+    frame_stats.submit_us += (unsigned int)(timer_us_gettime64() - start_us);
+}
+
+void
+draw_batch_frame_end(void) {
+    last_stats = frame_stats;
+    memset(&frame_stats, 0, sizeof(frame_stats));
+
+#ifdef OPENMENU_PROFILE
+    if (!(++batch_frame % BATCH_STATS_EVERY)) {
+        printf("DRAW: %s quads=%u headers=%u (%u compiled) flushes=%u submit=%uus per frame\n", DRAW_SUBMIT_NAME,
+               last_stats.quads, last_stats.headers, last_stats.header_compiles, last_stats.flushes,
+               last_stats.submit_us);
+        printf("DRAW: layers replayed=%u (%u bytes) rebuilt=%u\n", last_stats.layer_replays, last_stats.layer_bytes,
+               last_stats.layer_builds);
+        printf("DRAW: glyphs=%u in %u runs\n", last_stats.glyphs, last_stats.glyph_runs);
+    }
+#endif
+#ifdef DRAW_SUBMIT_RECORD
+    draw_trace_frame_end();
+#endif
+}
+
+void
+draw_batch_get_stats(draw_batch_stats* last_frame) {
+    *last_frame = last_stats;
+}
+
+void
+draw_prim(const void* data, int size) {
+    if (recording) {
+        /* Headers in raw writes can point at any texture */
+        recording->texture_count = DRAW_LAYER_TEXTURES + 1;
+    }
+    batch_write(data, size);
+}
+
+uint32_t
+draw_layer_hash(uint32_t hash, const void* data, unsigned int size) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    /* FNV-1a */
+    for (unsigned int i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+int
+draw_layer_begin(draw_layer* layer, uint32_t key) {
+    /* Whatever came before this layer goes out first */
+    draw_batch_flush();
+
+    if (layer->valid && layer->key == key && layer->list == draw_get_list() && layer->z_begin == z_get()
+        && !layer_stale(layer)) {
+        layer->generation = layer_generation;
+        draw_layer_replay(layer);
+        return 0;
+    }
+
+    layer->valid = 0;
+    layer->overflow = 0;
+    layer->size = 0;
+    layer->key = key;
+    layer->generation = layer_generation;
+    layer->texture_count = 0;
+    layer->list = draw_get_list();
+    layer->z_begin = z_get();
+    recording = layer;
+    frame_stats.layer_builds++;
+    return 1;
+}
+
+void
+draw_layer_end(draw_layer* layer) {
+    draw_batch_flush();
+    recording = NULL;
+
+    layer->z_end = z_get();
+    if (layer->overflow) {
+        /* Already drawn while recording */
+        layer->size = 0;
+        return;
+    }
+    layer->valid = 1;
+    draw_layer_replay(layer);
+}
+
+void
+draw_layer_replay(const draw_layer* layer) {
+    if (!layer->valid || layer->list != draw_get_list()) {
+        return;
+    }
+    draw_batch_flush();
+    if (layer->size) {
+        batch_prim(layer->data, layer->size);
+    }
+    /* Later draws have to land in front of the baked depths just like when it was recorded */
+    z_set(layer->z_end);
+    frame_stats.layer_replays++;
+    frame_stats.layer_bytes += layer->size;
+}
+
+void
+draw_layer_invalidate(draw_layer* layer) {
+    layer->valid = 0;
+}
@@ -0,0 +1,127 @@
+/*
+ * File: draw_batch.h
+ * Project: ui
+ * -----
+ * Quad batching and state sorting for the KOS draw backend
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "dc/pvr_texture.h"
+
+/* Quad batching for draw_kos. Quads are queued with their render state and submitted grouped by
+ * state, one header per group. Opaque quads are sorted by state since the depth buffer keeps them
+ * correct, translucent quads keep submission order (autosort is off) and only merge neighbours. */
+
+typedef struct draw_batch_stats {
+    unsigned int quads;           /* quads submitted */
+    unsigned int headers;         /* polygon headers submitted */
+    unsigned int flushes;         /* times the queue was emptied */
+    unsigned int header_compiles; /* headers built from scratch, the rest came from the cache */
+    unsigned int submit_us;       /* time spent writing headers and vertices to the TA */
+    unsigned int layer_replays;   /* retained layers submitted from their recording */
+    unsigned int layer_bytes;     /* bytes submitted by those replays */
+    unsigned int layer_builds;    /* retained layers recorded again */
+    unsigned int glyphs;          /* characters submitted by the fonts */
+    unsigned int glyph_runs;      /* headers those needed */
+} draw_batch_stats;
+
+#ifdef KOS_SPRITE
+typedef pvr_sprite_hdr_t draw_hdr_t;
+typedef pvr_sprite_txr_t draw_text_vert_t;
+#define DRAW_TEXT_VERT_PER_CHAR (1)
+#else
+typedef pvr_poly_hdr_t draw_hdr_t;
+typedef pvr_vertex_t draw_text_vert_t;
+#define DRAW_TEXT_VERT_PER_CHAR (4)
+#endif
+
+/* Queues one quad, img NULL draws untextured in color */
+void draw_batch_quad(const image* img, float x1, float y1, float x2, float y2, float z, float u1, float v1, float u2,
+                     float v2, uint32_t color);
+
+/* Text: both fonts lay glyphs out into one buffer shared for the whole frame. Consecutive text
+ * with the same font texture and filter goes out under one header. Color and depth are set per
+ * run with draw_text_begin and scale is already applied to the positions, so strings of different
+ * colors and sizes still share a run (sprites carry color in the header and split on it). Text
+ * is only submitted once a quad, a list change or a flush needs the list.
+ *
+ * Between begin and end nothing else may be drawn. record, when not NULL, receives a copy of
+ * every vertex for the layout cache. */
+struct text_layout;
+
+typedef struct draw_glyph_uv {
+#ifdef KOS_SPRITE
+    uint32_t a, b, c; /* packed upper left, upper right, lower right */
+#else
+    float u1, v1, u2, v2;
+#endif
+} draw_glyph_uv;
+
+void draw_glyph_uv_set(draw_glyph_uv* uv, float u1, float v1, float u2, float v2);
+
+void draw_text_begin(const image* font, int filter, uint32_t color, float z, struct text_layout* record);
+/* Same, but the glyphs only go to record and nothing is drawn */
+void draw_text_layout_begin(const image* font, int filter, uint32_t color, float z, struct text_layout* record);
+void draw_text_glyph(float x1, float y1, float x2, float y2, const draw_glyph_uv* uv);
+/* Same, trimmed to clip_x1..clip_x2 by moving the edges and their texture coordinates */
+void draw_text_glyph_clipped(float x1, float y1, float x2, float y2, const draw_glyph_uv* uv, float clip_x1,
+                             float clip_x2);
+void draw_text_end(void);
+
+/* Adds vertices laid out earlier, draw_text_begin rules apply to the arguments */
+void draw_glyphs(const image* img, int filter, uint32_t color, const draw_text_vert_t* verts, unsigned int count);
+/* Same for a line laid out left to right, moved by dx, dy and trimmed to clip_x1..clip_x2, at depth z */
+void draw_glyphs_clipped(const image* img, int filter, uint32_t color, float z, const draw_text_vert_t* verts,
+                         unsigned int count, float dx, float dy, float clip_x1, float clip_x2);
+
+/* Submits everything queued. Must run before anything else writes to the current list */
+void draw_batch_flush(void);
+
+/* Compiled headers are cached by texture, format, size, list and filter. img NULL is untextured.
+ * Whoever reuses texture memory has to invalidate it first, a new texture at the same address with
+ * the same format would otherwise not be noticed by anything else. */
+void draw_header_get(draw_hdr_t* header, int list, const image* img, int filter);
+void draw_header_invalidate(pvr_ptr_t texture);
+void draw_header_invalidate_all(void);
+
+/* Retained layers: static parts of a screen are recorded once and replayed with one bulk submit.
+ *
+ *   if (draw_layer_begin(&layer, key)) {
+ *       ...draw as usual...
+ *       draw_layer_end(&layer);
+ *   }
+ *
+ * begin replays the recording and returns 0 while key, list and starting depth are unchanged and
+ * no texture it used was invalidated. Otherwise it returns 1 and records until end, which then
+ * replays. key should cover whatever the content depends on, draw_layer_hash helps build it. */
+#define DRAW_LAYER_TEXTURES (16)
+
+typedef struct draw_layer {
+    void* data;
+    unsigned int size, capacity;
+    uint32_t key;
+    unsigned int generation;
+    pvr_ptr_t textures[DRAW_LAYER_TEXTURES]; /* in its headers */
+    int texture_count;                       /* over DRAW_LAYER_TEXTURES when it lost track */
+    int list;
+    float z_begin, z_end;
+    int valid;
+    int overflow; /* too big to retain, drawn directly */
+} draw_layer;
+
+int draw_layer_begin(draw_layer* layer, uint32_t key);
+void draw_layer_end(draw_layer* layer);
+void draw_layer_replay(const draw_layer* layer);
+void draw_layer_invalidate(draw_layer* layer);
+uint32_t draw_layer_hash(uint32_t hash, const void* data, unsigned int size);
+#define DRAW_LAYER_HASH_INIT (2166136261u)
+
+/* Raw writes to the current list, recorded when a layer is being built. Flush the batch first */
+void draw_prim(const void* data, int size);
+
+/* Call once per frame after the scene is submitted */
+void draw_batch_frame_end(void);
+void draw_batch_get_stats(draw_batch_stats* last_frame);
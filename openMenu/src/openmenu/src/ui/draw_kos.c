@@ -13,6 +13,7 @@
 #include <stdio.h>
 
 #include <backend/dat_format.h>
+#include "ui/draw_batch.h"
 #include "ui/draw_prototypes.h"
 #include "ui/font_prototypes.h"
 
@@ -165,11 +166,29 @@ draw_draw_image(int x, int y, float width, float height, uint32_t color, void* u
     draw_draw_sub_image(x, y, width, height, color, user, &uv_01);
 }
 
+/* Textures the PVR can't address are skipped instead of drawn garbled */
+static int
+draw_texture_size_valid(const image* img) {
+    switch (img->width) {
+        case 8:
+        case 16:
+        case 32:
+        case 64:
+        case 128:
+        case 256:
+        case 512:
+        case 1024: return 1;
+        default: break;
+    }
+    printf("%s error tex size %ld %ld\n", __func__, img->width, img->height);
+    return 0;
+}
+
 void
 draw_draw_sub_image(int x, int y, float width, float height, uint32_t color, void* user, const dimen_RECT* rect) {
     image* img = (image*)user;
 
-    if (img == NULL || img->width == 0 || img->height == 0) {
+    if (img == NULL || img->width == 0 || img->height == 0 || !draw_texture_size_valid(img)) {
         return;
     }
 
@@ -185,96 +204,39 @@ draw_draw_sub_image(int x, int y, float width, float height, uint32_t color, voi
     const float u2 = (float)(rect->x + rect->w) / img->width;
     const float v2 = (float)(rect->y + rect->h) / img->height;
 
-    const float z = z_inc();
-
-#ifdef KOS_SPRITE
-    pvr_sprite_cxt_t context;
-    pvr_sprite_hdr_t header;
-
-    pvr_sprite_cxt_txr(&context, draw_get_list(), img->format, img->width, img->height, img->texture,
-                       PVR_FILTER_BILINEAR);
-    pvr_sprite_compile(&header, &context);
-
-    pvr_prim(&header, sizeof(header));
-
-    pvr_sprite_txr_t vert = {
-        .flags = PVR_CMD_VERTEX_EOL, /* Always? */
-        /*  upper left */
-        .ax = x1,
-        .ay = y1,
-        .az = z,
-        /* upper right */
-        .bx = x2,
-        .by = y1,
-        .bz = z,
-        /* lower left */
-        .cx = x2,
-        .cy = y2,
-        .cz = z,
-        /* interpolated */
-        .dx = x1,
-        .dy = y2,
-        .auv = PVR_PACK_16BIT_UV(u1, v1), /* UVS */
-        .buv = PVR_PACK_16BIT_UV(u2, v1), /* UVS */
-        .cuv = PVR_PACK_16BIT_UV(u2, v2), /* UVS */
-    };
-    pvr_prim(&vert, sizeof(vert));
-
-#else
-    pvr_poly_cxt_t context;
-    pvr_poly_hdr_t header;
-
-    pvr_poly_cxt_txr(&context, draw_get_list(), img->format, img->width, img->height, img->texture,
-                     PVR_FILTER_BILINEAR);
-    if (context.txr.enable != PVR_TEXTURE_DISABLE) {
-        switch (context.txr.width) {
-            case 8:
-            case 16:
-            case 32:
-            case 64:
-            case 128:
-            case 256:
-            case 512:
-            case 1024: break;
-            default:
-                printf("%s error tex size %d(%ld) %d(%ld)\n", __func__, context.txr.width, img->width,
-                       context.txr.height, img->height);
-                return;
-                break;
-        }
+    draw_batch_quad(img, x1, y1, x2, y2, z_inc(), u1, v1, u2, v2, color);
+}
+
+/* Draws several parts of one image (atlas page), the batch puts them under a single header */
+void
+draw_draw_atlas(const void* user, uint32_t color, const draw_atlas_quad* quads, int count) {
+    const image* img = (const image*)user;
+
+    if (img == NULL || img->width == 0 || img->height == 0 || count <= 0 || !draw_texture_size_valid(img)) {
+        return;
+    }
+
+    const float u_scale = 1.0f / img->width;
+    const float v_scale = 1.0f / img->height;
+
+    for (int i = 0; i < count; i++) {
+        const draw_atlas_quad* quad = &quads[i];
+        /* Pull UVs of a part of the page in by half a texel so bilinear filtering doesn't sample the
+         * neighbouring icon, a whole texture has no neighbours and keeps its edges */
+        const int part = quad->uv.x > 0 || quad->uv.y > 0 || quad->uv.x + quad->uv.w < (int)img->width
+                         || quad->uv.y + quad->uv.h < (int)img->height;
+        const float inset = part ? 0.5f : 0.0f;
+        const float x1 = round((float)quad->x);
+        const float y1 = round((float)quad->y);
+        const float x2 = round((float)quad->x + quad->width);
+        const float y2 = round((float)quad->y + quad->height);
+        const float u1 = (quad->uv.x + inset) * u_scale;
+        const float v1 = (quad->uv.y + inset) * v_scale;
+        const float u2 = (quad->uv.x + quad->uv.w - inset) * u_scale;
+        const float v2 = (quad->uv.y + quad->uv.h - inset) * v_scale;
+
+        draw_batch_quad(img, x1, y1, x2, y2, z_inc(), u1, v1, u2, v2, color);
     }
-    pvr_poly_compile(&header, &context);
-
-    pvr_prim(&header, sizeof(header));
-
-    pvr_vertex_t vert = {.argb = color, .oargb = 0, .flags = PVR_CMD_VERTEX, .z = 1};
-
-    vert.x = x1;
-    vert.y = y2;
-    vert.z = z;
-    vert.u = u1;
-    vert.v = v2;
-    pvr_prim(&vert, sizeof(vert));
-
-    vert.x = x1;
-    vert.y = y1;
-    vert.u = u1;
-    vert.v = v1;
-    pvr_prim(&vert, sizeof(vert));
-
-    vert.x = x2;
-    vert.y = y2;
-    vert.u = u2;
-    vert.v = v2;
-    pvr_prim(&vert, sizeof(vert));
-
-    vert.flags = PVR_CMD_VERTEX_EOL;
-    vert.x = x2;
-    vert.y = y1;
-    vert.u = u2;
-    vert.v = v1;
-    pvr_prim(&vert, sizeof(vert));
-#endif
 }
 
 /* Draws untextured quad at coords with size and color(rgba) */
@@ -288,83 +250,7 @@ draw_draw_quad(int x, int y, float width, float height, uint32_t color) {
     const float x2 = round((float)x + width);
     const float y2 = round((float)y + height);
 
-    const float z = z_inc();
-
-#ifdef KOS_SPRITE
-    pvr_sprite_cxt_t context;
-    pvr_sprite_hdr_t header;
-
-    pvr_sprite_cxt_col(&context, draw_get_list());
-    pvr_sprite_compile(&header, &context);
-
-    header.argb = color;
-
-    pvr_prim(&header, sizeof(header));
-
-    pvr_sprite_col_t vert = {.flags = PVR_CMD_VERTEX_EOL, /* Always? */
-                             /*  upper left */
-                             .ax = x1,
-                             .ay = y1,
-                             .az = z,
-                             /* upper right */
-                             .bx = x2,
-                             .by = y1,
-                             .bz = z,
-                             /* lower left */
-                             .cx = x2,
-                             .cy = y2,
-                             .cz = z,
-                             /* interpolated */
-                             .dx = x1,
-                             .dy = y2};
-
-    pvr_prim(&vert, sizeof(vert));
-
-#else
-    pvr_poly_cxt_t context;
-    pvr_poly_hdr_t header;
-
-    pvr_poly_cxt_col(&context, draw_get_list());
-    if (context.txr.enable != PVR_TEXTURE_DISABLE) {
-        switch (context.txr.width) {
-            case 8:
-            case 16:
-            case 32:
-            case 64:
-            case 128:
-            case 256:
-            case 512:
-            case 1024: break;
-            default:
-                printf("%s error tex size %d(%f) %d(%f)\n", __func__, context.txr.width, width, context.txr.height,
-                       height);
-                return;
-                break;
-        }
-    }
-    pvr_poly_compile(&header, &context);
-
-    pvr_prim(&header, sizeof(header));
-
-    pvr_vertex_t vert = {.argb = color, .oargb = 0, .flags = PVR_CMD_VERTEX, .z = z, .u = 0, .v = 0};
-
-    vert.x = x1;
-    vert.y = y2;
-    pvr_prim(&vert, sizeof(vert));
-
-    vert.x = x1;
-    vert.y = y1;
-    pvr_prim(&vert, sizeof(vert));
-
-    vert.x = x2;
-    vert.y = y2;
-    pvr_prim(&vert, sizeof(vert));
-
-    vert.flags = PVR_CMD_VERTEX_EOL;
-    vert.x = x2;
-    vert.y = y1;
-    pvr_prim(&vert, sizeof(vert));
-#endif
+    draw_batch_quad(NULL, x1, y1, x2, y2, z_inc(), 0.0f, 0.0f, 0.0f, 0.0f, color);
 }
 
 /* draws an image at coords as a square */
@@ -28,6 +28,13 @@ typedef struct dimen_RECT {
     int16_t h;
 } dimen_RECT;
 
+/* One destination quad and its source rect on a shared texture */
+typedef struct draw_atlas_quad {
+    int x, y;
+    float width, height;
+    dimen_RECT uv;
+} draw_atlas_quad;
+
 /* Called only once at start */
 void draw_init(void);
 
@@ -55,6 +62,9 @@ void draw_draw_square(int x, int y, float size, uint32_t color, void* user);
 /* Draws part of an image specified in rect at the given coords of size */
 void draw_draw_sub_image(int x, int y, float width, float height, uint32_t color, void* user, const dimen_RECT* rect);
 
+/* Draws several parts of one image (atlas page) under a single polygon header */
+void draw_draw_atlas(const void* user, uint32_t color, const draw_atlas_quad* quads, int count);
+
 /* Draws untextured quad at coords with size and color(rgba) */
 void draw_draw_quad(int x, int y, float width, float height, uint32_t color);
 
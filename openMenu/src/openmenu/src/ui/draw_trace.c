@@ -0,0 +1,135 @@
+/*
+ * File: draw_trace.c
+ * Project: ui
+ * -----
+ * Recording submit backend for the batch layer
+ */
+
+#ifdef DRAW_SUBMIT_RECORD
+
+#include <stdio.h>
+#include <string.h>
+
+#include <dc/pvr.h>
+
+#include "ui/draw_trace.h"
+
+#define TRACE_MAX_HEADERS (1024) /* per frame, later ones still count towards the totals */
+
+/* Parameter type in the top three bits of every command word */
+#define TRACE_PARA_TYPE(cmd) ((cmd) >> 29)
+#define TRACE_PARA_POLY      (4)
+#define TRACE_PARA_SPRITE    (5)
+#define TRACE_PARA_VERTEX    (7)
+#define TRACE_EOS            (0x10000000) /* end of strip */
+#define TRACE_TEXTURE_WORD   (3)          /* texture control word of both header kinds */
+
+typedef struct trace_header {
+    uint8_t list;
+    uint32_t texture;
+    unsigned int vertices;
+} trace_header;
+
+static trace_header headers[TRACE_MAX_HEADERS];
+static unsigned int header_count;
+
+static draw_trace_stats frame_stats;
+static draw_trace_stats last_stats;
+static unsigned int trace_frame;
+
+/* State carried between submits, vertices usually come in a separate call from their header */
+static trace_header* current_header;
+static uint32_t current_texture;
+static int current_sprite;
+
+static FILE* trace_out;
+static int trace_opened;
+
+void
+draw_trace_submit(int list, const void* data, unsigned int size) {
+    const uint32_t* word = (const uint32_t*)data;
+    const uint32_t* end = word + size / sizeof(uint32_t);
+
+    frame_stats.bytes += size;
+
+    /* Headers and polygon vertices are 32 bytes, sprite vertices 64 */
+    while (word < end) {
+        const uint32_t cmd = word[0];
+
+        switch (TRACE_PARA_TYPE(cmd)) {
+            case TRACE_PARA_POLY:
+            case TRACE_PARA_SPRITE:
+                frame_stats.headers++;
+                if (word[TRACE_TEXTURE_WORD] && word[TRACE_TEXTURE_WORD] != current_texture) {
+                    frame_stats.binds++;
+                }
+                current_texture = word[TRACE_TEXTURE_WORD];
+                current_sprite = (TRACE_PARA_TYPE(cmd) == TRACE_PARA_SPRITE);
+
+                current_header = (header_count < TRACE_MAX_HEADERS) ? &headers[header_count++] : NULL;
+                if (current_header) {
+                    current_header->list = (uint8_t)list;
+                    current_header->texture = current_texture;
+                    current_header->vertices = 0;
+                }
+                word += 8;
+                break;
+
+            case TRACE_PARA_VERTEX:
+                frame_stats.vertices++;
+                if (cmd & TRACE_EOS) {
+                    frame_stats.strips++;
+                }
+                if (current_header) {
+                    current_header->vertices++;
+                }
+                word += current_sprite ? 16 : 8;
+                break;
+
+            default:
+                /* Clip and modifier parameters aren't used by the UI */
+                word += 8;
+                break;
+        }
+    }
+}
+
+static void
+trace_write_frame(void) {
+    if (!trace_opened) {
+        trace_opened = 1;
+        trace_out = fopen(DRAW_TRACE_PATH, "w");
+        if (!trace_out) {
+            printf("TRACE: can't open %s, tracing to serial\n", DRAW_TRACE_PATH);
+            trace_out = stdout;
+        }
+    }
+
+    fprintf(trace_out, "F %u\n", trace_frame);
+    for (unsigned int i = 0; i < header_count; i++) {
+        const trace_header* header = &headers[i];
+        fprintf(trace_out, "H %s %08x %u\n", header->list == PVR_LIST_OP_POLY ? "OP" : "TR",
+                (unsigned)header->texture, header->vertices);
+    }
+    fprintf(trace_out, "E %u %u %u %u\n", last_stats.headers, last_stats.binds, last_stats.vertices,
+            last_stats.bytes);
+}
+
+void
+draw_trace_frame_end(void) {
+    last_stats = frame_stats;
+    trace_write_frame();
+
+    memset(&frame_stats, 0, sizeof(frame_stats));
+    header_count = 0;
+    current_header = NULL;
+    current_texture = 0;
+    trace_frame++;
+}
+
+void
+draw_trace_get_stats(draw_trace_stats* last_frame) {
+    *last_frame = last_stats;
+}
+
+#endif /* DRAW_SUBMIT_RECORD */
@@ -0,0 +1,39 @@
+/*
+ * File: draw_trace.h
+ * Project: ui
+ * -----
+ * Recording submit backend for the batch layer
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/* Built with DRAW_SUBMIT_RECORD, the batch layer hands everything it would pass to pvr_prim here
+ * instead. The command stream is walked for headers, texture binds and vertices, and each frame is
+ * written out to a trace:
+ *
+ *   F <frame>
+ *   H <list> <texture word> <vertices>     one per header, in submission order
+ *   E <headers> <binds> <vertices> <bytes> frame totals
+ *
+ * Nothing reaches the PVR, so the screen stays black while the UI runs at full speed. */
+
+#ifndef DRAW_TRACE_PATH
+#define DRAW_TRACE_PATH "/pc/openmenu_trace.txt"
+#endif
+
+typedef struct draw_trace_stats {
+    unsigned int headers;  /* polygon and sprite headers */
+    unsigned int binds;    /* headers that changed texture from the one before */
+    unsigned int vertices; /* polygon vertices or sprite quads */
+    unsigned int strips;   /* strips ended */
+    unsigned int bytes;    /* command stream size */
+} draw_trace_stats;
+
+void draw_trace_submit(int list, const void* data, unsigned int size);
+
+/* Writes out the frame, call once per frame after the scene is submitted */
+void draw_trace_frame_end(void);
+/* Totals over both lists for the last complete frame */
+void draw_trace_get_stats(draw_trace_stats* last_frame);
@@ -36,9 +36,12 @@ void font_bmp_destroy(void);
 void font_bmp_begin_draw(void);
 void font_bmp_set_color(uint32_t color);
 void font_bmp_set_color_components(int r, int g, int b, int a);
+void font_bmp_set_color_default(void);
 
 void font_bmp_draw_main(int x, int y, const char* str);
 void font_bmp_draw_sub(int x, int y, const char* str);
 void font_bmp_draw_sub_wrap(int x, int y, const char* str, int width);
 void font_bmp_draw_auto_size(int x, int y, const char* str, int width);
 void font_bmp_draw_centered(int x, int y, const char* str);
+/* Draws length characters of str scrolled left by scroll pixels, only x..x+width is visible */
+void font_bmp_draw_clipped(int x, int y, const char* str, int length, int scroll, int width);
@@ -0,0 +1,255 @@
+/*
+ * File: profiler.c
+ * Project: ui
+ * -----
+ * Frame time profiler and overlay
+ */
+
+#ifdef OPENMENU_PROFILE
+
+#include <stdio.h>
+#include <string.h>
+
+#include <arch/timer.h>
+
+#include <openmenu_settings.h>
+#include "ui/draw_prototypes.h"
+#include "ui/font_prototypes.h"
+
+#include "ui/profiler.h"
+
+#define PROF_STATS_EVERY (60 * 10)
+#define PROF_FRAME_US    (16667) /* one 60Hz field */
+
+/* Overlay placement, the graph is one bar per recorded frame */
+#define OVERLAY_X      (16)
+#define OVERLAY_Y      (16)
+#define OVERLAY_LINE   (16)
+#define OVERLAY_WIDTH  (PROF_HISTORY * GRAPH_BAR + 8)
+#define GRAPH_BAR      (2)
+#define GRAPH_HEIGHT   (48) /* two frames tall */
+#define OVERLAY_BKG    (0xC0000000)
+#define OVERLAY_TEXT   (0xFFFFFFFF)
+#define OVERLAY_SLOW   (0xFFFF5050) /* phases over a frame, bars that missed vblank */
+#define OVERLAY_FRAME  (0xFF50A0FF)
+#define OVERLAY_WORK   (0xFF50FF50)
+#define OVERLAY_TARGET (0x80FFFFFF)
+
+static const char* zone_names[PROF_ZONE_COUNT] = {
+    "input", "vblank", "pvr wait", "draw op", "draw tr", "scene end", "txr tick",
+    "vmu",   "dcnow",  "txr load", "list",    "text",    "overlay",
+};
+
+static prof_frame history[PROF_HISTORY];
+static unsigned int frames; /* complete frames recorded, history holds the last PROF_HISTORY */
+
+static prof_frame current;
+static uint64_t frame_start;
+static uint64_t zone_start[PROF_ZONE_COUNT];
+static uint8_t zone_depth[PROF_ZONE_COUNT];
+
+static int overlay_shown;
+static int overlay_bmp; /* font the current UI has loaded */
+
+void
+prof_begin(PROF_ZONE zone) {
+    if (zone_depth[zone]++) {
+        return;
+    }
+    zone_start[zone] = timer_us_gettime64();
+}
+
+void
+prof_end(PROF_ZONE zone) {
+    if (!zone_depth[zone] || --zone_depth[zone]) {
+        return;
+    }
+    current.zone[zone] += (uint32_t)(timer_us_gettime64() - zone_start[zone]);
+}
+
+int
+prof_get_frame(unsigned int age, prof_frame* frame) {
+    if (age >= frames || age >= PROF_HISTORY) {
+        return 0;
+    }
+    *frame = history[(frames - 1 - age) & (PROF_HISTORY - 1)];
+    return 1;
+}
+
+/* Average and worst over the recorded history, index PROF_ZONE_COUNT is the whole frame */
+static unsigned int
+prof_summarize(uint32_t avg[PROF_ZONE_COUNT + 1], uint32_t max[PROF_ZONE_COUNT + 1]) {
+    const unsigned int count = frames < PROF_HISTORY ? frames : PROF_HISTORY;
+    uint32_t sum[PROF_ZONE_COUNT + 1];
+
+    memset(sum, 0, sizeof(sum));
+    memset(max, 0, sizeof(sum));
+    for (unsigned int i = 0; i < count; i++) {
+        const prof_frame* frame = &history[i];
+        for (int zone = 0; zone <= PROF_ZONE_COUNT; zone++) {
+            const uint32_t us = zone < PROF_ZONE_COUNT ? frame->zone[zone] : frame->total;
+            sum[zone] += us;
+            if (us > max[zone]) {
+                max[zone] = us;
+            }
+        }
+    }
+    for (int zone = 0; zone <= PROF_ZONE_COUNT; zone++) {
+        avg[zone] = count ? sum[zone] / count : 0;
+    }
+    return count;
+}
+
+static void
+prof_print_summary(void) {
+    uint32_t avg[PROF_ZONE_COUNT + 1], max[PROF_ZONE_COUNT + 1];
+    char line[512];
+    int length;
+
+    const unsigned int count = prof_summarize(avg, max);
+    length = snprintf(line, sizeof(line), "PROF: %u frames, us avg/max frame=%u/%u", count, (unsigned)avg[PROF_ZONE_COUNT],
+                      (unsigned)max[PROF_ZONE_COUNT]);
+    for (int zone = 0; zone < PROF_ZONE_COUNT && length < (int)sizeof(line); zone++) {
+        length += snprintf(line + length, sizeof(line) - length, " %s=%u/%u", zone_names[zone], (unsigned)avg[zone],
+                           (unsigned)max[zone]);
+    }
+    printf("%s\n", line);
+}
+
+void
+prof_frame_mark(void) {
+    const uint64_t now = timer_us_gettime64();
+
+    if (frame_start) {
+        current.total = (uint32_t)(now - frame_start);
+        history[frames & (PROF_HISTORY - 1)] = current;
+        frames++;
+        if (!(frames % PROF_STATS_EVERY)) {
+            prof_print_summary();
+        }
+    }
+    memset(&current, 0, sizeof(current));
+    frame_start = now;
+}
+
+void
+prof_dump(const char* path) {
+    FILE* out = path ? fopen(path, "w") : NULL;
+    const unsigned int count = frames < PROF_HISTORY ? frames : PROF_HISTORY;
+
+    if (!out) {
+        printf("PROF: can't open %s, dumping to serial\n", path ? path : "(null)");
+        out = stdout;
+    }
+
+    fprintf(out, "frame,total");
+    for (int zone = 0; zone < PROF_ZONE_COUNT; zone++) {
+        fprintf(out, ",%s", zone_names[zone]);
+    }
+    fprintf(out, "\n");
+
+    /* Oldest first */
+    for (unsigned int age = count; age-- > 0;) {
+        prof_frame frame;
+        prof_get_frame(age, &frame);
+        fprintf(out, "%u,%u", frames - 1 - age, (unsigned)frame.total);
+        for (int zone = 0; zone < PROF_ZONE_COUNT; zone++) {
+            fprintf(out, ",%u", (unsigned)frame.zone[zone]);
+        }
+        fprintf(out, "\n");
+    }
+
+    if (out != stdout) {
+        fclose(out);
+        printf("PROF: wrote %u frames to %s\n", count, path);
+    }
+    prof_print_summary();
+}
+
+void
+prof_toggle_overlay(void) {
+    overlay_shown = !overlay_shown;
+}
+
+/* Scroll and Folders only load the bitmap font, the other UIs only the BMF one */
+static void
+overlay_text(int x, int y, uint32_t color, const char* str) {
+    if (overlay_bmp) {
+        font_bmp_set_color(color);
+        font_bmp_draw_main(x, y, str);
+    } else {
+        font_bmf_draw(x, y, color, str);
+    }
+}
+
+static int
+overlay_bar_height(uint32_t us) {
+    const int height = (int)(us * (GRAPH_HEIGHT / 2) / PROF_FRAME_US);
+    return height < GRAPH_HEIGHT ? height : GRAPH_HEIGHT;
+}
+
+void
+prof_draw_overlay(void) {
+    uint32_t avg[PROF_ZONE_COUNT + 1], max[PROF_ZONE_COUNT + 1];
+    char str[16];
+
+    if (!overlay_shown) {
+        return;
+    }
+    prof_begin(PROF_OVERLAY);
+    prof_summarize(avg, max);
+
+    const int height = (PROF_ZONE_COUNT + 1) * OVERLAY_LINE + GRAPH_HEIGHT + 12;
+    draw_draw_quad(OVERLAY_X, OVERLAY_Y, OVERLAY_WIDTH, height, OVERLAY_BKG);
+
+    overlay_bmp = (sf_ui[0] == UI_SCROLL || sf_ui[0] == UI_FOLDERS);
+    if (!overlay_bmp) {
+        font_bmf_begin_draw();
+        font_bmf_set_height(OVERLAY_LINE - 2);
+    }
+
+    /* One row per zone in ms, average then worst over the history */
+    int y = OVERLAY_Y + 4;
+    for (int zone = 0; zone <= PROF_ZONE_COUNT; zone++) {
+        const uint32_t color = max[zone] > PROF_FRAME_US ? OVERLAY_SLOW : OVERLAY_TEXT;
+        overlay_text(OVERLAY_X + 4, y, color, zone < PROF_ZONE_COUNT ? zone_names[zone] : "frame");
+        snprintf(str, sizeof(str), "%2u.%02u", (unsigned)(avg[zone] / 1000), (unsigned)(avg[zone] % 1000 / 10));
+        overlay_text(OVERLAY_X + 4 + 12 * 8, y, color, str);
+        snprintf(str, sizeof(str), "%2u.%02u", (unsigned)(max[zone] / 1000), (unsigned)(max[zone] % 1000 / 10));
+        overlay_text(OVERLAY_X + 4 + 19 * 8, y, color, str);
+        y += OVERLAY_LINE;
+    }
+
+    /* Frame time graph, newest on the right. The tall bar is the whole frame, the short one the
+     * time spent outside vblank and PVR waits */
+    const int graph_bottom = y + 4 + GRAPH_HEIGHT;
+    const unsigned int count = frames < PROF_HISTORY ? frames : PROF_HISTORY;
+    for (unsigned int age = 0; age < count; age++) {
+        prof_frame frame;
+        prof_get_frame(age, &frame);
+
+        const int x = OVERLAY_X + 4 + (PROF_HISTORY - 1 - age) * GRAPH_BAR;
+        const uint32_t waits = frame.zone[PROF_VBLANK] + frame.zone[PROF_PVR_WAIT];
+        const uint32_t work = frame.total > waits ? frame.total - waits : 0;
+        const int total_height = overlay_bar_height(frame.total);
+        const int work_height = overlay_bar_height(work);
+
+        if (total_height > work_height) {
+            draw_draw_quad(x, graph_bottom - total_height, GRAPH_BAR, total_height - work_height,
+                           frame.total > PROF_FRAME_US + PROF_FRAME_US / 8 ? OVERLAY_SLOW : OVERLAY_FRAME);
+        }
+        if (work_height) {
+            draw_draw_quad(x, graph_bottom - work_height, GRAPH_BAR, work_height, OVERLAY_WORK);
+        }
+    }
+    draw_draw_quad(OVERLAY_X + 4, graph_bottom - GRAPH_HEIGHT / 2, PROF_HISTORY * GRAPH_BAR, 1, OVERLAY_TARGET);
+
+    if (overlay_bmp) {
+        font_bmp_set_color_default();
+    } else {
+        font_bmf_set_height_default();
+    }
+    prof_end(PROF_OVERLAY);
+}
+
+#endif /* OPENMENU_PROFILE */
@@ -0,0 +1,82 @@
+/*
+ * File: profiler.h
+ * Project: ui
+ * -----
+ * Frame time profiler and overlay
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/* Scoped timers over the main loop phases and a few subsystems. Each zone sums the microseconds
+ * spent between its prof_begin/prof_end pairs over a frame, nested pairs of the same zone are only
+ * timed once. prof_frame_mark at the top of the main loop closes the frame and keeps it in a
+ * history ring, which the overlay graphs and prof_dump writes out.
+ *
+ *   prof_begin(PROF_TXR_LOAD);
+ *   ...
+ *   prof_end(PROF_TXR_LOAD);
+ *
+ * Only built with OPENMENU_PROFILE, otherwise every call compiles away. */
+
+typedef enum PROF_ZONE {
+    /* Main loop phases, in the order they run */
+    PROF_INPUT = 0,
+    PROF_VBLANK,
+    PROF_PVR_WAIT,
+    PROF_DRAW_OP,
+    PROF_DRAW_TR,
+    PROF_SCENE_END,
+    PROF_TXR_TICK,
+    PROF_VMU,
+    PROF_DCNOW,
+    /* Subsystems, time already counted in one of the phases above */
+    PROF_TXR_LOAD, /* DAT reads and uploads into the texture pools */
+    PROF_LIST,     /* game list sorting and filtering */
+    PROF_TEXT,     /* laying out text the layout cache didn't have */
+    PROF_OVERLAY,
+    PROF_ZONE_COUNT
+} PROF_ZONE;
+
+#define PROF_HISTORY (128) /* frames, power of two */
+
+/* dcload's host filesystem, prof_dump falls back to serial without it */
+#ifndef PROF_DUMP_PATH
+#define PROF_DUMP_PATH "/pc/openmenu_profile.csv"
+#endif
+
+#ifdef OPENMENU_PROFILE
+
+typedef struct prof_frame {
+    uint32_t total;                 /* us from one frame mark to the next */
+    uint32_t zone[PROF_ZONE_COUNT]; /* us per zone */
+} prof_frame;
+
+void prof_begin(PROF_ZONE zone);
+void prof_end(PROF_ZONE zone);
+
+/* Call once at the top of the main loop */
+void prof_frame_mark(void);
+
+/* Draws the overlay into the current list when it is shown, call last in the TR pass */
+void prof_draw_overlay(void);
+void prof_toggle_overlay(void);
+
+/* Writes the history as CSV to path, or to serial when it can't be opened, and prints a summary */
+void prof_dump(const char* path);
+
+/* Most recent complete frame is 0, returns 0 when that far back was not recorded yet */
+int prof_get_frame(unsigned int age, prof_frame* frame);
+
+#else
+
+#define prof_begin(zone)         ((void)0)
+#define prof_end(zone)           ((void)0)
+#define prof_frame_mark()        ((void)0)
+#define prof_draw_overlay()      ((void)0)
+#define prof_toggle_overlay()    ((void)0)
+#define prof_dump(path)          ((void)0)
+#define prof_get_frame(age, frm) (0)
+
+#endif
@@ -0,0 +1,260 @@
+/*
+ * File: text_cache.c
+ * Project: ui
+ * -----
+ * Layout cache for text drawn every frame
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ui/draw_batch.h"
+
+#include "ui/text_cache.h"
+
+#define TEXT_CACHE_SETS        (16) /* power of two */
+#define TEXT_CACHE_WAYS        (4)
+#define TEXT_CACHE_MAX_LENGTH  (1024)       /* longer strings are never kept */
+#define TEXT_CACHE_MAX_BYTES   (192 * 1024) /* vertex memory over all entries */
+#define TEXT_CACHE_GROW        (32)         /* vertices, power of two */
+#define TEXT_CACHE_STATS_EVERY (60 * 10) /* OPENMENU_PROFILE builds print the stats this often */
+
+static text_layout cache[TEXT_CACHE_SETS][TEXT_CACHE_WAYS];
+static unsigned int cache_frame = 1;
+static unsigned int cache_bytes;
+
+static text_cache_stats frame_stats;
+static text_cache_stats last_stats;
+
+/* FNV-1a over the string, its length falls out of the same pass */
+static uint32_t
+text_hash(const char* str, uint32_t* length) {
+    const unsigned char* iter = (const unsigned char*)str;
+    uint32_t hash = 2166136261u;
+
+    while (*iter) {
+        hash ^= *iter++;
+        hash *= 16777619u;
+    }
+    *length = (uint32_t)(iter - (const unsigned char*)str);
+    return hash;
+}
+
+static void
+text_layout_release(text_layout* layout) {
+    cache_bytes -= layout->capacity * sizeof(text_vert_t) + layout->text_capacity;
+    free(layout->verts);
+    layout->verts = NULL;
+    layout->capacity = 0;
+    free(layout->text);
+    layout->text = NULL;
+    layout->text_capacity = 0;
+}
+
+/* Copies the string into the entry, growing its buffer when needed. Returns 0 without memory */
+static int
+text_layout_set_text(text_layout* layout, const char* str, uint32_t length) {
+    if (length + 1 > layout->text_capacity) {
+        const unsigned int capacity = (length + 1 + 15) & ~15u;
+        char* text = realloc(layout->text, capacity);
+        if (!text) {
+            return 0;
+        }
+        cache_bytes += capacity - layout->text_capacity;
+        layout->text = text;
+        layout->text_capacity = capacity;
+    }
+    memcpy(layout->text, str, length + 1);
+    return 1;
+}
+
+text_layout*
+text_cache_get(const char* str, TEXT_FONT font, float scale, int wrap) {
+    text_key key;
+
+    memset(&key, 0, sizeof(key));
+    key.hash = text_hash(str, &key.length);
+    key.scale = scale;
+    key.wrap = wrap;
+    key.font = font;
+
+    if (key.length > TEXT_CACHE_MAX_LENGTH) {
+        return NULL;
+    }
+    frame_stats.lookups++;
+
+    text_layout* set = cache[(key.hash ^ (key.hash >> 16)) & (TEXT_CACHE_SETS - 1)];
+    text_layout* victim = &set[0];
+    for (int i = 0; i < TEXT_CACHE_WAYS; i++) {
+        text_layout* layout = &set[i];
+        /* Different strings can share a hash, only the text itself tells them apart */
+        if (layout->used && !memcmp(&layout->key, &key, sizeof(key)) && !memcmp(layout->text, str, key.length)) {
+            layout->used = cache_frame;
+            return layout;
+        }
+        if (layout->used < victim->used) {
+            victim = layout;
+        }
+    }
+
+    /* Keep the victim's vertex storage, the next string is probably a similar size */
+    if (victim->used) {
+        frame_stats.evictions++;
+    }
+    if (!text_layout_set_text(victim, str, key.length)) {
+        /* Drawn uncached, the entry is free for the next lookup */
+        victim->used = 0;
+        return NULL;
+    }
+    victim->key = key;
+    victim->width = -1.0f;
+    victim->count = 0;
+    victim->built = 0;
+    victim->overflow = 0;
+    victim->used = cache_frame;
+    return victim;
+}
+
+int
+text_layout_draw(text_layout* layout, const image* img, int filter, float x, float y, float z, uint32_t color) {
+    if (!layout || !layout->built) {
+        return 0;
+    }
+
+    /* Moving text is laid out again, translating floats frame after frame would drift */
+    if (x != layout->x || y != layout->y) {
+        layout->count = 0;
+        layout->built = 0;
+        return 0;
+    }
+
+    if (z != layout->z || color != layout->color) {
+        text_vert_t* vert = layout->verts;
+        text_vert_t* end = vert + layout->count;
+
+        for (; vert < end; vert++) {
+#ifdef KOS_SPRITE
+            vert->az = vert->bz = vert->cz = z;
+#else
+            vert->z = z;
+            vert->argb = color;
+#endif
+        }
+        layout->z = z;
+        layout->color = color;
+        frame_stats.patched++;
+    }
+
+    draw_glyphs(img, filter, color, layout->verts, layout->count);
+    frame_stats.draws++;
+    return 1;
+}
+
+int
+text_layout_draw_clipped(text_layout* layout, const image* img, int filter, float x, float y, float z,
+                         uint32_t color, float clip_x1, float clip_x2) {
+    if (!layout || !layout->built) {
+        return 0;
+    }
+
+    /* The cached vertices stay where they were laid out, each frame's copy is moved instead */
+    draw_glyphs_clipped(img, filter, color, z, layout->verts, layout->count, x - layout->x, y - layout->y, clip_x1,
+                        clip_x2);
+    frame_stats.draws++;
+    return 1;
+}
+
+float
+text_layout_width(text_layout* layout) {
+    if (!layout || layout->width < 0.0f) {
+        return -1.0f;
+    }
+    frame_stats.measures++;
+    return layout->width;
+}
+
+void
+text_layout_set_width(text_layout* layout, float width) {
+    if (layout) {
+        layout->width = width;
+    }
+}
+
+void
+text_layout_record(text_layout* layout, const text_vert_t* verts, unsigned int count) {
+    if (!layout || layout->overflow || !count) {
+        return;
+    }
+
+    const unsigned int needed = layout->count + count;
+    if (needed > layout->capacity) {
+        const unsigned int capacity = (needed + TEXT_CACHE_GROW - 1) & ~(TEXT_CACHE_GROW - 1);
+        const unsigned int grow = (capacity - layout->capacity) * sizeof(text_vert_t);
+        text_vert_t* verts_new = NULL;
+
+        if (cache_bytes + grow <= TEXT_CACHE_MAX_BYTES) {
+            verts_new = realloc(layout->verts, capacity * sizeof(text_vert_t));
+        }
+        if (!verts_new) {
+            /* Drawn directly this time, tried again next frame */
+            layout->overflow = 1;
+            return;
+        }
+        layout->verts = verts_new;
+        layout->capacity = capacity;
+        cache_bytes += grow;
+    }
+
+    memcpy(layout->verts + layout->count, verts, count * sizeof(text_vert_t));
+    layout->count = needed;
+}
+
+void
+text_layout_finish(text_layout* layout, float x, float y, float z, uint32_t color) {
+    if (!layout) {
+        return;
+    }
+    if (layout->overflow) {
+        layout->count = 0;
+        layout->overflow = 0;
+        return;
+    }
+    layout->x = x;
+    layout->y = y;
+    layout->z = z;
+    layout->color = color;
+    layout->built = 1;
+    frame_stats.builds++;
+}
+
+void
+text_cache_clear(void) {
+    for (int set = 0; set < TEXT_CACHE_SETS; set++) {
+        for (int way = 0; way < TEXT_CACHE_WAYS; way++) {
+            text_layout_release(&cache[set][way]);
+        }
+    }
+    memset(cache, 0, sizeof(cache));
+}
+
+void
+text_cache_frame_end(void) {
+    frame_stats.bytes = cache_bytes;
+    last_stats = frame_stats;
+    memset(&frame_stats, 0, sizeof(frame_stats));
+
+#ifdef OPENMENU_PROFILE
+    if (!(cache_frame % TEXT_CACHE_STATS_EVERY)) {
+        printf("TEXT: lookups=%u drawn=%u (%u patched) built=%u measured=%u evicted=%u held=%u bytes\n",
+               last_stats.lookups, last_stats.draws, last_stats.patched, last_stats.builds, last_stats.measures,
+               last_stats.evictions, last_stats.bytes);
+    }
+#endif
+    cache_frame++;
+}
+
+void
+text_cache_get_stats(text_cache_stats* last_frame) {
+    *last_frame = last_stats;
+}
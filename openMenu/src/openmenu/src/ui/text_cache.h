@@ -0,0 +1,84 @@
+/*
+ * File: text_cache.h
+ * Project: ui
+ * -----
+ * Layout cache for text drawn every frame
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "ui/draw_batch.h"
+
+/* Game names, descriptions and menu labels are the same strings frame after frame. The fonts look
+ * them up here by content, font, scale and wrap width, and keep the measured width and the laid
+ * out vertices. Drawing a cached string again at the same position is a copy into the glyph runs,
+ * plus one pass over the vertices when its depth or color changed. Text that moved is laid out
+ * again.
+ *
+ *   text_layout* layout = text_cache_get(str, TEXT_FONT_BMF, scale, 0);
+ *   if (!text_layout_draw(layout, &font_texture, filter, x, y, z, color)) {
+ *       ...lay out as usual, passing every chunk of vertices to text_layout_record...
+ *       text_layout_finish(layout, x, y, z, color);
+ *   }
+ *
+ * Every text_layout_* call accepts NULL, which is what text_cache_get returns for strings too long
+ * to keep. */
+
+typedef draw_text_vert_t text_vert_t;
+
+/* Marquee lines are kept apart from the same strings drawn in place, they are laid out once and
+ * only ever replayed with an offset */
+typedef enum TEXT_FONT { TEXT_FONT_BMF = 0, TEXT_FONT_BMP, TEXT_FONT_BMP_MARQUEE } TEXT_FONT;
+
+typedef struct text_key {
+    uint32_t hash;
+    uint32_t length;
+    float scale;
+    int wrap; /* wrap width, 0 for a single line */
+    int font;
+} text_key;
+
+typedef struct text_layout {
+    text_key key;
+    char* text; /* copy of the string, hits are checked against it */
+    unsigned int text_capacity;
+    float width;        /* measured width, negative until measured */
+    text_vert_t* verts; /* laid out vertices, valid once built */
+    unsigned int count, capacity;
+    float x, y, z; /* placement the vertices currently carry */
+    uint32_t color;
+    unsigned int used; /* frame last looked up */
+    int built;
+    int overflow; /* ran out of cache memory while recording */
+} text_layout;
+
+typedef struct text_cache_stats {
+    unsigned int lookups;   /* strings looked up */
+    unsigned int draws;     /* strings drawn from their cached vertices */
+    unsigned int patched;   /* of those, how many needed new depth or color first */
+    unsigned int builds;    /* strings laid out and kept */
+    unsigned int measures;  /* widths served from the cache */
+    unsigned int evictions; /* entries reused for a different string */
+    unsigned int bytes;     /* vertex and string memory held, not reset per frame */
+} text_cache_stats;
+
+text_layout* text_cache_get(const char* str, TEXT_FONT font, float scale, int wrap);
+int text_layout_draw(text_layout* layout, const image* img, int filter, float x, float y, float z, uint32_t color);
+/* Draws a single line with its start moved to x, y and only clip_x1..clip_x2 showing. Unlike
+ * text_layout_draw it doesn't need the placement it was laid out at, so scrolling text is kept */
+int text_layout_draw_clipped(text_layout* layout, const image* img, int filter, float x, float y, float z,
+                             uint32_t color, float clip_x1, float clip_x2);
+/* Measured width, negative when not known yet */
+float text_layout_width(text_layout* layout);
+void text_layout_set_width(text_layout* layout, float width);
+void text_layout_record(text_layout* layout, const text_vert_t* verts, unsigned int count);
+void text_layout_finish(text_layout* layout, float x, float y, float z, uint32_t color);
+
+/* Layouts depend on the font metrics, call when a font is (re)loaded */
+void text_cache_clear(void);
+
+/* Call once per frame after the scene is submitted */
+void text_cache_frame_end(void);
+void text_cache_get_stats(text_cache_stats* last_frame);
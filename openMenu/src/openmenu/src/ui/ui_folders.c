@@ -23,6 +23,7 @@
 #include <openmenu_settings.h>
 #include "dc/input.h"
 #include "texture/txr_manager.h"
+#include "ui/draw_batch.h"
 #include "ui/draw_prototypes.h"
 #include "ui/font_prototypes.h"
 #include "ui/ui_common.h"
@@ -35,6 +36,7 @@
 
 /* Static resources */
 static image txr_bg_left, txr_bg_right;
+static draw_layer bg_layer; /* retained, see draw_bg_layers */
 static image txr_focus;
 extern image img_empty_boxart;
 extern image img_dir_boxart;
@@ -117,7 +119,7 @@ typedef enum {
 } marquee_state_t;
 
 static marquee_state_t marquee_state = MARQUEE_STATE_INITIAL_PAUSE;
-static int marquee_offset = 0;
+static float marquee_offset = 0; /* pixels */
 static int marquee_timer = 0;
 static int marquee_max_offset = 0;
 static int marquee_last_selected = -1;
@@ -141,10 +143,22 @@ get_marquee_speed_frames(void) {
 #define Y_ADJUST_TEXT 4
 #define Y_ADJUST_CRSR 3
 
+/* Pixels per frame, the same pace as the old one character per step */
+static inline float
+get_marquee_speed(void) {
+    return (float)FONT_CHAR_WIDTH / get_marquee_speed_frames();
+}
+
 /* Helper functions */
 
 static void
 draw_bg_layers(void) {
+    /* Background only changes with the theme textures */
+    uint32_t key = draw_layer_hash(DRAW_LAYER_HASH_INIT, &txr_bg_left, sizeof(txr_bg_left));
+    key = draw_layer_hash(key, &txr_bg_right, sizeof(txr_bg_right));
+    if (!draw_layer_begin(&bg_layer, key)) {
+        return;
+    }
     {
         const dimen_RECT left = {.x = 0, .y = 0, .w = 512, .h = 480};
         draw_draw_sub_image(0, 0, 512, 480, COLOR_WHITE, &txr_bg_left, &left);
@@ -153,6 +167,7 @@ draw_bg_layers(void) {
         const dimen_RECT right = {.x = 0, .y = 0, .w = 128, .h = 480};
         draw_draw_sub_image(512, 0, 128, 480, COLOR_WHITE, &txr_bg_right, &right);
     }
+    draw_layer_end(&bg_layer);
 }
 
 static void
@@ -163,9 +178,10 @@ marquee_reset(void) {
     marquee_max_offset = 0;
 }
 
+/* name_length and the threshold are in characters, the offset moves in pixels */
 static void
 marquee_update_animation(int name_length) {
-    int max_offset = name_length - cur_theme->list_marquee_threshold;
+    int max_offset = (name_length - cur_theme->list_marquee_threshold) * FONT_CHAR_WIDTH;
     if (max_offset < 0) {
         max_offset = 0;
     }
@@ -180,33 +196,27 @@ marquee_update_animation(int name_length) {
     switch (marquee_state) {
         case MARQUEE_STATE_INITIAL_PAUSE:
             marquee_state = MARQUEE_STATE_SCROLL_LEFT;
-            marquee_timer = get_marquee_speed_frames();
             break;
 
         case MARQUEE_STATE_SCROLL_LEFT:
-            marquee_offset++;
+            marquee_offset += get_marquee_speed();
             if (marquee_offset >= marquee_max_offset) {
                 marquee_offset = marquee_max_offset;
                 marquee_state = MARQUEE_STATE_END_PAUSE;
                 marquee_timer = MARQUEE_END_PAUSE_FRAMES;
-            } else {
-                marquee_timer = get_marquee_speed_frames();
             }
             break;
 
         case MARQUEE_STATE_END_PAUSE:
             marquee_state = MARQUEE_STATE_SCROLL_RIGHT;
-            marquee_timer = get_marquee_speed_frames();
             break;
 
         case MARQUEE_STATE_SCROLL_RIGHT:
-            marquee_offset--;
+            marquee_offset -= get_marquee_speed();
             if (marquee_offset <= 0) {
                 marquee_offset = 0;
                 marquee_state = MARQUEE_STATE_INITIAL_PAUSE;
                 marquee_timer = MARQUEE_INITIAL_PAUSE_FRAMES;
-            } else {
-                marquee_timer = get_marquee_speed_frames();
             }
             break;
     }
@@ -285,19 +295,13 @@ draw_gamelist(void) {
                         /* Add 2 to compensate for display width difference (inner vs full) */
                         marquee_update_animation(inner_len + 2);
 
-                        /* Temporarily null-terminate to show inner_threshold-char window of inner text */
-                        char saved_char = inner_start[marquee_offset + inner_threshold];
-                        inner_start[marquee_offset + inner_threshold] = '\0';
-
-                        /* Build display string: [ + scrolled_text + ] */
-                        char display_buf[128];
-                        snprintf(display_buf, sizeof(display_buf), "[%s]", &inner_start[marquee_offset]);
-
-                        font_bmp_draw_main(list_x + X_ADJUST_TEXT,
-                                           list_y + Y_ADJUST_TEXT + (i * ITEM_SPACING),
-                                           display_buf);
-
-                        inner_start[marquee_offset + inner_threshold] = saved_char;
+                        /* Brackets stay put, the inner text scrolls in an inner_threshold-char window */
+                        const int text_x = list_x + X_ADJUST_TEXT;
+                        const int text_y = list_y + Y_ADJUST_TEXT + (i * ITEM_SPACING);
+                        font_bmp_draw_main(text_x, text_y, "[");
+                        font_bmp_draw_clipped(text_x + FONT_CHAR_WIDTH, text_y, inner_start, inner_len,
+                                              (int)marquee_offset, inner_threshold * FONT_CHAR_WIDTH);
+                        font_bmp_draw_main(text_x + ((inner_threshold + 1) * FONT_CHAR_WIDTH), text_y, "]");
                     } else {
                         /* Folder name fits within threshold */
                         font_bmp_draw_main(list_x + X_ADJUST_TEXT,
@@ -313,12 +317,9 @@ draw_gamelist(void) {
             } else if (name_len > cur_theme->list_marquee_threshold) {
                 /* Non-folder long name - normal marquee */
                 marquee_update_animation(name_len);
-                char saved_char = buffer[marquee_offset + cur_theme->list_marquee_threshold];
-                buffer[marquee_offset + cur_theme->list_marquee_threshold] = '\0';
-                font_bmp_draw_main(list_x + X_ADJUST_TEXT,
-                                   list_y + Y_ADJUST_TEXT + (i * ITEM_SPACING),
-                                   &buffer[marquee_offset]);
-                buffer[marquee_offset + cur_theme->list_marquee_threshold] = saved_char;
+                font_bmp_draw_clipped(list_x + X_ADJUST_TEXT, list_y + Y_ADJUST_TEXT + (i * ITEM_SPACING), buffer,
+                                      name_len, (int)marquee_offset,
+                                      cur_theme->list_marquee_threshold * FONT_CHAR_WIDTH);
             } else {
                 /* Short name - display normally */
                 font_bmp_draw_main(list_x + X_ADJUST_TEXT,
@@ -380,13 +381,9 @@ draw_gameart(void) {
         return;
     }
 
-    /* Load artwork for games */
-    {
-        txr_get_large(item->product, &txr_focus);
-        if (txr_focus.texture == img_empty_boxart.texture) {
-            txr_get_small(item->product, &txr_focus);
-        }
-    }
+    /* Load artwork for games, icon first while the box art streams in */
+    txr_set_focus(item->product);
+    txr_get_progressive(item->product, &txr_focus);
 
     if (txr_focus.texture == img_empty_boxart.texture) {
         return;
@@ -18,8 +18,10 @@
 
 #include "texture/txr_manager.h"
 #include "ui/animation.h"
+#include "ui/draw_batch.h"
 #include "ui/draw_prototypes.h"
 #include "ui/font_prototypes.h"
+#include "ui/profiler.h"
 #include "ui/ui_common.h"
 #include "ui/ui_menu_credits.h"
 #include "ui/dc/input.h"
@@ -32,7 +34,6 @@
 
 /* List managment */
 #define INPUT_TIMEOUT        (10)
-#define FOCUSED_HIRES_FRAMES (60 * 1) /* 1 second load in */
 #define ANIM_FRAMES          (15)
 
 /* Tile parameters */
@@ -78,7 +79,7 @@ static int screen_row = 0;
 static int screen_column = 0;
 static int current_starting_index = 0;
 static int navigate_timeout = INPUT_TIMEOUT;
-static int frames_focused = 0;
+static int prefetch_selected = -1;
 
 static bool boxart_button_held = false;
 
@@ -97,6 +98,7 @@ static image txr_icon_list[/*ROWS * COLUMNS*/ 4 * 3 /* Assume the worst */]; /*
 static image txr_focus;
 static image txr_highlight; /* Highlight square */
 static image txr_bg_left, txr_bg_right;
+static draw_layer bg_layer; /* retained, see draw_bg_layers */
 
 extern image img_empty_boxart;
 extern image img_dir_boxart;
@@ -143,6 +145,12 @@ recalculate_aspect(CFG_ASPECT aspect) {
 
 static void
 draw_bg_layers(void) {
+    /* Background only changes with the theme textures */
+    uint32_t key = draw_layer_hash(DRAW_LAYER_HASH_INIT, &txr_bg_left, sizeof(txr_bg_left));
+    key = draw_layer_hash(key, &txr_bg_right, sizeof(txr_bg_right));
+    if (!draw_layer_begin(&bg_layer, key)) {
+        return;
+    }
     {
         const dimen_RECT left = {.x = 0, .y = 0, .w = 512, .h = 480};
         draw_draw_sub_image(0, 0, 512, 480, COLOR_WHITE, &txr_bg_left, &left);
@@ -151,6 +159,7 @@ draw_bg_layers(void) {
         const dimen_RECT right = {.x = 0, .y = 0, .w = 128, .h = 480};
         draw_draw_sub_image(512, 0, 128, 480, COLOR_WHITE, &txr_bg_right, &right);
     }
+    draw_layer_end(&bg_layer);
 }
 
 static inline int
@@ -158,10 +167,34 @@ current_selected(void) {
     return current_starting_index + (screen_row * COLUMNS) + (screen_column);
 }
 
+/* Queue the pages either side of the visible one, focused large art streams in once focus settles */
+static void
+prefetch_neighbor_pages(void) {
+    const char* ids[/*ROWS * COLUMNS*/ 4 * 3 * 2];
+    const int page = ROWS * COLUMNS;
+    int count = 0;
+
+    if (list_len <= 0 || prefetch_selected == current_selected()) {
+        return;
+    }
+    prefetch_selected = current_selected();
+
+    /* Next page first, most navigation is downwards */
+    for (int i = current_starting_index + page; i < current_starting_index + (page * 2) && i < list_len; i++) {
+        ids[count++] = list_current[i]->product;
+    }
+    for (int i = current_starting_index - page; i < current_starting_index; i++) {
+        if (i >= 0) {
+            ids[count++] = list_current[i]->product;
+        }
+    }
+    txr_prefetch_small(ids, count);
+}
+
 static void
 draw_large_art(void) {
     if (anim_active(&anim_large_art_scale.time)) {
-        txr_get_large(list_current[current_selected()]->product, &txr_focus);
+        txr_get_progressive(list_current[current_selected()]->product, &txr_focus);
         if (txr_focus.texture == img_empty_boxart.texture
             || !strncmp(list_current[current_selected()]->disc, "DIR", 3)) {
             /* Only draw if large is present */
@@ -209,8 +242,28 @@ draw_animated_highlight(int width, int height) {
     z_set(z);
 }
 
+/* Submits the tiles collected so far, they all share one texture */
+static void
+flush_tile_run(const image* run_img, const draw_atlas_quad* quads, int* count) {
+    if (*count) {
+        draw_draw_atlas(run_img, COLOR_WHITE, quads, *count);
+        *count = 0;
+    }
+}
+
 static void
 draw_grid_boxes(void) {
+    draw_atlas_quad tile_quads[/*ROWS * COLUMNS*/ 4 * 3];
+    const image* run_img = NULL;
+    int run_len = 0;
+    bool highlight_visible = false;
+    float highlight_x = 0.f, highlight_y = 0.f;
+
+    if (list_len > 0) {
+        txr_set_focus(list_current[current_selected()]->product);
+    }
+
+    /* Neighbouring tiles on the same atlas page are batched under one header */
     for (int row = 0; row < ROWS; row++) {
         for (int column = 0; column < COLUMNS; column++) {
             int idx = (row * COLUMNS) + column;
@@ -223,6 +276,7 @@ draw_grid_boxes(void) {
             }
             float x_pos = GUTTER_SIDE + ((HORIZONTAL_SPACING + TILE_SIZE_X) * column); /* 100 + ((40 + 120)*{0,1,2}) */
             float y_pos = GUTTER_TOP + ((VERTICAL_SPACING + TILE_SIZE_Y) * row);       /* 20 + ((10 + 120)*{0,1,2}) */
+            dimen_RECT uv;
 
             x_pos *= X_SCALE;
 
@@ -232,26 +286,40 @@ draw_grid_boxes(void) {
                 txr_icon_list[idx].width = img_dir_boxart.width;
                 txr_icon_list[idx].height = img_dir_boxart.height;
                 txr_icon_list[idx].format = img_dir_boxart.format;
+                uv = (dimen_RECT){.x = 0, .y = 0, .w = img_dir_boxart.width, .h = img_dir_boxart.height};
             } else {
-                txr_get_small(list_current[current_starting_index + idx]->product, &txr_icon_list[idx]);
+                txr_get_small_atlas(list_current[current_starting_index + idx]->product, &txr_icon_list[idx], &uv);
             }
-            draw_draw_image((int)x_pos, (int)y_pos, TILE_SIZE_X * X_SCALE, TILE_SIZE_Y, COLOR_WHITE,
-                            &txr_icon_list[idx]);
 
-            /* Highlight */
+            if (run_img
+                && (run_img->texture != txr_icon_list[idx].texture || run_img->format != txr_icon_list[idx].format)) {
+                flush_tile_run(run_img, tile_quads, &run_len);
+            }
+            run_img = &txr_icon_list[idx];
+            tile_quads[run_len++] = (draw_atlas_quad){
+                .x = (int)x_pos, .y = (int)y_pos, .width = TILE_SIZE_X * X_SCALE, .height = TILE_SIZE_Y, .uv = uv};
+
             if ((current_starting_index + idx) == current_selected()) {
-                if (anim_alive(&anim_highlight.time)) {
-                    draw_animated_highlight((TILE_SIZE_X + (HIGHLIGHT_OVERHANG * 2)) * X_SCALE,
-                                            TILE_SIZE_Y + (HIGHLIGHT_OVERHANG * 2));
-                } else {
-                    pos_highlight.x = x_pos - (HIGHLIGHT_OVERHANG * X_SCALE);
-                    pos_highlight.y = y_pos - (HIGHLIGHT_OVERHANG);
-                    draw_static_highlight((TILE_SIZE_X + (HIGHLIGHT_OVERHANG * 2)) * X_SCALE,
-                                          TILE_SIZE_Y + (HIGHLIGHT_OVERHANG * 2));
-                }
+                highlight_x = x_pos - (HIGHLIGHT_OVERHANG * X_SCALE);
+                highlight_y = y_pos - (HIGHLIGHT_OVERHANG);
+                highlight_visible = true;
             }
         }
     }
+    flush_tile_run(run_img, tile_quads, &run_len);
+
+    /* Highlight, drawn after the batch so it stays on top of the tiles */
+    if (highlight_visible) {
+        if (anim_alive(&anim_highlight.time)) {
+            draw_animated_highlight((TILE_SIZE_X + (HIGHLIGHT_OVERHANG * 2)) * X_SCALE,
+                                    TILE_SIZE_Y + (HIGHLIGHT_OVERHANG * 2));
+        } else {
+            pos_highlight.x = highlight_x;
+            pos_highlight.y = highlight_y;
+            draw_static_highlight((TILE_SIZE_X + (HIGHLIGHT_OVERHANG * 2)) * X_SCALE,
+                                  TILE_SIZE_Y + (HIGHLIGHT_OVERHANG * 2));
+        }
+    }
 
     /* Get multidisc settings */
     int hide_multidisc = sf_multidisc[0];
@@ -295,6 +363,8 @@ draw_grid_boxes(void) {
 
     /* If focused, draw large cover art */
     draw_large_art();
+
+    prefetch_neighbor_pages();
 }
 
 static void
@@ -383,7 +453,6 @@ menu_up(int amount) {
     setup_highlight_animation();
     kill_large_art_animation();
 
-    frames_focused = 0;
     navigate_timeout = INPUT_TIMEOUT;
 }
 
@@ -400,7 +469,6 @@ menu_down(int amount) {
     setup_highlight_animation();
     kill_large_art_animation();
 
-    frames_focused = 0;
     navigate_timeout = INPUT_TIMEOUT;
 }
 
@@ -434,7 +502,6 @@ menu_left(void) {
     setup_highlight_animation();
     kill_large_art_animation();
 
-    frames_focused = 0;
     navigate_timeout = INPUT_TIMEOUT;
 }
 
@@ -456,7 +523,6 @@ menu_right(void) {
     setup_highlight_animation();
     kill_large_art_animation();
 
-    frames_focused = 0;
     navigate_timeout = INPUT_TIMEOUT;
 }
 
@@ -505,6 +571,7 @@ menu_accept(void) {
     int current_selected_item = current_selected();
 
     if (!strncmp(list_current[current_selected_item]->disc, "DIR", 3)) {
+        prof_begin(PROF_LIST);
         if (!strcmp(list_current[current_selected_item]->name, "Back")) {
             switch (list_current[current_selected_item]->product[0]) {
                 case 'A': list_set_sort_name(); break;
@@ -516,12 +583,14 @@ menu_accept(void) {
             list_set_sort_filter(list_current[current_selected_item]->product[0],
                                  list_current[current_selected_item]->slot_num);
         }
+        prof_end(PROF_LIST);
 
         list_current = list_get();
         list_len = list_length();
 
         screen_column = screen_row = 0;
         current_starting_index = 0;
+        prefetch_selected = -1;
         draw_current = DRAW_UI;
 
         navigate_timeout = 3;
@@ -741,6 +810,7 @@ FUNCTION(UI_NAME, setup) {
 
     screen_column = screen_row = 0;
     current_starting_index = 0;
+    prefetch_selected = -1;
     draw_current = DRAW_UI;
 
     navigate_timeout = 3;
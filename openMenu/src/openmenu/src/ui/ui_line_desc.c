@@ -19,6 +19,7 @@
 #include <backend/gd_list.h>
 
 #include "texture/txr_manager.h"
+#include "ui/draw_batch.h"
 #include "ui/draw_prototypes.h"
 #include "ui/font_prototypes.h"
 #include "ui/ui_common.h"
@@ -34,7 +35,6 @@
 
 /* List managment */
 #define INPUT_TIMEOUT        (10)
-#define FOCUSED_HIRES_FRAMES (60 * 1) /* 1 second load in */
 
 /* Tile parameters */
 /* Basic Info */
@@ -53,7 +53,6 @@ static short ICON_SIZE_Y;
 
 static int current_selected_item;
 static int navigate_timeout;
-static int frames_focused;
 
 db_item* current_meta;
 
@@ -62,6 +61,7 @@ static image txr_icon_list[16]; /* Lower list of 9 icons */
 static image txr_focus;         /* current selected item, either lowres or hires */
 static image txr_highlight;     /* Highlight square*/
 static image txr_bg_left, txr_bg_right;
+static draw_layer bg_layer; /* retained, see draw_bg_layers */
 static image txr_icons_white /*, txr_icons_black*/;
 static image* txr_icons_current;
 
@@ -108,6 +108,12 @@ recalculate_aspect(CFG_ASPECT aspect) {
 
 static void
 draw_bg_layers(void) {
+    /* Background only changes with the theme textures */
+    uint32_t key = draw_layer_hash(DRAW_LAYER_HASH_INIT, &txr_bg_left, sizeof(txr_bg_left));
+    key = draw_layer_hash(key, &txr_bg_right, sizeof(txr_bg_right));
+    if (!draw_layer_begin(&bg_layer, key)) {
+        return;
+    }
     {
         const dimen_RECT left = {.x = 0, .y = 0, .w = 512, .h = 480};
         draw_draw_sub_image(0, 0, 512, 480, COLOR_WHITE, &txr_bg_left, &left);
@@ -116,6 +122,7 @@ draw_bg_layers(void) {
         const dimen_RECT right = {.x = 0, .y = 0, .w = 128, .h = 480};
         draw_draw_sub_image(512, 0, 128, 480, COLOR_WHITE, &txr_bg_right, &right);
     }
+    draw_layer_end(&bg_layer);
 }
 
 static void
@@ -283,10 +290,31 @@ draw_game_meta(void) {
     }
 }
 
+/* Queue the icons just outside the strip, nearest first */
+static void
+prefetch_neighbors(void) {
+    const char* ids[/*both sides of the widest strip, NUM_ICONS <= 11*/ 2 * (11 - 11 / 2)];
+    int count = 0;
+
+    if (list_len <= 0) {
+        return;
+    }
+
+    for (int i = (NUM_ICONS / 2) + 1; i <= NUM_ICONS; i++) {
+        if (current_selected_item + i < list_len) {
+            ids[count++] = list_current[current_selected_item + i]->product;
+        }
+        if (current_selected_item - i >= 0) {
+            ids[count++] = list_current[current_selected_item - i]->product;
+        }
+    }
+    txr_prefetch_small(ids, count);
+}
+
 static void
 menu_changed_item(void) {
-    frames_focused = 0;
     db_get_meta(list_current[current_selected_item]->product, &current_meta);
+    prefetch_neighbors();
 }
 
 static bool
@@ -467,7 +495,6 @@ menu_accept(void) {
         list_len = list_length();
 
         current_selected_item = 0;
-        frames_focused = 0;
         draw_current = DRAW_UI;
 
         navigate_timeout = INPUT_TIMEOUT * 2;
@@ -517,6 +544,7 @@ menu_settings(void) {
 
 static void
 update_data(void) {
+    txr_set_focus(list_current[current_selected_item]->product);
     if (!strncmp(list_current[current_selected_item]->disc, "DIR", 3)
         && !strncmp(list_current[current_selected_item]->name, "Back", 4)) {
         txr_focus.texture = img_dir_boxart.texture;
@@ -524,17 +552,8 @@ update_data(void) {
         txr_focus.height = img_dir_boxart.height;
         txr_focus.format = img_dir_boxart.format;
     } else {
-        if (frames_focused > FOCUSED_HIRES_FRAMES) {
-            txr_get_large(list_current[current_selected_item]->product, &txr_focus);
-            if (txr_focus.texture == img_empty_boxart.texture) {
-                txr_get_small(list_current[current_selected_item]->product, &txr_focus);
-            }
-        } else {
-            txr_get_small(list_current[current_selected_item]->product, &txr_focus);
-        }
+        txr_get_progressive(list_current[current_selected_item]->product, &txr_focus);
     }
-
-    frames_focused++;
 }
 
 static void
@@ -660,7 +679,6 @@ FUNCTION(UI_NAME, setup) {
     list_len = list_length();
 
     current_selected_item = 0;
-    frames_focused = 0;
     draw_current = DRAW_UI;
 
     navigate_timeout = INPUT_TIMEOUT * 2;
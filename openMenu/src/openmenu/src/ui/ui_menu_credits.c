@@ -20,9 +20,11 @@
 #include <openmenu_savefile.h>
 #include <openmenu_settings.h>
 
+#include "ui/draw_batch.h"
 #include "ui/draw_kos.h"
 #include "ui/draw_prototypes.h"
 #include "ui/font_prototypes.h"
+#include "ui/profiler.h"
 #include "ui/ui_common.h"
 #include "ui/dc/input.h"
 
@@ -258,6 +260,8 @@ static uint32_t menu_bkg_color;
 static uint32_t menu_bkg_border_color;
 static uint32_t menu_title_color;
 
+static draw_layer menu_layer; /* settings popup, retained while nothing in it changes */
+
 /* Build version string (compiled in from VERSION.TXT at build time) */
 #ifndef OPENMENU_BUILD_VERSION
 #define OPENMENU_BUILD_VERSION "Unknown"
@@ -470,6 +474,7 @@ menu_accept(void) {
         }
 
         /* If not filtering, then plain sort */
+        prof_begin(PROF_LIST);
         if (!choices[CHOICE_FILTER]) {
             switch ((CFG_SORT)choices[CHOICE_SORT]) {
                 case SORT_NAME: list_set_sort_name(); break;
@@ -483,6 +488,7 @@ menu_accept(void) {
             /* If filtering, filter down to only genre then sort */
             list_set_genre_sort((FLAGS_GENRE)choices[CHOICE_FILTER] - 1, choices[CHOICE_SORT]);
         }
+        prof_end(PROF_LIST);
 
         extern void reload_ui(void);
         reload_ui();
@@ -1028,9 +1034,23 @@ draw_popup_menu(int x, int y, int width, int height) {
     draw_popup_menu_ex(x, y, width, height, sf_ui[0]);
 }
 
+/* Everything the settings popup shows depends on */
+static uint32_t
+menu_layer_key(void) {
+    const uint32_t colors[] = {text_color, highlight_color, menu_bkg_color, menu_bkg_border_color, menu_title_color};
+    uint32_t key = draw_layer_hash(DRAW_LAYER_HASH_INIT, choices, sizeof(choices));
+    key = draw_layer_hash(key, &current_choice, sizeof(current_choice));
+    key = draw_layer_hash(key, &sf_ui[0], sizeof(sf_ui[0]));
+    key = draw_layer_hash(key, &vm2_device_count, sizeof(vm2_device_count));
+    return draw_layer_hash(key, colors, sizeof(colors));
+}
+
 void
 draw_menu_tr(void) {
     z_set_cond(205.0f);
+    if (!draw_layer_begin(&menu_layer, menu_layer_key())) {
+        return;
+    }
     if (sf_ui[0] == UI_SCROLL || sf_ui[0] == UI_FOLDERS) {
         /* Menu size and placement */
         const int line_height = 24;
@@ -1307,6 +1327,7 @@ draw_menu_tr(void) {
 
         font_bmf_set_height_default();
     }
+    draw_layer_end(&menu_layer);
 }
 
 void
@@ -2115,6 +2136,7 @@ static void saveload_do_load(void) {
 static void saveload_close_all(int do_reload) {
     if (do_reload) {
         /* Apply loaded settings to sort/filter */
+        prof_begin(PROF_LIST);
         if (!sf_filter[0]) {
             switch ((CFG_SORT)sf_sort[0]) {
                 case SORT_NAME: list_set_sort_name(); break;
@@ -2127,6 +2149,7 @@ static void saveload_close_all(int do_reload) {
         } else {
             list_set_genre_sort((FLAGS_GENRE)sf_filter[0] - 1, sf_sort[0]);
         }
+        prof_end(PROF_LIST);
 
         extern void reload_ui(void);
         reload_ui();
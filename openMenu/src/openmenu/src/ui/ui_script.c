@@ -0,0 +1,160 @@
+/*
+ * File: ui_script.c
+ * Project: ui
+ * -----
+ * Scripted navigation through every UI for benchmarking
+ */
+
+#ifdef UI_SCRIPT
+
+#include <stdio.h>
+#include <string.h>
+
+#include <openmenu_settings.h>
+#include "ui/common.h"
+#include "ui/draw_batch.h"
+#include "ui/draw_trace.h"
+
+#include "ui/ui_script.h"
+
+extern void reload_ui(void);
+
+#define SCRIPT_SETTLE (60) /* frames after loading a UI before the script starts */
+
+/* One character per frame, repeated characters are a held button: L R U D on the pad, l r the
+ * triggers, x X, s Start, b B and . nothing. Never A, it would launch whatever is selected */
+static const char script[] = "R.R.R.R.R.R.R.R...D.D.D.D.D.D.D.D...L.L.L.L.L.L.L.L...U.U.U.U.U.U.U.U..."
+                             "DDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDD....UUUUUUUUUUUUUUUUUUUUUUUUUUUUUUUU...."
+                             "RRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRR....LLLLLLLLLLLLLLLLLLLLLLLLLLLLLLLL...."
+                             "r.......r.......r.......l.......l.......l......."
+                             "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx................"
+                             "s...............D.D.D.D.........b...............";
+
+static const char* ui_names[] = {"line desc", "grid3", "scroll", "folders"};
+
+typedef enum SCRIPT_STAT {
+    STAT_QUADS = 0,
+    STAT_HEADERS,
+    STAT_FLUSHES,
+    STAT_GLYPHS,
+    STAT_SUBMIT_US,
+#ifdef DRAW_SUBMIT_RECORD
+    STAT_VERTICES,
+    STAT_BINDS,
+#endif
+    STAT_COUNT
+} SCRIPT_STAT;
+
+static const char* stat_names[] = {"quads", "headers", "flushes", "glyphs", "submit_us", "vertices", "binds"};
+
+static unsigned int stat_sum[STAT_COUNT];
+static unsigned int stat_max[STAT_COUNT];
+static unsigned int stat_frames;
+
+static int script_ui = -1; /* UI being driven, -1 before the first one is loaded */
+static int script_done;
+static int saved_ui;
+static unsigned int step;
+
+static void
+script_load(int ui) {
+    script_ui = ui;
+    sf_ui[0] = ui;
+    reload_ui();
+
+    step = 0;
+    stat_frames = 0;
+    memset(stat_sum, 0, sizeof(stat_sum));
+    memset(stat_max, 0, sizeof(stat_max));
+}
+
+/* Stats of the frame drawn after the previous input */
+static void
+script_sample(void) {
+    unsigned int value[STAT_COUNT];
+    draw_batch_stats batch;
+
+    draw_batch_get_stats(&batch);
+    value[STAT_QUADS] = batch.quads;
+    value[STAT_HEADERS] = batch.headers;
+    value[STAT_FLUSHES] = batch.flushes;
+    value[STAT_GLYPHS] = batch.glyphs;
+    value[STAT_SUBMIT_US] = batch.submit_us;
+#ifdef DRAW_SUBMIT_RECORD
+    draw_trace_stats trace;
+    draw_trace_get_stats(&trace);
+    value[STAT_VERTICES] = trace.vertices;
+    value[STAT_BINDS] = trace.binds;
+#endif
+
+    for (int i = 0; i < STAT_COUNT; i++) {
+        stat_sum[i] += value[i];
+        if (value[i] > stat_max[i]) {
+            stat_max[i] = value[i];
+        }
+    }
+    stat_frames++;
+}
+
+static void
+script_report(void) {
+    printf("SCRIPT: %s %u frames, avg/max per frame", ui_names[script_ui], stat_frames);
+    for (int i = 0; i < STAT_COUNT; i++) {
+        printf(" %s=%u/%u", stat_names[i], stat_frames ? stat_sum[i] / stat_frames : 0, stat_max[i]);
+    }
+    printf("\n");
+}
+
+static unsigned int
+script_control(char chr) {
+    switch (chr) {
+        case 'L': return LEFT;
+        case 'R': return RIGHT;
+        case 'U': return UP;
+        case 'D': return DOWN;
+        case 'l': return TRIG_L;
+        case 'r': return TRIG_R;
+        case 'x': return X;
+        case 's': return START;
+        case 'b': return B;
+        default: return NONE;
+    }
+}
+
+unsigned int
+ui_script_input(unsigned int pad_input) {
+    if (script_done) {
+        return pad_input;
+    }
+    if (script_ui < 0) {
+        saved_ui = sf_ui[0];
+        script_load(UI_START);
+        return NONE;
+    }
+
+    step++;
+    if (step <= SCRIPT_SETTLE) {
+        return NONE;
+    }
+    if (step > SCRIPT_SETTLE + 1) {
+        script_sample();
+    }
+
+    const unsigned int index = step - SCRIPT_SETTLE - 1;
+    if (index < sizeof(script) - 1) {
+        return script_control(script[index]);
+    }
+
+    script_report();
+    if (script_ui < UI_END) {
+        script_load(script_ui + 1);
+    } else {
+        sf_ui[0] = saved_ui;
+        reload_ui();
+        script_done = 1;
+        printf("SCRIPT: done\n");
+    }
+    return NONE;
+}
+
+#endif /* UI_SCRIPT */
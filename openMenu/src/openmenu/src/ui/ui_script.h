@@ -0,0 +1,27 @@
+/*
+ * File: ui_script.h
+ * Project: ui
+ * -----
+ * Scripted navigation through every UI for benchmarking
+ */
+
+#pragma once
+
+/* Built with UI_SCRIPT, each UI in turn is loaded and driven through the same fixed navigation
+ * sequence, one input per frame, and the submission stats of its frames are summed up on serial
+ * when it finishes. Afterwards the UI picked in the settings comes back and the pad works again.
+ * Pair with DRAW_SUBMIT_RECORD to get a per frame trace of the same run.
+ *
+ *   (*current_ui_handle_input)(ui_script_input(translate_input()));
+ */
+
+#ifdef UI_SCRIPT
+
+/* Input for this frame, the pad's input passes through once the script is done */
+unsigned int ui_script_input(unsigned int pad_input);
+
+#else
+
+#define ui_script_input(pad_input) (pad_input)
+
+#endif
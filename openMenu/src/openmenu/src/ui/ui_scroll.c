@@ -18,8 +18,10 @@
 #include <backend/gd_list.h>
 #include <openmenu_settings.h>
 #include "texture/txr_manager.h"
+#include "ui/draw_batch.h"
 #include "ui/draw_prototypes.h"
 #include "ui/font_prototypes.h"
+#include "ui/profiler.h"
 #include "ui/ui_common.h"
 #include "ui/ui_menu_credits.h"
 #include "ui/dc/input.h"
@@ -29,6 +31,7 @@
 #define UNUSED __attribute__((unused))
 
 static image txr_bg_left, txr_bg_right;
+static draw_layer bg_layer; /* retained, see draw_bg_layers */
 
 /* Info taken from megavolt85 and RazorX */
 /* GDMENU Default Colors */
@@ -138,6 +141,7 @@ static char cusor_step = -5;
 #define MARQUEE_DISPLAY_WIDTH 49
 #define MARQUEE_INITIAL_PAUSE_FRAMES 60
 #define MARQUEE_END_PAUSE_FRAMES 90
+#define FONT_CHAR_WIDTH 8
 
 typedef enum {
     MARQUEE_STATE_INITIAL_PAUSE,
@@ -147,7 +151,7 @@ typedef enum {
 } marquee_state_t;
 
 static marquee_state_t marquee_state = MARQUEE_STATE_INITIAL_PAUSE;
-static int marquee_offset = 0;
+static float marquee_offset = 0; /* pixels */
 static int marquee_timer = 0;
 static int marquee_max_offset = 0;
 static int marquee_last_selected = -1;
@@ -163,6 +167,12 @@ get_marquee_speed_frames(void) {
     }
 }
 
+/* Pixels per frame, the same pace as the old one character per step */
+static inline float
+get_marquee_speed(void) {
+    return (float)FONT_CHAR_WIDTH / get_marquee_speed_frames();
+}
+
 /*static theme_color gdemu_colors = {
     .text_color = color_main_default,
     .highlight_color = color_main_highlight,
@@ -183,6 +193,7 @@ extern image img_dir_boxart;
 static int current_selected_item = 0;
 static int current_starting_index = 0;
 static int navigate_timeout = INPUT_TIMEOUT_INITIAL;
+static int prefetch_selected = -1;
 static enum draw_state draw_current = DRAW_UI;
 
 static bool direction_last = false;
@@ -191,6 +202,12 @@ static bool direction_current = false;
 
 static void
 draw_bg_layers(void) {
+    /* Background only changes with the theme textures */
+    uint32_t key = draw_layer_hash(DRAW_LAYER_HASH_INIT, &txr_bg_left, sizeof(txr_bg_left));
+    key = draw_layer_hash(key, &txr_bg_right, sizeof(txr_bg_right));
+    if (!draw_layer_begin(&bg_layer, key)) {
+        return;
+    }
     {
         const dimen_RECT left = {.x = 0, .y = 0, .w = 512, .h = 480};
         draw_draw_sub_image(0, 0, 512, 480, COLOR_WHITE, &txr_bg_left, &left);
@@ -199,6 +216,7 @@ draw_bg_layers(void) {
         const dimen_RECT right = {.x = 0, .y = 0, .w = 128, .h = 480};
         draw_draw_sub_image(512, 0, 128, 480, COLOR_WHITE, &txr_bg_right, &right);
     }
+    draw_layer_end(&bg_layer);
 }
 
 static void
@@ -209,9 +227,10 @@ marquee_reset(void) {
     marquee_max_offset = 0;
 }
 
+/* name_length and the threshold are in characters, the offset moves in pixels */
 static void
 marquee_update_animation(int name_length) {
-    int max_offset = name_length - MARQUEE_DISPLAY_WIDTH;
+    int max_offset = (name_length - MARQUEE_DISPLAY_WIDTH) * FONT_CHAR_WIDTH;
     if (max_offset < 0) {
         max_offset = 0;
     }
@@ -226,33 +245,27 @@ marquee_update_animation(int name_length) {
     switch (marquee_state) {
         case MARQUEE_STATE_INITIAL_PAUSE:
             marquee_state = MARQUEE_STATE_SCROLL_LEFT;
-            marquee_timer = get_marquee_speed_frames();
             break;
 
         case MARQUEE_STATE_SCROLL_LEFT:
-            marquee_offset++;
+            marquee_offset += get_marquee_speed();
             if (marquee_offset >= marquee_max_offset) {
                 marquee_offset = marquee_max_offset;
                 marquee_state = MARQUEE_STATE_END_PAUSE;
                 marquee_timer = MARQUEE_END_PAUSE_FRAMES;
-            } else {
-                marquee_timer = get_marquee_speed_frames();
             }
             break;
 
         case MARQUEE_STATE_END_PAUSE:
             marquee_state = MARQUEE_STATE_SCROLL_RIGHT;
-            marquee_timer = get_marquee_speed_frames();
             break;
 
         case MARQUEE_STATE_SCROLL_RIGHT:
-            marquee_offset--;
+            marquee_offset -= get_marquee_speed();
             if (marquee_offset <= 0) {
                 marquee_offset = 0;
                 marquee_state = MARQUEE_STATE_INITIAL_PAUSE;
                 marquee_timer = MARQUEE_INITIAL_PAUSE_FRAMES;
-            } else {
-                marquee_timer = get_marquee_speed_frames();
             }
             break;
     }
@@ -323,13 +336,10 @@ draw_gamelist(void) {
             int name_len = strlen(buffer);
             if (name_len > MARQUEE_DISPLAY_WIDTH) {
                 marquee_update_animation(name_len);
-                /* Show only 49-char window */
-                char saved_char = buffer[marquee_offset + MARQUEE_DISPLAY_WIDTH];
-                buffer[marquee_offset + MARQUEE_DISPLAY_WIDTH] = '\0';
-                font_bmp_draw_main(cur_theme->pos_gameslist_x + X_ADJUST_TEXT,
-                                   cur_theme->pos_gameslist_y + Y_ADJUST_TEXT + (i * 21),
-                                   &buffer[marquee_offset]);
-                buffer[marquee_offset + MARQUEE_DISPLAY_WIDTH] = saved_char;
+                /* Show only 49-char window, scrolled by whole pixels */
+                font_bmp_draw_clipped(cur_theme->pos_gameslist_x + X_ADJUST_TEXT,
+                                      cur_theme->pos_gameslist_y + Y_ADJUST_TEXT + (i * 21), buffer, name_len,
+                                      (int)marquee_offset, MARQUEE_DISPLAY_WIDTH * FONT_CHAR_WIDTH);
             } else {
                 font_bmp_draw_main(cur_theme->pos_gameslist_x + X_ADJUST_TEXT,
                                    cur_theme->pos_gameslist_y + Y_ADJUST_TEXT + (i * 21),
@@ -424,6 +434,27 @@ draw_gameinfo(void) {
     font_bmp_draw_main(cur_theme->pos_gameinfo_x, cur_theme->pos_gameinfo_version_y, line_buf);
 }
 
+/* The art for the entries either side is what gets shown next */
+static void
+prefetch_neighbors(void) {
+    const char* ids[2];
+    int count = 0;
+
+    /* Wait for focus to settle so held scrolling doesn't queue art for every item passed */
+    if (prefetch_selected == current_selected_item || !txr_focus_settled()) {
+        return;
+    }
+    prefetch_selected = current_selected_item;
+
+    if (current_selected_item + 1 < list_len) {
+        ids[count++] = list_current[current_selected_item + 1]->product;
+    }
+    if (current_selected_item > 0) {
+        ids[count++] = list_current[current_selected_item - 1]->product;
+    }
+    txr_prefetch_large(ids, count);
+}
+
 static void
 draw_gameart(void) {
     /* Check if artwork display is disabled */
@@ -442,12 +473,12 @@ draw_gameart(void) {
         txr_focus.height = img_dir_boxart.height;
         txr_focus.format = img_dir_boxart.format;
     } else {
-        txr_get_large(list_current[current_selected_item]->product, &txr_focus);
-        if (txr_focus.texture == img_empty_boxart.texture) {
-            txr_get_small(list_current[current_selected_item]->product, &txr_focus);
-        }
+        txr_set_focus(list_current[current_selected_item]->product);
+        txr_get_progressive(list_current[current_selected_item]->product, &txr_focus);
     }
 
+    prefetch_neighbors();
+
     if (txr_focus.texture == img_empty_boxart.texture) {
         /* Only draw if image is present */
         return;
@@ -540,6 +571,7 @@ menu_accept(void) {
     }
 
     if (!strncmp(list_current[current_selected_item]->disc, "DIR", 3)) {
+        prof_begin(PROF_LIST);
         if (!strcmp(list_current[current_selected_item]->name, "Back")) {
             switch (list_current[current_selected_item]->product[0]) {
                 case 'A': list_set_sort_name(); break;
@@ -551,12 +583,14 @@ menu_accept(void) {
             list_set_sort_filter(list_current[current_selected_item]->product[0],
                                  list_current[current_selected_item]->slot_num);
         }
+        prof_end(PROF_LIST);
 
         list_current = list_get();
         list_len = list_length();
 
         current_selected_item = 0;
         current_starting_index = 0;
+        prefetch_selected = -1;
         navigate_timeout = INPUT_TIMEOUT_INITIAL * 2;
         draw_current = DRAW_UI;
         return;
@@ -708,6 +742,7 @@ FUNCTION(UI_NAME, setup) {
 
     current_selected_item = 0;
     current_starting_index = 0;
+    prefetch_selected = -1;
     navigate_timeout = INPUT_TIMEOUT_INITIAL * 2;
     draw_current = DRAW_UI;
 
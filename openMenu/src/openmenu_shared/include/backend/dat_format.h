@@ -17,9 +17,13 @@
 #include <kos/fs.h>
 #endif
 
+/* Largest item DAT_read_file_by_ID will read, the size of the texture loaders' buffer */
+#define DAT_MAX_ITEM_SIZE (512 * 512 * 2)
+
 typedef struct bin_item {
     char ID[12];
     uint32_t offset;
+    uint32_t length;   /* Chunks used by this item, always 1 in ver1 */
     UT_hash_handle hh; /* makes this structure hashable */
 } bin_item;
 
@@ -31,7 +35,9 @@ typedef struct bin_header {
         } rich;
 
         uint32_t raw;
-    } magic; /* DAT1 : DAT + single digit version */
+    } magic; /* DAT1 : DAT + single digit version
+              * DAT2 : items may span several chunks (variable sized VQ art), an item runs up to the
+              *        next item in the table or the end of the file */
 
     uint32_t chunk_size; /* Size of each chunk in the file */
     uint32_t num_chunks; /* How many chunks are present in this bin */
@@ -56,5 +62,6 @@ void DAT_info(const dat_file* bin);
 
 uint32_t DAT_get_offset_by_ID(const dat_file* bin, const char* ID);
 uint32_t DAT_get_index_by_ID(const dat_file* bin, const char* ID);
+uint32_t DAT_get_size_by_ID(const dat_file* bin, const char* ID);
 int DAT_read_file_by_ID(const dat_file* bin, const char* ID, void* buf);
 int DAT_read_file_by_num(const dat_file* bin, uint32_t chunk_num, void* buf);
@@ -75,11 +75,17 @@ DAT_load_parse(dat_file* bin, const char* path) {
 #else
     fread(&file_header, sizeof(bin_header), 1, bin_fd);
 #endif
-    if (file_header.magic.rich.version != 1) {
+    if (file_header.magic.rich.version != 1 && file_header.magic.rich.version != 2) {
         printf("DAT:Error Incorrect input file format!\n");
         return 1;
     }
 
+    /* A ver1 item is a whole chunk */
+    if (!file_header.chunk_size || (file_header.magic.rich.version == 1 && file_header.chunk_size > DAT_MAX_ITEM_SIZE)) {
+        printf("DAT:Error Unsupported chunk size %u!\n", (unsigned int)file_header.chunk_size);
+        return 1;
+    }
+
     /* setup basic bin file info */
     bin->chunk_size = file_header.chunk_size;
     bin->num_chunks = file_header.num_chunks;
@@ -98,9 +104,35 @@ DAT_load_parse(dat_file* bin, const char* path) {
 #else
         fread(&bin->items[i], sizeof(bin_item_raw), 1, bin->handle);
 #endif
+        bin->items[i].length = 1;
         HASH_ADD_STR(bin->hash, ID, &bin->items[i]);
     }
 
+    /* ver2 items are written back to back, each one ends where the next starts */
+    if (file_header.magic.rich.version == 2 && bin->num_chunks) {
+#ifndef STANDALONE_BINARY
+        const uint32_t total_chunks = fs_total(bin->handle) / bin->chunk_size;
+#else
+        fseek(bin->handle, 0, SEEK_END);
+        const uint32_t total_chunks = ftell(bin->handle) / bin->chunk_size;
+#endif
+        for (unsigned int i = 0; i < bin->num_chunks - 1; i++) {
+            bin->items[i].length = bin->items[i + 1].offset - bin->items[i].offset;
+        }
+        bin->items[bin->num_chunks - 1].length = total_chunks - bin->items[bin->num_chunks - 1].offset;
+
+        /* Out of order offsets wrap around, so this also catches a corrupt table. Rejected items are
+         * given offset 0, which reads as not present */
+        for (unsigned int i = 0; i < bin->num_chunks; i++) {
+            const uint32_t length = bin->items[i].length;
+            if (!length || length > DAT_MAX_ITEM_SIZE / bin->chunk_size) {
+                printf("DAT:Error Item %.12s spans %u chunks, skipped!\n", bin->items[i].ID, (unsigned int)length);
+                bin->items[i].offset = 0;
+                bin->items[i].length = 0;
+            }
+        }
+    }
+
     /* Leave our handle in a handy place in case we need to read after */
 #ifndef STANDALONE_BINARY
     fs_seek(bin->handle, bin->items[0].offset * bin->chunk_size, SEEK_SET);
@@ -135,6 +167,17 @@ DAT_get_offset_by_ID(const dat_file* bin, const char* ID) {
     return ret;
 }
 
+uint32_t
+DAT_get_size_by_ID(const dat_file* bin, const char* ID) {
+    const bin_item* item;
+
+    HASH_FIND_STR(bin->hash, ID, item);
+    if (item) {
+        return item->length * bin->chunk_size;
+    }
+    return 0;
+}
+
 uint32_t
 DAT_get_index_by_ID(const dat_file* bin, const char* ID) {
     const bin_item* item;
@@ -152,14 +195,18 @@ DAT_get_index_by_ID(const dat_file* bin, const char* ID) {
 
 int
 DAT_read_file_by_ID(const dat_file* bin, const char* ID, void* buf) {
-    uint32_t offset = DAT_get_offset_by_ID(bin, ID);
-    if (offset) {
+    const bin_item* item;
+
+    HASH_FIND_STR(bin->hash, ID, item);
+    if (item && item->offset) {
+        const uint32_t offset = item->offset * bin->chunk_size;
+        const uint32_t size = item->length * bin->chunk_size;
 #ifndef STANDALONE_BINARY
         fs_seek(bin->handle, offset, SEEK_SET);
-        fs_read(bin->handle, buf, bin->chunk_size);
+        fs_read(bin->handle, buf, size);
 #else
         fseek(bin->handle, offset, SEEK_SET);
-        fread(buf, bin->chunk_size, 1, bin->handle);
+        fread(buf, size, 1, bin->handle);
 #endif
         return 1;
     }
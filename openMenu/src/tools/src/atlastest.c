@@ -0,0 +1,265 @@
+/*
+ * File: atlastest.c
+ * Project: tools
+ * File Created: Sunday, 18th October 2026
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "texture/block_pool.h"
+#include "texture/lru.h"
+#include "texture/txr_atlas.h"
+
+/* Called:
+./atlastest
+
+checks the small pool packer, LRU eviction and atlas tile addressing the way the texture manager
+uses them, then compares headers for a grid page drawn per icon and from atlas pages.
+Exits non zero if any check failed.
+*/
+
+/* Small pool as the texture manager sets it up: 64 units of 64x64 16bit, one 512x512 page */
+#define UNIT_SIZE  (64 * 64 * 2)
+#define UNIT_NUM   (ATLAS_PAGE_SIZE / UNIT_SIZE)
+#define TILE_16BIT (128 * 128 * 2)      /* upload size, without the PVR header */
+#define TILE_VQ    (2048 + 128 * 128 / 4) /* codebook and indices */
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("FAIL %s:%d: ", __FILE__, __LINE__);                                                                      \
+      printf(__VA_ARGS__);                                                                                             \
+      printf("\n");                                                                                                    \
+      failures++;                                                                                                      \
+    }                                                                                                                  \
+  } while (0)
+
+/* Texel (x, y) of a twiddled square texture, y in the even bits and x in the odd ones */
+static unsigned int twiddle(unsigned int x, unsigned int y) {
+  unsigned int ret = 0;
+  for (unsigned int bit = 0; x | y; bit++, x >>= 1, y >>= 1) {
+    ret |= ((y & 1) << (2 * bit)) | ((x & 1) << (2 * bit + 1));
+  }
+  return ret;
+}
+
+static void test_slots_for_size(block_pool *pool) {
+  static const struct {
+    unsigned int size, units;
+  } cases[] = {
+      {1, 1},          {UNIT_SIZE, 1},      {UNIT_SIZE + 1, 2},     {TILE_VQ, 1},
+      {TILE_16BIT, 4}, {3 * UNIT_SIZE, 4},  {5 * UNIT_SIZE, 8},     {ATLAS_PAGE_SIZE, UNIT_NUM},
+  };
+  for (unsigned int i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    const unsigned int units = pool_slots_for_size(pool, cases[i].size);
+    CHECK(units == cases[i].units, "%u bytes took %u units, expected %u", cases[i].size, units, cases[i].units);
+  }
+}
+
+/* True when some run of count units aligned to count is entirely free */
+static int run_exists(const block_pool *pool, unsigned int count) {
+  for (unsigned int i = 0; i + count <= pool->slots; i += count) {
+    unsigned int j = 0;
+    while (j < count && !pool->state[i + j]) {
+      j++;
+    }
+    if (j == count) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* Random allocations and frees, checked against a shadow map of who owns each unit */
+static void test_alloc_run(block_pool *pool) {
+  int owner[UNIT_NUM];
+  unsigned int start[UNIT_NUM], length[UNIT_NUM];
+  int live = 0;
+
+  srand(1);
+  memset(owner, -1, sizeof(owner));
+  pool_dealloc_all(pool);
+
+  for (int step = 0; step < 20000; step++) {
+    if (live && rand() % 3 == 0) {
+      const int victim = rand() % live;
+      pool_dealloc_slot(pool, start[victim]);
+      for (unsigned int u = 0; u < length[victim]; u++) {
+        owner[start[victim] + u] = -1;
+      }
+      start[victim] = start[live - 1];
+      length[victim] = length[live - 1];
+      live--;
+      continue;
+    }
+
+    const unsigned int count = 1u << (rand() % 4);
+    const int expected = run_exists(pool, count);
+    unsigned int slot;
+    void *ptr;
+    const int ret = pool_alloc_run(pool, count, &slot, &ptr);
+
+    CHECK((ret == 0) == expected, "step %d: run of %u %s", step, count, expected ? "refused" : "handed out");
+    if (ret != 0) {
+      continue;
+    }
+    CHECK(slot % count == 0, "run of %u at unit %u isn't aligned", count, slot);
+    CHECK(ptr == pool_get_slot_addr(pool, slot), "run at unit %u has the wrong address", slot);
+    for (unsigned int u = 0; u < count; u++) {
+      CHECK(owner[slot + u] == -1, "unit %u handed out twice", slot + u);
+      owner[slot + u] = live;
+    }
+    start[live] = slot;
+    length[live] = count;
+    live++;
+  }
+  pool_dealloc_all(pool);
+}
+
+static unsigned int pool_del_cb(const char *key, void *value, void *user) {
+  (void)key;
+  pool_dealloc_slot((block_pool *)user, *(int *)value);
+  return 0;
+}
+
+/* Same loop as txr_alloc_run: evict least recently used textures until the run fits */
+static int alloc_evicting(block_pool *pool, cache_instance *cache, unsigned int units, unsigned int *slot) {
+  void *ptr;
+  while (pool_alloc_run(pool, units, slot, &ptr) == -1) {
+    if (peek_oldest_in_cache(cache) < 0) {
+      return -1;
+    }
+    evict_oldest_in_cache(cache);
+  }
+  return 0;
+}
+
+static void test_eviction(block_pool *pool) {
+  cache_instance cache = {0};
+  char key[16];
+  unsigned int slot;
+
+  pool_dealloc_all(pool);
+  cache_set_size(&cache, UNIT_NUM);
+  cache_callback_userdata(&cache, pool);
+  cache_callback_del(&cache, pool_del_cb);
+
+  /* A page of 16bit icons fills the pool */
+  for (int i = 0; i < UNIT_NUM / 4; i++) {
+    snprintf(key, sizeof(key), "T%02d", i);
+    CHECK(alloc_evicting(pool, &cache, 4, &slot) == 0, "icon %d didn't fit an empty pool", i);
+    add_to_cache(&cache, key, slot);
+  }
+
+  /* Touching the oldest keeps it, the next oldest goes instead */
+  find_in_cache(&cache, "T00");
+  CHECK(alloc_evicting(pool, &cache, 4, &slot) == 0, "no room made for a new icon");
+  CHECK(peek_in_cache(&cache, "T00") >= 0, "recently used icon was evicted");
+  CHECK(peek_in_cache(&cache, "T01") < 0, "least recently used icon survived");
+  CHECK(slot == 4, "new icon took unit %u instead of the evicted icon's", slot);
+  add_to_cache(&cache, "N00", slot);
+
+  /* A VQ icon takes a single unit, and a freed 16bit slot holds four of them */
+  const unsigned int vq_units = pool_slots_for_size(pool, TILE_VQ);
+  for (int i = 0; i < 4; i++) {
+    snprintf(key, sizeof(key), "V%02d", i);
+    CHECK(alloc_evicting(pool, &cache, vq_units, &slot) == 0, "VQ icon %d didn't fit", i);
+    add_to_cache(&cache, key, slot);
+    CHECK(slot >= 8 && slot < 12, "VQ icon %d went to unit %u, not the one freed 16bit slot", i, slot);
+  }
+
+  /* A request bigger than the pool fails once nothing is left to evict */
+  CHECK(alloc_evicting(pool, &cache, UNIT_NUM * 2, &slot) == -1, "oversized run succeeded");
+  CHECK(peek_oldest_in_cache(&cache) == -1, "oversized run left entries behind");
+
+  empty_cache(&cache);
+  pool_dealloc_all(pool);
+}
+
+/* Every texel of a tile's own twiddled image must be where the page's UVs say it is */
+static void test_untwiddle(block_pool *pool) {
+  unsigned int slot;
+  void *ptr;
+
+  pool_dealloc_all(pool);
+  for (unsigned int edge = 64; edge <= ATLAS_TILE_EDGE; edge <<= 1) {
+    const unsigned int units = pool_slots_for_size(pool, edge * edge * 2);
+    pool_dealloc_all(pool);
+    while (pool_alloc_run(pool, units, &slot, &ptr) == 0) {
+      const unsigned int first_texel = slot * UNIT_SIZE / 2;
+      const unsigned int tile = first_texel / (edge * edge);
+      const unsigned int u = atlas_untwiddle(tile >> 1) * edge;
+      const unsigned int v = atlas_untwiddle(tile) * edge;
+
+      CHECK(u + edge <= ATLAS_EDGE && v + edge <= ATLAS_EDGE, "%ux%u tile %u is off the page", edge, edge, tile);
+      for (unsigned int y = 0; y < edge; y += 7) {
+        for (unsigned int x = 0; x < edge; x += 5) {
+          const unsigned int in_page = twiddle(u + x, v + y);
+          const unsigned int in_tile = first_texel + twiddle(x, y);
+          if (in_page != in_tile) {
+            CHECK(0, "%ux%u tile %u texel %u,%u is at %u in the page, not %u", edge, edge, tile, x, y, in_page,
+                  in_tile);
+            return;
+          }
+        }
+      }
+    }
+  }
+  pool_dealloc_all(pool);
+}
+
+/* Headers for a 4x3 grid page of icons plus the highlight, per icon and from atlas pages */
+static void compare_headers(block_pool *pool, int vq_icons) {
+  unsigned int page[12];
+  unsigned int slot;
+  void *ptr;
+  int per_icon = 1, atlas = 1; /* the highlight */
+  int last_page = -1;
+
+  pool_dealloc_all(pool);
+  for (int i = 0; i < 12; i++) {
+    const int vq = i < vq_icons;
+    pool_alloc_run(pool, pool_slots_for_size(pool, vq ? TILE_VQ : TILE_16BIT), &slot, &ptr);
+    page[i] = vq ? 0xFFFFFFFF : slot * UNIT_SIZE / ATLAS_PAGE_SIZE;
+  }
+
+  /* The grid flushes a run whenever the page changes, VQ icons are drawn on their own */
+  for (int i = 0; i < 12; i++) {
+    per_icon++;
+    if (page[i] == 0xFFFFFFFF) {
+      atlas++;
+      last_page = -1;
+    } else if ((int)page[i] != last_page) {
+      atlas++;
+      last_page = page[i];
+    }
+  }
+  printf("4x3 grid, %2d VQ icons: %2d headers drawn per icon, %2d from atlas pages\n", vq_icons, per_icon, atlas);
+  CHECK(atlas <= per_icon, "atlas drawing needs more headers than drawing per icon");
+  pool_dealloc_all(pool);
+}
+
+int main(void) {
+  static unsigned char vram[ATLAS_PAGE_SIZE];
+  block_pool pool;
+
+  pool_create(&pool, vram, sizeof(vram), UNIT_NUM);
+
+  test_slots_for_size(&pool);
+  test_alloc_run(&pool);
+  test_eviction(&pool);
+  test_untwiddle(&pool);
+
+  compare_headers(&pool, 0);
+  compare_headers(&pool, 6);
+  compare_headers(&pool, 12);
+
+  pool_destroy(&pool);
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
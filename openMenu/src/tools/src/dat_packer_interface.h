@@ -24,6 +24,6 @@ typedef struct bin_item_raw {
 #endif
 
 void open_output(const char* path);
-void write_bin_file(bin_header* file_header, bin_item_raw* bin_items, void* data_buf);
+void write_bin_file(bin_header* file_header, bin_item_raw* bin_items, void* data_buf, uint32_t data_chunks);
 int iterate_dir(const char* path, int (*file_cb)(const char*, const char*, struct stat*), bin_header* file_header,
                 bin_item_raw** bin_items);
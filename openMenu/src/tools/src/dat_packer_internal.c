@@ -20,7 +20,7 @@ void open_output(const char *path) {
   }
 }
 
-void write_bin_file(bin_header *file_header, bin_item_raw *bin_items, void *data_buf) {
+void write_bin_file(bin_header *file_header, bin_item_raw *bin_items, void *data_buf, uint32_t data_chunks) {
   printf("Writing:");
   /* Write header */
   printf("header..");
@@ -41,7 +41,7 @@ void write_bin_file(bin_header *file_header, bin_item_raw *bin_items, void *data
     return;
   }
   printf("chunks..");
-  fwrite(data_buf, file_header->num_chunks * file_header->chunk_size, 1, out_fd);
+  fwrite(data_buf, data_chunks * file_header->chunk_size, 1, out_fd);
 
   fclose(out_fd);
   printf("done!\n");
@@ -0,0 +1,425 @@
+/*
+ * File: dcnow_replay.c
+ * Project: tools
+ * File Created: Sunday, 18th October 2026
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "dcnow_replay.h"
+
+#define REPLAY_PATH "/now/api/users.json"
+#define REPLAY_REQUEST_MAX 2048
+#define REPLAY_POLL_MS 100
+#define REPLAY_STALL_MS 60000 /* longest a stalled response holds the connection */
+
+typedef struct {
+  char *data;
+  size_t size;
+  bool gzip;
+  char etag[32];
+} replay_trace_t;
+
+/* A response on its way out, paced from its first byte */
+typedef struct {
+  int fd;
+  uint64_t start_us;
+  uint64_t bytes;
+} replay_link_t;
+
+static replay_config_t cfg;
+static replay_trace_t *traces;
+static int listen_fd = -1;
+static pthread_t server_thread;
+static volatile bool stopping;
+static volatile int request_count;
+
+static uint64_t now_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)(ts.tv_nsec / 1000);
+}
+
+static void sleep_us(uint64_t us) {
+  struct timespec ts = {(time_t)(us / 1000000), (long)(us % 1000000) * 1000};
+  nanosleep(&ts, NULL);
+}
+
+/* FNV-1a, equal traces get equal ETags */
+static uint32_t trace_hash(const char *data, size_t size) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ (unsigned char)data[i]) * 16777619u;
+  }
+  return hash;
+}
+
+static bool load_trace(replay_trace_t *trace, const char *path) {
+  FILE *file = fopen(path, "rb");
+  long size;
+  size_t len = strlen(path);
+
+  if (!file) {
+    printf("REPLAY: Can't open %s: %s\n", path, strerror(errno));
+    return false;
+  }
+  fseek(file, 0, SEEK_END);
+  size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+
+  trace->data = malloc(size > 0 ? size : 1);
+  if (!trace->data || fread(trace->data, 1, size, file) != (size_t)size) {
+    printf("REPLAY: Can't read %s\n", path);
+    fclose(file);
+    return false;
+  }
+  fclose(file);
+
+  trace->size = size;
+  trace->gzip = (len > 3 && strcmp(path + len - 3, ".gz") == 0);
+  snprintf(trace->etag, sizeof(trace->etag), "\"%08x-%lx\"", (unsigned)trace_hash(trace->data, size), size);
+  return true;
+}
+
+/* Value of a request header, matched without regard to case, false when it isn't there */
+static bool header_value(const char *request, const char *name, char *out, size_t out_len) {
+  const size_t name_len = strlen(name);
+  const char *line = strstr(request, "\r\n");
+
+  while (line) {
+    line += 2;
+    if (strncasecmp(line, name, name_len) == 0 && line[name_len] == ':') {
+      const char *value = line + name_len + 1;
+      const char *end = strstr(value, "\r\n");
+      size_t value_len = end ? (size_t)(end - value) : strlen(value);
+      while (*value == ' ' && value_len) {
+        value++;
+        value_len--;
+      }
+      if (value_len >= out_len) {
+        value_len = out_len - 1;
+      }
+      memcpy(out, value, value_len);
+      out[value_len] = '\0';
+      return true;
+    }
+    line = strstr(line, "\r\n");
+  }
+  return false;
+}
+
+/* Writes at most a fragment at a time and sleeps whenever it gets ahead of the link rate */
+static bool link_send(replay_link_t *link, const char *data, size_t len) {
+  size_t piece = len;
+
+  if (cfg.fragment > 0) {
+    piece = cfg.fragment;
+  } else if (cfg.bytes_per_sec) {
+    piece = cfg.bytes_per_sec / 20 + 1;
+  }
+
+  while (len > 0) {
+    const ssize_t sent = send(link->fd, data, len < piece ? len : piece, MSG_NOSIGNAL);
+    if (sent <= 0) {
+      return false;
+    }
+    data += sent;
+    len -= sent;
+    link->bytes += sent;
+
+    if (cfg.bytes_per_sec) {
+      const uint64_t due = link->start_us + link->bytes * 1000000 / cfg.bytes_per_sec;
+      const uint64_t now = now_us();
+      if (due > now) {
+        sleep_us(due - now);
+      }
+    }
+  }
+  return true;
+}
+
+static bool send_body(replay_link_t *link, const char *data, size_t len) {
+  if (!cfg.chunked) {
+    return link_send(link, data, len);
+  }
+
+  /* Chunk boundaries fall wherever writes do, so the client sees both kinds of split */
+  const size_t chunk_max = cfg.fragment > 0 ? (size_t)cfg.fragment : 1024;
+  while (len > 0) {
+    const size_t chunk = len < chunk_max ? len : chunk_max;
+    char size_line[16];
+    snprintf(size_line, sizeof(size_line), "%zx\r\n", chunk);
+    if (!link_send(link, size_line, strlen(size_line)) || !link_send(link, data, chunk) ||
+        !link_send(link, "\r\n", 2)) {
+      return false;
+    }
+    data += chunk;
+    len -= chunk;
+  }
+  return true;
+}
+
+/* Holds the connection without sending until the client closes it */
+static void stall(int fd) {
+  struct pollfd pfd = {fd, POLLIN, 0};
+  char scratch[256];
+
+  for (int waited = 0; waited < REPLAY_STALL_MS && !stopping; waited += REPLAY_POLL_MS) {
+    if (poll(&pfd, 1, REPLAY_POLL_MS) > 0 && recv(fd, scratch, sizeof(scratch), 0) <= 0) {
+      return;
+    }
+  }
+}
+
+static bool send_status(replay_link_t *link, const char *status, const char *extra, bool keep_alive) {
+  char head[512];
+  const int len = snprintf(head, sizeof(head),
+                           "HTTP/1.1 %s\r\n"
+                           "%s"
+                           "Content-Length: 0\r\n"
+                           "Connection: %s\r\n\r\n",
+                           status, extra, keep_alive ? "keep-alive" : "close");
+  return link_send(link, head, len);
+}
+
+/* Answers one request, returns whether the connection stays open */
+static bool respond(int fd, const char *request) {
+  const int n = request_count++;
+  const replay_trace_t *trace = &traces[n % cfg.trace_count];
+  const bool fail = cfg.failure != REPLAY_FAIL_NONE && cfg.fail_every > 0 && (n + 1) % cfg.fail_every == 0;
+  replay_link_t link = {fd, now_us(), 0};
+  char value[128];
+  char head[512];
+  bool keep_alive = !cfg.close_each;
+  size_t body_len = trace->size;
+
+  if (header_value(request, "Connection", value, sizeof(value)) && strcasecmp(value, "close") == 0) {
+    keep_alive = false;
+  }
+
+  if (strncmp(request, "GET " REPLAY_PATH " ", strlen("GET " REPLAY_PATH " ")) != 0) {
+    printf("REPLAY: #%d not found: %.*s\n", n + 1, (int)strcspn(request, "\r\n"), request);
+    return send_status(&link, "404 Not Found", "", keep_alive) && keep_alive;
+  }
+
+  if (fail && cfg.failure == REPLAY_FAIL_500) {
+    static const char body[] = "Internal Server Error";
+    printf("REPLAY: #%d failing with 500\n", n + 1);
+    const int len = snprintf(head, sizeof(head),
+                             "HTTP/1.1 500 Internal Server Error\r\n"
+                             "Content-Type: text/plain\r\n"
+                             "Content-Length: %zu\r\n"
+                             "Connection: %s\r\n\r\n",
+                             sizeof(body) - 1, keep_alive ? "keep-alive" : "close");
+    return link_send(&link, head, len) && link_send(&link, body, sizeof(body) - 1) && keep_alive;
+  }
+
+  if (header_value(request, "If-None-Match", value, sizeof(value)) && strcmp(value, trace->etag) == 0) {
+    char extra[64];
+    snprintf(extra, sizeof(extra), "ETag: %s\r\n", trace->etag);
+    return send_status(&link, "304 Not Modified", extra, keep_alive) && keep_alive;
+  }
+
+  if (trace->gzip &&
+      !(header_value(request, "Accept-Encoding", value, sizeof(value)) && strstr(value, "gzip"))) {
+    printf("REPLAY: #%d didn't accept gzip for a gzipped trace\n", n + 1);
+    return send_status(&link, "406 Not Acceptable", "", keep_alive) && keep_alive;
+  }
+
+  char framing[48];
+  if (cfg.chunked) {
+    snprintf(framing, sizeof(framing), "Transfer-Encoding: chunked\r\n");
+  } else {
+    snprintf(framing, sizeof(framing), "Content-Length: %zu\r\n", trace->size);
+  }
+  const int len = snprintf(head, sizeof(head),
+                           "HTTP/1.1 200 OK\r\n"
+                           "Content-Type: application/json\r\n"
+                           "ETag: %s\r\n"
+                           "%s%s"
+                           "Connection: %s\r\n\r\n",
+                           trace->etag, trace->gzip ? "Content-Encoding: gzip\r\n" : "", framing,
+                           keep_alive ? "keep-alive" : "close");
+
+  if (fail) {
+    body_len = trace->size / 2;
+  }
+  if (!link_send(&link, head, len) || !send_body(&link, trace->data, body_len)) {
+    return false;
+  }
+
+  if (fail) {
+    switch (cfg.failure) {
+      case REPLAY_FAIL_RESET: {
+        /* Closing with a zero linger sends RST instead of FIN */
+        struct linger hard = {1, 0};
+        printf("REPLAY: #%d reset after %zu of %zu bytes\n", n + 1, body_len, trace->size);
+        setsockopt(fd, SOL_SOCKET, SO_LINGER, &hard, sizeof(hard));
+        break;
+      }
+      case REPLAY_FAIL_STALL:
+        printf("REPLAY: #%d stalled after %zu of %zu bytes\n", n + 1, body_len, trace->size);
+        stall(fd);
+        break;
+      default:
+        printf("REPLAY: #%d closed after %zu of %zu bytes\n", n + 1, body_len, trace->size);
+        break;
+    }
+    return false;
+  }
+
+  if (cfg.chunked && !link_send(&link, "0\r\n\r\n", 5)) {
+    return false;
+  }
+  return keep_alive;
+}
+
+static void serve_connection(int fd) {
+  char request[REPLAY_REQUEST_MAX];
+  int len = 0;
+  const int one = 1;
+
+  /* Every fragment goes out as its own segment */
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+  while (!stopping) {
+    char *end;
+
+    request[len] = '\0';
+    end = strstr(request, "\r\n\r\n");
+    if (!end) {
+      struct pollfd pfd = {fd, POLLIN, 0};
+      ssize_t received;
+
+      if (len == REPLAY_REQUEST_MAX - 1) {
+        printf("REPLAY: Request too long\n");
+        break;
+      }
+      if (poll(&pfd, 1, REPLAY_POLL_MS) <= 0) {
+        continue;
+      }
+      received = recv(fd, request + len, REPLAY_REQUEST_MAX - 1 - len, 0);
+      if (received <= 0) {
+        break;
+      }
+      len += received;
+      continue;
+    }
+
+    /* Cut after the blank line's CRLF, header_value needs the last header's */
+    end[2] = '\0';
+    const int used = (int)(end + 4 - request);
+    const bool keep = respond(fd, request);
+    memmove(request, request + used, len - used);
+    len -= used;
+    if (!keep) {
+      break;
+    }
+  }
+  close(fd);
+}
+
+static void *server_main(void *arg) {
+  (void)arg;
+
+  while (!stopping) {
+    struct pollfd pfd = {listen_fd, POLLIN, 0};
+    if (poll(&pfd, 1, REPLAY_POLL_MS) <= 0) {
+      continue;
+    }
+    const int fd = accept(listen_fd, NULL, NULL);
+    if (fd >= 0) {
+      serve_connection(fd);
+    }
+  }
+  return NULL;
+}
+
+static void free_traces(void) {
+  if (traces) {
+    for (int i = 0; i < cfg.trace_count; i++) {
+      free(traces[i].data);
+    }
+    free(traces);
+    traces = NULL;
+  }
+}
+
+int replay_start(const replay_config_t *config) {
+  struct sockaddr_in addr;
+  socklen_t addr_len = sizeof(addr);
+  const int one = 1;
+
+  cfg = *config;
+  if (cfg.trace_count <= 0) {
+    return -1;
+  }
+  traces = calloc(cfg.trace_count, sizeof(replay_trace_t));
+  if (!traces) {
+    return -1;
+  }
+  for (int i = 0; i < cfg.trace_count; i++) {
+    if (!load_trace(&traces[i], cfg.traces[i])) {
+      free_traces();
+      return -1;
+    }
+  }
+
+  listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (listen_fd < 0) {
+    free_traces();
+    return -2;
+  }
+  setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0; /* any free port */
+  if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(listen_fd, 4) < 0 ||
+      getsockname(listen_fd, (struct sockaddr *)&addr, &addr_len) < 0) {
+    printf("REPLAY: Can't listen: %s\n", strerror(errno));
+    close(listen_fd);
+    listen_fd = -1;
+    free_traces();
+    return -2;
+  }
+
+  stopping = false;
+  request_count = 0;
+  if (pthread_create(&server_thread, NULL, server_main, NULL) != 0) {
+    close(listen_fd);
+    listen_fd = -1;
+    free_traces();
+    return -2;
+  }
+  return ntohs(addr.sin_port);
+}
+
+void replay_stop(void) {
+  if (listen_fd < 0) {
+    return;
+  }
+  stopping = true;
+  pthread_join(server_thread, NULL);
+  close(listen_fd);
+  listen_fd = -1;
+  free_traces();
+}
+
+int replay_request_count(void) {
+  return request_count;
+}
@@ -0,0 +1,59 @@
+/*
+ * File: dcnow_replay.h
+ * Project: tools
+ * File Created: Sunday, 18th October 2026
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+#ifndef DCNOW_REPLAY_H
+#define DCNOW_REPLAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Stand-in for dreamcast.online on 127.0.0.1
+ * Every request for the users list is answered with the next recorded trace,
+ * in the order given, wrapping around. A trace is a users.json body as the
+ * server sent it; one ending in .gz is served with Content-Encoding: gzip.
+ * The ETag comes from a trace's contents, so a request carrying the ETag of
+ * the trace it would get is answered 304, list the same trace twice to see one.
+ */
+
+/* Bytes per second of common dial-up links, 10 bits a byte on the wire */
+#define REPLAY_RATE_V34 3360 /* 33.6k */
+#define REPLAY_RATE_V90 5333 /* 56k, as fast as they ever actually connect */
+
+typedef enum {
+  REPLAY_FAIL_NONE = 0,
+  REPLAY_FAIL_RESET,    /* half the body, then a TCP reset */
+  REPLAY_FAIL_STALL,    /* half the body, then nothing until the client gives up */
+  REPLAY_FAIL_500,      /* Internal Server Error instead of the list */
+  REPLAY_FAIL_TRUNCATE, /* half of a Content-Length body, then a clean close */
+} replay_failure_t;
+
+typedef struct {
+  const char **traces;
+  int trace_count;
+  uint32_t bytes_per_sec;   /* 0 for as fast as the loopback goes */
+  int fragment;             /* largest write, 0 to pick one from the rate */
+  bool chunked;             /* chunked transfer encoding instead of Content-Length */
+  bool close_each;          /* Connection: close after every response */
+  replay_failure_t failure;
+  int fail_every;           /* fail every Nth request, 0 never */
+} replay_config_t;
+
+/**
+ * Load the traces and start serving on a thread
+ *
+ * @return port listened on, negative when a trace can't be read or the socket can't be set up
+ */
+int replay_start(const replay_config_t *config);
+
+/* Stop serving and free the traces */
+void replay_stop(void);
+
+/* Requests answered so far, failures included */
+int replay_request_count(void);
+
+#endif /* DCNOW_REPLAY_H */
@@ -0,0 +1,401 @@
+/*
+ * File: dcnowbench.c
+ * Project: tools
+ * File Created: Sunday, 18th October 2026
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "dcnow_api.h"
+#include "dcnow_inflate.h"
+#include "dcnow_json.h"
+#include "dcnow_replay.h"
+
+/* Called:
+./dcnowbench [options] users.json [users2.json.gz ...]
+
+parses each recorded users.json trace on its own, then fetches them in turn
+through the DC Now client from a local replay server, and reports parse time,
+time to first game and memory use
+With -x every fetch must end the way its letter says and every parsed list must
+match the trace the server sent, else it exits non zero
+
+  -r RATE   link speed: 33.6k, 56k, lan or bytes per second (default lan)
+  -f BYTES  largest write the server makes
+  -c        chunked transfer encoding
+  -k        close the connection after every response
+  -F MODE   fail requests with reset, stall, 500 or truncate
+  -e N      fail every Nth request (default 3 with -F)
+  -n N      fetches (default one per trace)
+  -t MS     fetch timeout (default 10000)
+  -i N      offline parse iterations (default 20)
+  -o        offline parsing only
+  -x RESULTS expected result of each fetch, p parsed, n not modified, f failed
+  -v        DC Now debug output
+*/
+
+#define BENCH_MSS 1460 /* pieces the streaming parse is fed in, one TCP segment each */
+
+#define BENCH_MAX_TRACES 64
+
+static int verbose = 0;
+static int failures = 0;
+
+/* Digest of each trace's parse, to check what the client fetched */
+static uint32_t trace_digest[BENCH_MAX_TRACES];
+
+/* DC Now only prints its debug output while this says the serial port is free */
+int dcnow_is_serial_scif_active(void) {
+  return !verbose;
+}
+
+static double now_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+typedef struct {
+  char *data;
+  size_t size;
+  size_t cap;
+} bench_buf_t;
+
+static void buf_append(void *user, const char *data, int len) {
+  bench_buf_t *buf = (bench_buf_t *)user;
+  if (buf->size + len + 1 > buf->cap) {
+    buf->cap = (buf->size + len + 1) * 2;
+    buf->data = realloc(buf->data, buf->cap);
+    if (!buf->data) {
+      printf("Out of memory\n");
+      exit(1);
+    }
+  }
+  memcpy(buf->data + buf->size, data, len);
+  buf->size += len;
+  buf->data[buf->size] = '\0';
+}
+
+static uint32_t fnv_add(uint32_t hash, const void *data, size_t len) {
+  const unsigned char *bytes = (const unsigned char *)data;
+  for (size_t i = 0; i < len; i++) {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  return hash;
+}
+
+static uint32_t fnv_add_str(uint32_t hash, const char *str) {
+  return fnv_add(hash, str ? str : "", str ? strlen(str) + 1 : 1);
+}
+
+/* Games, in order, with their players, and the online count */
+static uint32_t games_digest(const json_game_t *games, int game_count, int total_players) {
+  uint32_t hash = fnv_add(2166136261u, &total_players, sizeof(total_players));
+  for (int g = 0; g < game_count; g++) {
+    hash = fnv_add_str(hash, games[g].game_code);
+    hash = fnv_add_str(hash, games[g].game_name);
+    hash = fnv_add(hash, &games[g].player_count, sizeof(games[g].player_count));
+    for (int p = 0; p < games[g].player_count; p++) {
+      hash = fnv_add_str(hash, games[g].players[p].name);
+      hash = fnv_add_str(hash, games[g].players[p].level);
+      hash = fnv_add_str(hash, games[g].players[p].country);
+    }
+  }
+  return hash;
+}
+
+/* Mostly the 32KB window */
+static inflate_stream_t inflater;
+
+/* The trace as the parser sees it, inflated when it was recorded gzipped */
+static bool load_body(const char *path, bench_buf_t *body) {
+  FILE *file = fopen(path, "rb");
+  const size_t len = strlen(path);
+  bench_buf_t raw = {0};
+  char piece[4096];
+  size_t got;
+
+  if (!file) {
+    printf("Can't open %s\n", path);
+    return false;
+  }
+  while ((got = fread(piece, 1, sizeof(piece), file)) > 0) {
+    buf_append(&raw, piece, got);
+  }
+  fclose(file);
+
+  memset(body, 0, sizeof(*body));
+  if (len > 3 && strcmp(path + len - 3, ".gz") == 0) {
+    dcnow_inflate_init(&inflater, buf_append, body);
+    if (!dcnow_inflate_feed(&inflater, raw.data, raw.size) || !dcnow_inflate_done(&inflater)) {
+      printf("%s: not a complete gzip stream\n", path);
+      free(raw.data);
+      free(body->data);
+      return false;
+    }
+    free(raw.data);
+  } else {
+    *body = raw;
+  }
+  if (!body->data) {
+    buf_append(body, "", 0);
+  }
+  return true;
+}
+
+static void bench_offline(int trace, const char *path, int iterations) {
+  bench_buf_t body;
+  dcnow_arena_t arena = {0};
+  json_dcnow_t result;
+  json_parser_t parser;
+  double best = 1e30, total = 0, first_best = 1e30;
+  int players = 0;
+
+  if (!load_body(path, &body)) {
+    failures++;
+    return;
+  }
+
+  for (int i = 0; i < iterations; i++) {
+    const double start = now_us();
+    if (!dcnow_json_parse(body.data, &result, &arena)) {
+      printf("%s: parse failed\n", path);
+      failures++;
+      dcnow_arena_release(&arena);
+      free(body.data);
+      return;
+    }
+    const double took = now_us() - start;
+    total += took;
+    if (took < best) {
+      best = took;
+    }
+
+    /* Fed the way it arrives, to see how soon the first game is there */
+    const double stream_start = now_us();
+    dcnow_json_begin(&parser, &result, &arena);
+    for (size_t at = 0; at < body.size; at += BENCH_MSS) {
+      const size_t piece = body.size - at < BENCH_MSS ? body.size - at : BENCH_MSS;
+      dcnow_json_feed(&parser, body.data + at, piece);
+      if (parser.game_count > 0) {
+        const double first = now_us() - stream_start;
+        if (first < first_best) {
+          first_best = first;
+        }
+        break;
+      }
+    }
+  }
+
+  dcnow_json_parse(body.data, &result, &arena);
+  trace_digest[trace] = games_digest(result.games, result.game_count, result.total_players);
+  for (int g = 0; g < result.game_count; g++) {
+    players += result.games[g].player_count;
+  }
+
+  printf("%s\n", path);
+  printf("  %zu bytes, %d games, %d players in games, %d online\n", body.size, result.game_count, players,
+         result.total_players);
+  printf("  parse %.1f us best, %.1f us average, %.1f MB/s\n", best, total / iterations,
+         best > 0 ? body.size / best : 0.0);
+  if (first_best < 1e30) {
+    printf("  first game after %.1f us of streaming parse\n", first_best);
+  }
+  printf("  arena %u bytes used, %u reserved\n", (unsigned)arena.bytes_used, (unsigned)arena.bytes_reserved);
+
+  dcnow_arena_release(&arena);
+  free(body.data);
+}
+
+static uint32_t parse_rate(const char *rate) {
+  if (strcmp(rate, "33.6k") == 0) {
+    return REPLAY_RATE_V34;
+  } else if (strcmp(rate, "56k") == 0) {
+    return REPLAY_RATE_V90;
+  } else if (strcmp(rate, "lan") == 0) {
+    return 0;
+  }
+  return (uint32_t)atoi(rate);
+}
+
+static replay_failure_t parse_failure(const char *mode) {
+  if (strcmp(mode, "reset") == 0) {
+    return REPLAY_FAIL_RESET;
+  } else if (strcmp(mode, "stall") == 0) {
+    return REPLAY_FAIL_STALL;
+  } else if (strcmp(mode, "500") == 0) {
+    return REPLAY_FAIL_500;
+  } else if (strcmp(mode, "truncate") == 0) {
+    return REPLAY_FAIL_TRUNCATE;
+  }
+  printf("Unknown failure mode %s\n", mode);
+  exit(1);
+}
+
+/* The letter -x takes for how a fetch ended */
+static char fetch_outcome(int result, const dcnow_fetch_stats_t *stats) {
+  if (result < 0) {
+    return 'f';
+  }
+  return stats->status == 304 ? 'n' : 'p';
+}
+
+static void bench_network(replay_config_t *config, int fetches, uint32_t timeout_ms, const char *expect) {
+  uint64_t total_ms = 0, first_ms = 0, wire = 0;
+  uint32_t arena_peak = 0;
+  int parsed = 0, not_modified = 0, failed = 0;
+
+  const int port = replay_start(config);
+  if (port < 0) {
+    failures++;
+    return;
+  }
+  dcnow_set_server("127.0.0.1", (uint16_t)port);
+  dcnow_init();
+
+  printf("\nFetching from 127.0.0.1:%d, %s\n", port,
+         config->bytes_per_sec ? "throttled" : "unthrottled");
+  printf("   #  status  wire B  body B  parsed B  first ms  total ms  games  events\n");
+
+  for (int i = 0; i < fetches; i++) {
+    const int result = dcnow_fetch_data(timeout_ms);
+    const dcnow_fetch_stats_t *stats = dcnow_get_fetch_stats();
+    const dcnow_data_t *data = dcnow_get_snapshot();
+    const char outcome = fetch_outcome(result, stats);
+
+    if (expect && expect[i] != outcome) {
+      printf("fetch %d: expected '%c', got '%c'\n", i + 1, expect[i], outcome);
+      failures++;
+    }
+    if (outcome == 'p') {
+      /* The list parsed is the one sent in answer to the last request */
+      const int trace = (replay_request_count() - 1) % config->trace_count;
+      if (games_digest(data->games, data->game_count, data->total_players) != trace_digest[trace]) {
+        printf("fetch %d: snapshot differs from %s\n", i + 1, config->traces[trace]);
+        failures++;
+      }
+    }
+
+    if (result < 0) {
+      failed++;
+      printf("%4d  %6d  failed: %s (%u ms)\n", i + 1, stats->status, dcnow_get_last_error(),
+             (unsigned)stats->total_ms);
+      continue;
+    }
+
+    wire += stats->wire_bytes;
+    if (stats->status == 304) {
+      not_modified++;
+      printf("%4d  %6d  %6u  %30s  %8u\n", i + 1, stats->status, (unsigned)stats->wire_bytes, "not modified",
+             (unsigned)stats->total_ms);
+      continue;
+    }
+
+    parsed++;
+    total_ms += stats->total_ms;
+    first_ms += stats->first_game_ms;
+    if (stats->arena_reserved > arena_peak) {
+      arena_peak = stats->arena_reserved;
+    }
+    printf("%4d  %6d  %6u  %6u  %8u  %8u  %8u  %5d  %6d%s\n", i + 1, stats->status, (unsigned)stats->wire_bytes,
+           (unsigned)stats->body_bytes, (unsigned)stats->inflated_bytes, (unsigned)stats->first_game_ms,
+           (unsigned)stats->total_ms, data->game_count, data->delta.event_count,
+           data->delta.events_complete ? "" : "+");
+  }
+
+  printf("\n%d parsed, %d not modified, %d failed, %d requests served, %llu bytes received\n", parsed,
+         not_modified, failed, replay_request_count(), (unsigned long long)wire);
+  if (parsed) {
+    printf("average %llu ms to the first game, %llu ms to the whole list\n",
+           (unsigned long long)(first_ms / parsed), (unsigned long long)(total_ms / parsed));
+  }
+  printf("largest snapshot arena %u bytes\n", (unsigned)arena_peak);
+
+  dcnow_shutdown();
+  dcnow_clear_cache();
+  replay_stop();
+}
+
+int main(int argc, char **argv) {
+  replay_config_t config = {0};
+  int iterations = 20;
+  int fetches = 0;
+  uint32_t timeout_ms = 10000;
+  bool offline_only = false;
+  const char *expect = NULL;
+  struct rusage usage;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "r:f:ckF:e:n:t:i:ox:v")) != -1) {
+    switch (opt) {
+      case 'r': config.bytes_per_sec = parse_rate(optarg); break;
+      case 'f': config.fragment = atoi(optarg); break;
+      case 'c': config.chunked = true; break;
+      case 'k': config.close_each = true; break;
+      case 'F': config.failure = parse_failure(optarg); break;
+      case 'e': config.fail_every = atoi(optarg); break;
+      case 'n': fetches = atoi(optarg); break;
+      case 't': timeout_ms = (uint32_t)atoi(optarg); break;
+      case 'i': iterations = atoi(optarg); break;
+      case 'o': offline_only = true; break;
+      case 'x': expect = optarg; break;
+      case 'v': verbose = 1; break;
+      default:
+        printf("usage: %s [-r 33.6k|56k|lan|B/s] [-f bytes] [-c] [-k] [-F reset|stall|500|truncate] [-e N]\n"
+               "       [-n fetches] [-t ms] [-i iterations] [-o] [-x results] [-v] trace.json [trace.json.gz ...]\n",
+               argv[0]);
+        return 1;
+    }
+  }
+  if (optind >= argc) {
+    printf("No traces given\n");
+    return 1;
+  }
+  if (iterations < 1) {
+    iterations = 1;
+  }
+  if (argc - optind > BENCH_MAX_TRACES) {
+    printf("At most %d traces\n", BENCH_MAX_TRACES);
+    return 1;
+  }
+
+  config.traces = (const char **)&argv[optind];
+  config.trace_count = argc - optind;
+  if (config.failure != REPLAY_FAIL_NONE && config.fail_every <= 0) {
+    config.fail_every = 3;
+  }
+  if (fetches <= 0) {
+    fetches = expect ? (int)strlen(expect) : config.trace_count;
+  }
+  if (expect && (int)strlen(expect) != fetches) {
+    printf("-x gives %d results for %d fetches\n", (int)strlen(expect), fetches);
+    return 1;
+  }
+
+  /* A reset connection must fail the send, not kill the process */
+  signal(SIGPIPE, SIG_IGN);
+
+  printf("Parsing each trace %d times\n\n", iterations);
+  for (int i = 0; i < config.trace_count; i++) {
+    bench_offline(i, config.traces[i], iterations);
+  }
+
+  if (!offline_only) {
+    bench_network(&config, fetches, timeout_ms, expect);
+  }
+
+  getrusage(RUSAGE_SELF, &usage);
+  printf("\nmemory: snapshots %zu bytes static, inflater %zu, parser %zu on the stack, peak RSS %ld KB\n",
+         3 * sizeof(dcnow_data_t), sizeof(inflate_stream_t), sizeof(json_parser_t), usage.ru_maxrss);
+  if (expect) {
+    printf("%s\n", failures ? "FAILED" : "OK");
+  }
+  return failures ? 1 : 0;
+}
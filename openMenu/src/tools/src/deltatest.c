@@ -0,0 +1,236 @@
+/*
+ * File: deltatest.c
+ * Project: tools
+ * File Created: Sunday, 18th October 2026
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "dcnow_delta.h"
+
+/* Called:
+./deltatest
+
+parses pairs of users.json documents into snapshots the way a fetch does and
+checks what the delta between them says: rows that only moved, games added
+and removed, games matched by code or by name, players joining and leaving,
+more changes than the event list holds, and finding a row again from a
+snapshot the delta doesn't follow on from.
+Exits non zero if any check failed.
+*/
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("FAIL %s:%d: ", __FILE__, __LINE__);                                                                      \
+      printf(__VA_ARGS__);                                                                                             \
+      printf("\n");                                                                                                    \
+      failures++;                                                                                                      \
+    }                                                                                                                  \
+  } while (0)
+
+/* DC Now only prints its debug output while this says the serial port is free */
+int dcnow_is_serial_scif_active(void) {
+  return 1;
+}
+
+static dcnow_data_t prev, next;
+static char doc[32768];
+
+/* users.json from username, code, display name triples ending in NULL, "" for no code */
+static const char *users_doc(const char *const *users) {
+  int len = snprintf(doc, sizeof(doc), "{\"users\": [");
+  int count = 0;
+
+  for (; users[0]; users += 3, count++) {
+    len += snprintf(doc + len, sizeof(doc) - len,
+                    "%s{\"username\": \"%s\", \"current_game\": \"%s\", \"current_game_display\": \"%s\"}",
+                    count ? ", " : "", users[0], users[1], users[2]);
+  }
+  snprintf(doc + len, sizeof(doc) - len, "], \"total_count\": %d, \"online_count\": %d}", count, count);
+  return doc;
+}
+
+/* Parse into a snapshot the way the fetch thread fills one */
+static void load(dcnow_data_t *data, uint32_t seq, const char *const *users) {
+  json_dcnow_t result;
+
+  CHECK(dcnow_json_parse(users_doc(users), &result, &data->arena), "snapshot %u didn't parse", (unsigned)seq);
+  data->games = result.games;
+  data->game_count = result.game_count;
+  data->total_players = result.total_players;
+  data->data_valid = result.valid;
+  data->seq = seq;
+  memset(&data->delta, 0, sizeof(data->delta));
+}
+
+/* Snapshot 1 from before, snapshot 2 from after with its delta */
+static void publish(const char *const *before, const char *const *after) {
+  load(&prev, 1, before);
+  load(&next, 2, after);
+  dcnow_delta_compute(&prev, &next);
+  CHECK(next.delta.base_seq == 1, "delta follows on from %u", (unsigned)next.delta.base_seq);
+}
+
+static int count_events(dcnow_event_type_t type, const char *game, const char *username) {
+  int found = 0;
+  for (int i = 0; i < next.delta.event_count; i++) {
+    const dcnow_event_t *event = &next.delta.events[i];
+    if (event->type == type && strcmp(event->game_code, game) == 0 &&
+        (!username || strcmp(event->username, username) == 0)) {
+      found++;
+    }
+  }
+  return found;
+}
+
+static void check_reordered(void) {
+  static const char *const before[] = {"alice", "PSO", "Phantasy Star Online", "bob", "Q3", "Quake III Arena",
+                                       "carol", "PSO", "Phantasy Star Online", NULL};
+  static const char *const after[] = {"bob", "Q3", "Quake III Arena", "alice", "PSO", "Phantasy Star Online",
+                                      "carol", "PSO", "Phantasy Star Online", NULL};
+  publish(before, after);
+
+  CHECK(next.delta.event_count == 0 && next.delta.events_complete, "reordered: %d events",
+        next.delta.event_count);
+  CHECK(next.delta.prev_row[0] == 1 && next.delta.prev_row[1] == 0, "reordered: rows came from %d, %d",
+        next.delta.prev_row[0], next.delta.prev_row[1]);
+  CHECK(dcnow_delta_row_changed(&next.delta, 0) && dcnow_delta_row_changed(&next.delta, 1),
+        "reordered: moved rows not marked");
+  CHECK(dcnow_delta_find_row(&next, 1, 0) == 1 && dcnow_delta_find_row(&next, 1, 1) == 0,
+        "reordered: rows not found again");
+}
+
+static void check_added_removed(void) {
+  static const char *const before[] = {"alice", "PSO", "Phantasy Star Online", "bob", "Q3", "Quake III Arena",
+                                       "dave", "CR", "ChuChu Rocket!", NULL};
+  static const char *const after[] = {"alice", "PSO", "Phantasy Star Online", "erin", "AFO", "Alien Front Online",
+                                      "dave", "CR", "ChuChu Rocket!", NULL};
+  publish(before, after);
+
+  CHECK(next.delta.event_count == 4, "added and removed: %d events", next.delta.event_count);
+  CHECK(count_events(DCNOW_EVENT_GAME_ADDED, "AFO", NULL) == 1, "added: AFO not reported");
+  CHECK(count_events(DCNOW_EVENT_PLAYER_JOINED, "AFO", "erin") == 1, "added: erin didn't join");
+  CHECK(count_events(DCNOW_EVENT_GAME_REMOVED, "Q3", NULL) == 1, "removed: Q3 not reported");
+  CHECK(count_events(DCNOW_EVENT_PLAYER_LEFT, "Q3", "bob") == 1, "removed: bob didn't leave");
+  CHECK(next.delta.prev_row[0] == 0 && next.delta.prev_row[1] == -1 && next.delta.prev_row[2] == 2,
+        "added and removed: rows came from %d, %d, %d", next.delta.prev_row[0], next.delta.prev_row[1],
+        next.delta.prev_row[2]);
+  CHECK(!dcnow_delta_row_changed(&next.delta, 0) && dcnow_delta_row_changed(&next.delta, 1) &&
+            !dcnow_delta_row_changed(&next.delta, 2),
+        "added and removed: only the replaced row should be marked");
+  CHECK(dcnow_delta_find_row(&next, 1, 1) == -1, "removed: Q3's row found again");
+}
+
+static void check_matching(void) {
+  /* Same code under a new name, the same code-less name, and a name that gained a code */
+  static const char *const before[] = {"alice", "PSO",  "Phantasy Star Online", "bob", "", "Dreamcast Browser",
+                                       "carol", "",     "Starlancer",           NULL};
+  static const char *const after[] = {"alice", "PSO",  "PSO Ver.2",  "bob", "", "Dreamcast Browser",
+                                      "carol", "SL",   "Starlancer", NULL};
+  publish(before, after);
+
+  CHECK(next.delta.prev_row[0] == 0, "by code: renamed PSO came from %d", next.delta.prev_row[0]);
+  CHECK(dcnow_delta_row_changed(&next.delta, 0), "by code: renamed row not marked");
+  CHECK(next.delta.prev_row[1] == 1 && !dcnow_delta_row_changed(&next.delta, 1),
+        "by name: browser came from %d", next.delta.prev_row[1]);
+  CHECK(next.delta.prev_row[2] == -1, "a code and a name matched, row %d", next.delta.prev_row[2]);
+  CHECK(count_events(DCNOW_EVENT_GAME_ADDED, "SL", NULL) == 1 &&
+            count_events(DCNOW_EVENT_GAME_REMOVED, "Starlancer", NULL) == 1,
+        "by code: Starlancer with a code isn't the one without");
+  CHECK(count_events(DCNOW_EVENT_GAME_ADDED, "PSO", NULL) == 0 &&
+            count_events(DCNOW_EVENT_GAME_REMOVED, "PSO", NULL) == 0,
+        "by code: renaming PSO added or removed it");
+}
+
+static void check_players(void) {
+  static const char *const before[] = {"alice", "PSO", "Phantasy Star Online", "bob", "PSO",
+                                       "Phantasy Star Online", "dave", "Q3", "Quake III Arena", NULL};
+  static const char *const after[] = {"alice", "PSO", "Phantasy Star Online", "carol", "PSO",
+                                      "Phantasy Star Online", "dave", "Q3", "Quake III Arena",
+                                      "erin", "Q3", "Quake III Arena", NULL};
+  publish(before, after);
+
+  CHECK(count_events(DCNOW_EVENT_PLAYER_JOINED, "PSO", "carol") == 1, "carol didn't join PSO");
+  CHECK(count_events(DCNOW_EVENT_PLAYER_LEFT, "PSO", "bob") == 1, "bob didn't leave PSO");
+  CHECK(count_events(DCNOW_EVENT_PLAYER_JOINED, "PSO", "alice") == 0, "alice joined again");
+  CHECK(count_events(DCNOW_EVENT_COUNT_CHANGED, "PSO", NULL) == 0, "PSO's count didn't change");
+  CHECK(!dcnow_delta_row_changed(&next.delta, 0), "PSO kept its row and count, but was marked");
+
+  CHECK(count_events(DCNOW_EVENT_PLAYER_JOINED, "Q3", "erin") == 1, "erin didn't join Q3");
+  CHECK(count_events(DCNOW_EVENT_COUNT_CHANGED, "Q3", NULL) == 1, "Q3's count change not reported");
+  for (int i = 0; i < next.delta.event_count; i++) {
+    const dcnow_event_t *event = &next.delta.events[i];
+    if (event->type == DCNOW_EVENT_COUNT_CHANGED) {
+      CHECK(event->count_before == 1 && event->count_after == 2 && event->row == 1, "Q3 went from %d to %d in row %d",
+            event->count_before, event->count_after, event->row);
+    }
+  }
+  CHECK(dcnow_delta_row_changed(&next.delta, 1), "Q3's count changed, but its row wasn't marked");
+  CHECK(next.delta.event_count == 4 && next.delta.events_complete, "players: %d events", next.delta.event_count);
+}
+
+static void check_overflow(void) {
+  static const char *before[] = {"alice", "PSO", "Phantasy Star Online", NULL};
+  static const char *after[3 * 61 + 1];
+  static char names[60][16];
+
+  after[0] = "alice";
+  after[1] = "PSO";
+  after[2] = "Phantasy Star Online";
+  for (int i = 0; i < 60; i++) {
+    snprintf(names[i], sizeof(names[i]), "player%02d", i);
+    after[3 + 3 * i] = names[i];
+    after[4 + 3 * i] = "Q3";
+    after[5 + 3 * i] = "Quake III Arena";
+  }
+  after[3 * 61] = NULL;
+  publish(before, after);
+
+  /* Q3 added and 60 joins, more than the list holds */
+  CHECK(next.delta.event_count == MAX_DCNOW_EVENTS, "overflow: %d events", next.delta.event_count);
+  CHECK(!next.delta.events_complete, "overflow: events said to be complete");
+  CHECK(count_events(DCNOW_EVENT_GAME_ADDED, "Q3", NULL) == 1, "overflow: Q3 not added first");
+  CHECK(dcnow_delta_row_changed(&next.delta, 1) && next.delta.prev_row[0] == 0,
+        "overflow: rows still have to be right when the events aren't");
+}
+
+static void check_base_seq(void) {
+  static const char *const before[] = {"alice", "PSO", "Phantasy Star Online", "bob", "Q3", "Quake III Arena", NULL};
+  static const char *const after[] = {"bob", "Q3", "Quake III Arena", "alice", "PSO", "Phantasy Star Online", NULL};
+  publish(before, after);
+
+  /* A reader that last showed snapshot 1 can follow the delta, one that showed anything else can't */
+  CHECK(dcnow_delta_find_row(&next, 1, 0) == 1, "base_seq: PSO not found from snapshot 1");
+  CHECK(dcnow_delta_find_row(&next, 0, 0) == -1, "base_seq: found from a snapshot before the base");
+  CHECK(dcnow_delta_find_row(&next, 7, 1) == -1, "base_seq: found from an unknown snapshot");
+  CHECK(dcnow_delta_find_row(&next, 2, 1) == 1, "base_seq: same snapshot doesn't keep its row");
+  CHECK(dcnow_delta_find_row(&next, 2, 5) == -1, "base_seq: same snapshot found a row past the end");
+  CHECK(dcnow_delta_find_row(&next, 1, -1) == -1, "base_seq: found a row for no row");
+
+  /* The next publish follows on from 2, not 1 */
+  load(&prev, 3, after);
+  dcnow_delta_compute(&next, &prev);
+  CHECK(prev.delta.base_seq == 2 && prev.delta.event_count == 0, "base_seq: %u with %d events",
+        (unsigned)prev.delta.base_seq, prev.delta.event_count);
+  CHECK(dcnow_delta_find_row(&prev, 1, 0) == -1, "base_seq: snapshot 3 followed from 1");
+}
+
+int main(void) {
+  check_reordered();
+  check_added_removed();
+  check_matching();
+  check_players();
+  check_overflow();
+  check_base_seq();
+
+  dcnow_arena_release(&prev.arena);
+  dcnow_arena_release(&next.arena);
+
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
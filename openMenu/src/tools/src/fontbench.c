@@ -0,0 +1,421 @@
+/*
+ * File: fontbench.c
+ * Project: tools
+ * File Created: Sunday, 18th October 2026
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* The BMFont renderer itself, for its static glyph tables, kerning hash and run layout */
+#include "ui/dc/font_bmf.c"
+
+/* Called:
+./fontbench [iterations] [font.fnt]
+
+lays out 1000 game titles with font_bmf_draw_run on glyph quads and a kerning
+hash built by BMF_build_glyphs and BMF_build_kern_hash, and again the way the
+renderer used to: quads worked out per character and kerning found by walking
+the sorted pairs of the first character. Checks both put every glyph in the
+same place and prints the best time of each (default 200 runs). Without a
+font file a made up one with about 1000 kerning pairs is used.
+Exits non zero if the layouts differ.
+*/
+
+#define BENCH_STRINGS 1000
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("FAIL %s:%d: ", __FILE__, __LINE__);                                                                      \
+      printf(__VA_ARGS__);                                                                                             \
+      printf("\n");                                                                                                    \
+      failures++;                                                                                                      \
+    }                                                                                                                  \
+  } while (0)
+
+static double now_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/* KOS files on top of POSIX ones */
+file_t fs_open(const char *fn, int mode) {
+  return open(fn, mode);
+}
+int fs_close(file_t hnd) {
+  return close(hnd);
+}
+ssize_t fs_read(file_t hnd, void *buffer, size_t cnt) {
+  return read(hnd, buffer, cnt);
+}
+off_t fs_seek(file_t hnd, off_t offset, int whence) {
+  return lseek(hnd, offset, whence);
+}
+int fs_stat(const char *path, struct stat *buf, int flag) {
+  (void)flag;
+  return stat(path, buf);
+}
+
+/* Glyphs land here instead of the TA, a sum of every corner keeps the compiler honest */
+typedef struct {
+  float x1, y1, x2, y2;
+} bench_quad;
+
+static bench_quad *quads;
+static unsigned int quad_count;
+static unsigned int quad_max;
+static double quad_sum;
+
+void draw_glyph_uv_set(draw_glyph_uv *uv, float u1, float v1, float u2, float v2) {
+  uv->u1 = u1;
+  uv->v1 = v1;
+  uv->u2 = u2;
+  uv->v2 = v2;
+}
+
+void draw_text_glyph(float x1, float y1, float x2, float y2, const draw_glyph_uv *uv) {
+  quad_sum += x1 + y1 + x2 + y2 + uv->u1 + uv->v2;
+  if (quads && quad_count < quad_max) {
+    quads[quad_count] = (bench_quad){x1, y1, x2, y2};
+  }
+  quad_count++;
+}
+
+/* Only reached from the drawing entry points, which the bench doesn't call */
+void draw_text_begin(const image *font, int filter, uint32_t color, float z, struct text_layout *record) {
+  (void)font, (void)filter, (void)color, (void)z, (void)record;
+}
+void draw_text_end(void) {
+}
+text_layout *text_cache_get(const char *str, TEXT_FONT font, float scale, int wrap) {
+  (void)str, (void)font, (void)scale, (void)wrap;
+  return NULL;
+}
+int text_layout_draw(text_layout *layout, const image *img, int filter, float x, float y, float z, uint32_t color) {
+  (void)layout, (void)img, (void)filter, (void)x, (void)y, (void)z, (void)color;
+  return 0;
+}
+float text_layout_width(text_layout *layout) {
+  (void)layout;
+  return -1.0f;
+}
+void text_layout_set_width(text_layout *layout, float width) {
+  (void)layout, (void)width;
+}
+void text_layout_finish(text_layout *layout, float x, float y, float z, uint32_t color) {
+  (void)layout, (void)x, (void)y, (void)z, (void)color;
+}
+void text_cache_clear(void) {
+}
+float z_inc(void) {
+  return 1.0f;
+}
+uint32_t texman_create(void) {
+  return 0;
+}
+unsigned char *texman_get_tex_data(uint32_t num) {
+  (void)num;
+  return NULL;
+}
+struct Simple_Texture *texman_reserve_memory(uint32_t width, uint32_t height, int bpp) {
+  (void)width, (void)height, (void)bpp;
+  return NULL;
+}
+void *draw_load_texture_buffer(const char *filename, void *user, void *buffer) {
+  (void)filename, (void)buffer;
+  return user;
+}
+
+/* The old lookup: pairs sorted by first then second, each character pointing at its first pair */
+static bm_kern_pair *sorted_pairs;
+static const bm_kern_pair *old_kerns[256];
+
+static int kern_pair_sort(const void *a, const void *b) {
+  const bm_kern_pair *ia = (const bm_kern_pair *)a;
+  const bm_kern_pair *ib = (const bm_kern_pair *)b;
+  if (ia->first == ib->first) {
+    return (int)ia->second - (int)ib->second;
+  }
+  return (int)ia->first - (int)ib->first;
+}
+
+static void old_build_kerns(const bm_kern_pair *pairs, int num_pairs) {
+  /* One zeroed pair past the end stops the walk of the last character */
+  sorted_pairs = calloc(num_pairs + 1, sizeof(bm_kern_pair));
+  memcpy(sorted_pairs, pairs, num_pairs * sizeof(bm_kern_pair));
+  qsort(sorted_pairs, num_pairs, sizeof(bm_kern_pair), kern_pair_sort);
+
+  memset(old_kerns, 0, sizeof(old_kerns));
+  for (int i = num_pairs - 1; i >= 0; i--) {
+    if (sorted_pairs[i].first < 256) {
+      old_kerns[sorted_pairs[i].first] = &sorted_pairs[i];
+    }
+  }
+}
+
+static int old_kerning(unsigned char first, unsigned char second) {
+  const bm_kern_pair *kern_pairs = old_kerns[first];
+  if (kern_pairs) {
+    do {
+      if (kern_pairs->second == second) {
+        return kern_pairs->amount;
+      }
+    } while ((unsigned char)(kern_pairs++)->first == first);
+  }
+  return 0;
+}
+
+static int old_draw_char(int x, int y, unsigned char chr) {
+  const bm_font *font = &font_basilea;
+  const bm_char_ex *c = &font->chars[chr];
+  draw_glyph_uv uv;
+
+  const float x1 = round(x + (current_scale * (float)c->xoffset) * X_SCALE);
+  const float y1 = round(y + current_scale * (float)c->yoffset);
+  const float u1 = (float)c->x / (float)font->width;
+  const float v1 = (float)c->y / (float)font->height;
+
+  const float x2 = round(x + (current_scale * ((float)c->width + c->xoffset)) * X_SCALE);
+  const float y2 = round(y + current_scale * ((float)c->height + c->yoffset));
+  const float u2 = (float)(c->x + c->width) / (float)font->width;
+  const float v2 = (float)(c->y + c->height) / (float)font->height;
+
+  draw_glyph_uv_set(&uv, u1, v1, u2, v2);
+  draw_text_glyph(x1, y1, x2, y2, &uv);
+  return (current_scale * c->xadvance) * X_SCALE;
+}
+
+static int old_draw_run(int x, int y, const unsigned char *str, const unsigned char *end) {
+  unsigned char prev = 0;
+  while (str < end) {
+    const unsigned char chr = *str++;
+    if (chr != ' ') {
+      x += round(current_scale * old_kerning(prev, chr));
+      x += old_draw_char(x, y, chr);
+    } else {
+      x += round(current_scale * (float)font_basilea.chars[' '].width);
+    }
+    prev = chr;
+  }
+  return x;
+}
+
+/* Printable ASCII with made up metrics, and pairs for every letter against a spread of others */
+static bm_kern_pair *make_font(int *num_pairs) {
+  bm_font *font = &font_basilea;
+  bm_kern_pair *pairs = malloc(52 * 20 * sizeof(bm_kern_pair));
+  int count = 0;
+
+  memset(font, 0, sizeof(*font));
+  font->width = font->height = 256;
+  font->fontSize = font->lineHeight = 24;
+  font->num_chars = 127 - 32;
+  for (int i = 32; i < 127; i++) {
+    bm_char_ex *c = &font->chars[i];
+    c->id = i;
+    c->x = (i % 16) * 16;
+    c->y = (i / 16) * 24;
+    c->width = 6 + i % 9;
+    c->height = 18 + i % 5;
+    c->xoffset = i % 3 - 1;
+    c->yoffset = 2 + i % 4;
+    c->xadvance = c->width + 1;
+  }
+
+  for (int f = 0; f < 52; f++) {
+    const unsigned char first = f < 26 ? 'A' + f : 'a' + f - 26;
+    for (int s = 0; s < 20; s++) {
+      pairs[count].first = first;
+      pairs[count].second = 33 + (f * 7 + s * 5) % 94;
+      pairs[count].amount = -1 - (f + s) % 3;
+      count++;
+    }
+  }
+  *num_pairs = count;
+  return pairs;
+}
+
+/* Reads the metrics and pairs of a binary BMFont file, the pairs are kept for the old lookup */
+static bool load_font(const char *path, bm_kern_pair **pairs, int *num_pairs) {
+  bm_font *font = &font_basilea;
+  bm_header header;
+  bm_block_tag block;
+  const file_t fd = fs_open(path, O_RDONLY);
+
+  *pairs = NULL;
+  *num_pairs = 0;
+  if (fd == FILEHND_INVALID) {
+    printf("Can't open %s\n", path);
+    return false;
+  }
+  memset(font, 0, sizeof(*font));
+  if (fs_read(fd, &header, sizeof(header)) != sizeof(header) || header.version != 3) {
+    printf("%s isn't a version 3 binary BMFont\n", path);
+    fs_close(fd);
+    return false;
+  }
+
+  while (fs_read(fd, &block, sizeof(block)) == sizeof(block)) {
+    switch (block.type) {
+      case INFO: BMF_parse_info(fd, block.size, font); break;
+      case COMMON: BMF_parse_common(fd, block.size, font); break;
+      case CHARS: BMF_parse_chars(fd, block.size, font); break;
+      case KERNING:
+        *num_pairs = block.size / sizeof(bm_kern_pair);
+        *pairs = malloc(block.size);
+        fs_read(fd, *pairs, *num_pairs * sizeof(bm_kern_pair));
+        break;
+      default: fs_seek(fd, block.size, SEEK_CUR); break;
+    }
+  }
+  fs_close(fd);
+  return true;
+}
+
+/* Game titles from a few common words, about as long as the list shows */
+static char **make_strings(void) {
+  static const char *const words[] = {
+      "Sonic", "Adventure", "Crazy", "Taxi", "Jet", "Set", "Radio", "Soul", "Calibur", "Phantasy", "Star", "Online",
+      "Virtua", "Tennis", "Shenmue", "Power", "Stone", "Marvel", "vs.", "Capcom", "Skies", "of", "Arcadia", "Rez",
+      "Ikaruga", "Quake", "III", "Arena", "Resident", "Evil", "Code", "Veronica", "Grandia", "II", "Toy", "Commander",
+      "NFL", "2K2", "Space", "Channel", "5", "Chu", "Rocket!", "Hydro", "Thunder", "Fighting", "Vipers", "(USA)",
+  };
+  const int word_count = sizeof(words) / sizeof(words[0]);
+  char **strings = malloc(BENCH_STRINGS * sizeof(char *));
+
+  srand(35);
+  for (int i = 0; i < BENCH_STRINGS; i++) {
+    char title[128] = "";
+    const int length = 2 + rand() % 5;
+    for (int w = 0; w < length; w++) {
+      if (w) {
+        strcat(title, " ");
+      }
+      strcat(title, words[rand() % word_count]);
+    }
+    strings[i] = strdup(title);
+  }
+  return strings;
+}
+
+typedef int (*run_fn)(int x, int y, const unsigned char *str, const unsigned char *end);
+
+/* Lays out every string once, returns the sum of the pen positions after each */
+static long layout_all(run_fn run, char **strings) {
+  long pen = 0;
+  for (int i = 0; i < BENCH_STRINGS; i++) {
+    const unsigned char *str = (const unsigned char *)strings[i];
+    pen += run(10, 20 + i % 400, str, str + strlen(strings[i]));
+  }
+  return pen;
+}
+
+static double time_layout(run_fn run, char **strings, int iterations) {
+  double best = 1e30;
+  for (int i = 0; i < iterations; i++) {
+    quad_count = 0;
+    const double start = now_us();
+    layout_all(run, strings);
+    const double took = now_us() - start;
+    if (took < best) {
+      best = took;
+    }
+  }
+  return best;
+}
+
+/* Both layouts must agree on the pen and on every quad, at each scale and aspect the menu uses */
+static void compare_layouts(char **strings) {
+  static const float scales[] = {1.0f, 16.0f / 24.0f, 0.8f, 1.25f};
+  static const float aspects[] = {X_SCALE_4_3, X_SCALE_16_9};
+
+  quad_max = 64 * BENCH_STRINGS;
+  bench_quad *want = malloc(quad_max * sizeof(bench_quad));
+  bench_quad *got = malloc(quad_max * sizeof(bench_quad));
+
+  for (unsigned int a = 0; a < sizeof(aspects) / sizeof(aspects[0]); a++) {
+    for (unsigned int s = 0; s < sizeof(scales) / sizeof(scales[0]); s++) {
+      X_SCALE = aspects[a];
+      current_scale = scales[s];
+
+      quads = want;
+      quad_count = 0;
+      const long old_pen = layout_all(old_draw_run, strings);
+      const unsigned int old_count = quad_count;
+
+      quads = got;
+      quad_count = 0;
+      const long new_pen = layout_all(font_bmf_draw_run, strings);
+
+      CHECK(new_pen == old_pen, "scale %.2f aspect %.2f: pens end %ld apart", scales[s], aspects[a],
+            new_pen - old_pen);
+      CHECK(quad_count == old_count, "scale %.2f aspect %.2f: %u glyphs, %u before", scales[s], aspects[a],
+            quad_count, old_count);
+      for (unsigned int q = 0; q < quad_count && q < old_count && q < quad_max; q++) {
+        const float dx = got[q].x1 - want[q].x1 + got[q].x2 - want[q].x2;
+        const float dy = got[q].y1 - want[q].y1 + got[q].y2 - want[q].y2;
+        if (dx * dx + dy * dy > 0.01f) {
+          CHECK(0, "scale %.2f aspect %.2f: glyph %u moved by %.2f, %.2f", scales[s], aspects[a], q, dx, dy);
+          break;
+        }
+      }
+    }
+  }
+  quads = NULL;
+  free(want);
+  free(got);
+}
+
+int main(int argc, char **argv) {
+  const int iterations = argc > 1 && atoi(argv[1]) > 0 ? atoi(argv[1]) : 200;
+  bm_kern_pair *pairs;
+  int num_pairs;
+
+  if (argc > 2) {
+    if (!load_font(argv[2], &pairs, &num_pairs)) {
+      return 1;
+    }
+  } else {
+    pairs = make_font(&num_pairs);
+  }
+  char **strings = make_strings();
+
+  double start = now_us();
+  BMF_build_kern_hash(pairs, num_pairs);
+  BMF_build_glyphs(&font_basilea);
+  const double build_us = now_us() - start;
+  old_build_kerns(pairs, num_pairs);
+
+  compare_layouts(strings);
+
+  X_SCALE = X_SCALE_4_3;
+  current_scale = 1.0f;
+  const double old_us = time_layout(old_draw_run, strings, iterations);
+  const unsigned int glyph_count = quad_count;
+  const double new_us = time_layout(font_bmf_draw_run, strings, iterations);
+
+  printf("%s: %u chars, %d kerning pairs, tables built in %.1f us\n", argc > 2 ? argv[2] : "made up font",
+         (unsigned)font_basilea.num_chars, num_pairs, build_us);
+  printf("%d strings, %u glyphs, best of %d\n", BENCH_STRINGS, glyph_count, iterations);
+  printf("  linear kerning walk %8.1f us, %6.1f ns a glyph\n", old_us, old_us * 1000 / glyph_count);
+  printf("  glyphs + kern hash  %8.1f us, %6.1f ns a glyph, %.2fx\n", new_us, new_us * 1000 / glyph_count,
+         old_us / new_us);
+  printf("(checksum %.0f)\n", quad_sum);
+
+  for (int i = 0; i < BENCH_STRINGS; i++) {
+    free(strings[i]);
+  }
+  free(strings);
+  free(sorted_pairs);
+  free(pairs);
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
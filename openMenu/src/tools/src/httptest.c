@@ -0,0 +1,396 @@
+/*
+ * File: httptest.c
+ * Project: tools
+ * File Created: Sunday, 18th October 2026
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "dcnow_http.h"
+
+/* Called:
+./httptest
+
+feeds the DC Now HTTP response parser canned responses whole, split in two at
+every byte and a byte at a time: Content-Length and read until close bodies,
+chunked bodies with extensions and trailers, 1xx, 204 and 304, and malformed
+ones. Then runs dcnow_http_get against a small server on 127.0.0.1 to check a
+kept connection is reused, a connection the server dropped is retried on a new
+one, a kept connection that never answers costs the timeout only once, and a
+cancelled request stops waiting on one at once.
+Exits non zero if any check failed.
+*/
+
+#define BODY_MAX       4096
+#define GET_TIMEOUT_MS 300
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("FAIL %s:%d: ", __FILE__, __LINE__);                                                                      \
+      printf(__VA_ARGS__);                                                                                             \
+      printf("\n");                                                                                                    \
+      failures++;                                                                                                      \
+    }                                                                                                                  \
+  } while (0)
+
+/* DC Now only prints its debug output while this says the serial port is free */
+int dcnow_is_serial_scif_active(void) {
+  return 1;
+}
+
+static uint64_t now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+typedef struct {
+  char data[BODY_MAX];
+  int len;
+} body_t;
+
+static void collect(void *user, const char *data, int len) {
+  body_t *body = (body_t *)user;
+  if (body->len + len <= BODY_MAX) {
+    memcpy(body->data + body->len, data, len);
+  }
+  body->len += len;
+}
+
+typedef enum { ENDS_DONE, ENDS_AT_CLOSE, ENDS_MALFORMED, ENDS_SHORT } ending_t;
+
+typedef struct {
+  const char *name;
+  const char *response;
+  ending_t ending;
+  int status;
+  const char *body;
+  bool keep_alive;
+} response_case_t;
+
+static const response_case_t cases[] = {
+    {"content-length",
+     "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nETag: \"v1\"\r\n"
+     "Last-Modified: Sun, 18 Oct 2026 10:00:00 GMT\r\nContent-Length: 11\r\n\r\n{\"users\":1}",
+     ENDS_DONE, 200, "{\"users\":1}", true},
+    {"content-length 0", "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n", ENDS_DONE, 200, "", true},
+    {"chunked",
+     "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+     "4\r\n{\"us\r\n7;ext=1\r\ners\":1}\r\nA\r\n, \"more\":2\r\n1\r\n}\r\n0\r\nX-Trailer: yes\r\n\r\n",
+     ENDS_DONE, 200, "{\"users\":1}, \"more\":2}", true},
+    {"chunked, bare LF", "HTTP/1.1 200 OK\nTransfer-Encoding: chunked\n\n3\nabc\n0\n\n", ENDS_DONE, 200, "abc",
+     true},
+    {"until close", "HTTP/1.0 200 OK\r\nContent-Type: application/json\r\n\r\n{\"users\":[]}", ENDS_AT_CLOSE, 200,
+     "{\"users\":[]}", false},
+    {"connection close", "HTTP/1.1 200 OK\r\nConnection: close\r\nContent-Length: 2\r\n\r\n{}", ENDS_DONE, 200, "{}",
+     false},
+    {"1.0 keep-alive", "HTTP/1.0 200 OK\r\nConnection: Keep-Alive\r\nContent-Length: 2\r\n\r\n{}", ENDS_DONE, 200,
+     "{}", true},
+    {"100 continue", "HTTP/1.1 100 Continue\r\n\r\nHTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\n{}", ENDS_DONE, 200,
+     "{}", true},
+    {"204", "HTTP/1.1 204 No Content\r\n\r\n", ENDS_DONE, 204, "", true},
+    {"304", "HTTP/1.1 304 Not Modified\r\nETag: \"v1\"\r\nContent-Length: 11\r\n\r\n", ENDS_DONE, 304, "", true},
+    {"long header",
+     "HTTP/1.1 200 OK\r\nX-Long: "
+     "0123456789012345678901234567890123456789012345678901234567890123456789012345678901234567890123456789"
+     "0123456789012345678901234567890123456789012345678901234567890123456789012345678901234567890123456789"
+     "0123456789012345678901234567890123456789012345678901234567890123456789012345678901234567890123456789\r\n"
+     "Content-Length: 2\r\n\r\n{}",
+     ENDS_DONE, 200, "{}", true},
+    {"not http", "SSH-2.0-OpenSSH\r\n\r\n", ENDS_MALFORMED, 0, "", true},
+    {"bad chunk size", "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n", ENDS_MALFORMED, 200, "", true},
+    {"chunk overruns", "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n2\r\nabc\r\n0\r\n\r\n", ENDS_MALFORMED, 200,
+     "ab", true},
+    {"unasked gzip", "HTTP/1.1 200 OK\r\nContent-Encoding: gzip\r\nContent-Length: 4\r\n\r\nabcd", ENDS_MALFORMED,
+     200, "", true},
+    {"cut short", "HTTP/1.1 200 OK\r\nContent-Length: 20\r\n\r\n{\"users\":", ENDS_SHORT, 200, "{\"users\":", true},
+    {"chunked cut short", "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n8\r\nabcd", ENDS_SHORT, 200, "abcd",
+     true},
+};
+
+/* Feeds response in pieces cut at the given offsets, step 0 for two pieces split at split */
+static void run_case(const response_case_t *c, int split, int step, const char *how) {
+  const int len = (int)strlen(c->response);
+  http_response_t res;
+  body_t body = {{0}, 0};
+  bool ok = true;
+
+  dcnow_http_response_init(&res, collect, &body);
+  if (step) {
+    for (int i = 0; i < len && ok; i += step) {
+      ok = dcnow_http_response_feed(&res, c->response + i, len - i < step ? len - i : step);
+    }
+  } else {
+    ok = dcnow_http_response_feed(&res, c->response, split) &&
+         dcnow_http_response_feed(&res, c->response + split, len - split);
+  }
+
+  switch (c->ending) {
+    case ENDS_DONE:
+      CHECK(ok && dcnow_http_response_done(&res), "%s %s: not done", c->name, how);
+      CHECK(dcnow_http_response_close(&res), "%s %s: close after the end failed", c->name, how);
+      break;
+    case ENDS_AT_CLOSE:
+      CHECK(ok && !dcnow_http_response_done(&res), "%s %s: done before close", c->name, how);
+      CHECK(dcnow_http_response_close(&res) && dcnow_http_response_done(&res), "%s %s: not done at close", c->name,
+            how);
+      break;
+    case ENDS_MALFORMED:
+      CHECK(!ok, "%s %s: accepted", c->name, how);
+      CHECK(!dcnow_http_response_close(&res), "%s %s: done at close", c->name, how);
+      return;
+    case ENDS_SHORT:
+      CHECK(ok && !dcnow_http_response_done(&res), "%s %s: done early", c->name, how);
+      CHECK(!dcnow_http_response_close(&res), "%s %s: done at close", c->name, how);
+      break;
+  }
+  CHECK(res.status == c->status, "%s %s: status %d", c->name, how, res.status);
+  CHECK(res.keep_alive == c->keep_alive, "%s %s: keep-alive %d", c->name, how, res.keep_alive);
+  CHECK(body.len == (int)strlen(c->body) && !memcmp(body.data, c->body, body.len), "%s %s: body %.*s", c->name, how,
+        body.len, body.data);
+  CHECK((int)res.body_bytes == body.len, "%s %s: %u body bytes counted, %d passed on", c->name, how,
+        (unsigned)res.body_bytes, body.len);
+}
+
+static void test_parser(void) {
+  char how[32];
+
+  for (unsigned int i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    const int len = (int)strlen(cases[i].response);
+    for (int split = 0; split <= len; split++) {
+      snprintf(how, sizeof(how), "split at %d", split);
+      run_case(&cases[i], split, 0, how);
+    }
+    run_case(&cases[i], 0, 1, "byte at a time");
+  }
+
+  /* Validators come out as sent */
+  http_response_t res;
+  dcnow_http_response_init(&res, NULL, NULL);
+  dcnow_http_response_feed(&res, cases[0].response, strlen(cases[0].response));
+  CHECK(!strcmp(res.validators.etag, "\"v1\""), "etag read as %s", res.validators.etag);
+  CHECK(!strcmp(res.validators.last_modified, "Sun, 18 Oct 2026 10:00:00 GMT"), "last-modified read as %s",
+        res.validators.last_modified);
+}
+
+/* A server on 127.0.0.1, a thread per connection, doing whatever the test set last */
+typedef enum {
+  SERVE_OK,      /* answers with keep-alive, 304 when If-None-Match is "v1" */
+  SERVE_CLOSE,   /* answers with Connection: close */
+  SERVE_DROP,    /* answers as if keeping the connection, then closes it */
+  SERVE_SILENT,  /* reads requests and never answers */
+} serve_mode_t;
+
+static atomic_int serve_mode;
+static atomic_int accepted;
+static atomic_int requests;
+static int listen_fd;
+static uint16_t server_port;
+
+static const char served_body[] = "{\"users\": [], \"online_count\": 0}";
+
+static void *serve_connection(void *arg) {
+  const int fd = (int)(intptr_t)arg;
+  char request[1024];
+  int len = 0;
+  char response[256];
+
+  for (;;) {
+    const int received = recv(fd, request + len, sizeof(request) - 1 - len, 0);
+    if (received <= 0) {
+      break;
+    }
+    len += received;
+    request[len] = '\0';
+    char *end = strstr(request, "\r\n\r\n");
+    if (!end) {
+      continue;
+    }
+    requests++;
+
+    const serve_mode_t mode = serve_mode;
+    if (mode == SERVE_SILENT) {
+      len = 0;
+      continue;
+    }
+    int sent;
+    if (strstr(request, "If-None-Match: \"v1\"")) {
+      sent = snprintf(response, sizeof(response), "HTTP/1.1 304 Not Modified\r\nETag: \"v1\"\r\n\r\n");
+    } else {
+      sent = snprintf(response, sizeof(response),
+                      "HTTP/1.1 200 OK\r\nETag: \"v1\"\r\nContent-Length: %zu\r\nConnection: %s\r\n\r\n%s",
+                      sizeof(served_body) - 1, mode == SERVE_CLOSE ? "close" : "keep-alive", served_body);
+    }
+    send(fd, response, sent, MSG_NOSIGNAL);
+    if (mode == SERVE_CLOSE || mode == SERVE_DROP) {
+      break;
+    }
+    len = 0;
+  }
+  close(fd);
+  return NULL;
+}
+
+static void *serve(void *arg) {
+  (void)arg;
+  for (;;) {
+    const int fd = accept(listen_fd, NULL, NULL);
+    if (fd < 0) {
+      return NULL;
+    }
+    accepted++;
+    pthread_t thread;
+    pthread_create(&thread, NULL, serve_connection, (void *)(intptr_t)fd);
+    pthread_detach(thread);
+  }
+}
+
+static bool server_start(void) {
+  struct sockaddr_in addr;
+  socklen_t addr_len = sizeof(addr);
+  pthread_t thread;
+
+  listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (listen_fd < 0 || bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(listen_fd, 8) < 0 ||
+      getsockname(listen_fd, (struct sockaddr *)&addr, &addr_len) < 0) {
+    return false;
+  }
+  server_port = ntohs(addr.sin_port);
+  pthread_create(&thread, NULL, serve, NULL);
+  pthread_detach(thread);
+  return true;
+}
+
+/* One GET, the body it got back in body */
+static int get(const http_validators_t *validators, http_response_t *res, body_t *body) {
+  body->len = 0;
+  dcnow_http_response_init(res, collect, body);
+  return dcnow_http_get("127.0.0.1", server_port, "/online/users.json", validators, res, GET_TIMEOUT_MS);
+}
+
+static void reset_server(serve_mode_t mode) {
+  dcnow_http_disconnect();
+  usleep(10000); /* let the server notice */
+  serve_mode = mode;
+  accepted = 0;
+  requests = 0;
+}
+
+static volatile bool cancel_requested;
+
+static void *cancel_later(void *arg) {
+  (void)arg;
+  usleep(100 * 1000);
+  cancel_requested = true;
+  return NULL;
+}
+
+static void test_client(void) {
+  http_response_t res;
+  body_t body;
+  int result;
+
+  if (!server_start()) {
+    CHECK(0, "no local server");
+    return;
+  }
+
+  /* Kept connection carries the next request, a 304 too */
+  reset_server(SERVE_OK);
+  result = get(NULL, &res, &body);
+  CHECK(result > 0 && res.status == 200 && body.len == (int)sizeof(served_body) - 1, "first GET: %d, status %d",
+        result, res.status);
+  http_validators_t validators = res.validators;
+  result = get(NULL, &res, &body);
+  CHECK(result > 0 && res.status == 200, "second GET: %d, status %d", result, res.status);
+  result = get(&validators, &res, &body);
+  CHECK(result > 0 && res.status == 304 && body.len == 0, "conditional GET: %d, status %d", result, res.status);
+  result = get(NULL, &res, &body);
+  CHECK(result > 0 && res.status == 200, "GET after the 304: %d, status %d", result, res.status);
+  CHECK(accepted == 1 && requests == 4, "4 requests took %d connections", (int)accepted);
+
+  /* Connection: close is honoured, the next request opens a new one */
+  reset_server(SERVE_CLOSE);
+  get(NULL, &res, &body);
+  CHECK(!res.keep_alive, "Connection: close not seen");
+  result = get(NULL, &res, &body);
+  CHECK(result > 0 && accepted == 2, "after a close: %d, %d connections", result, (int)accepted);
+
+  /* The server dropped the kept connection, the request goes again on a new one */
+  reset_server(SERVE_DROP);
+  get(NULL, &res, &body);
+  usleep(10000);
+  result = get(NULL, &res, &body);
+  CHECK(result > 0 && res.status == 200 && body.len == (int)sizeof(served_body) - 1,
+        "retry after a drop: %d, status %d, %d body bytes", result, res.status, body.len);
+  CHECK(accepted == 2 && requests == 2, "retry after a drop: %d connections, %d requests", (int)accepted,
+        (int)requests);
+
+  /* A kept connection that never answers fails once the timeout is spent, it isn't waited out twice */
+  reset_server(SERVE_OK);
+  get(NULL, &res, &body);
+  serve_mode = SERVE_SILENT;
+  const uint64_t start = now_ms();
+  result = get(NULL, &res, &body);
+  const uint64_t took = now_ms() - start;
+  CHECK(result == -6, "silent connection: %d", result);
+  CHECK(took >= GET_TIMEOUT_MS && took < GET_TIMEOUT_MS * 3 / 2, "silent connection took %llu ms for a %d ms timeout",
+        (unsigned long long)took, GET_TIMEOUT_MS);
+  printf("silent kept connection gave up after %llu ms, %d ms timeout\n", (unsigned long long)took, GET_TIMEOUT_MS);
+
+  /* Cancelling stops the wait on a silent connection well before its timeout, and drops it */
+  reset_server(SERVE_SILENT);
+  pthread_t canceller;
+  cancel_requested = false;
+  dcnow_http_set_cancel_flag(&cancel_requested);
+  pthread_create(&canceller, NULL, cancel_later, NULL);
+  const uint64_t cancel_start = now_ms();
+  body.len = 0;
+  dcnow_http_response_init(&res, collect, &body);
+  result = dcnow_http_get("127.0.0.1", server_port, "/online/users.json", NULL, &res, 5000);
+  const uint64_t cancel_took = now_ms() - cancel_start;
+  pthread_join(canceller, NULL);
+  CHECK(result == -7, "cancelled request: %d", result);
+  CHECK(cancel_took < 1000, "cancelled request took %llu ms", (unsigned long long)cancel_took);
+  result = get(NULL, &res, &body);
+  CHECK(result == -7 && accepted == 1, "request with the flag still set: %d, %d connections", result, (int)accepted);
+  dcnow_http_set_cancel_flag(NULL);
+  serve_mode = SERVE_OK;
+  result = get(NULL, &res, &body);
+  CHECK(result > 0 && res.status == 200 && accepted == 2, "after a cancel: %d, %d connections", result,
+        (int)accepted);
+
+  /* Nothing listening */
+  reset_server(SERVE_OK);
+  shutdown(listen_fd, SHUT_RDWR);
+  close(listen_fd);
+  result = get(NULL, &res, &body);
+  CHECK(result == -4, "GET with nothing listening: %d", result);
+  dcnow_http_disconnect();
+}
+
+int main(void) {
+  /* A request on a connection the server closed must fail, not end the test */
+  signal(SIGPIPE, SIG_IGN);
+  test_parser();
+  test_client();
+
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,405 @@
+/*
+ * File: inflatetest.c
+ * Project: tools
+ * File Created: Sunday, 18th October 2026
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dcnow_inflate.h"
+
+/* Called:
+./inflatetest data_folder
+
+checks the DC Now gzip decoder on stored, fixed and dynamic Huffman blocks,
+fed whole, a byte at a time and split in two at every byte, on copies that
+reach across the 32KB window, on bad CRCs and lengths and on streams cut
+short, and inflates data_folder/users.json.gz to compare it with users.json.
+Exits non zero if any check failed.
+*/
+
+#define OUT_MAX (128 * 1024)
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("FAIL %s:%d: ", __FILE__, __LINE__);                                                                      \
+      printf(__VA_ARGS__);                                                                                             \
+      printf("\n");                                                                                                    \
+      failures++;                                                                                                      \
+    }                                                                                                                  \
+  } while (0)
+
+/* DC Now only prints its debug output while this says the serial port is free */
+int dcnow_is_serial_scif_active(void) {
+  return 1;
+}
+
+/* The same two users as gzip -9 writes them with fixed Huffman codes only */
+static const char fixed_plain[] =
+    "{\"users\": [{\"username\": \"Sega_Fan\", \"level\": \"Newbie\", \"country\": \"US\"}, {\"username\": \"Ragol\", "
+    "\"level\": \"Newbie\", \"country\": \"FR\"}], \"total_count\": 2, \"online_count\": 2}";
+
+static const uint8_t fixed_gz[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0xab, 0x56, 0x2a, 0x2d, 0x4e, 0x2d,
+    0x2a, 0x56, 0xb2, 0x52, 0x88, 0xae, 0x06, 0x33, 0xf3, 0x12, 0x73, 0x53, 0x81, 0x3c, 0xa5, 0xe0,
+    0xd4, 0xf4, 0xc4, 0x78, 0xb7, 0xc4, 0x3c, 0x25, 0x1d, 0x05, 0xa5, 0x9c, 0xd4, 0xb2, 0xd4, 0x1c,
+    0x90, 0xa0, 0x5f, 0x6a, 0x79, 0x52, 0x66, 0x2a, 0x48, 0x28, 0x39, 0xbf, 0x34, 0xaf, 0xa4, 0xa8,
+    0x12, 0x24, 0x18, 0x1a, 0xac, 0x54, 0xab, 0xa3, 0x80, 0xaa, 0x3b, 0x28, 0x31, 0x3d, 0x3f, 0x87,
+    0xb0, 0x56, 0xb7, 0x20, 0xa5, 0xda, 0x58, 0xa0, 0x50, 0x49, 0x7e, 0x49, 0x62, 0x4e, 0x3c, 0x58,
+    0x02, 0x28, 0x6c, 0x04, 0x14, 0xc9, 0xcf, 0xcb, 0xc9, 0xcc, 0x4b, 0x45, 0x08, 0xd5, 0x02, 0x00,
+    0x11, 0x1f, 0x72, 0x72, 0xa9, 0x00, 0x00, 0x00,
+};
+
+typedef struct {
+  uint8_t *data;
+  size_t size;
+} bytes_t;
+
+static void collect(void *user, const char *data, int len) {
+  bytes_t *out = (bytes_t *)user;
+  if (out->size + len > OUT_MAX) {
+    CHECK(0, "more than %d bytes inflated", OUT_MAX);
+    return;
+  }
+  memcpy(out->data + out->size, data, len);
+  out->size += len;
+}
+
+static uint32_t crc32_bytes(const uint8_t *data, size_t len) {
+  uint32_t crc = 0xffffffff;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; b++) {
+      crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+    }
+  }
+  return ~crc;
+}
+
+/* Builds deflate streams a bit at a time, least significant bit first */
+typedef struct {
+  uint8_t *data;
+  size_t size;
+  uint32_t bits;
+  int count;
+} bit_writer_t;
+
+static void put_byte(bit_writer_t *w, uint8_t byte) {
+  w->data[w->size++] = byte;
+}
+
+static void put_bits(bit_writer_t *w, uint32_t value, int n) {
+  for (int i = 0; i < n; i++) {
+    w->bits |= ((value >> i) & 1) << w->count;
+    if (++w->count == 8) {
+      put_byte(w, (uint8_t)w->bits);
+      w->bits = 0;
+      w->count = 0;
+    }
+  }
+}
+
+/* Huffman codes go out most significant bit first */
+static void put_code(bit_writer_t *w, uint32_t code, int n) {
+  for (int i = n - 1; i >= 0; i--) {
+    put_bits(w, (code >> i) & 1, 1);
+  }
+}
+
+static void align(bit_writer_t *w) {
+  if (w->count) {
+    put_bits(w, 0, 8 - w->count);
+  }
+}
+
+static void put_le32(bit_writer_t *w, uint32_t value) {
+  for (int i = 0; i < 4; i++) {
+    put_byte(w, (uint8_t)(value >> (8 * i)));
+  }
+}
+
+/* Header with every optional field when extras is set */
+static void put_gzip_header(bit_writer_t *w, bool extras) {
+  static const uint8_t header[] = {0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03};
+  for (size_t i = 0; i < sizeof(header); i++) {
+    put_byte(w, i == 3 && extras ? 0x1e : header[i]);
+  }
+  if (extras) {
+    static const uint8_t fields[] = {5, 0, 'A', 'B', 2, 0, 'x', 'u', 's', 'e', 'r', 's', '.', 'j', 's', 'o', 'n', 0,
+                                     'D', 'C', ' ', 'N', 'o', 'w', 0, 0x12, 0x34};
+    for (size_t i = 0; i < sizeof(fields); i++) {
+      put_byte(w, fields[i]);
+    }
+  }
+}
+
+static void put_stored(bit_writer_t *w, const uint8_t *data, uint16_t len, bool last) {
+  put_bits(w, last, 1);
+  put_bits(w, 0, 2);
+  align(w);
+  put_byte(w, len & 0xff);
+  put_byte(w, len >> 8);
+  put_byte(w, ~len & 0xff);
+  put_byte(w, (uint16_t)~len >> 8);
+  for (uint16_t i = 0; i < len; i++) {
+    put_byte(w, data[i]);
+  }
+}
+
+static void put_fixed_symbol(bit_writer_t *w, int sym) {
+  if (sym < 144) {
+    put_code(w, 0x30 + sym, 8);
+  } else if (sym < 256) {
+    put_code(w, 0x190 + sym - 144, 9);
+  } else if (sym < 280) {
+    put_code(w, sym - 256, 7);
+  } else {
+    put_code(w, 0xc0 + sym - 280, 8);
+  }
+}
+
+/* Length and distance of a copy, with out grown by it the way the decoder must */
+static void put_fixed_copy(bit_writer_t *w, bytes_t *out, int length, int distance) {
+  static const int len_base[] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+  static const int len_extra[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+  static const int dist_base[] = {1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+                                  193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+  int l = 28, d = 29;
+
+  while (len_base[l] > length) {
+    l--;
+  }
+  while (dist_base[d] > distance) {
+    d--;
+  }
+  put_fixed_symbol(w, 257 + l);
+  put_bits(w, length - len_base[l], len_extra[l]);
+  put_code(w, d, 5);
+  put_bits(w, distance - dist_base[d], d < 4 ? 0 : d / 2 - 1);
+
+  for (int i = 0; i < length; i++) {
+    out->data[out->size] = out->data[out->size - distance];
+    out->size++;
+  }
+}
+
+static void put_gzip_trailer(bit_writer_t *w, const bytes_t *plain) {
+  align(w);
+  put_le32(w, crc32_bytes(plain->data, plain->size));
+  put_le32(w, (uint32_t)plain->size);
+}
+
+/* Outcome of one run, DONE only when the trailer checked out */
+typedef enum { RUN_ERROR = -1, RUN_SHORT = 0, RUN_DONE = 1 } run_result_t;
+
+static inflate_stream_t inflater;
+static uint8_t out_data[OUT_MAX];
+
+/* Inflates gz fed as its first `at` bytes, then the rest `piece` bytes at a time (0 for all at once) */
+static run_result_t run(const uint8_t *gz, size_t len, size_t at, size_t piece, bytes_t *out) {
+  out->data = out_data;
+  out->size = 0;
+  dcnow_inflate_init(&inflater, collect, out);
+
+  if (at > 0 && !dcnow_inflate_feed(&inflater, (const char *)gz, (int)at)) {
+    return RUN_ERROR;
+  }
+  while (at < len) {
+    const size_t n = piece == 0 || len - at < piece ? len - at : piece;
+    if (!dcnow_inflate_feed(&inflater, (const char *)gz + at, (int)n)) {
+      return RUN_ERROR;
+    }
+    at += n;
+  }
+  return dcnow_inflate_done(&inflater) ? RUN_DONE : RUN_SHORT;
+}
+
+static bool same(const bytes_t *out, const uint8_t *plain, size_t plain_len) {
+  return out->size == plain_len && memcmp(out->data, plain, plain_len) == 0;
+}
+
+/*
+ * Whole, a byte at a time, and split in two wherever split_every says, then
+ * every prefix in truncate_from.. must leave the stream waiting for more
+ */
+static void check_stream(const char *name, const uint8_t *gz, size_t len, const uint8_t *plain, size_t plain_len,
+                         size_t split_every, size_t truncate_from) {
+  bytes_t out;
+  int bad_splits = 0, bad_prefixes = 0;
+
+  CHECK(run(gz, len, 0, 0, &out) == RUN_DONE && same(&out, plain, plain_len), "%s: whole stream, %zu of %zu bytes",
+        name, out.size, plain_len);
+  CHECK(inflater.out_bytes == plain_len && inflater.in_bytes == len, "%s: counted %u in, %u out", name,
+        (unsigned)inflater.in_bytes, (unsigned)inflater.out_bytes);
+  CHECK(run(gz, len, 0, 1, &out) == RUN_DONE && same(&out, plain, plain_len), "%s: a byte at a time", name);
+
+  for (size_t at = 1; at < len; at += split_every) {
+    if (run(gz, len, at, 0, &out) != RUN_DONE || !same(&out, plain, plain_len)) {
+      if (bad_splits++ == 0) {
+        CHECK(0, "%s: split at byte %zu", name, at);
+      }
+    }
+  }
+  for (size_t at = truncate_from; at < len; at++) {
+    const run_result_t result = run(gz, at, 0, 0, &out);
+    if (result != RUN_SHORT || out.size > plain_len || memcmp(out.data, plain, out.size) != 0) {
+      if (bad_prefixes++ == 0) {
+        CHECK(0, "%s: cut to %zu bytes gave %d with %zu bytes out", name, at, result, out.size);
+      }
+    }
+  }
+  CHECK(bad_splits == 0, "%s: %d splits failed", name, bad_splits);
+  CHECK(bad_prefixes == 0, "%s: %d truncated streams weren't left waiting", name, bad_prefixes);
+
+  /* The trailer is checked once all of it is in */
+  uint8_t *bad = malloc(len);
+  memcpy(bad, gz, len);
+  bad[len - 8] ^= 0x01;
+  CHECK(run(bad, len, 0, 0, &out) == RUN_ERROR, "%s: bad CRC accepted", name);
+  memcpy(bad, gz, len);
+  bad[len - 4] ^= 0x01;
+  CHECK(run(bad, len, 0, 0, &out) == RUN_ERROR, "%s: bad ISIZE accepted", name);
+  memcpy(bad, gz, len);
+  bad[len - 1] ^= 0x80;
+  CHECK(run(bad, len, 0, 1, &out) == RUN_ERROR, "%s: bad ISIZE accepted a byte at a time", name);
+  free(bad);
+
+  printf("%-24s %6zu bytes in, %6zu out\n", name, len, plain_len);
+}
+
+static uint8_t pattern_byte(size_t i) {
+  return (uint8_t)(i * 31 + (i >> 7));
+}
+
+/* Three stored blocks, an empty one in the middle, behind a header with every optional field */
+static void check_stored(void) {
+  uint8_t plain[300], gz[400];
+  bit_writer_t w = {gz, 0, 0, 0};
+  bytes_t text = {plain, sizeof(plain)};
+
+  for (size_t i = 0; i < sizeof(plain); i++) {
+    plain[i] = pattern_byte(i);
+  }
+  put_gzip_header(&w, true);
+  put_stored(&w, plain, 100, false);
+  put_stored(&w, plain + 100, 0, false);
+  put_stored(&w, plain + 100, 200, true);
+  put_gzip_trailer(&w, &text);
+
+  check_stream("stored, header fields", gz, w.size, plain, sizeof(plain), 1, 0);
+}
+
+/*
+ * 40000 stored bytes, more than the window holds, then a fixed block copying
+ * from 32768 back, with extra length and distance bits, and a copy that
+ * overlaps itself
+ */
+static void check_window(void) {
+  static uint8_t plain[OUT_MAX], gz[OUT_MAX];
+  bit_writer_t w = {gz, 0, 0, 0};
+  bytes_t text = {plain, 0};
+
+  for (; text.size < 40000; text.size++) {
+    plain[text.size] = pattern_byte(text.size);
+  }
+  put_gzip_header(&w, false);
+  put_stored(&w, plain, 30000, false);
+  put_stored(&w, plain + 30000, 10000, false);
+
+  put_bits(&w, 1, 1);
+  put_bits(&w, 1, 2);
+  put_fixed_symbol(&w, 'X');
+  plain[text.size++] = 'X';
+  for (int i = 0; i < 40; i++) {
+    put_fixed_copy(&w, &text, 258, 32768);
+  }
+  put_fixed_copy(&w, &text, 100, 1000);
+  put_fixed_copy(&w, &text, 20, 1);
+  put_fixed_copy(&w, &text, 3, 32768);
+  put_fixed_symbol(&w, 256);
+  put_gzip_trailer(&w, &text);
+
+  check_stream("stored and fixed, window", gz, w.size, plain, text.size, 997, w.size - 400);
+}
+
+static bool read_file(const char *folder, const char *name, bytes_t *file) {
+  char path[1024];
+  snprintf(path, sizeof(path), "%s/%s", folder, name);
+  FILE *fd = fopen(path, "rb");
+  if (!fd) {
+    CHECK(0, "can't open %s", path);
+    return false;
+  }
+  file->data = malloc(OUT_MAX);
+  file->size = fread(file->data, 1, OUT_MAX, fd);
+  fclose(fd);
+  return true;
+}
+
+/* A trace as gzip -9 made it, dynamic Huffman blocks, against the plain copy */
+static void check_trace(const char *folder) {
+  bytes_t plain, gz, out;
+
+  if (!read_file(folder, "users.json", &plain)) {
+    return;
+  }
+  if (!read_file(folder, "users.json.gz", &gz)) {
+    free(plain.data);
+    return;
+  }
+
+  CHECK(gz.size > 10 && ((gz.data[10] >> 1) & 3) == 2, "users.json.gz doesn't start with a dynamic block");
+  check_stream("dynamic, users.json.gz", gz.data, gz.size, plain.data, plain.size, 1, 0);
+
+  /* A body sent without Content-Encoding must not be taken for gzip */
+  CHECK(run(plain.data, plain.size, 0, 0, &out) == RUN_ERROR && out.size == 0, "plain users.json inflated");
+
+  free(plain.data);
+  free(gz.data);
+}
+
+static void check_corrupt(void) {
+  uint8_t bad[sizeof(fixed_gz)];
+  bytes_t out;
+
+  memcpy(bad, fixed_gz, sizeof(bad));
+  bad[10] |= 0x06;
+  CHECK(run(bad, sizeof(bad), 0, 0, &out) == RUN_ERROR, "reserved block type accepted");
+
+  memcpy(bad, fixed_gz, sizeof(bad));
+  bad[2] = 7;
+  CHECK(run(bad, sizeof(bad), 0, 0, &out) == RUN_ERROR, "method other than deflate accepted");
+
+  memcpy(bad, fixed_gz, sizeof(bad));
+  bad[3] = 0x20;
+  CHECK(run(bad, sizeof(bad), 0, 0, &out) == RUN_ERROR, "reserved header flag accepted");
+
+  /* Stored block whose length and its complement disagree */
+  uint8_t stored[] = {0x1f, 0x8b, 0x08, 0x00, 0, 0, 0, 0, 0, 0x03, 0x01, 0x05, 0x00, 0xfa, 0xfe, 'h', 'e', 'l', 'l', 'o'};
+  CHECK(run(stored, sizeof(stored), 0, 0, &out) == RUN_ERROR, "stored length mismatch accepted");
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    printf("usage: %s data_folder\n", argv[0]);
+    return 1;
+  }
+
+  check_stored();
+  check_stream("fixed, gzip -9", fixed_gz, sizeof(fixed_gz), (const uint8_t *)fixed_plain, strlen(fixed_plain), 1, 0);
+  check_trace(argv[1]);
+  check_window();
+  check_corrupt();
+
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,257 @@
+/*
+ * File: jsontest.c
+ * Project: tools
+ * File Created: Sunday, 18th October 2026
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "dcnow_json.h"
+
+/* Called:
+./jsontest [iterations]
+
+checks the DC Now users.json parser on documents split into pieces at every
+byte, on escapes and on malformed input, then times it on a generated list
+of 1000 users, whole and fed one TCP segment at a time (default 50 runs).
+Exits non zero if any check failed.
+*/
+
+#define BENCH_USERS 1000
+#define BENCH_MSS   1460
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("FAIL %s:%d: ", __FILE__, __LINE__);                                                                      \
+      printf(__VA_ARGS__);                                                                                             \
+      printf("\n");                                                                                                    \
+      failures++;                                                                                                      \
+    }                                                                                                                  \
+  } while (0)
+
+/* DC Now only prints its debug output while this says the serial port is free */
+int dcnow_is_serial_scif_active(void) {
+  return 1;
+}
+
+static double now_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static const char sample[] =
+    "{\"users\": [\n"
+    "  {\"username\": \"alice\", \"level\": \"Newbie\", \"country\": \"US\", \"current_game\": \"PSO\",\n"
+    "   \"current_game_display\": \"Phantasy Star Online\", \"id\": 98765432109876543210, \"ratio\": -1.5e3,\n"
+    "   \"banned\": false, \"flags\": [true, null, {\"deep\": [1, 2]}]},\n"
+    "  {\"username\": \"b\\\"o\\\\b\\/\\u0041\\u00e9\\n\", \"current_game\": \"Q3\", \"current_game_display\": \"Quake III\"},\n"
+    "  {\"username\": \"carol\", \"level\": \"Pro\", \"current_game\": \"PSO\", \"current_game_display\": \"PSO v2\"},\n"
+    "  {\"username\": \"dave\", \"current_game_display\": \"\"}\n"
+    "], \"total_count\": 4, \"online_count\": 4}";
+
+/* What sample holds, checked the same way however it was fed */
+static void check_sample(const json_dcnow_t *r, const char *how) {
+  CHECK(r->valid, "%s: not valid", how);
+  CHECK(r->total_players == 4, "%s: online_count %d", how, r->total_players);
+  CHECK(r->game_count == 3, "%s: %d games", how, r->game_count);
+  if (r->game_count != 3) {
+    return;
+  }
+
+  const json_game_t *pso = &r->games[0], *quake = &r->games[1], *idle = &r->games[2];
+  CHECK(strcmp(pso->game_code, "PSO") == 0 && strcmp(pso->game_name, "Phantasy Star Online") == 0,
+        "%s: first game %s/%s", how, pso->game_code, pso->game_name);
+  CHECK(pso->player_count == 2, "%s: players grouped by code, %d in PSO", how, pso->player_count);
+  if (pso->player_count == 2) {
+    CHECK(strcmp(pso->players[0].name, "alice") == 0 && strcmp(pso->players[1].name, "carol") == 0,
+          "%s: PSO players %s, %s", how, pso->players[0].name, pso->players[1].name);
+    CHECK(strcmp(pso->players[0].level, "Newbie") == 0 && strcmp(pso->players[0].country, "US") == 0,
+          "%s: alice is %s from %s", how, pso->players[0].level, pso->players[0].country);
+  }
+  CHECK(quake->player_count == 1 && strcmp(quake->players[0].name, "b\"o\\b/A?\n") == 0, "%s: escapes read as %s",
+        how, quake->player_count ? quake->players[0].name : "nothing");
+  CHECK(quake->players[0].level[0] == '\0', "%s: missing level read as %s", how, quake->players[0].level);
+  CHECK(idle->player_count == 1 && strcmp(idle->players[0].name, "dave") == 0, "%s: idle user missing", how);
+}
+
+static void test_whole(dcnow_arena_t *arena) {
+  json_dcnow_t r;
+  CHECK(dcnow_json_parse(sample, &r, arena), "sample didn't parse");
+  check_sample(&r, "whole");
+}
+
+/* Split in two at every byte, then fed a byte at a time, to cross every token */
+static void test_chunk_splits(dcnow_arena_t *arena) {
+  const int len = (int)strlen(sample);
+  json_parser_t parser;
+  json_dcnow_t r;
+  char how[32];
+
+  for (int split = 0; split <= len; split++) {
+    snprintf(how, sizeof(how), "split at %d", split);
+    dcnow_json_begin(&parser, &r, arena);
+    CHECK(dcnow_json_feed(&parser, sample, split) && dcnow_json_feed(&parser, sample + split, len - split),
+          "%s: feed failed", how);
+    CHECK(dcnow_json_done(&parser), "%s: not done", how);
+    CHECK(dcnow_json_end(&parser), "%s: end failed", how);
+    check_sample(&r, how);
+  }
+
+  dcnow_json_begin(&parser, &r, arena);
+  for (int i = 0; i < len; i++) {
+    if (!dcnow_json_feed(&parser, sample + i, 1)) {
+      CHECK(0, "byte at a time: feed failed at %d", i);
+      break;
+    }
+    CHECK(dcnow_json_done(&parser) == (i == len - 1), "byte at a time: done at %d", i);
+  }
+  CHECK(dcnow_json_end(&parser), "byte at a time: end failed");
+  check_sample(&r, "byte at a time");
+}
+
+static void test_numbers(dcnow_arena_t *arena) {
+  static const struct {
+    const char *doc;
+    int online;
+  } cases[] = {
+      {"{\"online_count\": 12}", 12},
+      {"{\"online_count\": 12.9e1}", 12},
+      {"{\"online_count\": -3}", -3},
+      {"{\"online_count\": 2147483647}", INT_MAX},
+      {"{\"online_count\": 99999999999999999999}", INT_MAX},
+      {"{\"id\": 99999999999999999999, \"online_count\": 5, \"total_count\": 4294967296}", 5},
+      {"{\"nested\": {\"online_count\": 8}, \"online_count\": 6}", 6},
+  };
+  json_dcnow_t r;
+
+  for (unsigned int i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    CHECK(dcnow_json_parse(cases[i].doc, &r, arena), "%s didn't parse", cases[i].doc);
+    CHECK(r.total_players == cases[i].online, "%s read as %d", cases[i].doc, r.total_players);
+  }
+}
+
+static void test_malformed(dcnow_arena_t *arena) {
+  static const char *const good[] = {
+      "{}",
+      "{\"users\": []}",
+      "{\"a\": true, \"b\": false, \"c\": null, \"d\": [true, false, null, [], {}]}",
+      " {\"a\" : [ 1 , \"x\" ] } trailing bytes are ignored",
+  };
+  static const char *const bad[] = {
+      "",
+      "[]",
+      "\"users\"",
+      "{",
+      "{\"users\": [{\"username\": \"a\"}",
+      "{\"users\": [{\"username\": \"a\"},]}",    /* trailing comma in an array */
+      "{\"username\": \"a\",}",                   /* trailing comma in an object */
+      "{\"users\": [{\"username\": \"a\" \"level\": \"b\"}]}", /* missing comma */
+      "{\"users\": [1 2]}",
+      "{\"users\": [,1]}",
+      "{,\"a\": 1}",
+      "{\"a\": 1,, \"b\": 2}",
+      "{\"a\" 1}",
+      "{\"a\":: 1}",
+      "{\"a\": 1: 2}",
+      "{\"a\":}",
+      "{\"a\"}",
+      "{\"a\": 1 \"b\": 2}",
+      "{1: 2}",
+      "{\"a\": nope}",
+      "{\"a\": tru}",
+      "{\"a\": truex}",
+      "{\"a\": nul}",
+      "{\"a\": falsy}",
+      "{\"a\": True}",
+      "{\"a\": [true false]}",
+      "{\"a\": \"\\u00zz\"}",
+      "{\"a\": [}",
+      "{\"a\": {]}",
+  };
+  json_dcnow_t r;
+
+  for (unsigned int i = 0; i < sizeof(good) / sizeof(good[0]); i++) {
+    CHECK(dcnow_json_parse(good[i], &r, arena), "rejected %s", good[i]);
+  }
+  for (unsigned int i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+    CHECK(!dcnow_json_parse(bad[i], &r, arena), "accepted %s", bad[i]);
+  }
+}
+
+/* Users spread over a few dozen games, about what the server sends on a busy evening */
+static char *make_doc(int users, size_t *size) {
+  char *doc = malloc(users * 200 + 64);
+  int len = sprintf(doc, "{\"users\": [");
+
+  for (int i = 0; i < users; i++) {
+    const int game = i % 37;
+    len += sprintf(doc + len,
+                   "%s{\"username\": \"player%d\", \"level\": \"%s\", \"country\": \"%s\", \"id\": %d, "
+                   "\"current_game\": \"G%02d\", \"current_game_display\": \"Game number %d\"}",
+                   i ? ", " : "", i, i % 3 ? "Occasional Gamer" : "Newbie", i % 2 ? "US" : "JP", 100000 + i, game,
+                   game);
+  }
+  len += sprintf(doc + len, "], \"total_count\": %d, \"online_count\": %d}", users, users);
+  *size = len;
+  return doc;
+}
+
+static void bench(dcnow_arena_t *arena, int iterations) {
+  size_t size;
+  char *doc = make_doc(BENCH_USERS, &size);
+  double whole_best = 1e30, fed_best = 1e30;
+  json_parser_t parser;
+  json_dcnow_t r;
+
+  for (int i = 0; i < iterations; i++) {
+    double start = now_us();
+    CHECK(dcnow_json_parse(doc, &r, arena), "generated list didn't parse");
+    double took = now_us() - start;
+    if (took < whole_best) {
+      whole_best = took;
+    }
+
+    start = now_us();
+    dcnow_json_begin(&parser, &r, arena);
+    for (size_t at = 0; at < size; at += BENCH_MSS) {
+      dcnow_json_feed(&parser, doc + at, size - at < BENCH_MSS ? (int)(size - at) : BENCH_MSS);
+    }
+    CHECK(dcnow_json_end(&parser), "generated list didn't parse in pieces");
+    took = now_us() - start;
+    if (took < fed_best) {
+      fed_best = took;
+    }
+  }
+  CHECK(r.game_count == 37 && r.total_players == BENCH_USERS, "generated list read as %d games, %d players",
+        r.game_count, r.total_players);
+
+  printf("%d users, %zu bytes, %d games\n", BENCH_USERS, size, r.game_count);
+  printf("  whole       %8.1f us best of %d, %.1f MB/s\n", whole_best, iterations, size / whole_best);
+  printf("  %4d B feed %8.1f us best of %d, %.1f MB/s\n", BENCH_MSS, fed_best, iterations, size / fed_best);
+  printf("  arena %u bytes used, %u reserved\n", (unsigned)arena->bytes_used, (unsigned)arena->bytes_reserved);
+  free(doc);
+}
+
+int main(int argc, char **argv) {
+  dcnow_arena_t arena = {0};
+  const int iterations = argc > 1 && atoi(argv[1]) > 0 ? atoi(argv[1]) : 50;
+
+  test_whole(&arena);
+  test_chunk_splits(&arena);
+  test_numbers(&arena);
+  test_malformed(&arena);
+  bench(&arena, iterations);
+
+  dcnow_arena_release(&arena);
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
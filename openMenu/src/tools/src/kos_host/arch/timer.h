@@ -0,0 +1,15 @@
+/*
+ * File: timer.h
+ * Project: tools
+ * File Created: Sunday, 18th October 2026
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+#pragma once
+
+/* KOS <arch/timer.h> on the host, a tool defines the calls it needs */
+
+#include <stdint.h>
+
+uint64_t timer_ms_gettime64(void);
+uint64_t timer_us_gettime64(void);
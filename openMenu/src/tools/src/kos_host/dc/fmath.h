@@ -0,0 +1,16 @@
+/*
+ * File: fmath.h
+ * Project: tools
+ * File Created: Sunday, 18th October 2026
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+#pragma once
+
+/* KOS <dc/fmath.h> on the host, the SH4 approximations become libm */
+
+#include <math.h>
+
+#define fsin  sinf
+#define fcos  cosf
+#define fsqrt sqrtf
@@ -0,0 +1,63 @@
+/*
+ * File: pvr.h
+ * Project: tools
+ * File Created: Sunday, 18th October 2026
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+#pragma once
+
+/* Just enough of KOS <dc/pvr.h> for host builds of the UI code, the types only need the right shape */
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef void *pvr_ptr_t;
+typedef uint32_t pvr_list_t;
+
+typedef struct {
+  uint32_t cmd, mode1, mode2, mode3, d1, d2, d3, d4;
+} pvr_poly_hdr_t;
+
+typedef struct {
+  uint32_t cmd, mode1, mode2, mode3, argb, oargb, d1, d2;
+} pvr_sprite_hdr_t;
+
+/* Only what a tool's pvr_poly_compile needs to fill a header in */
+typedef struct {
+  int list_type;
+  struct {
+    int enable, filter;
+    uint32_t width, height, format;
+    pvr_ptr_t base;
+  } txr;
+} pvr_poly_cxt_t;
+
+typedef struct {
+  uint32_t flags;
+  float x, y, z, u, v;
+  uint32_t argb, oargb;
+} pvr_vertex_t;
+
+typedef struct {
+  uint32_t flags;
+  float ax, ay, az, bx, by, bz, cx, cy, cz, dx, dy;
+  uint32_t dummy, auv, buv, cuv;
+} pvr_sprite_txr_t;
+
+#define PVR_LIST_OP_POLY 0
+#define PVR_LIST_TR_POLY 2
+#define PVR_LIST_PT_POLY 4
+
+#define PVR_FILTER_NONE     0
+#define PVR_FILTER_BILINEAR 2
+
+#define PVR_CMD_VERTEX     0xe0000000
+#define PVR_CMD_VERTEX_EOL 0xf0000000
+
+#define PVR_CMD_POLYHDR 0x80840000
+
+void pvr_poly_cxt_txr(pvr_poly_cxt_t *dst, pvr_list_t list, int textureformat, int tw, int th, pvr_ptr_t textureaddr,
+                      int filtering);
+void pvr_poly_cxt_col(pvr_poly_cxt_t *dst, pvr_list_t list);
+void pvr_poly_compile(pvr_poly_hdr_t *dst, const pvr_poly_cxt_t *src);
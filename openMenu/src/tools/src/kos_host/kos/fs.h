@@ -0,0 +1,27 @@
+/*
+ * File: fs.h
+ * Project: tools
+ * File Created: Sunday, 18th October 2026
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+#pragma once
+
+/* KOS <kos/fs.h> on the host, a tool defines the calls it needs on top of POSIX files */
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+typedef int file_t;
+
+#define FILEHND_INVALID (-1)
+#define STAT_TYPE_NONE  0
+
+file_t fs_open(const char *fn, int mode);
+int fs_close(file_t hnd);
+ssize_t fs_read(file_t hnd, void *buffer, size_t cnt);
+off_t fs_seek(file_t hnd, off_t offset, int whence);
+int fs_stat(const char *path, struct stat *buf, int flag);
@@ -287,7 +287,7 @@ int main(int argc, char **argv) {
 
   open_output(argv[2]);
   iterate_dir(argv[1], add_bin_file, &file_header, &bin_items);
-  write_bin_file(&file_header, bin_items, data_buf);
+  write_bin_file(&file_header, bin_items, data_buf, file_header.num_chunks);
 
   return EXIT_SUCCESS;
 }
\ No newline at end of file
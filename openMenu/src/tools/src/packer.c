@@ -23,27 +23,44 @@
 ./datpack FOLDER output.dat
 
 packs the items in the folder into the output.bin
+If every file is the same size a DAT1 is written with one file per chunk as before, otherwise
+(VQ compressed art) a DAT2 is written where each file takes as many VAR_CHUNK_SIZE chunks as it needs.
 */
 
-#define NUM_ARGS (2)
+#define NUM_ARGS      (2)
+#define VAR_CHUNK_SIZE (512)
 
 /* Locals */
 static bin_header file_header;
 static bin_item_raw *bin_items;
 static unsigned char *data_buf;
+static uint32_t *file_sizes;
+static uint32_t max_file_size;
+static uint32_t files_expected;
 
 int add_pvr_file(const char *path, const char *folder, struct stat *statptr) {
   char temp_id[12];
   char temp_file[FILENAME_MAX];
 
-  if (file_header.chunk_size == 0) {
-    file_header.chunk_size = (uint32_t)statptr->st_size;
-    data_buf = malloc(file_header.chunk_size * file_header.padding0); /* Temporarily use padding0 as num_files */
-  } else {
-    if (statptr->st_size != file_header.chunk_size) {
-      printf("Err: Filesize mismatch for %s, found %lld vs %u!\n", path, statptr->st_size, file_header.chunk_size);
-      return -1;
+  /* Nothing to store, and an item needs at least one chunk */
+  if (statptr->st_size == 0) {
+    printf("Skipping empty file %s\n", path);
+    return 0;
+  }
+
+  /* Files are staged at the largest size seen so far and compacted once we know the layout */
+  if (file_sizes == NULL) {
+    files_expected = file_header.padding0; /* Temporarily use padding0 as num_files */
+    file_sizes = calloc(files_expected, sizeof(uint32_t));
+  }
+  if ((uint32_t)statptr->st_size > max_file_size) {
+    unsigned char *new_buf = malloc((size_t)statptr->st_size * files_expected);
+    for (uint32_t i = 0; i < file_header.num_chunks; i++) {
+      memcpy(new_buf + (i * (size_t)statptr->st_size), data_buf + (i * (size_t)max_file_size), file_sizes[i]);
     }
+    free(data_buf);
+    data_buf = new_buf;
+    max_file_size = (uint32_t)statptr->st_size;
   }
   /* Check if filename too long, dont try to reconcile, just skip */
   char *dot = strrchr(path, '.');
@@ -61,8 +78,9 @@ int add_pvr_file(const char *path, const char *folder, struct stat *statptr) {
     printf("ERR: cant read %s\n", temp_file);
     return -1;
   }
-  fread(data_buf + (file_header.num_chunks * file_header.chunk_size), file_header.chunk_size, 1, temp_fd);
+  fread(data_buf + (file_header.num_chunks * (size_t)max_file_size), statptr->st_size, 1, temp_fd);
   fclose(temp_fd);
+  file_sizes[file_header.num_chunks] = (uint32_t)statptr->st_size;
 
   /* Use filename as ID, remove extension */
   printf("Working on %s\n", path);
@@ -82,7 +100,6 @@ int add_pvr_file(const char *path, const char *folder, struct stat *statptr) {
   temp_id[10] = '\0';
   memcpy(&bin_items[file_header.num_chunks].ID, temp_id, sizeof(bin_items->ID));
 
-  bin_items[file_header.num_chunks].offset = file_header.num_chunks + 1;
   (void)file_header.num_chunks++;
 
   printf("Added[%u] as %s\n", file_header.num_chunks, temp_id);
@@ -105,7 +122,55 @@ int main(int argc, char **argv) {
   open_output(argv[2]);
   iterate_dir(argv[1], add_pvr_file, &file_header, &bin_items);
   file_header.padding0 = 0;
-  write_bin_file(&file_header, bin_items, data_buf);
+  if (!file_header.num_chunks) {
+    printf("Err: nothing to pack!\n");
+    return 1;
+  }
+
+  int fixed_size = 1;
+  for (uint32_t i = 0; i < file_header.num_chunks; i++) {
+    if (file_sizes[i] != max_file_size) {
+      fixed_size = 0;
+      break;
+    }
+  }
+
+  if (fixed_size) {
+    /* DAT1: one file per chunk, padding0 counts the extra chunks the header spills into */
+    const uint32_t header_size = sizeof(bin_header) + (file_header.num_chunks * sizeof(bin_item_raw));
+    file_header.chunk_size = max_file_size;
+    file_header.padding0 = header_size / file_header.chunk_size;
+    for (uint32_t i = 0; i < file_header.num_chunks; i++) {
+      bin_items[i].offset = i + file_header.padding0 + 1;
+    }
+    write_bin_file(&file_header, bin_items, data_buf, file_header.num_chunks);
+    return EXIT_SUCCESS;
+  }
+
+  /* DAT2: variable sized files, each rounded up to whole chunks */
+  const uint32_t header_size = sizeof(bin_header) + (file_header.num_chunks * sizeof(bin_item_raw));
+  uint32_t chunk = (header_size + VAR_CHUNK_SIZE - 1) / VAR_CHUNK_SIZE;
+  uint32_t data_chunks = 0;
+
+  file_header.magic.rich.version = 2;
+  file_header.chunk_size = VAR_CHUNK_SIZE;
+  file_header.padding0 = chunk - 1;
+  for (uint32_t i = 0; i < file_header.num_chunks; i++) {
+    data_chunks += (file_sizes[i] + VAR_CHUNK_SIZE - 1) / VAR_CHUNK_SIZE;
+  }
+
+  unsigned char *packed = calloc(data_chunks, VAR_CHUNK_SIZE);
+  unsigned char *dst = packed;
+  for (uint32_t i = 0; i < file_header.num_chunks; i++) {
+    const uint32_t file_chunks = (file_sizes[i] + VAR_CHUNK_SIZE - 1) / VAR_CHUNK_SIZE;
+    memcpy(dst, data_buf + (i * (size_t)max_file_size), file_sizes[i]);
+    bin_items[i].offset = chunk;
+    chunk += file_chunks;
+    dst += file_chunks * VAR_CHUNK_SIZE;
+  }
+  printf("Variable sized input, packing as DAT2 (%u chunks of %u)\n", data_chunks, VAR_CHUNK_SIZE);
+  write_bin_file(&file_header, bin_items, packed, data_chunks);
+  free(packed);
 
   return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,162 @@
+/*
+ * File: packtest.c
+ * Project: tools
+ * File Created: Sunday, 18th October 2026
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Builds the packer itself, its main is run on folders made here */
+#define main datpack_main
+#include "packer.c"
+#undef main
+
+/* Called:
+./packtest
+
+packs generated folders with datpack, DAT1 when every file has the same size and DAT2
+otherwise, with item tables that fit one chunk and ones that spill into several, then
+reads every item back through the menu's DAT reader and compares it.
+Exits non zero if any check failed.
+*/
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("FAIL %s:%d: ", __FILE__, __LINE__);                                                                      \
+      printf(__VA_ARGS__);                                                                                             \
+      printf("\n");                                                                                                    \
+      failures++;                                                                                                      \
+    }                                                                                                                  \
+  } while (0)
+
+/* Contents of file i, different in every file and at every offset */
+static unsigned char file_byte(int i, uint32_t at) {
+  return (unsigned char)(i * 31 + at * 7 + (at >> 8));
+}
+
+/* Sizes picked for file i, same_size 0 for a mix */
+static uint32_t file_size(int i, uint32_t same_size) {
+  return same_size ? same_size : 100 + (uint32_t)(i * 997) % 9000;
+}
+
+static void make_folder(const char *folder, int files, uint32_t same_size) {
+  char path[FILENAME_MAX];
+
+  mkdir(folder, S_IRWXU);
+  for (int i = 0; i < files; i++) {
+    const uint32_t size = file_size(i, same_size);
+    snprintf(path, sizeof(path), "%s" PATH_SEP "I%04d.PVR", folder, i);
+    FILE *fd = fopen(path, "wb");
+    for (uint32_t at = 0; at < size; at++) {
+      fputc(file_byte(i, at), fd);
+    }
+    fclose(fd);
+  }
+}
+
+static void remove_folder(const char *folder, int files) {
+  char path[FILENAME_MAX];
+
+  for (int i = 0; i < files; i++) {
+    snprintf(path, sizeof(path), "%s" PATH_SEP "I%04d.PVR", folder, i);
+    remove(path);
+  }
+  rmdir(folder);
+}
+
+/* Runs datpack with its chatter sent to /dev/null, and resets its state for the next run */
+static int run_packer(const char *folder, const char *output) {
+  char *argv[] = {"datpack", (char *)folder, (char *)output, NULL};
+  const int saved = dup(STDOUT_FILENO);
+  const int null_fd = open("/dev/null", O_WRONLY);
+
+  fflush(stdout);
+  dup2(null_fd, STDOUT_FILENO);
+  const int ret = datpack_main(3, argv);
+  fflush(stdout);
+  dup2(saved, STDOUT_FILENO);
+  close(null_fd);
+  close(saved);
+
+  free(bin_items);
+  free(data_buf);
+  free(file_sizes);
+  memset(&file_header, 0, sizeof(file_header));
+  bin_items = NULL;
+  data_buf = NULL;
+  file_sizes = NULL;
+  max_file_size = 0;
+  files_expected = 0;
+  return ret;
+}
+
+static void round_trip(const char *name, int files, uint32_t same_size) {
+  static const char folder[] = "packtest_in";
+  static const char output[] = "packtest.dat";
+  unsigned char *buf = malloc(DAT_MAX_ITEM_SIZE);
+  char id[12];
+  dat_file bin;
+
+  make_folder(folder, files, same_size);
+  CHECK(run_packer(folder, output) == EXIT_SUCCESS, "%s: datpack failed", name);
+
+  DAT_init(&bin);
+  if (DAT_load_parse(&bin, output) != 0) {
+    CHECK(0, "%s: packed file didn't load", name);
+    remove_folder(folder, files);
+    free(buf);
+    return;
+  }
+
+  const uint32_t header_size = sizeof(bin_header) + files * sizeof(bin_item_raw);
+  printf("%-28s %4d items, %5u byte chunks, header %u chunks\n", name, files, (unsigned)bin.chunk_size,
+         (unsigned)((header_size + bin.chunk_size - 1) / bin.chunk_size));
+  CHECK((int)bin.num_chunks == files, "%s: %u items read back", name, (unsigned)bin.num_chunks);
+  CHECK(bin.items[0].offset * bin.chunk_size >= header_size, "%s: first item at chunk %u overlaps the header",
+        name, (unsigned)bin.items[0].offset);
+
+  for (int i = 0; i < files; i++) {
+    const uint32_t size = file_size(i, same_size);
+    snprintf(id, sizeof(id), "I%04d", i);
+    memset(buf, 0, DAT_MAX_ITEM_SIZE);
+    if (!DAT_read_file_by_ID(&bin, id, buf)) {
+      CHECK(0, "%s: %s missing", name, id);
+      continue;
+    }
+    CHECK(DAT_get_size_by_ID(&bin, id) >= size, "%s: %s is %u bytes, holds %u", name, id,
+          (unsigned)DAT_get_size_by_ID(&bin, id), (unsigned)size);
+    uint32_t at = 0;
+    while (at < size && buf[at] == file_byte(i, at)) {
+      at++;
+    }
+    CHECK(at == size, "%s: %s differs at byte %u", name, id, (unsigned)at);
+  }
+
+  fclose(bin.handle);
+  HASH_CLEAR(hh, bin.hash);
+  free(bin.items);
+  remove(output);
+  remove_folder(folder, files);
+  free(buf);
+}
+
+int main(void) {
+  /* A folder of uniform 128x128 VQ icons, 6176 bytes each */
+  round_trip("DAT1, header in one chunk", 300, 6176);
+  round_trip("DAT1, header over 2 chunks", 500, 6176);
+  round_trip("DAT1, tiny items", 64, 32);
+  round_trip("DAT2, mixed sizes", 40, 0);
+  round_trip("DAT2, header over 19 chunks", 600, 0);
+
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
@@ -38,7 +38,13 @@ Dumps all info about the container, optionally dump to files in input/
 void DAT_dump(const dat_file *bin, const char *output) {
   char out_filename[FILENAME_MAX] = {0};
   mkdir(output, S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH);
-  uint8_t *file_buffer = malloc(bin->chunk_size);
+  uint32_t max_length = 1;
+  for (int i = 0; i < bin->num_chunks; i++) {
+    if (bin->items[i].length > max_length) {
+      max_length = bin->items[i].length;
+    }
+  }
+  uint8_t *file_buffer = malloc(max_length * bin->chunk_size);
 
   DBG_PRINT("BIN Stats:\nChunk Size: %u\nNum Chunks: %u\n\n", bin->chunk_size, bin->num_chunks);
   for (int i = 0; i < bin->num_chunks; i++) {
@@ -50,7 +56,7 @@ void DAT_dump(const dat_file *bin, const char *output) {
 
     /* Read chunk to buffer */
     int ret_f = fseek((FILE *)bin->handle, bin->items[i].offset * bin->chunk_size, SEEK_SET);
-    int ret_r = fread(file_buffer, bin->chunk_size, 1, (FILE *)bin->handle);
+    int ret_r = fread(file_buffer, bin->items[i].length * bin->chunk_size, 1, (FILE *)bin->handle);
 
     /* Write out */
     FILE *fd = fopen(out_filename, "wb");
@@ -58,7 +64,7 @@ void DAT_dump(const dat_file *bin, const char *output) {
       perror("Could not open output file for writing");
       exit(2);
     }
-    int ret_w = fwrite(file_buffer, bin->chunk_size, 1, fd);
+    int ret_w = fwrite(file_buffer, bin->items[i].length * bin->chunk_size, 1, fd);
     fclose(fd);
   }
 }
@@ -0,0 +1,229 @@
+/*
+ * File: schedtest.c
+ * Project: tools
+ * File Created: Sunday, 18th October 2026
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "dcnow_sched.h"
+
+/* Called:
+./schedtest
+
+drives the DC Now refresh scheduler with a simulated clock, checks the
+intervals it picks after changes, quiet spells, errors and the PPP cooldown,
+then counts the refreshes of an hour in a few usage patterns.
+Exits non zero if any check failed.
+*/
+
+#define FRAME_MS 16
+#define HOUR_MS  (60 * 60 * 1000)
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("FAIL %s:%d: ", __FILE__, __LINE__);                                                                      \
+      printf(__VA_ARGS__);                                                                                             \
+      printf("\n");                                                                                                    \
+      failures++;                                                                                                      \
+    }                                                                                                                  \
+  } while (0)
+
+/* DC Now only prints its debug output while this says the serial port is free */
+int dcnow_is_serial_scif_active(void) {
+  return 1;
+}
+
+/* Time from the last fetch to the next refresh */
+static uint64_t wait_ms(const dcnow_sched_t *s) {
+  return dcnow_sched_next_ms(s) - s->last_ms;
+}
+
+static void test_first_fetch(void) {
+  dcnow_sched_t s;
+
+  dcnow_sched_init(&s);
+  CHECK(dcnow_sched_next_ms(&s) == 0, "refresh planned before the first fetch");
+  CHECK(!dcnow_sched_due(&s, 1000), "refresh due before the first fetch");
+
+  dcnow_sched_on_success(&s, 1000, true, false);
+  CHECK(wait_ms(&s) == DCNOW_SCHED_BASE_MS, "first interval %llu", (unsigned long long)wait_ms(&s));
+  CHECK(!dcnow_sched_due(&s, 1000 + DCNOW_SCHED_BASE_MS - 1), "due a millisecond early");
+  CHECK(dcnow_sched_due(&s, 1000 + DCNOW_SCHED_BASE_MS), "not due on time");
+}
+
+static void test_success_intervals(void) {
+  dcnow_sched_t s;
+  uint64_t now = 1000;
+
+  dcnow_sched_init(&s);
+
+  /* Counts changing halve the interval down to the minimum */
+  dcnow_sched_on_success(&s, now, true, true);
+  CHECK(wait_ms(&s) == DCNOW_SCHED_MIN_MS, "after a count change %llu", (unsigned long long)wait_ms(&s));
+  now += wait_ms(&s);
+  dcnow_sched_on_success(&s, now, true, true);
+  CHECK(wait_ms(&s) == DCNOW_SCHED_MIN_MS, "went below the minimum, %llu", (unsigned long long)wait_ms(&s));
+
+  /* Nothing changing grows it by half each time, up to the maximum */
+  uint64_t last = wait_ms(&s);
+  for (int i = 0; i < 10; i++) {
+    now += wait_ms(&s);
+    dcnow_sched_on_success(&s, now, false, false);
+    CHECK(wait_ms(&s) >= last && wait_ms(&s) <= DCNOW_SCHED_MAX_MS, "unchanged %d: %llu after %llu", i,
+          (unsigned long long)wait_ms(&s), (unsigned long long)last);
+    last = wait_ms(&s);
+  }
+  CHECK(last == DCNOW_SCHED_MAX_MS, "quiet list settled at %llu", (unsigned long long)last);
+  CHECK(s.unchanged_streak == 10, "unchanged streak %d", s.unchanged_streak);
+
+  /* A change in names only goes back to the base interval */
+  now += wait_ms(&s);
+  dcnow_sched_on_success(&s, now, true, false);
+  CHECK(wait_ms(&s) == DCNOW_SCHED_BASE_MS && s.unchanged_streak == 0, "after a name change %llu",
+        (unsigned long long)wait_ms(&s));
+}
+
+static void test_hidden(void) {
+  dcnow_sched_t s;
+
+  dcnow_sched_init(&s);
+  dcnow_sched_on_success(&s, 1000, true, false);
+
+  dcnow_sched_set_visible(&s, false);
+  CHECK(wait_ms(&s) == DCNOW_SCHED_BASE_MS * DCNOW_SCHED_HIDDEN_FACTOR, "hidden interval %llu",
+        (unsigned long long)wait_ms(&s));
+  for (int i = 0; i < 10; i++) {
+    dcnow_sched_on_success(&s, s.last_ms + wait_ms(&s), false, false);
+  }
+  CHECK(wait_ms(&s) == DCNOW_SCHED_HIDDEN_MAX_MS, "hidden interval capped at %llu", (unsigned long long)wait_ms(&s));
+
+  /* Showing the list again goes straight back to the visible interval, from the same last fetch */
+  dcnow_sched_set_visible(&s, true);
+  CHECK(wait_ms(&s) == DCNOW_SCHED_MAX_MS, "shown again, interval %llu", (unsigned long long)wait_ms(&s));
+}
+
+static void test_errors(void) {
+  dcnow_sched_t s;
+  uint64_t now = 1000;
+  uint64_t expected = DCNOW_SCHED_RETRY_MS;
+
+  dcnow_sched_init(&s);
+  dcnow_sched_on_success(&s, now, false, false);
+
+  /* Retries double from the first retry up to the cap, and stay there */
+  for (int i = 0; i < 40; i++) {
+    dcnow_sched_on_error(&s, now, 0);
+    CHECK(wait_ms(&s) == expected, "error %d retries after %llu, expected %llu", i + 1,
+          (unsigned long long)wait_ms(&s), (unsigned long long)expected);
+    expected = expected * 2 > DCNOW_SCHED_RETRY_MAX_MS ? DCNOW_SCHED_RETRY_MAX_MS : expected * 2;
+    now += wait_ms(&s);
+  }
+
+  /* Hiding the list doesn't stretch a retry */
+  dcnow_sched_set_visible(&s, false);
+  CHECK(wait_ms(&s) == DCNOW_SCHED_RETRY_MAX_MS, "hidden retry %llu", (unsigned long long)wait_ms(&s));
+  dcnow_sched_set_visible(&s, true);
+
+  /* One success clears the streak */
+  dcnow_sched_on_success(&s, now, false, false);
+  CHECK(s.error_streak == 0 && dcnow_sched_next_ms(&s) == now + s.interval_ms, "success after errors");
+  dcnow_sched_on_error(&s, now, 0);
+  CHECK(wait_ms(&s) == DCNOW_SCHED_RETRY_MS, "backoff not reset, %llu", (unsigned long long)wait_ms(&s));
+}
+
+static void test_cooldown(void) {
+  dcnow_sched_t s;
+
+  dcnow_sched_init(&s);
+  dcnow_sched_on_success(&s, 1000, true, false);
+
+  /* Never retried inside the PPP cooldown */
+  dcnow_sched_on_error(&s, 1000, 45000);
+  CHECK(wait_ms(&s) == 45000, "retry inside the cooldown, after %llu", (unsigned long long)wait_ms(&s));
+
+  /* A cooldown shorter than the backoff doesn't shorten it */
+  dcnow_sched_on_error(&s, 1000, 5000);
+  CHECK(wait_ms(&s) == DCNOW_SCHED_RETRY_MS * 2, "cooldown shortened the backoff to %llu",
+        (unsigned long long)wait_ms(&s));
+}
+
+typedef struct {
+  const char *name;
+  int change_every;  /* the server's counts change every Nth fetch, 0 never */
+  int fail_every;    /* every Nth fetch fails, 0 never */
+  int hidden_from;   /* minute the list is hidden, -1 never */
+} scenario_t;
+
+/* One hour of frames, fetching whenever the scheduler says so */
+static int run_hour(const scenario_t *sc) {
+  dcnow_sched_t s;
+  uint64_t shortest = UINT64_MAX;
+  uint64_t previous = 0;
+  int fetches = 0;
+
+  dcnow_sched_init(&s);
+  for (uint64_t now = FRAME_MS; now < HOUR_MS; now += FRAME_MS) {
+    dcnow_sched_set_visible(&s, sc->hidden_from < 0 || now < (uint64_t)sc->hidden_from * 60000);
+    if (s.last_ms != 0 && !dcnow_sched_due(&s, now)) {
+      continue;
+    }
+
+    fetches++;
+    if (previous && now - previous < shortest) {
+      shortest = now - previous;
+    }
+    previous = now;
+    if (sc->fail_every && fetches % sc->fail_every == 0) {
+      dcnow_sched_on_error(&s, now, 0);
+    } else {
+      const bool counts = sc->change_every && fetches % sc->change_every == 0;
+      dcnow_sched_on_success(&s, now, counts, counts);
+    }
+  }
+
+  printf("  %-28s %3d refreshes, shortest gap %llu s\n", sc->name, fetches,
+         (unsigned long long)(shortest == UINT64_MAX ? 0 : shortest / 1000));
+  CHECK(shortest >= DCNOW_SCHED_MIN_MS || shortest == UINT64_MAX || sc->fail_every,
+        "%s: refreshed after only %llu ms", sc->name, (unsigned long long)shortest);
+  return fetches;
+}
+
+static void test_hour(void) {
+  static const scenario_t busy = {"counts change every fetch", 1, 0, -1};
+  static const scenario_t quiet = {"nothing changes", 0, 0, -1};
+  static const scenario_t hidden = {"nothing changes, hidden", 0, 0, 0};
+  static const scenario_t mixed = {"changes, hidden after 20 min", 3, 0, 20};
+  static const scenario_t flaky = {"every 4th fetch fails", 2, 4, -1};
+  static const scenario_t down = {"server down", 0, 1, -1};
+
+  printf("One hour at %d ms a frame:\n", FRAME_MS);
+  const int busy_fetches = run_hour(&busy);
+  const int quiet_fetches = run_hour(&quiet);
+  const int hidden_fetches = run_hour(&hidden);
+  run_hour(&mixed);
+  run_hour(&flaky);
+  const int down_fetches = run_hour(&down);
+
+  CHECK(busy_fetches == HOUR_MS / DCNOW_SCHED_MIN_MS, "busy list refreshed %d times", busy_fetches);
+  CHECK(quiet_fetches < HOUR_MS / DCNOW_SCHED_BASE_MS, "quiet list refreshed %d times", quiet_fetches);
+  CHECK(hidden_fetches < quiet_fetches, "hidden list refreshed %d times, %d shown", hidden_fetches, quiet_fetches);
+  CHECK(down_fetches < 12, "dead server tried %d times", down_fetches);
+}
+
+int main(void) {
+  test_first_fetch();
+  test_success_intervals();
+  test_hidden();
+  test_errors();
+  test_cooldown();
+  test_hour();
+
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,400 @@
+/*
+ * File: tracetest.c
+ * Project: tools
+ * File Created: Sunday, 18th October 2026
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <arch/timer.h>
+#include <dc/pvr.h>
+#include <openmenu_settings.h>
+
+#include "ui/draw_batch.h"
+#include "ui/draw_prototypes.h"
+#include "ui/draw_trace.h"
+#include "ui/text_cache.h"
+#include "ui/ui_script.h"
+
+/* Called:
+./tracetest
+
+runs the UI script over a stand in UI drawn through the batch layer built with the
+recording backend, a retained background layer, a grid of icons that follows the
+input and a line of text, then reads back the trace it wrote. Checks every frame's
+headers and vertices add up to its totals and to what was drawn, that a replayed
+layer traces the same as its recording, that evicting a texture only rebuilds the
+layer when it uses it, that a marquee line replays only what its window shows, and
+that the script visits every UI and hands the pad back afterwards.
+Exits non zero if any check failed.
+*/
+
+#define ICON_COUNT   (12)
+#define ICON_TEXTURES (16)
+#define MAX_FRAMES   (20000)
+#define LINE_MAX     (64)
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("FAIL %s:%d: ", __FILE__, __LINE__);                                                                      \
+      printf(__VA_ARGS__);                                                                                             \
+      printf("\n");                                                                                                    \
+      failures++;                                                                                                      \
+    }                                                                                                                  \
+  } while (0)
+
+/* KOS and the rest of the menu, as far as the batch layer and the script reach */
+uint64_t timer_ms_gettime64(void) {
+  return timer_us_gettime64() / 1000;
+}
+
+uint64_t timer_us_gettime64(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void pvr_poly_cxt_txr(pvr_poly_cxt_t *dst, pvr_list_t list, int textureformat, int tw, int th, pvr_ptr_t textureaddr,
+                      int filtering) {
+  memset(dst, 0, sizeof(*dst));
+  dst->list_type = list;
+  dst->txr.enable = 1;
+  dst->txr.filter = filtering;
+  dst->txr.width = tw;
+  dst->txr.height = th;
+  dst->txr.format = textureformat;
+  dst->txr.base = textureaddr;
+}
+
+void pvr_poly_cxt_col(pvr_poly_cxt_t *dst, pvr_list_t list) {
+  memset(dst, 0, sizeof(*dst));
+  dst->list_type = list;
+}
+
+/* Texture word as the PVR has it, format in the top bits and the address in 8 byte units */
+void pvr_poly_compile(pvr_poly_hdr_t *dst, const pvr_poly_cxt_t *src) {
+  memset(dst, 0, sizeof(*dst));
+  dst->cmd = PVR_CMD_POLYHDR | (src->list_type << 24);
+  if (src->txr.enable) {
+    dst->mode3 = src->txr.format | (((uint32_t)(uintptr_t)src->txr.base >> 3) & 0x1fffff);
+  }
+}
+
+static int list = PVR_LIST_OP_POLY;
+static float z = 1.0f;
+
+void draw_set_list(int new_list) {
+  list = new_list;
+}
+int draw_get_list(void) {
+  return list;
+}
+float z_get(void) {
+  return z;
+}
+float z_set(float new_z) {
+  z = new_z;
+  return z;
+}
+float z_inc(void) {
+  z += 0.01f;
+  return z;
+}
+
+/* Text is laid out directly, nothing goes through the layout cache */
+/* Layouts only the marquee check asks for, kept here in place of the cache */
+#define RECORD_MAX_VERTS (64 * DRAW_TEXT_VERT_PER_CHAR)
+static text_vert_t recorded[RECORD_MAX_VERTS];
+static unsigned int recorded_count;
+
+void text_layout_record(text_layout *layout, const text_vert_t *verts, unsigned int count) {
+  if (layout && recorded_count + count <= RECORD_MAX_VERTS) {
+    memcpy(recorded + recorded_count, verts, count * sizeof(*verts));
+    recorded_count += count;
+  }
+}
+
+static uint8_t ui_setting = UI_GRID3;
+uint8_t *sf_ui = &ui_setting;
+
+/* The stand in UI: a background, a grid of icons scrolled by the pad and a line of text */
+static int ui_loaded = -1;
+static int ui_reloads;
+static int selected;
+static draw_layer background;
+static image backdrop = {"BG", 512, 512, 1 << 27, (pvr_ptr_t)0x100000};
+static image font = {"FONT", 256, 256, 5 << 27, (pvr_ptr_t)0x180000};
+static image icons[ICON_TEXTURES];
+
+void reload_ui(void) {
+  ui_loaded = sf_ui[0];
+  ui_reloads++;
+  selected = 0;
+  draw_layer_invalidate(&background);
+}
+
+static void handle_input(unsigned int input) {
+  switch (input) {
+    case LEFT: selected--; break;
+    case RIGHT: selected++; break;
+    case UP: selected -= 4; break;
+    case DOWN: selected += 4; break;
+    case TRIG_L: selected -= ICON_COUNT; break;
+    case TRIG_R: selected += ICON_COUNT; break;
+    default: break;
+  }
+  selected = (selected % ICON_TEXTURES + ICON_TEXTURES) % ICON_TEXTURES;
+}
+
+/* Draws one frame, returns the vertices it should reach the trace with */
+static unsigned int draw_frame(void) {
+  static const char title[] = "Phantasy Star Online";
+  unsigned int quads = 0;
+  draw_glyph_uv uv;
+
+  z = 1.0f;
+  draw_set_list(PVR_LIST_OP_POLY);
+  const uint32_t key = draw_layer_hash(DRAW_LAYER_HASH_INIT, &ui_loaded, sizeof(ui_loaded));
+  if (draw_layer_begin(&background, key)) {
+    for (int i = 0; i < 4; i++) {
+      draw_batch_quad(&backdrop, i * 160, 0, i * 160 + 160, 480, z_inc(), 0, 0, 1, 1, 0xFFFFFFFF);
+    }
+    draw_batch_quad(NULL, 0, 400, 640, 480, z_inc(), 0, 0, 0, 0, 0xFF202020);
+    draw_layer_end(&background);
+  }
+  quads += 5;
+
+  for (int i = 0; i < ICON_COUNT; i++) {
+    const image *icon = &icons[(selected + i) % ICON_TEXTURES];
+    const float x = 40 + (i % 4) * 140, y = 40 + (i / 4) * 120;
+    draw_batch_quad(icon, x, y, x + 128, y + 96, z_inc(), 0, 0, 1, 1, 0xFFFFFFFF);
+  }
+  quads += ICON_COUNT;
+  draw_batch_flush();
+
+  draw_set_list(PVR_LIST_TR_POLY);
+  draw_batch_quad(NULL, 40 + (selected % 4) * 140, 40, 168 + (selected % 4) * 140, 136, z_inc(), 0, 0, 0, 0,
+                  0x80FFFFFF);
+  quads++;
+  draw_text_begin(&font, PVR_FILTER_BILINEAR, 0xFFFFFFFF, z_inc(), NULL);
+  for (unsigned int i = 0; i < sizeof(title) - 1; i++) {
+    draw_glyph_uv_set(&uv, (title[i] % 16) / 16.0f, (title[i] / 16) / 16.0f, (title[i] % 16 + 1) / 16.0f,
+                      (title[i] / 16 + 1) / 16.0f);
+    draw_text_glyph(40 + i * 12.0f, 420, 52 + i * 12.0f, 440, &uv);
+  }
+  draw_text_end();
+  draw_batch_flush();
+
+  draw_batch_frame_end();
+  return (quads + sizeof(title) - 1) * 4;
+}
+
+typedef struct frame_info {
+  int ui, selected;
+  unsigned int expected_vertices;
+  unsigned int headers, vertices; /* read back from the trace */
+  char *stream;                   /* the frame's H lines */
+} frame_info;
+
+static frame_info frames[MAX_FRAMES];
+
+/* Reads the trace back into frames, returns how many were complete */
+static int read_trace(int frame_count) {
+  FILE *fd = fopen(DRAW_TRACE_PATH, "r");
+  char line[LINE_MAX];
+  unsigned int frame = 0, headers, binds, vertices, bytes;
+  unsigned int h_count = 0, h_vertices = 0;
+  size_t stream_len = 0, stream_cap = 0;
+  char *stream = NULL;
+  int complete = 0;
+
+  if (!fd) {
+    CHECK(0, "no trace at %s", DRAW_TRACE_PATH);
+    return 0;
+  }
+  while (fgets(line, sizeof(line), fd)) {
+    char list[3];
+    unsigned int texture, count;
+
+    if (sscanf(line, "F %u", &frame) == 1) {
+      h_count = h_vertices = 0;
+      stream_len = 0;
+    } else if (sscanf(line, "H %2s %x %u", list, &texture, &count) == 3) {
+      h_count++;
+      h_vertices += count;
+      const size_t len = strlen(line);
+      if (stream_len + len + 1 > stream_cap) {
+        stream_cap = (stream_len + len + 1) * 2;
+        stream = realloc(stream, stream_cap);
+      }
+      memcpy(stream + stream_len, line, len + 1);
+      stream_len += len;
+    } else if (sscanf(line, "E %u %u %u %u", &headers, &binds, &vertices, &bytes) == 4) {
+      CHECK(h_count == headers, "frame %u lists %u headers, totals say %u", frame, h_count, headers);
+      CHECK(h_vertices == vertices, "frame %u lists %u vertices, totals say %u", frame, h_vertices, vertices);
+      CHECK(bytes == headers * sizeof(pvr_poly_hdr_t) + vertices * sizeof(pvr_vertex_t),
+            "frame %u: %u bytes for %u headers and %u vertices", frame, bytes, headers, vertices);
+      CHECK(binds && binds <= headers, "frame %u: %u binds for %u headers", frame, binds, headers);
+      if ((int)frame < frame_count && (int)frame == complete) {
+        frames[frame].headers = headers;
+        frames[frame].vertices = vertices;
+        frames[frame].stream = stream ? strdup(stream) : strdup("");
+        complete++;
+      }
+    } else {
+      CHECK(0, "unexpected trace line %s", line);
+    }
+  }
+  fclose(fd);
+  free(stream);
+  return complete;
+}
+
+/* Background layer builds in a frame drawn after evict ran */
+static unsigned int builds_after(void (*evict)(void)) {
+  draw_batch_stats stats;
+
+  draw_frame();
+  if (evict) {
+    evict();
+  }
+  draw_frame();
+  draw_batch_get_stats(&stats);
+  return stats.layer_builds;
+}
+
+static void evict_icon(void) {
+  draw_header_invalidate(icons[0].texture);
+}
+
+static void evict_backdrop(void) {
+  draw_header_invalidate(backdrop.texture);
+}
+
+static void evict_many_icons(void) {
+  for (int i = 0; i < 100; i++) {
+    draw_header_invalidate(icons[i % ICON_TEXTURES].texture);
+  }
+}
+
+static void evict_all(void) {
+  draw_header_invalidate_all();
+}
+
+/* A line laid out without drawing, then replayed scrolled into a window like the marquee does */
+static void check_marquee(void) {
+  static text_layout layout;
+  draw_batch_stats stats;
+  draw_glyph_uv uv;
+
+  draw_glyph_uv_set(&uv, 0, 0, 1.0f / 16, 1.0f / 16);
+  draw_set_list(PVR_LIST_TR_POLY);
+  recorded_count = 0;
+  draw_text_layout_begin(&font, PVR_FILTER_BILINEAR, 0xFFFFFFFF, z_inc(), &layout);
+  for (int i = 0; i < 40; i++) {
+    draw_text_glyph(100 + i * 12.0f, 200, 112 + i * 12.0f, 220, &uv);
+  }
+  draw_text_end();
+  draw_batch_flush();
+  draw_batch_frame_end();
+  draw_batch_get_stats(&stats);
+  CHECK(recorded_count == 40 * DRAW_TEXT_VERT_PER_CHAR, "marquee: %u vertices recorded", recorded_count);
+  CHECK(stats.glyphs == 0, "marquee: laying out drew %u glyphs", stats.glyphs);
+
+  /* 30 pixels in, glyphs 2 and 22 are cut by the 100..340 window and 21 show */
+  draw_glyphs_clipped(&font, PVR_FILTER_BILINEAR, 0xFFFFFFFF, z_inc(), recorded, recorded_count, -30, 40, 100, 340);
+  draw_batch_flush();
+  draw_batch_frame_end();
+  draw_batch_get_stats(&stats);
+  CHECK(stats.glyphs == 21 && stats.glyph_runs == 1, "marquee: %u glyphs in %u runs replayed", stats.glyphs,
+        stats.glyph_runs);
+}
+
+/* Only an eviction of a texture the background uses, or more than can be told apart, rebuilds it */
+static void check_evictions(void) {
+  CHECK(builds_after(NULL) == 0, "background rebuilt with nothing evicted");
+  CHECK(builds_after(evict_icon) == 0, "background rebuilt for an icon it doesn't use");
+  CHECK(builds_after(evict_backdrop) == 1, "background replayed after its texture was evicted");
+  CHECK(builds_after(evict_many_icons) == 1, "background replayed after more evictions than are logged");
+  CHECK(builds_after(evict_all) == 1, "background replayed after every texture was invalidated");
+}
+
+int main(void) {
+  const uint8_t picked_ui = ui_setting;
+  int frame_count = 0;
+  unsigned int input = NONE;
+
+  remove(DRAW_TRACE_PATH);
+  for (int i = 0; i < ICON_TEXTURES; i++) {
+    snprintf(icons[i].name, sizeof(icons[i].name), "ICON%02d", i);
+    icons[i].width = icons[i].height = 128;
+    icons[i].format = 1 << 27;
+    icons[i].texture = (pvr_ptr_t)(uintptr_t)(0x200000 + i * 0x8000);
+  }
+
+  /* Y never comes from the script, once it passes through the pad is back */
+  for (; frame_count < MAX_FRAMES; frame_count++) {
+    input = ui_script_input(Y);
+    if (input == Y) {
+      break;
+    }
+    handle_input(input);
+    frames[frame_count].ui = ui_loaded;
+    frames[frame_count].selected = selected;
+    frames[frame_count].expected_vertices = draw_frame();
+  }
+  fflush(NULL); /* draw_trace keeps its file open */
+
+  CHECK(frame_count < MAX_FRAMES, "script still running after %d frames", frame_count);
+  CHECK(ui_reloads == UI_END - UI_START + 2, "%d UI loads for %d UIs", ui_reloads, UI_END - UI_START + 1);
+  CHECK(sf_ui[0] == picked_ui && ui_loaded == picked_ui, "UI %d picked, %d left after the script", picked_ui,
+        ui_loaded);
+  CHECK(ui_script_input(B) == B, "pad input doesn't pass through after the script");
+
+  const int traced = read_trace(frame_count);
+  CHECK(traced == frame_count, "%d frames drawn, %d traced", frame_count, traced);
+
+  int replays = 0, moves = 0;
+  unsigned int most_headers = 0;
+  for (int i = 0; i < traced; i++) {
+    CHECK(frames[i].vertices == frames[i].expected_vertices, "frame %d traced %u vertices, drew %u", i,
+          frames[i].vertices, frames[i].expected_vertices);
+    if (frames[i].headers > most_headers) {
+      most_headers = frames[i].headers;
+    }
+    if (i == 0 || frames[i].ui != frames[i - 1].ui) {
+      continue;
+    }
+    /* Same screen as the frame before, whether its background was recorded or replayed */
+    if (frames[i].selected == frames[i - 1].selected) {
+      CHECK(!strcmp(frames[i].stream, frames[i - 1].stream), "frame %d traced differently from the one before", i);
+      replays++;
+    } else {
+      moves++;
+    }
+  }
+  for (int i = 0; i < traced; i++) {
+    free(frames[i].stream);
+  }
+
+  draw_trace_stats last;
+  draw_trace_get_stats(&last);
+  CHECK(traced && last.vertices == frames[traced - 1].vertices, "last frame stats %u vertices, trace %u",
+        last.vertices, traced ? frames[traced - 1].vertices : 0);
+
+  printf("%d frames traced, %d of an unchanged screen, %d after a move, at most %u headers a frame\n", traced,
+         replays, moves, most_headers);
+  CHECK(replays && moves, "script didn't both hold still and move");
+
+  check_evictions();
+  check_marquee();
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
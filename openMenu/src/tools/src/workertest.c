@@ -0,0 +1,330 @@
+/*
+ * File: workertest.c
+ * Project: tools
+ * File Created: Sunday, 18th October 2026
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "dcnow_worker.h"
+
+/* Called:
+./workertest
+
+runs the DC Now job queue on a pthread worker against stand-ins for the
+network calls. Each stand-in logs its job and blocks until the test lets it
+finish, so the order jobs run in is known exactly. Checks priority order,
+merging of queued fetches, cancelling, a disconnect dropping fetches and a
+full queue. Exits non zero if any check failed.
+*/
+
+#define WAIT_LIMIT_MS 2000
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("FAIL %s:%d: ", __FILE__, __LINE__);                                                                      \
+      printf(__VA_ARGS__);                                                                                             \
+      printf("\n");                                                                                                    \
+      failures++;                                                                                                      \
+    }                                                                                                                  \
+  } while (0)
+
+/* Jobs the worker ran, one letter each, and the parameter each was given */
+static pthread_mutex_t stub_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t stub_cond = PTHREAD_COND_INITIALIZER;
+static char ran[64];
+static uint32_t ran_param[64];
+static int ran_count = 0;
+static int released = 0;
+
+/* Log a job, then block the worker until the test releases it */
+static int stub_run(char job, uint32_t param) {
+  pthread_mutex_lock(&stub_mutex);
+  ran_param[ran_count] = param;
+  ran[ran_count++] = job;
+  pthread_cond_broadcast(&stub_cond);
+  while (released < ran_count) {
+    pthread_cond_wait(&stub_cond, &stub_mutex);
+  }
+  pthread_mutex_unlock(&stub_mutex);
+  return job == 'C' && param == DCNOW_CONN_MODEM ? -5 : 0;
+}
+
+int dcnow_is_serial_scif_active(void) {
+  return 1;
+}
+void dcnow_set_status_callback(dcnow_status_callback_t callback) {
+  (void)callback;
+}
+void dcnow_set_status_sleep_enabled(bool enabled) {
+  (void)enabled;
+}
+int dcnow_net_init_with_method(dcnow_connection_method_t method) {
+  return stub_run('C', method);
+}
+void dcnow_net_disconnect(void) {
+  stub_run('D', 0);
+}
+void dcnow_clear_cache(void) {
+}
+int dcnow_prefetch_dns(void) {
+  return stub_run('N', 0);
+}
+/* What the running fetch would stop on */
+static const volatile bool *cancel_flag;
+void dcnow_set_cancel_flag(const volatile bool *flag) {
+  cancel_flag = flag;
+}
+int dcnow_fetch_data(uint32_t timeout_ms) {
+  return stub_run('F', timeout_ms);
+}
+const char *dcnow_get_last_error(void) {
+  return "";
+}
+
+/* Whether the worker has started its nth job since the log was cleared */
+static bool has_started(int count) {
+  bool started;
+  pthread_mutex_lock(&stub_mutex);
+  started = ran_count >= count;
+  pthread_mutex_unlock(&stub_mutex);
+  return started;
+}
+
+static bool wait_started(int count) {
+  for (int ms = 0; ms < WAIT_LIMIT_MS; ms++) {
+    if (has_started(count)) {
+      return true;
+    }
+    usleep(1000);
+  }
+  return false;
+}
+
+static void release(int count) {
+  pthread_mutex_lock(&stub_mutex);
+  released += count;
+  pthread_cond_broadcast(&stub_cond);
+  pthread_mutex_unlock(&stub_mutex);
+}
+
+static void clear_log(void) {
+  pthread_mutex_lock(&stub_mutex);
+  ran_count = released = 0;
+  pthread_mutex_unlock(&stub_mutex);
+}
+
+/* Until a context's state is one of two, without taking its result */
+static bool wait_state(dcnow_worker_context_t *ctx, dcnow_worker_state_t a, dcnow_worker_state_t b) {
+  for (int ms = 0; ms < WAIT_LIMIT_MS; ms++) {
+    if (ctx->state == a || ctx->state == b) {
+      return true;
+    }
+    usleep(1000);
+  }
+  return false;
+}
+
+/* Until nothing is queued, running or waiting to be polled */
+static bool wait_idle(void) {
+  for (int ms = 0; ms < WAIT_LIMIT_MS; ms++) {
+    if (!dcnow_worker_is_busy()) {
+      return true;
+    }
+    usleep(1000);
+  }
+  return false;
+}
+
+/* Let every job run and check the order they ran in */
+static void drain(const char *expected, dcnow_worker_context_t *const *ctxs, int ctx_count, const char *what) {
+  const int count = (int)strlen(expected);
+
+  for (int i = 1; i < count; i++) {
+    release(1);
+    /* A context's next job waits until its result is polled, so keep polling while waiting */
+    int ms = 0;
+    for (; ms < WAIT_LIMIT_MS && !has_started(i + 1); ms++) {
+      for (int c = 0; c < ctx_count; c++) {
+        if (ctxs[c]->result_pending) {
+          dcnow_worker_poll(ctxs[c]);
+        }
+      }
+      usleep(1000);
+    }
+    if (ms == WAIT_LIMIT_MS) {
+      break;
+    }
+  }
+  release(1);
+  for (int c = 0; c < ctx_count; c++) {
+    /* Contexts whose jobs were dropped have no result to take */
+    if (ctxs[c]->state != DCNOW_WORKER_IDLE && wait_state(ctxs[c], DCNOW_WORKER_DONE, DCNOW_WORKER_ERROR)) {
+      dcnow_worker_poll(ctxs[c]);
+    }
+  }
+  CHECK(wait_idle(), "%s: worker still busy", what);
+  CHECK(ran_count == count && memcmp(ran, expected, count) == 0, "%s: ran %.*s, expected %s", what, ran_count, ran,
+        expected);
+}
+
+static void test_priority(void) {
+  dcnow_worker_context_t connect = {0}, user = {0}, background = {0};
+  dcnow_worker_context_t *const ctxs[] = {&connect, &user, &background};
+
+  clear_log();
+  /* Keep the worker busy while the rest is queued */
+  dcnow_worker_start_connect(&connect, DCNOW_CONN_SERIAL);
+  CHECK(wait_started(1), "connect never started");
+
+  CHECK(dcnow_worker_submit(NULL, DCNOW_JOB_DNS_PREFETCH, DCNOW_JOB_PRIO_BACKGROUND, 0) == 0, "prefetch refused");
+  CHECK(dcnow_worker_start_fetch(&background, 1000, DCNOW_JOB_PRIO_BACKGROUND) == 0, "background fetch refused");
+  CHECK(dcnow_worker_start_fetch(&user, 2000, DCNOW_JOB_PRIO_USER) == 0, "user fetch refused");
+  CHECK(user.state == DCNOW_WORKER_QUEUED && background.state == DCNOW_WORKER_QUEUED, "fetches not queued");
+
+  /* User work first, background work in the order it was queued */
+  drain("CFNF", ctxs, 3, "priority");
+  CHECK(ran_param[1] == 2000 && ran_param[3] == 1000, "fetches ran as %u then %u", ran_param[1], ran_param[3]);
+  CHECK(connect.state == DCNOW_WORKER_DONE && user.state == DCNOW_WORKER_DONE, "results not handed over");
+}
+
+static void test_merge(void) {
+  dcnow_worker_context_t blocker = {0}, a = {0}, b = {0};
+  dcnow_worker_context_t *const ctxs[] = {&blocker, &a, &b};
+
+  clear_log();
+  dcnow_worker_start_connect(&blocker, DCNOW_CONN_SERIAL);
+  CHECK(wait_started(1), "connect never started");
+
+  /* a's background refresh becomes the user's when they ask, with the longer timeout */
+  dcnow_worker_start_fetch(&a, 3000, DCNOW_JOB_PRIO_BACKGROUND);
+  dcnow_worker_start_fetch(&b, 1000, DCNOW_JOB_PRIO_BACKGROUND);
+  CHECK(dcnow_worker_start_fetch(&a, 5000, DCNOW_JOB_PRIO_USER) == 0, "merged fetch refused");
+  CHECK(dcnow_worker_start_fetch(&a, 4000, DCNOW_JOB_PRIO_BACKGROUND) == 0, "second merge refused");
+
+  drain("CFF", ctxs, 3, "merge");
+  CHECK(ran_param[1] == 5000 && ran_param[2] == 1000, "fetches ran as %u then %u", ran_param[1], ran_param[2]);
+
+  /* A fetch asked for while the same context's fetch runs rides along with it */
+  clear_log();
+  dcnow_worker_start_fetch(&a, 1000, DCNOW_JOB_PRIO_USER);
+  CHECK(wait_started(1), "fetch never started");
+  CHECK(dcnow_worker_start_fetch(&a, 1000, DCNOW_JOB_PRIO_USER) == 0, "fetch during a fetch refused");
+  drain("F", ctxs, 3, "merge with running");
+}
+
+static void test_cancel(void) {
+  dcnow_worker_context_t blocker = {0}, a = {0};
+  dcnow_worker_context_t *const ctxs[] = {&blocker, &a};
+
+  /* Queued: dropped without running */
+  clear_log();
+  dcnow_worker_start_connect(&blocker, DCNOW_CONN_SERIAL);
+  CHECK(wait_started(1), "connect never started");
+  dcnow_worker_start_fetch(&a, 1000, DCNOW_JOB_PRIO_USER);
+  dcnow_worker_cancel(&a);
+  CHECK(a.state == DCNOW_WORKER_IDLE, "cancelled queued fetch left state %d", a.state);
+  drain("C", ctxs, 2, "cancel queued");
+
+  /* Running: the fetch sees the flag it stops on turn, and its result is dropped */
+  clear_log();
+  dcnow_worker_start_fetch(&a, 1000, DCNOW_JOB_PRIO_USER);
+  CHECK(wait_started(1), "fetch never started");
+  CHECK(a.state == DCNOW_WORKER_FETCHING, "running fetch in state %d", a.state);
+  CHECK(cancel_flag == &a.cancel_requested && !*cancel_flag, "fetch runs without its context's cancel flag");
+  dcnow_worker_cancel(&a);
+  CHECK(cancel_flag && *cancel_flag, "cancel didn't reach the running fetch");
+  release(1);
+  CHECK(wait_idle(), "cancelled fetch kept the worker busy");
+  CHECK(a.state == DCNOW_WORKER_IDLE && !a.result_pending, "cancelled fetch left state %d", a.state);
+  CHECK(cancel_flag == NULL, "cancel flag still set after the fetch");
+
+  /* A fetch nobody waits for, asked for again while it runs */
+  clear_log();
+  CHECK(dcnow_worker_submit(NULL, DCNOW_JOB_FETCH, DCNOW_JOB_PRIO_BACKGROUND, 1000) == 0, "fetch refused");
+  CHECK(wait_started(1), "fetch never started");
+  CHECK(cancel_flag == NULL, "fetch without a context has a cancel flag");
+  CHECK(dcnow_worker_submit(NULL, DCNOW_JOB_FETCH, DCNOW_JOB_PRIO_BACKGROUND, 1000) == 0, "second fetch refused");
+  drain("FF", ctxs, 0, "fetches without a context");
+
+  /* A failed connect reports its error once, then the context is free again */
+  clear_log();
+  dcnow_worker_start_connect(&a, DCNOW_CONN_MODEM);
+  release(1);
+  CHECK(wait_state(&a, DCNOW_WORKER_ERROR, DCNOW_WORKER_ERROR), "modem connect didn't fail");
+  CHECK(a.error_code == -5, "connect error %d", a.error_code);
+  CHECK(dcnow_worker_poll(&a) == DCNOW_WORKER_ERROR && !a.result_pending, "error not handed over");
+  CHECK(wait_idle(), "worker busy after the error was polled");
+}
+
+static void test_disconnect(void) {
+  dcnow_worker_context_t blocker = {0}, a = {0}, b = {0};
+  dcnow_worker_context_t *const ctxs[] = {&blocker, &a, &b};
+
+  clear_log();
+  dcnow_worker_start_connect(&blocker, DCNOW_CONN_SERIAL);
+  CHECK(wait_started(1), "connect never started");
+  dcnow_worker_start_fetch(&a, 1000, DCNOW_JOB_PRIO_USER);
+  dcnow_worker_start_fetch(&b, 1000, DCNOW_JOB_PRIO_BACKGROUND);
+  dcnow_worker_submit(NULL, DCNOW_JOB_DNS_PREFETCH, DCNOW_JOB_PRIO_BACKGROUND, 0);
+  dcnow_worker_submit(NULL, DCNOW_JOB_DISCONNECT, DCNOW_JOB_PRIO_CONNECTION, 0);
+  CHECK(a.state == DCNOW_WORKER_IDLE && b.state == DCNOW_WORKER_IDLE, "dropped fetches left states %d, %d", a.state,
+        b.state);
+  drain("CD", ctxs, 3, "disconnect");
+}
+
+static void test_full_queue(void) {
+  dcnow_worker_context_t blocker = {0}, fetcher = {0};
+  dcnow_worker_context_t *const ctxs[] = {&blocker, &fetcher};
+  char expected[DCNOW_WORKER_QUEUE_LEN + 2];
+
+  clear_log();
+  dcnow_worker_start_connect(&blocker, DCNOW_CONN_SERIAL);
+  CHECK(wait_started(1), "connect never started");
+
+  /* The running job doesn't take a slot */
+  CHECK(dcnow_worker_start_fetch(&fetcher, 1000, DCNOW_JOB_PRIO_BACKGROUND) == 0, "fetch refused");
+  for (int i = 1; i < DCNOW_WORKER_QUEUE_LEN; i++) {
+    CHECK(dcnow_worker_submit(NULL, DCNOW_JOB_DNS_PREFETCH, DCNOW_JOB_PRIO_BACKGROUND, 0) == 0, "job %d refused", i);
+  }
+  CHECK(dcnow_worker_submit(NULL, DCNOW_JOB_DNS_PREFETCH, DCNOW_JOB_PRIO_BACKGROUND, 0) == -1,
+        "ninth job accepted");
+  CHECK(dcnow_worker_start_connect(NULL, DCNOW_CONN_SERIAL) == -1, "connect accepted into a full queue");
+  /* Merging takes no slot */
+  CHECK(dcnow_worker_start_fetch(&fetcher, 2000, DCNOW_JOB_PRIO_USER) == 0, "merge into a full queue refused");
+
+  snprintf(expected, sizeof(expected), "CF%.*s", DCNOW_WORKER_QUEUE_LEN - 1, "NNNNNNNNNNNNNNNN");
+  drain(expected, ctxs, 2, "full queue");
+  CHECK(ran_param[1] == 2000, "merged fetch ran with %u", ran_param[1]);
+
+  /* And there is room again */
+  clear_log();
+  CHECK(dcnow_worker_submit(NULL, DCNOW_JOB_DNS_PREFETCH, DCNOW_JOB_PRIO_BACKGROUND, 0) == 0, "queue still full");
+  drain("N", ctxs, 0, "after full");
+}
+
+int main(void) {
+  dcnow_worker_context_t late = {0};
+
+  dcnow_worker_init();
+
+  test_priority();
+  test_merge();
+  test_cancel();
+  test_disconnect();
+  test_full_queue();
+
+  dcnow_worker_shutdown();
+  CHECK(dcnow_worker_start_fetch(&late, 1000, DCNOW_JOB_PRIO_USER) == -2, "fetch accepted after shutdown");
+  CHECK(late.state == DCNOW_WORKER_ERROR && late.error_code == -2, "refused fetch left state %d", late.state);
+
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}